@@ -19,6 +19,7 @@
 #include <cstddef>
 #include "async_result.hpp"
 #include "basic_socket.hpp"
+#include "buffer_pool.hpp"
 #include "detail/handler_type_requirements.hpp"
 #include "detail/non_const_lvalue.hpp"
 #include "detail/throw_error.hpp"
@@ -329,6 +330,70 @@ public:
   {
   }
 
+#if !defined(ASIO_HAS_IOCP) && !defined(ASIO_WINDOWS_RUNTIME) \
+  || defined(GENERATING_DOCUMENTATION)
+  /// Gets whether asynchronous sends avoid copying data into the kernel.
+  /**
+   * @returns @c true if zero-copy sends have been enabled by calling
+   * zero_copy(bool).
+   */
+  bool zero_copy() const
+  {
+    return this->impl_.get_service().zero_copy(
+        this->impl_.get_implementation());
+  }
+
+  /// Sets whether asynchronous sends avoid copying data into the kernel.
+  /**
+   * When zero-copy sends are enabled, the asynchronous send operations
+   * @c async_send and @c async_write_some, and so the composed operation
+   * @c async_write, pass large buffers to the kernel without copying them. The
+   * handler is then called only once the kernel has finished with the data,
+   * which may be after it has been acknowledged by the peer. Until the handler
+   * is called the buffers must remain valid and must not be modified.
+   *
+   * Zero-copy is worthwhile only for sends of at least several kilobytes, and
+   * smaller sends are copied as usual. If the kernel reports that it copied
+   * the data anyway, as it does when the peer is on the same host, subsequent
+   * sends on the socket are copied.
+   *
+   * @param mode If @c true, enable zero-copy sends.
+   *
+   * @throws asio::system_error Thrown on failure. An error code of
+   * asio::error::operation_not_supported indicates that the platform
+   * does not support zero-copy sends.
+   *
+   * @note Zero-copy sends are implemented using @c MSG_ZEROCOPY, and require
+   * Linux 4.14 or later. Cancelling an operation that has passed its buffers to
+   * the kernel does not stop the kernel from reading them.
+   */
+  void zero_copy(bool mode)
+  {
+    asio::error_code ec;
+    this->impl_.get_service().zero_copy(
+        this->impl_.get_implementation(), mode, ec);
+    asio::detail::throw_error(ec, "zero_copy");
+  }
+
+  /// Sets whether asynchronous sends avoid copying data into the kernel.
+  /**
+   * See zero_copy(bool) for a description of zero-copy sends.
+   *
+   * @param mode If @c true, enable zero-copy sends.
+   *
+   * @param ec Set to indicate what error occurred, if any. An error code of
+   * asio::error::operation_not_supported indicates that the platform
+   * does not support zero-copy sends.
+   */
+  ASIO_SYNC_OP_VOID zero_copy(bool mode, asio::error_code& ec)
+  {
+    this->impl_.get_service().zero_copy(
+        this->impl_.get_implementation(), mode, ec);
+    ASIO_SYNC_OP_VOID_RETURN(ec);
+  }
+#endif // !defined(ASIO_HAS_IOCP) && !defined(ASIO_WINDOWS_RUNTIME)
+       //   || defined(GENERATING_DOCUMENTATION)
+
   /// Send some data on the socket.
   /**
    * This function is used to send data on the stream socket. The function
@@ -745,6 +810,102 @@ public:
         initiate_async_receive(this), handler, buffers, flags);
   }
 
+#if !defined(ASIO_HAS_IOCP) && !defined(ASIO_WINDOWS_RUNTIME) \
+  || defined(GENERATING_DOCUMENTATION)
+  /// Start an asynchronous receive into a buffer taken from a pool.
+  /**
+   * This function is used to asynchronously receive data from the stream
+   * socket without dedicating a buffer to the operation while it waits. A
+   * buffer is taken from the pool only when data arrives. The function call
+   * always returns immediately.
+   *
+   * @param pool The pool from which a buffer is taken. Ownership of the pool
+   * is retained by the caller, which must guarantee that it remains valid
+   * until the handler is called.
+   *
+   * @param handler The handler to be called when the receive operation
+   * completes. Copies will be made of the handler as required. The function
+   * signature of the handler must be:
+   * @code void handler(
+   *   const asio::error_code& error, // Result of operation.
+   *   asio::mutable_buffer data      // The data received.
+   * ); @endcode
+   * On success, @c data refers to the part of a pool buffer that holds the
+   * data received, and the handler must return the buffer to the pool by
+   * calling buffer_pool::release(). On failure, @c data is empty. If the pool
+   * has no buffer available when data arrives, the operation fails with the
+   * error asio::error::no_buffer_space. Regardless of whether the asynchronous
+   * operation completes immediately or not, the handler will not be invoked
+   * from within this function. On immediate completion, invocation of the
+   * handler will be performed in a manner equivalent to using
+   * asio::post().
+   *
+   * @par Example
+   * @code
+   * socket.async_receive(pool, handler);
+   * @endcode
+   */
+  template <
+      ASIO_COMPLETION_TOKEN_FOR(void (asio::error_code,
+        asio::mutable_buffer)) ReadHandler
+          ASIO_DEFAULT_COMPLETION_TOKEN_TYPE(executor_type)>
+  ASIO_INITFN_AUTO_RESULT_TYPE(ReadHandler,
+      void (asio::error_code, asio::mutable_buffer))
+  async_receive(buffer_pool& pool,
+      ASIO_MOVE_ARG(ReadHandler) handler
+        ASIO_DEFAULT_COMPLETION_TOKEN(executor_type))
+  {
+    return async_initiate<ReadHandler,
+      void (asio::error_code, asio::mutable_buffer)>(
+        initiate_async_receive_from_pool(this), handler,
+        &pool, socket_base::message_flags(0));
+  }
+
+  /// Start an asynchronous receive into a buffer taken from a pool.
+  /**
+   * This function is used to asynchronously receive data from the stream
+   * socket without dedicating a buffer to the operation while it waits. A
+   * buffer is taken from the pool only when data arrives. The function call
+   * always returns immediately.
+   *
+   * @param pool The pool from which a buffer is taken. Ownership of the pool
+   * is retained by the caller, which must guarantee that it remains valid
+   * until the handler is called.
+   *
+   * @param flags Flags specifying how the receive call is to be made.
+   *
+   * @param handler The handler to be called when the receive operation
+   * completes. Copies will be made of the handler as required. The function
+   * signature of the handler must be:
+   * @code void handler(
+   *   const asio::error_code& error, // Result of operation.
+   *   asio::mutable_buffer data      // The data received.
+   * ); @endcode
+   * On success, @c data refers to the part of a pool buffer that holds the
+   * data received, and the handler must return the buffer to the pool by
+   * calling buffer_pool::release(). On failure, @c data is empty. Regardless
+   * of whether the asynchronous operation completes immediately or not, the
+   * handler will not be invoked from within this function. On immediate
+   * completion, invocation of the handler will be performed in a manner
+   * equivalent to using asio::post().
+   */
+  template <
+      ASIO_COMPLETION_TOKEN_FOR(void (asio::error_code,
+        asio::mutable_buffer)) ReadHandler
+          ASIO_DEFAULT_COMPLETION_TOKEN_TYPE(executor_type)>
+  ASIO_INITFN_AUTO_RESULT_TYPE(ReadHandler,
+      void (asio::error_code, asio::mutable_buffer))
+  async_receive(buffer_pool& pool, socket_base::message_flags flags,
+      ASIO_MOVE_ARG(ReadHandler) handler
+        ASIO_DEFAULT_COMPLETION_TOKEN(executor_type))
+  {
+    return async_initiate<ReadHandler,
+      void (asio::error_code, asio::mutable_buffer)>(
+        initiate_async_receive_from_pool(this), handler, &pool, flags);
+  }
+#endif // !defined(ASIO_HAS_IOCP) && !defined(ASIO_WINDOWS_RUNTIME)
+       //   || defined(GENERATING_DOCUMENTATION)
+
   /// Write some data to the socket.
   /**
    * This function is used to write data to the stream socket. The function call
@@ -1040,6 +1201,37 @@ private:
   private:
     basic_stream_socket* self_;
   };
+
+#if !defined(ASIO_HAS_IOCP) && !defined(ASIO_WINDOWS_RUNTIME)
+  class initiate_async_receive_from_pool
+  {
+  public:
+    typedef Executor executor_type;
+
+    explicit initiate_async_receive_from_pool(basic_stream_socket* self)
+      : self_(self)
+    {
+    }
+
+    executor_type get_executor() const ASIO_NOEXCEPT
+    {
+      return self_->get_executor();
+    }
+
+    template <typename ReadHandler>
+    void operator()(ASIO_MOVE_ARG(ReadHandler) handler,
+        buffer_pool* pool, socket_base::message_flags flags) const
+    {
+      detail::non_const_lvalue<ReadHandler> handler2(handler);
+      self_->impl_.get_service().async_receive(
+          self_->impl_.get_implementation(), *pool, flags,
+          handler2.value, self_->impl_.get_implementation_executor());
+    }
+
+  private:
+    basic_stream_socket* self_;
+  };
+#endif // !defined(ASIO_HAS_IOCP) && !defined(ASIO_WINDOWS_RUNTIME)
 };
 
 } // namespace asio
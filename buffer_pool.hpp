@@ -0,0 +1,178 @@
+//
+// buffer_pool.hpp
+// ~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2020 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_BUFFER_POOL_HPP
+#define ASIO_BUFFER_POOL_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "detail/config.hpp"
+#include <cstddef>
+#include <vector>
+#include "buffer.hpp"
+#include "error_code.hpp"
+#include "detail/mutex.hpp"
+#include "detail/noncopyable.hpp"
+#include "detail/reactor_fwd.hpp"
+
+#include "detail/push_options.hpp"
+
+namespace asio {
+
+class io_context;
+
+namespace detail {
+  class reactive_socket_recv_pool_op_base;
+  class reactive_socket_service_base;
+} // namespace detail
+
+/// A fixed set of equally sized buffers that receive operations share.
+/**
+ * An asynchronous receive operation normally needs its own buffer for as
+ * long as it waits for data to arrive. A program with many mostly idle
+ * connections therefore keeps a large amount of memory tied up in buffers
+ * that are empty. When a stream socket's @c async_receive function is given a
+ * buffer_pool instead, the operation takes a buffer from the pool only when
+ * data arrives, and passes the filled part of the buffer to the handler. The
+ * handler must return the buffer to the pool, by calling release(), once it
+ * has finished with the data.
+ *
+ * If no buffer is available when data arrives, the operation fails with the
+ * error asio::error::no_buffer_space. If the kernel refused the buffers,
+ * the operation instead fails with the error that the kernel reported.
+ *
+ * When the io_context uses the io_uring backend and the kernel supports
+ * provided buffers, the buffers are given to the kernel, which chooses a
+ * buffer as it completes each receive. Otherwise a buffer is taken from the
+ * pool when the socket becomes ready to read.
+ *
+ * @par Thread Safety
+ * @e Distinct @e objects: Safe.@n
+ * @e Shared @e objects: Safe.
+ *
+ * The pool must be destroyed before its io_context, and must not be destroyed
+ * while receive operations that use it are outstanding.
+ *
+ * @par Example
+ * @code asio::buffer_pool pool(io_context, 4096, 1024);
+ *
+ * socket.async_receive(pool,
+ *     [&](asio::error_code ec, asio::mutable_buffer data)
+ *     {
+ *       if (!ec)
+ *       {
+ *         process(data);
+ *         pool.release(data);
+ *       }
+ *     }); @endcode
+ */
+class buffer_pool
+  : private noncopyable
+{
+public:
+  /// Construct a pool of buffers for use with the specified io_context.
+  /**
+   * @param ctx The io_context whose sockets will receive into the buffers.
+   *
+   * @param buffer_size The size of each buffer, in bytes.
+   *
+   * @param buffer_count The number of buffers.
+   *
+   * @throws asio::system_error Thrown with asio::error::invalid_argument if
+   * @c buffer_size or @c buffer_count is zero.
+   */
+  ASIO_DECL buffer_pool(io_context& ctx,
+      std::size_t buffer_size, std::size_t buffer_count);
+
+  /// Destructor.
+  ASIO_DECL ~buffer_pool();
+
+  /// Get the size of each buffer, in bytes.
+  std::size_t buffer_size() const
+  {
+    return buffer_size_;
+  }
+
+  /// Get the number of buffers.
+  std::size_t buffer_count() const
+  {
+    return buffer_count_;
+  }
+
+  /// Return a buffer to the pool.
+  /**
+   * @param buffer The buffer passed to a receive operation's handler, or any
+   * part of it.
+   */
+  ASIO_DECL void release(const mutable_buffer& buffer);
+
+private:
+  friend class detail::reactive_socket_recv_pool_op_base;
+  friend class detail::reactive_socket_service_base;
+
+  // Take a buffer from the pool. Returns 0 if none is available.
+  ASIO_DECL void* acquire();
+
+  // Get the error with which the kernel refused the pool's buffers, if any.
+  ASIO_DECL asio::error_code group_error() const;
+
+  // Get the buffer with the specified index.
+  void* get_buffer(std::size_t index) const
+  {
+    return data_ + index * buffer_size_;
+  }
+
+  // Get the group in which the buffers have been given to the specified
+  // reactor, or -1 if they have not.
+  int buffer_group(const detail::reactor* r) const
+  {
+#if defined(ASIO_HAS_IO_URING)
+    return r == reactor_ ? group_ : -1;
+#else // defined(ASIO_HAS_IO_URING)
+    (void)r;
+    return -1;
+#endif // defined(ASIO_HAS_IO_URING)
+  }
+
+  // Mutex to protect access to the free buffers.
+  detail::mutex mutex_;
+
+  // The memory that is divided into buffers.
+  unsigned char* data_;
+
+  // The size of each buffer.
+  std::size_t buffer_size_;
+
+  // The number of buffers.
+  std::size_t buffer_count_;
+
+  // The buffers that are available to be taken by a receive operation that
+  // is performed when the socket is ready to read.
+  std::vector<void*> free_buffers_;
+
+#if defined(ASIO_HAS_IO_URING)
+  // The reactor to which the buffers have been given, and the group in which
+  // they are held.
+  detail::reactor* reactor_;
+  int group_;
+#endif // defined(ASIO_HAS_IO_URING)
+};
+
+} // namespace asio
+
+#include "detail/pop_options.hpp"
+
+#if defined(ASIO_HEADER_ONLY)
+#include "impl/buffer_pool.ipp"
+#endif // defined(ASIO_HEADER_ONLY)
+
+#endif // ASIO_BUFFER_POOL_HPP
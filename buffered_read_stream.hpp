@@ -21,7 +21,6 @@
 #include "buffered_read_stream_fwd.hpp"
 #include "buffer.hpp"
 #include "detail/bind_handler.hpp"
-#include "detail/buffer_resize_guard.hpp"
 #include "detail/buffered_stream_storage.hpp"
 #include "detail/noncopyable.hpp"
 #include "detail/type_traits.hpp"
@@ -36,6 +35,12 @@ namespace asio {
  * The buffered_read_stream class template can be used to add buffering to the
  * synchronous and asynchronous read operations of a stream.
  *
+ * The buffer is circular, so consuming data never moves the data that
+ * remains. Its size adapts to the amounts of data returned by the next
+ * layer: a read that fills the available space doubles the buffer, up to 16
+ * times the size given on construction, and a run of small reads halves it
+ * again.
+ *
  * @par Thread Safety
  * @e Distinct @e objects: Safe.@n
  * @e Shared @e objects: Unsafe.
@@ -68,7 +73,7 @@ public:
   template <typename Arg>
   explicit buffered_read_stream(Arg& a)
     : next_layer_(a),
-      storage_(default_buffer_size)
+      storage_(default_buffer_size, true)
   {
   }
 
@@ -76,7 +81,7 @@ public:
   template <typename Arg>
   buffered_read_stream(Arg& a, std::size_t buffer_size)
     : next_layer_(a),
-      storage_(buffer_size)
+      storage_(buffer_size, true)
   {
   }
 
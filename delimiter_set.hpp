@@ -0,0 +1,215 @@
+//
+// delimiter_set.hpp
+// ~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2020 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_DELIMITER_SET_HPP
+#define ASIO_DELIMITER_SET_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "detail/config.hpp"
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+#include "buffer.hpp"
+#include "detail/cstdint.hpp"
+#include "detail/memory.hpp"
+
+#include "detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+// A deterministic automaton that recognises the end of any of a set of
+// delimiters, built using the Aho-Corasick algorithm.
+struct delimiter_automaton
+{
+  // The number of transitions from each state.
+  enum { alphabet_size = 256 };
+
+  // The next state for each state and byte.
+  std::vector<uint32_t> next;
+
+  // For each state, the length of the delimiter prefix that it represents.
+  std::vector<std::size_t> depth;
+
+  // For each state, whether a delimiter ends there.
+  std::vector<unsigned char> accept;
+
+  // The first byte of every delimiter, if they all share one, or -1.
+  int first_byte;
+};
+
+} // namespace detail
+
+/// A set of delimiters that may be passed to read_until and async_read_until.
+/**
+ * The delimiter_set class compiles a set of delimiters into an automaton that
+ * finds the first place in the data where any of the delimiters ends. The
+ * automaton is built once, on construction, and copies of a delimiter_set
+ * share it.
+ *
+ * A delimiter_set is a match condition, and read_until and async_read_until
+ * accept it wherever they accept a match condition. These operations
+ * recognise the type and scan each contiguous buffer of the dynamic buffer's
+ * data directly, rather than through buffers_iterator. Each call resumes
+ * from where the previous scan of the data stopped, so only the bytes at the
+ * end of the data that may begin a delimiter are scanned again.
+ *
+ * The number of bytes returned by read_until includes the delimiter that
+ * ends first. When several delimiters end at the same byte, such as "\r\n"
+ * and "\n", the result is the same whichever of them is considered to have
+ * matched.
+ *
+ * @par Thread Safety
+ * @e Distinct @e objects: Safe.@n
+ * @e Shared @e objects: Safe.
+ *
+ * @par Example
+ * Reading records that end with CR LF, LF or NUL:
+ * @code const std::string terminators[] =
+ *   { "\r\n", "\n", std::string(1, '\0') };
+ * asio::delimiter_set delims(terminators, terminators + 3);
+ * ...
+ * std::size_t n = asio::read_until(sock,
+ *     asio::dynamic_buffer(data), delims); @endcode
+ */
+class delimiter_set
+{
+public:
+  /// The result type of the match condition. Required by is_match_condition.
+  typedef bool result_type;
+
+  /// Construct a delimiter set from a range of strings.
+  /**
+   * @param first The start of the range of delimiters. The value type must be
+   * convertible to @c std::string. An empty delimiter matches immediately.
+   *
+   * @param last The end of the range of delimiters.
+   */
+  template <typename Iterator>
+  delimiter_set(Iterator first, Iterator last)
+  {
+    std::vector<std::string> delimiters;
+    for (; first != last; ++first)
+      delimiters.push_back(std::string(*first));
+    compile(delimiters);
+  }
+
+  /// Find the end of the first delimiter in a sequence of buffers.
+  /**
+   * @param buffers The data to be searched.
+   *
+   * @param position The offset in the data at which to start the search.
+   *
+   * @returns <tt>(n, true)</tt> if a delimiter was found, where @c n is the
+   * offset of the byte following the delimiter. Returns <tt>(n, false)</tt>
+   * if the data ends with the start of a delimiter, where @c n is the offset
+   * of that start. Otherwise returns <tt>(buffer_size(buffers), false)</tt>.
+   */
+  template <typename ConstBufferSequence>
+  std::pair<std::size_t, bool> search(const ConstBufferSequence& buffers,
+      std::size_t position) const
+  {
+    return search(asio::buffer_sequence_begin(buffers),
+        asio::buffer_sequence_end(buffers), position);
+  }
+
+  /// Find the end of the first delimiter in a range of bytes.
+  /**
+   * This function implements the match condition requirements of read_until.
+   * The iterator type must be a random access iterator whose value type is
+   * convertible to @c char, such as buffers_iterator.
+   *
+   * @returns <tt>(i, true)</tt> if a delimiter was found, where @c i refers
+   * to the byte following the delimiter. Returns <tt>(i, false)</tt> if the
+   * range ends with the start of a delimiter, where @c i refers to that
+   * start. Otherwise returns <tt>(end, false)</tt>.
+   */
+  template <typename Iterator>
+  std::pair<Iterator, bool> operator()(Iterator begin, Iterator end) const
+  {
+    const detail::delimiter_automaton& a = *automaton_;
+    if (a.accept[0])
+      return std::make_pair(begin, true);
+
+    std::size_t state = 0;
+    for (Iterator iter = begin; iter != end;)
+    {
+      state = a.next[state * detail::delimiter_automaton::alphabet_size
+        + static_cast<unsigned char>(*iter++)];
+      if (a.accept[state])
+        return std::make_pair(iter, true);
+    }
+    return std::make_pair(
+        end - static_cast<std::ptrdiff_t>(a.depth[state]), false);
+  }
+
+private:
+  // Build the automaton for the given delimiters.
+  ASIO_DECL void compile(const std::vector<std::string>& delimiters);
+
+  // Find the end of the first delimiter in a sequence of buffers. Each buffer
+  // is scanned directly. While no delimiter is partly matched, a byte that
+  // starts every delimiter is located using memchr.
+  template <typename Iterator>
+  std::pair<std::size_t, bool> search(Iterator begin, Iterator end,
+      std::size_t position) const
+  {
+    const detail::delimiter_automaton& a = *automaton_;
+    if (a.accept[0])
+      return std::make_pair(position, true);
+
+    std::size_t state = 0;
+    std::size_t offset = 0;
+    for (Iterator iter = begin; iter != end; ++iter)
+    {
+      const_buffer buffer(*iter);
+      std::size_t size = buffer.size();
+      const unsigned char* data =
+        static_cast<const unsigned char*>(buffer.data());
+      std::size_t i = position > offset ? position - offset : 0;
+      while (i < size)
+      {
+        if (state == 0 && a.first_byte >= 0)
+        {
+          using namespace std; // For memchr.
+          const void* p = memchr(data + i, a.first_byte, size - i);
+          if (!p)
+            break;
+          i = static_cast<const unsigned char*>(p) - data;
+        }
+
+        state = a.next[state * detail::delimiter_automaton::alphabet_size
+          + data[i++]];
+        if (a.accept[state])
+          return std::make_pair(offset + i, true);
+      }
+      offset += size;
+    }
+    return std::make_pair(offset - a.depth[state], false);
+  }
+
+  // The automaton, which is shared between copies.
+  detail::shared_ptr<const detail::delimiter_automaton> automaton_;
+};
+
+} // namespace asio
+
+#include "detail/pop_options.hpp"
+
+#if defined(ASIO_HEADER_ONLY)
+#include "impl/delimiter_set.ipp"
+#endif // defined(ASIO_HEADER_ONLY)
+
+#endif // ASIO_DELIMITER_SET_HPP
@@ -0,0 +1,63 @@
+//
+// detail/affinity_thread_function.hpp
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2020 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_DETAIL_AFFINITY_THREAD_FUNCTION_HPP
+#define ASIO_DETAIL_AFFINITY_THREAD_FUNCTION_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "../detail/config.hpp"
+#include <cstddef>
+#include "../error_code.hpp"
+#include "../thread_affinity.hpp"
+
+#include "../detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+// Wraps a thread's function so that the thread binds itself to a CPU set
+// before doing anything else. Any memory the function allocates is then
+// first touched on the CPUs where it will be used.
+template <typename Function>
+class affinity_thread_function
+{
+public:
+  affinity_thread_function(Function f,
+      const thread_affinity& affinity, std::size_t thread_index)
+    : function_(f),
+      affinity_(affinity),
+      thread_index_(thread_index)
+  {
+  }
+
+  void operator()()
+  {
+    // A failure cannot be reported to the thread's creator, so the function
+    // is run unbound instead.
+    asio::error_code ec;
+    affinity_.apply(thread_index_, ec);
+    function_();
+  }
+
+private:
+  Function function_;
+  thread_affinity affinity_;
+  std::size_t thread_index_;
+};
+
+} // namespace detail
+} // namespace asio
+
+#include "../detail/pop_options.hpp"
+
+#endif // ASIO_DETAIL_AFFINITY_THREAD_FUNCTION_HPP
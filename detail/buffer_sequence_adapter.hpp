@@ -18,6 +18,8 @@
 #include "../detail/config.hpp"
 #include "../buffer.hpp"
 #include "../detail/array_fwd.hpp"
+#include "../detail/noncopyable.hpp"
+#include "../detail/recycling_allocator.hpp"
 #include "../detail/socket_types.hpp"
 
 #include "../detail/push_options.hpp"
@@ -32,6 +34,9 @@ public:
   // The maximum number of buffers to support in a single operation.
   enum { max_buffers = 1 };
 
+  // The maximum number of buffers in a single gather or scatter operation.
+  enum { max_gather_buffers = max_buffers };
+
 protected:
   typedef Windows::Storage::Streams::IBuffer^ native_buffer_type;
 
@@ -47,6 +52,9 @@ public:
   // The maximum number of buffers to support in a single operation.
   enum { max_buffers = 64 < max_iov_len ? 64 : max_iov_len };
 
+  // The maximum number of buffers in a single gather or scatter operation.
+  enum { max_gather_buffers = max_buffers };
+
 protected:
   typedef WSABUF native_buffer_type;
 
@@ -65,9 +73,14 @@ protected:
   }
 #else // defined(ASIO_WINDOWS) || defined(__CYGWIN__)
 public:
-  // The maximum number of buffers to support in a single operation.
+  // The number of native buffers held in the adapter itself, and so on the
+  // stack. Longer sequences use an allocated array.
   enum { max_buffers = 64 < max_iov_len ? 64 : max_iov_len };
 
+  // The maximum number of buffers in a single gather or scatter operation,
+  // which is as many as the kernel accepts.
+  enum { max_gather_buffers = max_iov_len };
+
 protected:
   typedef iovec native_buffer_type;
 
@@ -96,6 +109,72 @@ protected:
     iov.iov_len = buffer.size();
   }
 #endif // defined(ASIO_WINDOWS) || defined(__CYGWIN__)
+
+protected:
+  // Count the buffers in a range, up to the given limit.
+  template <typename Iterator>
+  static std::size_t count_buffers(Iterator begin, Iterator end,
+      std::size_t limit)
+  {
+    std::size_t n = 0;
+    for (Iterator iter = begin; iter != end && n < limit; ++iter)
+      ++n;
+    return n;
+  }
+};
+
+// Holds the native buffers for an adapter. Up to LocalSize buffers are held in
+// the object itself. A longer array is allocated from the calling thread's
+// recycled memory.
+template <typename NativeBuffer, std::size_t LocalSize>
+class native_buffer_array
+  : private noncopyable
+{
+public:
+  native_buffer_array()
+    : buffers_(local_),
+      capacity_(LocalSize)
+  {
+  }
+
+  ~native_buffer_array()
+  {
+    if (buffers_ != local_)
+      recycling_allocator<NativeBuffer>().deallocate(buffers_, capacity_);
+  }
+
+  NativeBuffer* data()
+  {
+    return buffers_;
+  }
+
+  NativeBuffer& operator[](std::size_t i)
+  {
+    return buffers_[i];
+  }
+
+  std::size_t capacity() const
+  {
+    return capacity_;
+  }
+
+  // Move to an array of the given size, keeping the first count buffers.
+  void grow(std::size_t new_capacity, std::size_t count)
+  {
+    NativeBuffer* buffers =
+      recycling_allocator<NativeBuffer>().allocate(new_capacity);
+    for (std::size_t i = 0; i < count; ++i)
+      buffers[i] = buffers_[i];
+    if (buffers_ != local_)
+      recycling_allocator<NativeBuffer>().deallocate(buffers_, capacity_);
+    buffers_ = buffers;
+    capacity_ = new_capacity;
+  }
+
+private:
+  NativeBuffer local_[LocalSize];
+  NativeBuffer* buffers_;
+  std::size_t capacity_;
 };
 
 // Helper class to translate buffers into the native buffer representation.
@@ -116,7 +195,7 @@ public:
 
   native_buffer_type* buffers()
   {
-    return buffers_;
+    return buffers_.data();
   }
 
   std::size_t count() const
@@ -170,8 +249,14 @@ private:
   void init(Iterator begin, Iterator end)
   {
     Iterator iter = begin;
-    for (; iter != end && count_ < max_buffers; ++iter, ++count_)
+    for (; iter != end && count_ < max_gather_buffers; ++iter, ++count_)
     {
+      if (count_ == buffers_.capacity())
+      {
+        buffers_.grow(count_ + count_buffers(iter, end,
+              max_gather_buffers - count_), count_);
+      }
+
       Buffer buffer(*iter);
       init_native_buffer(buffers_[count_], buffer);
       total_buffer_size_ += buffer.size();
@@ -183,7 +268,7 @@ private:
   {
     Iterator iter = begin;
     std::size_t i = 0;
-    for (; iter != end && i < max_buffers; ++iter, ++i)
+    for (; iter != end && i < max_gather_buffers; ++iter, ++i)
       if (Buffer(*iter).size() > 0)
         return false;
     return true;
@@ -237,7 +322,7 @@ private:
     return Buffer(storage.data(), storage.size() - unused_storage.size());
   }
 
-  native_buffer_type buffers_[max_buffers];
+  native_buffer_array<native_buffer_type, max_buffers> buffers_;
   std::size_t count_;
   std::size_t total_buffer_size_;
 };
@@ -638,6 +723,118 @@ private:
 
 #endif // defined(ASIO_HAS_STD_ARRAY)
 
+#if !defined(ASIO_WINDOWS_RUNTIME)
+
+// Helper class to translate buffers into the native buffer representation for
+// a gather operation, copying runs of adjacent small buffers into storage held
+// by the adapter so that each run occupies a single native buffer. The native
+// buffers are valid only for the lifetime of the adapter, and so must not be
+// used with operations that complete after the call, such as zero-copy sends.
+template <typename Buffers>
+class flattened_buffer_sequence_adapter
+  : buffer_sequence_adapter_base
+{
+public:
+  // The number of bytes that may be copied by a single adapter.
+  enum { storage_size = 4096 };
+
+  // Buffers smaller than flatten_size bytes are copied.
+  flattened_buffer_sequence_adapter(const Buffers& buffer_sequence,
+      std::size_t flatten_size)
+    : count_(0), total_buffer_size_(0), storage_used_(0)
+  {
+    flattened_buffer_sequence_adapter::init(
+        asio::buffer_sequence_begin(buffer_sequence),
+        asio::buffer_sequence_end(buffer_sequence), flatten_size);
+  }
+
+  native_buffer_type* buffers()
+  {
+    return buffers_.data();
+  }
+
+  std::size_t count() const
+  {
+    return count_;
+  }
+
+  std::size_t total_size() const
+  {
+    return total_buffer_size_;
+  }
+
+  bool all_empty() const
+  {
+    return total_buffer_size_ == 0;
+  }
+
+private:
+  template <typename Iterator>
+  void init(Iterator begin, Iterator end, std::size_t flatten_size)
+  {
+    // The last native buffer is either a small buffer that has not yet been
+    // copied, or a run that has, or neither.
+    asio::const_buffer pending;
+    std::size_t run_start = 0;
+    bool in_run = false;
+
+    Iterator iter = begin;
+    for (; iter != end; ++iter)
+    {
+      asio::const_buffer buffer(*iter);
+      if (buffer.size() == 0)
+        continue;
+
+      // Copying a buffer is cheaper than passing it separately only when it
+      // can be joined with its neighbour.
+      if (buffer.size() < flatten_size && count_ > 0
+          && (pending.size() > 0 || in_run)
+          && pending.size() + buffer.size() <= storage_size - storage_used_)
+      {
+        if (!in_run)
+        {
+          run_start = storage_used_;
+          storage_used_ += asio::buffer_copy(
+              asio::buffer(storage_ + storage_used_,
+                storage_size - storage_used_), pending);
+          pending = asio::const_buffer();
+          in_run = true;
+        }
+
+        storage_used_ += asio::buffer_copy(
+            asio::buffer(storage_ + storage_used_,
+              storage_size - storage_used_), buffer);
+        init_native_buffer(buffers_[count_ - 1], asio::const_buffer(
+              storage_ + run_start, storage_used_ - run_start));
+        total_buffer_size_ += buffer.size();
+        continue;
+      }
+
+      if (count_ == max_gather_buffers)
+        break;
+      if (count_ == buffers_.capacity())
+      {
+        buffers_.grow(count_ + count_buffers(iter, end,
+              max_gather_buffers - count_), count_);
+      }
+
+      init_native_buffer(buffers_[count_++], buffer);
+      total_buffer_size_ += buffer.size();
+      pending = buffer.size() < flatten_size
+        ? buffer : asio::const_buffer();
+      in_run = false;
+    }
+  }
+
+  native_buffer_array<native_buffer_type, max_buffers> buffers_;
+  std::size_t count_;
+  std::size_t total_buffer_size_;
+  unsigned char storage_[storage_size];
+  std::size_t storage_used_;
+};
+
+#endif // !defined(ASIO_WINDOWS_RUNTIME)
+
 } // namespace detail
 } // namespace asio
 
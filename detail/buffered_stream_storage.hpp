@@ -17,9 +17,10 @@
 
 #include "../detail/config.hpp"
 #include "../buffer.hpp"
+#include "../detail/array.hpp"
 #include "../detail/assert.hpp"
+#include "../detail/limits.hpp"
 #include <cstddef>
-#include <cstring>
 #include <vector>
 
 #include "../detail/push_options.hpp"
@@ -27,6 +28,9 @@
 namespace asio {
 namespace detail {
 
+// A circular buffer. The unread data, and the space following it, may each
+// wrap around the end of the underlying memory, so each is represented by up
+// to two buffers. Consuming data never moves the data that remains.
 class buffered_stream_storage
 {
 public:
@@ -36,10 +40,31 @@ public:
   // The type used for offsets into the buffer.
   typedef std::size_t size_type;
 
-  // Constructor.
-  explicit buffered_stream_storage(std::size_t buffer_capacity)
+  // The type used to represent the unread data or the free space.
+  typedef array<mutable_buffer, 2> mutable_buffers_type;
+
+  // The type used to represent the unread data.
+  typedef array<const_buffer, 2> const_buffers_type;
+
+  // The factor by which an adaptive buffer may grow beyond its initial size.
+  enum { max_growth = 16 };
+
+  // The number of consecutive small fills after which an adaptive buffer
+  // shrinks.
+  enum { shrink_threshold = 16 };
+
+  // Constructor. An adaptive buffer changes its capacity to suit the amounts
+  // of data recorded by record_fill(), between the given capacity and
+  // max_growth times that capacity.
+  explicit buffered_stream_storage(std::size_t buffer_capacity,
+      bool adaptive = false)
     : begin_offset_(0),
-      end_offset_(0),
+      size_(0),
+      min_capacity_(buffer_capacity),
+      max_capacity_(adaptive && buffer_capacity
+          <= (std::numeric_limits<std::size_t>::max)() / max_growth
+        ? buffer_capacity * max_growth : buffer_capacity),
+      small_fills_(0),
       buffer_(buffer_capacity)
   {
   }
@@ -48,72 +73,141 @@ public:
   void clear()
   {
     begin_offset_ = 0;
-    end_offset_ = 0;
+    size_ = 0;
+  }
+
+  // Return the buffers that represent the unread data.
+  mutable_buffers_type data()
+  {
+    std::size_t first = first_size(begin_offset_, size_);
+    mutable_buffers_type bufs = {{
+      asio::buffer(asio::buffer(buffer_) + begin_offset_, first),
+      asio::buffer(buffer_, size_ - first) }};
+    return bufs;
+  }
+
+  // Return the buffers that represent the unread data.
+  const_buffers_type data() const
+  {
+    std::size_t first = first_size(begin_offset_, size_);
+    const_buffers_type bufs = {{
+      asio::buffer(asio::buffer(buffer_) + begin_offset_, first),
+      asio::buffer(buffer_, size_ - first) }};
+    return bufs;
   }
 
-  // Return a pointer to the beginning of the unread data.
-  mutable_buffer data()
+  // Return the buffers that represent the free space following the unread
+  // data.
+  mutable_buffers_type prepare()
   {
-    return asio::buffer(buffer_) + begin_offset_;
+    std::size_t end_offset = (begin_offset_ + size_) % capacity_or_one();
+    std::size_t space = capacity() - size_;
+    std::size_t first = first_size(end_offset, space);
+    mutable_buffers_type bufs = {{
+      asio::buffer(asio::buffer(buffer_) + end_offset, first),
+      asio::buffer(buffer_, space - first) }};
+    return bufs;
   }
 
-  // Return a pointer to the beginning of the unread data.
-  const_buffer data() const
+  // Append bytes written to the free space to the unread data.
+  void commit(size_type count)
   {
-    return asio::buffer(buffer_) + begin_offset_;
+    ASIO_ASSERT(size_ + count <= capacity());
+    size_ += count;
   }
 
   // Is there no unread data in the buffer.
   bool empty() const
   {
-    return begin_offset_ == end_offset_;
+    return size_ == 0;
   }
 
   // Return the amount of unread data the is in the buffer.
   size_type size() const
   {
-    return end_offset_ - begin_offset_;
+    return size_;
   }
 
-  // Resize the buffer to the specified length.
-  void resize(size_type length)
+  // Return the maximum size for data in the buffer.
+  size_type capacity() const
   {
-    ASIO_ASSERT(length <= capacity());
-    if (begin_offset_ + length <= capacity())
+    return buffer_.size();
+  }
+
+  // Consume multiple bytes from the beginning of the buffer.
+  void consume(size_type count)
+  {
+    ASIO_ASSERT(count <= size_);
+    size_ -= count;
+    begin_offset_ = size_ == 0 ? 0 : (begin_offset_ + count) % capacity();
+  }
+
+  // Record that a read into the free space, which had the given size,
+  // transferred the given number of bytes. For an adaptive buffer, a read
+  // that fills the space doubles the capacity, and a run of reads that each
+  // use less than a quarter of it halves the capacity.
+  void record_fill(size_type space, size_type count)
+  {
+    if (count == space && space != 0)
     {
-      end_offset_ = begin_offset_ + length;
+      small_fills_ = 0;
+      if (capacity() < max_capacity_)
+        reallocate(capacity() < max_capacity_ / 2
+            ? capacity() * 2 : max_capacity_);
+    }
+    else if (count < capacity() / 4)
+    {
+      if (++small_fills_ >= shrink_threshold)
+      {
+        small_fills_ = 0;
+        if (capacity() > min_capacity_ && size_ <= capacity() / 2)
+          reallocate(capacity() / 2 > min_capacity_
+              ? capacity() / 2 : min_capacity_);
+      }
     }
     else
     {
-      using namespace std; // For memmove.
-      memmove(&buffer_[0], &buffer_[0] + begin_offset_, size());
-      end_offset_ = length;
-      begin_offset_ = 0;
+      small_fills_ = 0;
     }
   }
 
-  // Return the maximum size for data in the buffer.
-  size_type capacity() const
+private:
+  // Return the number of bytes of a region of the given size, starting at the
+  // given offset, that precede the end of the underlying memory.
+  std::size_t first_size(std::size_t offset, std::size_t n) const
   {
-    return buffer_.size();
+    std::size_t to_end = capacity() - offset;
+    return n < to_end ? n : to_end;
   }
 
-  // Consume multiple bytes from the beginning of the buffer.
-  void consume(size_type count)
+  // Return the capacity, or one for a zero-sized buffer.
+  std::size_t capacity_or_one() const
   {
-    ASIO_ASSERT(begin_offset_ + count <= end_offset_);
-    begin_offset_ += count;
-    if (empty())
-      clear();
+    return buffer_.empty() ? 1 : buffer_.size();
+  }
+
+  // Move the unread data to new memory of the given size.
+  void reallocate(size_type new_capacity)
+  {
+    std::vector<byte_type> new_buffer(new_capacity);
+    asio::buffer_copy(asio::buffer(new_buffer), data());
+    buffer_.swap(new_buffer);
+    begin_offset_ = 0;
   }
 
-private:
   // The offset to the beginning of the unread data.
   size_type begin_offset_;
 
-  // The offset to the end of the unread data.
-  size_type end_offset_;
-  
+  // The amount of unread data.
+  size_type size_;
+
+  // The limits on the capacity of an adaptive buffer.
+  size_type min_capacity_;
+  size_type max_capacity_;
+
+  // The number of consecutive fills that used little of the capacity.
+  size_type small_fills_;
+
   // The data in the buffer.
   std::vector<byte_type> buffer_;
 };
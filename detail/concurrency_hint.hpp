@@ -33,6 +33,10 @@
 // If set, this bit indicates that the reactor should perform locking for I/O.
 #define ASIO_CONCURRENCY_HINT_LOCKING_REACTOR_IO 0x4u
 
+// If set, this bit indicates that the scheduler should give each thread its
+// own queue of ready handlers, with idle threads stealing from their peers.
+#define ASIO_CONCURRENCY_HINT_WORK_STEALING_SCHEDULER 0x8u
+
 // Helper macro to determine if we have a special concurrency hint.
 #define ASIO_CONCURRENCY_HINT_IS_SPECIAL(hint) \
   ((static_cast<unsigned>(hint) \
@@ -46,6 +50,12 @@
       | ASIO_CONCURRENCY_HINT_LOCKING_ ## facility)) \
         ^ ASIO_CONCURRENCY_HINT_ID) != 0)
 
+// Helper macro to determine if work stealing is enabled in the scheduler.
+#define ASIO_CONCURRENCY_HINT_IS_WORK_STEALING(hint) \
+  (ASIO_CONCURRENCY_HINT_IS_SPECIAL(hint) \
+    && (static_cast<unsigned>(hint) \
+      & ASIO_CONCURRENCY_HINT_WORK_STEALING_SCHEDULER) != 0)
+
 // This special concurrency hint disables locking in both the scheduler and
 // reactor I/O. This hint has the following restrictions:
 //
@@ -78,6 +88,18 @@
       | ASIO_CONCURRENCY_HINT_LOCKING_REACTOR_REGISTRATION \
       | ASIO_CONCURRENCY_HINT_LOCKING_REACTOR_IO)
 
+// This special concurrency hint provides full thread safety, and gives each
+// thread that runs the io_context its own queue of ready handlers. Handlers
+// posted from within a handler stay on the posting thread's queue, idle
+// threads steal from the queues of busy threads, and the shared queue is used
+// only for handlers posted from threads outside the io_context.
+#define ASIO_CONCURRENCY_HINT_WORK_STEALING \
+  static_cast<int>(ASIO_CONCURRENCY_HINT_ID \
+      | ASIO_CONCURRENCY_HINT_LOCKING_SCHEDULER \
+      | ASIO_CONCURRENCY_HINT_LOCKING_REACTOR_REGISTRATION \
+      | ASIO_CONCURRENCY_HINT_LOCKING_REACTOR_IO \
+      | ASIO_CONCURRENCY_HINT_WORK_STEALING_SCHEDULER)
+
 // This #define may be overridden at compile time to specify a program-wide
 // default concurrency hint, used by the zero-argument io_context constructor.
 #if !defined(ASIO_CONCURRENCY_HINT_DEFAULT)
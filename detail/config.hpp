@@ -1109,7 +1109,8 @@
 # include <unistd.h>
 #endif // defined(ASIO_HAS_UNISTD_H)
 
-// Linux: epoll, eventfd and timerfd.
+// Linux: epoll, eventfd, timerfd, (opt-in) io_uring, MSG_ZEROCOPY, splice,
+// memfd-backed ring buffers.
 #if defined(__linux__)
 # include <linux/version.h>
 # if !defined(ASIO_HAS_EPOLL)
@@ -1133,6 +1134,36 @@
 #   endif // (__GLIBC__ > 2) || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 8)
 #  endif // defined(ASIO_HAS_EPOLL)
 # endif // !defined(ASIO_HAS_TIMERFD)
+# if defined(ASIO_HAS_IO_URING)
+#  if defined(ASIO_DISABLE_IO_URING) \
+    || (LINUX_VERSION_CODE < KERNEL_VERSION(5,6,0))
+#   undef ASIO_HAS_IO_URING
+#  endif // defined(ASIO_DISABLE_IO_URING)
+         //   || (LINUX_VERSION_CODE < KERNEL_VERSION(5,6,0))
+# endif // defined(ASIO_HAS_IO_URING)
+# if !defined(ASIO_HAS_MSG_ZEROCOPY)
+#  if !defined(ASIO_DISABLE_MSG_ZEROCOPY)
+#   if defined(ASIO_HAS_EPOLL) || defined(ASIO_HAS_IO_URING)
+#    if LINUX_VERSION_CODE >= KERNEL_VERSION(4,14,0)
+#     define ASIO_HAS_MSG_ZEROCOPY 1
+#    endif // LINUX_VERSION_CODE >= KERNEL_VERSION(4,14,0)
+#   endif // defined(ASIO_HAS_EPOLL) || defined(ASIO_HAS_IO_URING)
+#  endif // !defined(ASIO_DISABLE_MSG_ZEROCOPY)
+# endif // !defined(ASIO_HAS_MSG_ZEROCOPY)
+# if !defined(ASIO_HAS_SPLICE)
+#  if !defined(ASIO_DISABLE_SPLICE)
+#   if LINUX_VERSION_CODE >= KERNEL_VERSION(2,6,33)
+#    define ASIO_HAS_SPLICE 1
+#   endif // LINUX_VERSION_CODE >= KERNEL_VERSION(2,6,33)
+#  endif // !defined(ASIO_DISABLE_SPLICE)
+# endif // !defined(ASIO_HAS_SPLICE)
+# if !defined(ASIO_HAS_RING_BUFFER)
+#  if !defined(ASIO_DISABLE_RING_BUFFER)
+#   if LINUX_VERSION_CODE >= KERNEL_VERSION(3,17,0)
+#    define ASIO_HAS_RING_BUFFER 1
+#   endif // LINUX_VERSION_CODE >= KERNEL_VERSION(3,17,0)
+#  endif // !defined(ASIO_DISABLE_RING_BUFFER)
+# endif // !defined(ASIO_HAS_RING_BUFFER)
 #endif // defined(__linux__)
 
 // Mac OS X, FreeBSD, NetBSD, OpenBSD: kqueue.
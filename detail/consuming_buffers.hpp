@@ -56,7 +56,9 @@ struct prepared_buffers
   typedef Buffer value_type;
   typedef const Buffer* const_iterator;
 
-  enum { max_buffers = MaxBuffers < 16 ? MaxBuffers : 16 };
+  // The prepared buffers are copied into each operation, so their number is
+  // limited to keep the operation's size within the recycled memory blocks.
+  enum { max_buffers = MaxBuffers < 64 ? MaxBuffers : 64 };
 
   prepared_buffers() : count(0) {}
   const_iterator begin() const { return elems; }
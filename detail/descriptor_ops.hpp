@@ -24,6 +24,7 @@
 #include <cstddef>
 #include "../error.hpp"
 #include "../error_code.hpp"
+#include "../detail/cstdint.hpp"
 #include "../detail/socket_types.hpp"
 
 #include "../detail/push_options.hpp"
@@ -122,6 +123,20 @@ ASIO_DECL int poll_write(int d,
 ASIO_DECL int poll_error(int d,
     state_type state, asio::error_code& ec);
 
+#if defined(ASIO_HAS_SPLICE)
+
+ASIO_DECL int create_pipe(int descriptors[2], asio::error_code& ec);
+
+ASIO_DECL bool non_blocking_splice(int in_d, int out_d,
+    std::size_t size, asio::error_code& ec,
+    std::size_t& bytes_transferred);
+
+ASIO_DECL bool non_blocking_sendfile(int out_d, int in_d,
+    uint64_t& offset, std::size_t size, asio::error_code& ec,
+    std::size_t& bytes_transferred);
+
+#endif // defined(ASIO_HAS_SPLICE)
+
 } // namespace descriptor_ops
 } // namespace detail
 } // namespace asio
@@ -150,6 +150,12 @@ public:
   // Interrupt the select loop.
   ASIO_DECL void interrupt();
 
+  // Release memory retained for reuse. Nothing is retained, so this does
+  // nothing.
+  void trim()
+  {
+  }
+
 private:
   // Create the /dev/poll file descriptor. Throws an exception if the descriptor
   // cannot be created.
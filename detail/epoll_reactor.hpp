@@ -19,17 +19,22 @@
 
 #if defined(ASIO_HAS_EPOLL)
 
+#include <vector>
+#include <sys/epoll.h>
 #include "../detail/atomic_count.hpp"
 #include "../detail/conditionally_enabled_mutex.hpp"
+#include "../detail/cstdint.hpp"
 #include "../detail/limits.hpp"
 #include "../detail/object_pool.hpp"
 #include "../detail/op_queue.hpp"
 #include "../detail/reactor_op.hpp"
+#include "../detail/relaxed_atomic.hpp"
 #include "../detail/select_interrupter.hpp"
 #include "../detail/socket_types.hpp"
 #include "../detail/timer_queue_base.hpp"
 #include "../detail/timer_queue_set.hpp"
 #include "../detail/wait_op.hpp"
+#include "../detail/zero_copy_tracker.hpp"
 #include "../execution_context.hpp"
 
 #if defined(ASIO_HAS_TIMERFD)
@@ -69,6 +74,14 @@ public:
     bool try_speculative_[max_ops];
     bool shutdown_;
 
+#if defined(ASIO_HAS_MSG_ZEROCOPY)
+    zero_copy_tracker zero_copy_;
+#endif // defined(ASIO_HAS_MSG_ZEROCOPY)
+
+    // The number of times the object has been returned to the scheduler as a
+    // descriptor operation and not yet performed.
+    atomic_count pending_;
+
     ASIO_DECL descriptor_state(bool locking);
     void set_ready_events(uint32_t events) { task_result_ = events; }
     void add_ready_events(uint32_t events) { task_result_ |= events; }
@@ -148,6 +161,17 @@ public:
   ASIO_DECL void cleanup_descriptor_data(
       per_descriptor_data& descriptor_data);
 
+#if defined(ASIO_HAS_MSG_ZEROCOPY)
+  // Get the object that tracks the zero-copy sends made on a descriptor. It
+  // may be used only by the descriptor's operations, which are performed with
+  // the descriptor's lock held.
+  zero_copy_tracker* get_zero_copy_tracker(
+      per_descriptor_data& descriptor_data)
+  {
+    return descriptor_data ? &descriptor_data->zero_copy_ : 0;
+  }
+#endif // defined(ASIO_HAS_MSG_ZEROCOPY)
+
   // Add a new timer queue to the reactor.
   template <typename Time_Traits>
   void add_timer_queue(timer_queue<Time_Traits>& timer_queue);
@@ -182,6 +206,29 @@ public:
   // Interrupt the select loop.
   ASIO_DECL void interrupt();
 
+  // Get the number of events returned by the most recent call to epoll_wait.
+  // May be called from any thread.
+  std::size_t last_event_count() const
+  {
+    return last_event_count_.load();
+  }
+
+  // Get the maximum number of events that the next call to epoll_wait may
+  // return. May be called from any thread.
+  std::size_t batch_size() const
+  {
+    return batch_size_.load();
+  }
+
+  // Request that freed descriptor state objects be destroyed, and that the
+  // memory they occupied be released where possible. The objects are
+  // destroyed by the thread running the task, the next time it runs.
+  ASIO_DECL void trim();
+
+  // Get the number of freed descriptor state objects that are retained for
+  // reuse.
+  ASIO_DECL std::size_t free_descriptor_states();
+
 private:
   // The hint to pass to epoll_create to size its data structures.
   enum { epoll_size = 20000 };
@@ -199,6 +246,19 @@ private:
   // Free an existing descriptor state object.
   ASIO_DECL void free_descriptor_state(descriptor_state* s);
 
+  // Destroy freed descriptor state objects that can no longer be accessed.
+  // Must only be called by the thread running the task, before it fetches
+  // new events.
+  ASIO_DECL void trim_descriptor_states();
+
+  // Determine whether a freed descriptor state object can no longer be
+  // accessed: it has been removed from the epoll set, and it is not waiting
+  // to be performed as a descriptor operation.
+  static bool is_unreferenced(descriptor_state* s)
+  {
+    return s->registered_events_ == 0 && s->pending_ == 0;
+  }
+
   // Helper function to add a new timer queue.
   ASIO_DECL void do_add_timer_queue(timer_queue_base& queue);
 
@@ -214,6 +274,10 @@ private:
   ASIO_DECL int get_timeout(int msec);
 
 #if defined(ASIO_HAS_TIMERFD)
+  // Set the timer descriptor to expire when the next timer is due, unless it
+  // is already set to expire within the timer slack after that time.
+  ASIO_DECL void update_timer_fd();
+
   // Get the timeout value for the timer descriptor. The return value is the
   // flag argument to be used when calling timerfd_settime.
   ASIO_DECL int get_timeout(itimerspec& ts);
@@ -234,6 +298,28 @@ private:
   // The timer file descriptor.
   int timer_fd_;
 
+  // The time, in microseconds, by which timers may be late so that more of
+  // them can be handled by a single wakeup.
+  const long timer_slack_usec_;
+
+  // The absolute CLOCK_MONOTONIC time, in microseconds, at which the timer
+  // descriptor was last set to expire, or zero if it was set without slack.
+  int64_t timer_fd_expiry_usec_;
+
+  // The bounds on the number of events fetched by each call to epoll_wait,
+  // and whether the number is adapted between them.
+  const std::size_t min_batch_size_;
+  const std::size_t max_batch_size_;
+  const bool adaptive_batch_;
+
+  // The number of events fetched by each call to epoll_wait, the number
+  // returned by the most recent call, and the buffer that receives them. Only
+  // the thread running the task modifies these, but the counts may be read by
+  // any thread.
+  relaxed_atomic<std::size_t> batch_size_;
+  relaxed_atomic<std::size_t> last_event_count_;
+  std::vector<epoll_event> events_;
+
   // The timer queues.
   timer_queue_set timer_queues_;
 
@@ -246,6 +332,21 @@ private:
   // Keep track of all registered descriptors.
   object_pool<descriptor_state> registered_descriptors_;
 
+  // The number of freed descriptor state objects retained for reuse, beyond
+  // which they are destroyed. If unbounded, descriptors that are closed are
+  // not explicitly removed from the epoll set until a trim is requested.
+  const std::size_t max_free_descriptor_states_;
+
+  // Whether the next trim should destroy all unreferenced objects, rather
+  // than only those beyond the limit. Protected by the descriptors mutex.
+  bool trim_all_;
+
+  // The number of times a trim has been requested, and the number of those
+  // requests that the thread running the task has seen. The count is never
+  // reset, so a nonzero value also means that trims are in use.
+  atomic_count trim_requests_;
+  long trims_performed_;
+
   // Helper class to do post-perform_io cleanup.
   struct perform_io_cleanup_on_block_exit;
   friend struct perform_io_cleanup_on_block_exit;
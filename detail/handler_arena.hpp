@@ -0,0 +1,150 @@
+//
+// detail/handler_arena.hpp
+// ~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2020 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_DETAIL_HANDLER_ARENA_HPP
+#define ASIO_DETAIL_HANDLER_ARENA_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "../detail/config.hpp"
+#include <cstddef>
+#include <cstring>
+#include "../detail/atomic_count.hpp"
+#include "../detail/mutex.hpp"
+#include "../detail/noncopyable.hpp"
+#include "../detail/relaxed_atomic.hpp"
+
+#include "../detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+// A fixed amount of memory, reserved up front, from which an io_context's
+// handler memory is allocated. The memory is divided into blocks of a fixed
+// set of sizes, with the same number of blocks of each size.
+//
+// Each allocation of handler memory, whether from an arena or not, is
+// followed by a tag byte. The tag of a block from an arena is followed by a
+// pointer to the arena, so that the block can be returned to it by any thread
+// without a search.
+class handler_arena
+  : private noncopyable
+{
+public:
+  // Blocks are powers of two in size, from the smallest block size up to that
+  // of the largest size class.
+  enum { smallest_block_size = 64 };
+  enum { num_size_classes = 6 };
+
+  // The number of bytes that must follow an allocation made elsewhere, to
+  // hold its tag.
+  enum { tag_size = 1 };
+
+  // Create an arena with the specified number of blocks of each size.
+  ASIO_DECL static handler_arena* create(std::size_t blocks_per_size_class);
+
+  // Give up ownership of the arena. It is destroyed once all of its blocks
+  // have been deallocated.
+  ASIO_DECL void release();
+
+  // Allocate a block large enough for the specified size and its tag. Returns
+  // 0 if the size is too large or no block of a suitable size is free.
+  ASIO_DECL void* allocate(std::size_t size);
+
+  // Deallocate a block that was allocated from the arena.
+  ASIO_DECL void deallocate(void* pointer);
+
+  // Get the number of bytes in blocks that are currently allocated.
+  std::size_t bytes_allocated() const
+  {
+    return bytes_allocated_.load();
+  }
+
+  // Get the largest number of bytes that have been allocated at one time.
+  std::size_t peak_bytes_allocated() const
+  {
+    return peak_bytes_allocated_.load();
+  }
+
+  // Tag a block of the specified size that was not allocated from an arena.
+  // The block must have room for the tag after that size.
+  static void* tag_unowned(void* pointer, std::size_t size)
+  {
+    static_cast<unsigned char*>(pointer)[size] = 0;
+    return pointer;
+  }
+
+  // Find the arena from which a block was allocated, given the size that was
+  // requested for it. Returns 0 if the block was not allocated from an arena.
+  static handler_arena* find(const void* pointer, std::size_t size)
+  {
+    const unsigned char* tag
+      = static_cast<const unsigned char*>(pointer) + size;
+    if (*tag != arena_tag)
+      return 0;
+    handler_arena* arena;
+    std::memcpy(&arena, tag + 1, sizeof(arena));
+    return arena;
+  }
+
+private:
+  // The tag value of a block allocated from an arena.
+  enum { arena_tag = 1 };
+
+  // Constructor.
+  ASIO_DECL explicit handler_arena(std::size_t blocks_per_size_class);
+
+  // Destructor.
+  ASIO_DECL ~handler_arena();
+
+  // Header of an unused block.
+  struct free_block
+  {
+    free_block* next_;
+  };
+
+  // The unused blocks of one size. Each size has its own mutex, so that
+  // allocations of different sizes do not contend with each other.
+  struct size_class
+  {
+    mutex mutex_;
+    free_block* free_blocks_;
+  };
+
+  // The memory from which blocks are allocated.
+  unsigned char* begin_;
+
+  // The number of blocks of each size.
+  std::size_t blocks_per_size_class_;
+
+  // The unused blocks of each size.
+  size_class size_classes_[num_size_classes];
+
+  // The number of bytes currently allocated, and the peak.
+  relaxed_atomic<std::size_t> bytes_allocated_;
+  relaxed_atomic<std::size_t> peak_bytes_allocated_;
+
+  // One reference for the owner, and one for each allocated block. The arena
+  // is destroyed when the last of them goes.
+  atomic_count ref_count_;
+};
+
+} // namespace detail
+} // namespace asio
+
+#include "../detail/pop_options.hpp"
+
+#if defined(ASIO_HEADER_ONLY)
+#include "../detail/impl/handler_arena.ipp"
+#endif // defined(ASIO_HEADER_ONLY)
+
+#endif // ASIO_DETAIL_HANDLER_ARENA_HPP
@@ -24,6 +24,11 @@
   && !defined(ASIO_WINDOWS_RUNTIME) \
   && !defined(__CYGWIN__)
 
+#if defined(ASIO_HAS_SPLICE)
+# include <fcntl.h>
+# include <sys/sendfile.h>
+#endif // defined(ASIO_HAS_SPLICE)
+
 #include "../../detail/push_options.hpp"
 
 namespace asio {
@@ -595,6 +600,84 @@ int poll_error(int d, state_type state, asio::error_code& ec)
   return result;
 }
 
+#if defined(ASIO_HAS_SPLICE)
+
+int create_pipe(int descriptors[2], asio::error_code& ec)
+{
+  int result = ::pipe2(descriptors, O_NONBLOCK | O_CLOEXEC);
+  get_last_error(ec, result != 0);
+  return result;
+}
+
+bool non_blocking_splice(int in_d, int out_d,
+    std::size_t size, asio::error_code& ec,
+    std::size_t& bytes_transferred)
+{
+  for (;;)
+  {
+    // Move some data. Either descriptor may be a pipe.
+    signed_size_type bytes = ::splice(in_d, 0, out_d, 0,
+        size, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+    get_last_error(ec, bytes < 0);
+
+    // Check if operation succeeded.
+    if (bytes >= 0)
+    {
+      bytes_transferred = bytes;
+      return true;
+    }
+
+    // Retry operation if interrupted by signal.
+    if (ec == asio::error::interrupted)
+      continue;
+
+    // Check if we need to run the operation again.
+    if (ec == asio::error::would_block
+        || ec == asio::error::try_again)
+      return false;
+
+    // Operation failed.
+    bytes_transferred = 0;
+    return true;
+  }
+}
+
+bool non_blocking_sendfile(int out_d, int in_d,
+    uint64_t& offset, std::size_t size, asio::error_code& ec,
+    std::size_t& bytes_transferred)
+{
+  for (;;)
+  {
+    // Send some data from the file.
+    off_t file_offset = static_cast<off_t>(offset);
+    signed_size_type bytes = ::sendfile(out_d, in_d, &file_offset, size);
+    get_last_error(ec, bytes < 0);
+
+    // Check if operation succeeded.
+    if (bytes >= 0)
+    {
+      offset += bytes;
+      bytes_transferred = bytes;
+      return true;
+    }
+
+    // Retry operation if interrupted by signal.
+    if (ec == asio::error::interrupted)
+      continue;
+
+    // Check if we need to run the operation again.
+    if (ec == asio::error::would_block
+        || ec == asio::error::try_again)
+      return false;
+
+    // Operation failed.
+    bytes_transferred = 0;
+    return true;
+  }
+}
+
+#endif // defined(ASIO_HAS_SPLICE)
+
 } // namespace descriptor_ops
 } // namespace detail
 } // namespace asio
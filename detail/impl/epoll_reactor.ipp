@@ -27,6 +27,7 @@
 
 #if defined(ASIO_HAS_TIMERFD)
 # include <sys/timerfd.h>
+# include <time.h>
 #endif // defined(ASIO_HAS_TIMERFD)
 
 #include "../../detail/push_options.hpp"
@@ -42,8 +43,25 @@ epoll_reactor::epoll_reactor(asio::execution_context& ctx)
     interrupter_(),
     epoll_fd_(do_epoll_create()),
     timer_fd_(do_timerfd_create()),
+    timer_slack_usec_(scheduler_.options().timer_slack_usec() > 0
+        ? scheduler_.options().timer_slack_usec() : 0),
+    timer_fd_expiry_usec_(0),
+    min_batch_size_(scheduler_.options().reactor_batch_size() > 0
+        ? scheduler_.options().reactor_batch_size() : 1),
+    max_batch_size_(scheduler_.options().adaptive_reactor_batch()
+        && scheduler_.options().max_reactor_batch_size() > min_batch_size_
+        ? scheduler_.options().max_reactor_batch_size() : min_batch_size_),
+    adaptive_batch_(max_batch_size_ > min_batch_size_),
+    batch_size_(min_batch_size_),
+    last_event_count_(0),
+    events_(max_batch_size_),
     shutdown_(false),
-    registered_descriptors_mutex_(mutex_.enabled())
+    registered_descriptors_mutex_(mutex_.enabled()),
+    max_free_descriptor_states_(
+        scheduler_.options().max_free_descriptor_states()),
+    trim_all_(false),
+    trim_requests_(0),
+    trims_performed_(0)
 {
   // Add the interrupter's descriptor to epoll.
   epoll_event ev = { 0, { 0 } };
@@ -104,6 +122,7 @@ void epoll_reactor::notify_fork(
       ::close(timer_fd_);
     timer_fd_ = -1;
     timer_fd_ = do_timerfd_create();
+    timer_fd_expiry_usec_ = 0;
 
     interrupter_.recreate();
 
@@ -164,6 +183,9 @@ int epoll_reactor::register_descriptor(socket_type descriptor,
     descriptor_data->shutdown_ = false;
     for (int i = 0; i < max_ops; ++i)
       descriptor_data->try_speculative_[i] = true;
+#if defined(ASIO_HAS_MSG_ZEROCOPY)
+    descriptor_data->zero_copy_.reset();
+#endif // defined(ASIO_HAS_MSG_ZEROCOPY)
   }
 
   epoll_event ev = { 0, { 0 } };
@@ -352,15 +374,21 @@ void epoll_reactor::deregister_descriptor(socket_type descriptor,
 
   if (!descriptor_data->shutdown_)
   {
-    if (closing)
+    if (closing && max_free_descriptor_states_ == (std::numeric_limits<
+          std::size_t>::max)() && trim_requests_ == 0)
     {
       // The descriptor will be automatically removed from the epoll set when
-      // it is closed.
+      // it is closed. However, a duplicate of the descriptor keeps the
+      // registration alive, so the descriptor state object must be retained
+      // in case of further events. Once freed objects may be destroyed,
+      // either because their number is bounded or because a trim has been
+      // requested, the descriptor is removed explicitly instead.
     }
     else if (descriptor_data->registered_events_ != 0)
     {
       epoll_event ev = { 0, { 0 } };
       epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, descriptor, &ev);
+      descriptor_data->registered_events_ = 0;
     }
 
     op_queue<operation> ops;
@@ -408,6 +436,7 @@ void epoll_reactor::deregister_internal_descriptor(socket_type descriptor,
   {
     epoll_event ev = { 0, { 0 } };
     epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, descriptor, &ev);
+    descriptor_data->registered_events_ = 0;
 
     op_queue<operation> ops;
     for (int i = 0; i < max_ops; ++i)
@@ -451,6 +480,16 @@ void epoll_reactor::run(long usec, op_queue<operation>& ops)
   // operations have already been dequeued. Therefore it is now safe for us to
   // reuse and return them for the scheduler to queue again.
 
+  // Destroy freed descriptor states before fetching any new events, so that
+  // every earlier event is already accounted for in the states' counts of
+  // pending operations.
+  long trim_requests = trim_requests_;
+  if (trim_requests != trims_performed_)
+  {
+    trims_performed_ = trim_requests;
+    trim_descriptor_states();
+  }
+
   // Calculate timeout. Check the timer queues only if timerfd is not in use.
   int timeout;
   if (usec == 0)
@@ -466,8 +505,28 @@ void epoll_reactor::run(long usec, op_queue<operation>& ops)
   }
 
   // Block on the epoll descriptor.
-  epoll_event events[128];
-  int num_events = epoll_wait(epoll_fd_, events, 128, timeout);
+  epoll_event* events = &events_[0];
+  std::size_t batch_size = batch_size_.load();
+  int num_events = epoll_wait(epoll_fd_,
+      events, static_cast<int>(batch_size), timeout);
+  std::size_t event_count = num_events > 0 ? num_events : 0;
+  last_event_count_.store(event_count);
+
+  // Grow the batch when it was filled, and shrink it when it was mostly
+  // unused.
+  if (adaptive_batch_)
+  {
+    if (event_count == batch_size && batch_size < max_batch_size_)
+    {
+      batch_size_.store(batch_size * 2 < max_batch_size_
+          ? batch_size * 2 : max_batch_size_);
+    }
+    else if (event_count < batch_size / 4 && batch_size > min_batch_size_)
+    {
+      batch_size_.store(batch_size / 2 > min_batch_size_
+          ? batch_size / 2 : min_batch_size_);
+    }
+  }
 
 #if defined(ASIO_ENABLE_HANDLER_TRACKING)
   // Trace the waiting events.
@@ -538,6 +597,7 @@ void epoll_reactor::run(long usec, op_queue<operation>& ops)
       if (!ops.is_enqueued(descriptor_data))
       {
         descriptor_data->set_ready_events(events[i].events);
+        ++descriptor_data->pending_;
         ops.push(descriptor_data);
       }
       else
@@ -554,12 +614,7 @@ void epoll_reactor::run(long usec, op_queue<operation>& ops)
 
 #if defined(ASIO_HAS_TIMERFD)
     if (timer_fd_ != -1)
-    {
-      itimerspec new_timeout;
-      itimerspec old_timeout;
-      int flags = get_timeout(new_timeout);
-      timerfd_settime(timer_fd_, flags, &new_timeout, &old_timeout);
-    }
+      update_timer_fd();
 #endif // defined(ASIO_HAS_TIMERFD)
   }
 }
@@ -632,6 +687,32 @@ void epoll_reactor::free_descriptor_state(epoll_reactor::descriptor_state* s)
 {
   mutex::scoped_lock descriptors_lock(registered_descriptors_mutex_);
   registered_descriptors_.free(s);
+  if (registered_descriptors_.free_count() > max_free_descriptor_states_)
+    ++trim_requests_;
+}
+
+void epoll_reactor::trim()
+{
+  mutex::scoped_lock descriptors_lock(registered_descriptors_mutex_);
+  trim_all_ = true;
+  ++trim_requests_;
+  descriptors_lock.unlock();
+
+  interrupt();
+}
+
+std::size_t epoll_reactor::free_descriptor_states()
+{
+  mutex::scoped_lock descriptors_lock(registered_descriptors_mutex_);
+  return registered_descriptors_.free_count();
+}
+
+void epoll_reactor::trim_descriptor_states()
+{
+  mutex::scoped_lock descriptors_lock(registered_descriptors_mutex_);
+  std::size_t max_free = trim_all_ ? 0 : max_free_descriptor_states_;
+  trim_all_ = false;
+  registered_descriptors_.trim(max_free, &epoll_reactor::is_unreferenced);
 }
 
 void epoll_reactor::do_add_timer_queue(timer_queue_base& queue)
@@ -651,10 +732,7 @@ void epoll_reactor::update_timeout()
 #if defined(ASIO_HAS_TIMERFD)
   if (timer_fd_ != -1)
   {
-    itimerspec new_timeout;
-    itimerspec old_timeout;
-    int flags = get_timeout(new_timeout);
-    timerfd_settime(timer_fd_, flags, &new_timeout, &old_timeout);
+    update_timer_fd();
     return;
   }
 #endif // defined(ASIO_HAS_TIMERFD)
@@ -666,11 +744,58 @@ int epoll_reactor::get_timeout(int msec)
   // By default we will wait no longer than 5 minutes. This will ensure that
   // any changes to the system clock are detected after no longer than this.
   const int max_msec = 5 * 60 * 1000;
-  return timer_queues_.wait_duration_msec(
-      (msec < 0 || max_msec < msec) ? max_msec : msec);
+  if (msec < 0 || max_msec < msec)
+    msec = max_msec;
+  int timeout = timer_queues_.wait_duration_msec(msec);
+
+  // Wake no earlier than required, so that timers expiring within the slack
+  // of the earliest one are handled by the same wakeup.
+  if (timer_slack_usec_ > 0 && timeout > 0 && timeout < msec)
+  {
+    long slack_msec = (timer_slack_usec_ - 1) / 1000 + 1;
+    timeout = (msec - timeout > slack_msec)
+      ? timeout + static_cast<int>(slack_msec) : msec;
+  }
+
+  return timeout;
 }
 
 #if defined(ASIO_HAS_TIMERFD)
+void epoll_reactor::update_timer_fd()
+{
+  itimerspec new_timeout;
+  itimerspec old_timeout;
+
+  const long max_usec = 5 * 60 * 1000 * 1000;
+  long usec = timer_slack_usec_ > 0
+    ? timer_queues_.wait_duration_usec(max_usec) : 0;
+  timespec now;
+  if (usec > 0 && usec < max_usec
+      && ::clock_gettime(CLOCK_MONOTONIC, &now) == 0)
+  {
+    // Any time within the slack after the earliest expiry will do. Keep the
+    // current setting if it falls in that window, so that scheduling many
+    // timers with similar expiry times changes the timer descriptor only once.
+    int64_t earliest = static_cast<int64_t>(now.tv_sec) * 1000000
+      + now.tv_nsec / 1000 + usec;
+    if (timer_fd_expiry_usec_ >= earliest
+        && timer_fd_expiry_usec_ - earliest <= timer_slack_usec_)
+      return;
+
+    timer_fd_expiry_usec_ = earliest + timer_slack_usec_;
+    new_timeout.it_interval.tv_sec = 0;
+    new_timeout.it_interval.tv_nsec = 0;
+    new_timeout.it_value.tv_sec = timer_fd_expiry_usec_ / 1000000;
+    new_timeout.it_value.tv_nsec = (timer_fd_expiry_usec_ % 1000000) * 1000;
+    timerfd_settime(timer_fd_, TFD_TIMER_ABSTIME, &new_timeout, &old_timeout);
+    return;
+  }
+
+  timer_fd_expiry_usec_ = 0;
+  int flags = get_timeout(new_timeout);
+  timerfd_settime(timer_fd_, flags, &new_timeout, &old_timeout);
+}
+
 int epoll_reactor::get_timeout(itimerspec& ts)
 {
   ts.it_interval.tv_sec = 0;
@@ -719,7 +844,8 @@ struct epoll_reactor::perform_io_cleanup_on_block_exit
 
 epoll_reactor::descriptor_state::descriptor_state(bool locking)
   : operation(&epoll_reactor::descriptor_state::do_complete),
-    mutex_(locking)
+    mutex_(locking),
+    pending_(0)
 {
 }
 
@@ -770,7 +896,12 @@ void epoll_reactor::descriptor_state::do_complete(
   {
     descriptor_state* descriptor_data = static_cast<descriptor_state*>(base);
     uint32_t events = static_cast<uint32_t>(bytes_transferred);
-    if (operation* op = descriptor_data->perform_io(events))
+    operation* op = descriptor_data->perform_io(events);
+
+    // The descriptor state may be destroyed as soon as this is decremented.
+    --descriptor_data->pending_;
+
+    if (op)
     {
       op->complete(owner, ec, 0);
     }
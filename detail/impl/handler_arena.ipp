@@ -0,0 +1,132 @@
+//
+// detail/impl/handler_arena.ipp
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2020 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_DETAIL_IMPL_HANDLER_ARENA_IPP
+#define ASIO_DETAIL_IMPL_HANDLER_ARENA_IPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "../../detail/config.hpp"
+#include <cstring>
+#include <new>
+#include "../../detail/handler_arena.hpp"
+
+#include "../../detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+handler_arena* handler_arena::create(std::size_t blocks_per_size_class)
+{
+  return new handler_arena(blocks_per_size_class);
+}
+
+handler_arena::handler_arena(std::size_t blocks_per_size_class)
+  : begin_(0),
+    blocks_per_size_class_(blocks_per_size_class),
+    bytes_allocated_(0),
+    peak_bytes_allocated_(0),
+    ref_count_(1)
+{
+  // The blocks of each size class follow those of the next smaller size.
+  std::size_t size = blocks_per_size_class
+    * smallest_block_size * ((1 << num_size_classes) - 1);
+  begin_ = static_cast<unsigned char*>(::operator new(size));
+
+  // Touch all of the memory now, rather than while handling a load spike.
+  unsigned char* p = begin_;
+  for (int i = 0; i < num_size_classes; ++i)
+  {
+    std::size_t block_size = static_cast<std::size_t>(smallest_block_size) << i;
+    size_classes_[i].free_blocks_ = 0;
+    for (std::size_t j = 0; j < blocks_per_size_class; ++j, p += block_size)
+    {
+      free_block* block = reinterpret_cast<free_block*>(p);
+      block->next_ = size_classes_[i].free_blocks_;
+      size_classes_[i].free_blocks_ = block;
+    }
+  }
+}
+
+handler_arena::~handler_arena()
+{
+  ::operator delete(begin_);
+}
+
+void handler_arena::release()
+{
+  if (ref_count_down(ref_count_))
+    delete this;
+}
+
+void* handler_arena::allocate(std::size_t size)
+{
+  // The block also holds the tag and a pointer to the arena.
+  std::size_t tagged_size = size + tag_size + sizeof(handler_arena*);
+  int i = 0;
+  std::size_t block_size = smallest_block_size;
+  while (block_size < tagged_size)
+  {
+    if (++i == num_size_classes)
+      return 0;
+    block_size *= 2;
+  }
+
+  mutex::scoped_lock lock(size_classes_[i].mutex_);
+  free_block* block = size_classes_[i].free_blocks_;
+  if (block == 0)
+    return 0;
+  size_classes_[i].free_blocks_ = block->next_;
+  lock.unlock();
+
+  ref_count_up(ref_count_);
+  peak_bytes_allocated_.raise(bytes_allocated_.add(block_size));
+
+  unsigned char* tag = reinterpret_cast<unsigned char*>(block) + size;
+  tag[0] = arena_tag;
+  handler_arena* arena = this;
+  std::memcpy(tag + 1, &arena, sizeof(arena));
+  return block;
+}
+
+void handler_arena::deallocate(void* pointer)
+{
+  // Find the size class from the block's position in the arena.
+  std::size_t offset = static_cast<unsigned char*>(pointer) - begin_;
+  int i = 0;
+  std::size_t block_size = smallest_block_size;
+  std::size_t class_size = blocks_per_size_class_ * block_size;
+  while (offset >= class_size)
+  {
+    offset -= class_size;
+    ++i;
+    block_size *= 2;
+    class_size *= 2;
+  }
+
+  mutex::scoped_lock lock(size_classes_[i].mutex_);
+  free_block* block = static_cast<free_block*>(pointer);
+  block->next_ = size_classes_[i].free_blocks_;
+  size_classes_[i].free_blocks_ = block;
+  lock.unlock();
+
+  bytes_allocated_.subtract(block_size);
+  if (ref_count_down(ref_count_))
+    delete this;
+}
+
+} // namespace detail
+} // namespace asio
+
+#include "../../detail/pop_options.hpp"
+
+#endif // ASIO_DETAIL_IMPL_HANDLER_ARENA_IPP
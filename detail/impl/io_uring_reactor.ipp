@@ -0,0 +1,1040 @@
+//
+// detail/impl/io_uring_reactor.ipp
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2020 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_DETAIL_IMPL_IO_URING_REACTOR_IPP
+#define ASIO_DETAIL_IMPL_IO_URING_REACTOR_IPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "../../detail/config.hpp"
+
+#if defined(ASIO_HAS_IO_URING)
+
+#include <cstddef>
+#include <cstring>
+#include <ctime>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include "../../detail/io_uring_reactor.hpp"
+#include "../../detail/scheduler.hpp"
+#include "../../detail/throw_error.hpp"
+#include "../../error.hpp"
+
+#include "../../detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+io_uring_reactor::io_uring_reactor(asio::execution_context& ctx)
+  : execution_context_service_base<io_uring_reactor>(ctx),
+    scheduler_(use_service<scheduler>(ctx)),
+    mutex_(ASIO_CONCURRENCY_HINT_IS_LOCKING(
+          REACTOR_IO, scheduler_.concurrency_hint())),
+    sq_tail_(0),
+    waiting_(false),
+    timeouts_outstanding_(0),
+    wait_timeouts_outstanding_(0),
+    shutdown_(false),
+    next_buffer_group_(0),
+    registered_descriptors_mutex_(mutex_.enabled())
+{
+  do_ring_create(ring_);
+  sq_tail_ = *ring_.sq_tail_;
+
+  std::memset(&timeout_ts_, 0, sizeof(timeout_ts_));
+  std::memset(&wait_ts_, 0, sizeof(wait_ts_));
+
+  // Arm the timeout used to wake up for expired timers. The submission will
+  // be passed to the kernel the first time the task is run.
+  mutex::scoped_lock lock(mutex_);
+  update_timeout();
+}
+
+io_uring_reactor::~io_uring_reactor()
+{
+  do_ring_destroy(ring_);
+}
+
+void io_uring_reactor::shutdown()
+{
+  mutex::scoped_lock lock(mutex_);
+  shutdown_ = true;
+  lock.unlock();
+
+  // The kernel may still be writing into the buffers of operations that are
+  // in flight, so cancel them and wait for the kernel to release them before
+  // the operations are destroyed.
+  int num_in_flight = 0;
+  for (descriptor_state* state = registered_descriptors_.first();
+      state != 0; state = state->next_)
+  {
+    mutex::scoped_lock descriptor_lock(state->mutex_);
+    for (int i = 0; i < max_ops; ++i)
+      cancel_head_op(state, i);
+    num_in_flight += state->num_in_flight_;
+  }
+
+  lock.lock();
+  submit_sqes();
+  lock.unlock();
+
+  while (num_in_flight > 0)
+  {
+    unsigned head = *ring_.cq_head_;
+    unsigned tail = __atomic_load_n(ring_.cq_tail_, __ATOMIC_ACQUIRE);
+    if (head == tail)
+    {
+      if (::syscall(__NR_io_uring_enter, ring_.fd_, 0, 1,
+            IORING_ENTER_GETEVENTS, 0, 0) < 0 && errno != EINTR)
+        break;
+      continue;
+    }
+
+    for (; head != tail; ++head)
+    {
+      __u64 user_data = ring_.cqes_[head & *ring_.cq_mask_].user_data;
+      if (user_data != 0
+          && user_data != reinterpret_cast<__u64>(&timer_queues_)
+          && user_data != reinterpret_cast<__u64>(&wait_ts_)
+          && !is_buffer_user_data(user_data))
+      {
+        descriptor_state* state = reinterpret_cast<descriptor_state*>(
+            user_data & ~static_cast<__u64>(3));
+        int op_type = static_cast<int>(user_data & 3);
+        if (state->in_flight_[op_type])
+        {
+          state->in_flight_[op_type] = false;
+          --state->num_in_flight_;
+          --num_in_flight;
+        }
+      }
+    }
+
+    __atomic_store_n(ring_.cq_head_, head, __ATOMIC_RELEASE);
+  }
+
+  op_queue<operation> ops;
+
+  while (descriptor_state* state = registered_descriptors_.first())
+  {
+    for (int i = 0; i < max_ops; ++i)
+      ops.push(state->op_queue_[i]);
+    state->shutdown_ = true;
+    registered_descriptors_.free(state);
+  }
+
+  timer_queues_.get_all_timers(ops);
+
+  scheduler_.abandon_operations(ops);
+}
+
+void io_uring_reactor::notify_fork(
+    asio::execution_context::fork_event fork_ev)
+{
+  if (fork_ev == asio::execution_context::fork_child)
+  {
+    // The ring is shared with the parent, so the child needs its own.
+    do_ring_destroy(ring_);
+    do_ring_create(ring_);
+
+    mutex::scoped_lock lock(mutex_);
+    sq_tail_ = *ring_.sq_tail_;
+    waiting_ = false;
+    timeouts_outstanding_ = 0;
+    wait_timeouts_outstanding_ = 0;
+    update_timeout();
+    lock.unlock();
+
+    // Resubmit the operations that were in flight in the parent.
+    mutex::scoped_lock descriptors_lock(registered_descriptors_mutex_);
+    for (descriptor_state* state = registered_descriptors_.first();
+        state != 0; state = state->next_)
+    {
+      mutex::scoped_lock descriptor_lock(state->mutex_);
+      state->num_in_flight_ = 0;
+      for (int i = 0; i < max_ops; ++i)
+      {
+        state->in_flight_[i] = false;
+        state->cancel_requested_[i] = false;
+        if (!state->shutdown_ && !state->op_queue_[i].empty())
+          if (!arm_head_op(state, i, true))
+          {
+            asio::error_code ec(asio::error::no_buffer_space);
+            asio::detail::throw_error(ec, "io_uring re-registration");
+          }
+      }
+    }
+  }
+}
+
+void io_uring_reactor::init_task()
+{
+  scheduler_.init_task();
+}
+
+int io_uring_reactor::register_descriptor(socket_type descriptor,
+    io_uring_reactor::per_descriptor_data& descriptor_data)
+{
+  descriptor_data = allocate_descriptor_state();
+
+  ASIO_HANDLER_REACTOR_REGISTRATION((
+        context(), static_cast<uintmax_t>(descriptor),
+        reinterpret_cast<uintmax_t>(descriptor_data)));
+
+  mutex::scoped_lock descriptor_lock(descriptor_data->mutex_);
+
+  descriptor_data->descriptor_ = descriptor;
+  descriptor_data->num_in_flight_ = 0;
+  descriptor_data->shutdown_ = false;
+  descriptor_data->cleanup_pending_ = false;
+  for (int i = 0; i < max_ops; ++i)
+  {
+    descriptor_data->try_speculative_[i] = true;
+    descriptor_data->in_flight_[i] = false;
+    descriptor_data->completion_[i] = false;
+    descriptor_data->cancel_requested_[i] = false;
+  }
+#if defined(ASIO_HAS_MSG_ZEROCOPY)
+  descriptor_data->zero_copy_.reset();
+#endif // defined(ASIO_HAS_MSG_ZEROCOPY)
+
+  // Unlike epoll, no registration with the kernel is required until an
+  // operation is started.
+  return 0;
+}
+
+int io_uring_reactor::register_internal_descriptor(
+    int op_type, socket_type descriptor,
+    io_uring_reactor::per_descriptor_data& descriptor_data, reactor_op* op)
+{
+  register_descriptor(descriptor, descriptor_data);
+
+  mutex::scoped_lock descriptor_lock(descriptor_data->mutex_);
+
+  descriptor_data->op_queue_[op_type].push(op);
+  if (!arm_head_op(descriptor_data, op_type, false))
+  {
+    descriptor_data->op_queue_[op_type].pop();
+    return op->ec_.value();
+  }
+
+  return 0;
+}
+
+void io_uring_reactor::move_descriptor(socket_type,
+    io_uring_reactor::per_descriptor_data& target_descriptor_data,
+    io_uring_reactor::per_descriptor_data& source_descriptor_data)
+{
+  target_descriptor_data = source_descriptor_data;
+  source_descriptor_data = 0;
+}
+
+void io_uring_reactor::start_op(int op_type, socket_type,
+    io_uring_reactor::per_descriptor_data& descriptor_data, reactor_op* op,
+    bool is_continuation, bool allow_speculative)
+{
+  if (!descriptor_data)
+  {
+    op->ec_ = asio::error::bad_descriptor;
+    post_immediate_completion(op, is_continuation);
+    return;
+  }
+
+  mutex::scoped_lock descriptor_lock(descriptor_data->mutex_);
+
+  if (descriptor_data->shutdown_)
+  {
+    post_immediate_completion(op, is_continuation);
+    return;
+  }
+
+  if (descriptor_data->op_queue_[op_type].empty())
+  {
+    if (allow_speculative
+        && (op_type != read_op
+          || descriptor_data->op_queue_[except_op].empty()))
+    {
+      if (descriptor_data->try_speculative_[op_type])
+      {
+        if (reactor_op::status status = op->perform())
+        {
+          if (status == reactor_op::done_and_exhausted)
+            descriptor_data->try_speculative_[op_type] = false;
+          descriptor_lock.unlock();
+          scheduler_.post_immediate_completion(op, is_continuation);
+          return;
+        }
+      }
+    }
+
+    descriptor_data->op_queue_[op_type].push(op);
+    if (!arm_head_op(descriptor_data, op_type, true))
+    {
+      descriptor_data->op_queue_[op_type].pop();
+      descriptor_lock.unlock();
+      scheduler_.post_immediate_completion(op, is_continuation);
+      return;
+    }
+  }
+  else
+  {
+    descriptor_data->op_queue_[op_type].push(op);
+  }
+
+  scheduler_.work_started();
+}
+
+void io_uring_reactor::cancel_ops(socket_type,
+    io_uring_reactor::per_descriptor_data& descriptor_data)
+{
+  if (!descriptor_data)
+    return;
+
+  mutex::scoped_lock descriptor_lock(descriptor_data->mutex_);
+
+  op_queue<operation> ops;
+  cancel_all_ops(descriptor_data, ops);
+
+  descriptor_lock.unlock();
+
+  scheduler_.post_deferred_completions(ops);
+}
+
+void io_uring_reactor::deregister_descriptor(socket_type descriptor,
+    io_uring_reactor::per_descriptor_data& descriptor_data, bool)
+{
+  (void)descriptor;
+
+  if (!descriptor_data)
+    return;
+
+  mutex::scoped_lock descriptor_lock(descriptor_data->mutex_);
+
+  if (!descriptor_data->shutdown_)
+  {
+    op_queue<operation> ops;
+    cancel_all_ops(descriptor_data, ops);
+
+    // Submissions refer to the descriptor by number, so any that are still
+    // queued must reach the kernel before the descriptor can be closed.
+    if (descriptor_data->num_in_flight_ > 0)
+    {
+      mutex::scoped_lock lock(mutex_);
+      submit_sqes();
+    }
+
+    descriptor_data->descriptor_ = -1;
+    descriptor_data->shutdown_ = true;
+
+    descriptor_lock.unlock();
+
+    ASIO_HANDLER_REACTOR_DEREGISTRATION((
+          context(), static_cast<uintmax_t>(descriptor),
+          reinterpret_cast<uintmax_t>(descriptor_data)));
+
+    scheduler_.post_deferred_completions(ops);
+
+    // Leave descriptor_data set so that it will be freed by the subsequent
+    // call to cleanup_descriptor_data.
+  }
+  else
+  {
+    // We are shutting down, so prevent cleanup_descriptor_data from freeing
+    // the descriptor_data object and let the destructor free it instead.
+    descriptor_data = 0;
+  }
+}
+
+void io_uring_reactor::deregister_internal_descriptor(socket_type descriptor,
+    io_uring_reactor::per_descriptor_data& descriptor_data)
+{
+  (void)descriptor;
+
+  if (!descriptor_data)
+    return;
+
+  mutex::scoped_lock descriptor_lock(descriptor_data->mutex_);
+
+  if (!descriptor_data->shutdown_)
+  {
+    // Internal operations only ever wait for readiness, so the kernel holds
+    // no references into them and they may be destroyed immediately.
+    op_queue<operation> ops;
+    for (int i = 0; i < max_ops; ++i)
+    {
+      cancel_head_op(descriptor_data, i);
+      ops.push(descriptor_data->op_queue_[i]);
+    }
+
+    if (descriptor_data->num_in_flight_ > 0)
+    {
+      mutex::scoped_lock lock(mutex_);
+      submit_sqes();
+    }
+
+    descriptor_data->descriptor_ = -1;
+    descriptor_data->shutdown_ = true;
+
+    descriptor_lock.unlock();
+
+    ASIO_HANDLER_REACTOR_DEREGISTRATION((
+          context(), static_cast<uintmax_t>(descriptor),
+          reinterpret_cast<uintmax_t>(descriptor_data)));
+
+    // Leave descriptor_data set so that it will be freed by the subsequent
+    // call to cleanup_descriptor_data.
+  }
+  else
+  {
+    // We are shutting down, so prevent cleanup_descriptor_data from freeing
+    // the descriptor_data object and let the destructor free it instead.
+    descriptor_data = 0;
+  }
+}
+
+void io_uring_reactor::cleanup_descriptor_data(
+    per_descriptor_data& descriptor_data)
+{
+  if (descriptor_data)
+  {
+    // If submissions are still in flight then the descriptor state is freed
+    // once the last of their completions has been processed.
+    mutex::scoped_lock descriptor_lock(descriptor_data->mutex_);
+    if (descriptor_data->num_in_flight_ > 0)
+    {
+      descriptor_data->cleanup_pending_ = true;
+    }
+    else
+    {
+      descriptor_lock.unlock();
+      free_descriptor_state(descriptor_data);
+    }
+    descriptor_data = 0;
+  }
+}
+
+void io_uring_reactor::run(long usec, op_queue<operation>& ops)
+{
+  mutex::scoped_lock lock(mutex_);
+
+  // Bound the wait using a timeout submission. A timeout left over from an
+  // earlier wait that ended for some other reason is removed first, so that
+  // stale timeouts do not accumulate in the kernel and cause spurious wakeups.
+  if (usec > 0)
+  {
+    if (wait_timeouts_outstanding_ > 0)
+    {
+      if (io_uring_sqe* sqe = get_sqe())
+      {
+        sqe->opcode = IORING_OP_TIMEOUT_REMOVE;
+        sqe->fd = -1;
+        sqe->addr = reinterpret_cast<__u64>(&wait_ts_);
+        sqe->user_data = 0;
+      }
+    }
+
+    if (io_uring_sqe* sqe = get_sqe())
+    {
+      get_expiry(usec, wait_ts_);
+      sqe->opcode = IORING_OP_TIMEOUT;
+      sqe->fd = -1;
+      sqe->addr = reinterpret_cast<__u64>(&wait_ts_);
+      sqe->len = 1;
+      sqe->timeout_flags = IORING_TIMEOUT_ABS;
+      sqe->user_data = reinterpret_cast<__u64>(&wait_ts_);
+      ++wait_timeouts_outstanding_;
+    }
+  }
+
+  // Everything queued since the last run is submitted using the same system
+  // call that waits for completions.
+  __atomic_store_n(ring_.sq_tail_, sq_tail_, __ATOMIC_RELEASE);
+  unsigned to_submit = sq_tail_
+    - __atomic_load_n(ring_.sq_head_, __ATOMIC_ACQUIRE);
+  bool wait = (usec != 0) && (*ring_.cq_head_
+      == __atomic_load_n(ring_.cq_tail_, __ATOMIC_ACQUIRE));
+  unsigned flags = wait ? IORING_ENTER_GETEVENTS : 0;
+  unsigned sq_flags = __atomic_load_n(ring_.sq_flags_, __ATOMIC_ACQUIRE);
+  if (sq_flags & IORING_SQ_CQ_OVERFLOW)
+    flags |= IORING_ENTER_GETEVENTS;
+  waiting_ = wait;
+  lock.unlock();
+
+  if (to_submit > 0 || flags != 0)
+  {
+    ::syscall(__NR_io_uring_enter, ring_.fd_,
+        to_submit, wait ? 1 : 0, flags, 0, 0);
+  }
+
+  if (wait)
+  {
+    lock.lock();
+    waiting_ = false;
+    lock.unlock();
+  }
+
+  // Dispatch the completions.
+  bool check_timers = false;
+  unsigned head = *ring_.cq_head_;
+  for (;;)
+  {
+    if (head == __atomic_load_n(ring_.cq_tail_, __ATOMIC_ACQUIRE))
+      break;
+
+    io_uring_cqe* cqe = &ring_.cqes_[head & *ring_.cq_mask_];
+    __u64 user_data = cqe->user_data;
+    int result = cqe->res;
+    unsigned flags = cqe->flags;
+    __atomic_store_n(ring_.cq_head_, ++head, __ATOMIC_RELEASE);
+
+    if (user_data == 0)
+    {
+      // An interruption or a cancellation request.
+    }
+    else if (user_data == reinterpret_cast<__u64>(&wait_ts_))
+    {
+      // A bounded wait that has expired or been removed.
+      lock.lock();
+      --wait_timeouts_outstanding_;
+      lock.unlock();
+    }
+    else if (user_data == reinterpret_cast<__u64>(&timer_queues_))
+    {
+      lock.lock();
+      --timeouts_outstanding_;
+      lock.unlock();
+      check_timers = true;
+    }
+    else if (is_buffer_user_data(user_data))
+    {
+      // Buffers given to a group, which the kernel may refuse. Receives that
+      // find no buffers in the group report the reason.
+      if (result < 0)
+      {
+        lock.lock();
+        buffer_group_errors_[static_cast<std::size_t>(user_data >> 2)]
+          = -result;
+        lock.unlock();
+      }
+    }
+    else
+    {
+      descriptor_state* descriptor_data = reinterpret_cast<descriptor_state*>(
+          user_data & ~static_cast<__u64>(3));
+      int op_type = static_cast<int>(user_data & 3);
+      complete_descriptor_op(descriptor_data,
+          op_type, result, flags, ops);
+    }
+  }
+
+  if (check_timers)
+  {
+    lock.lock();
+    timer_queues_.get_ready_timers(ops);
+    if (timeouts_outstanding_ == 0)
+      update_timeout();
+  }
+}
+
+void io_uring_reactor::interrupt()
+{
+  mutex::scoped_lock lock(mutex_);
+  if (io_uring_sqe* sqe = get_sqe())
+  {
+    sqe->opcode = IORING_OP_NOP;
+    sqe->user_data = 0;
+    submit_sqes();
+  }
+}
+
+int io_uring_reactor::register_buffers(void* data,
+    std::size_t buffer_size, std::size_t count, asio::error_code& ec)
+{
+#if defined(IOSQE_BUFFER_SELECT)
+  // Buffer identifiers are 16 bits wide.
+  if (buffer_size == 0 || buffer_size > 0x7fffffff
+      || count == 0 || count > 0x10000)
+  {
+    ec = asio::error::invalid_argument;
+    return -1;
+  }
+
+  // Provided buffers were introduced in the same kernel release as fast poll.
+  if ((ring_.features_ & IORING_FEAT_FAST_POLL) == 0)
+  {
+    ec = asio::error::operation_not_supported;
+    return -1;
+  }
+
+  mutex::scoped_lock lock(mutex_);
+
+  io_uring_sqe* sqe = get_sqe();
+  if (!sqe)
+  {
+    ec = asio::error::no_buffer_space;
+    return -1;
+  }
+
+  int group = next_buffer_group_;
+  next_buffer_group_ = (next_buffer_group_ + 1) & 0xffff;
+  if (buffer_group_errors_.size() <= static_cast<std::size_t>(group))
+    buffer_group_errors_.resize(group + 1);
+  buffer_group_errors_[group] = 0;
+
+  sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+  sqe->fd = static_cast<__s32>(count);
+  sqe->addr = reinterpret_cast<__u64>(data);
+  sqe->len = static_cast<__u32>(buffer_size);
+  sqe->off = 0;
+  sqe->buf_group = static_cast<__u16>(group);
+  sqe->user_data = make_buffer_user_data(group);
+  submit_if_waiting();
+  ec = asio::error_code();
+  return group;
+#else // defined(IOSQE_BUFFER_SELECT)
+  (void)data;
+  (void)buffer_size;
+  (void)count;
+  ec = asio::error::operation_not_supported;
+  return -1;
+#endif // defined(IOSQE_BUFFER_SELECT)
+}
+
+asio::error_code io_uring_reactor::buffer_group_error(int group)
+{
+  mutex::scoped_lock lock(mutex_);
+  if (group < 0 || static_cast<std::size_t>(group)
+      >= buffer_group_errors_.size() || buffer_group_errors_[group] == 0)
+    return asio::error_code();
+  return asio::error_code(buffer_group_errors_[group],
+      asio::error::get_system_category());
+}
+
+bool io_uring_reactor::provide_buffer(int group, void* data,
+    std::size_t buffer_size, std::size_t index)
+{
+#if defined(IOSQE_BUFFER_SELECT)
+  mutex::scoped_lock lock(mutex_);
+
+  io_uring_sqe* sqe = get_sqe();
+  if (!sqe)
+    return false;
+
+  sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+  sqe->fd = 1;
+  sqe->addr = reinterpret_cast<__u64>(data);
+  sqe->len = static_cast<__u32>(buffer_size);
+  sqe->off = static_cast<__u64>(index);
+  sqe->buf_group = static_cast<__u16>(group);
+  sqe->user_data = make_buffer_user_data(group);
+  submit_if_waiting();
+  return true;
+#else // defined(IOSQE_BUFFER_SELECT)
+  (void)group;
+  (void)data;
+  (void)buffer_size;
+  (void)index;
+  return false;
+#endif // defined(IOSQE_BUFFER_SELECT)
+}
+
+void io_uring_reactor::unregister_buffers(int group, std::size_t count)
+{
+#if defined(IOSQE_BUFFER_SELECT)
+  mutex::scoped_lock lock(mutex_);
+
+  if (io_uring_sqe* sqe = get_sqe())
+  {
+    sqe->opcode = IORING_OP_REMOVE_BUFFERS;
+    sqe->fd = static_cast<__s32>(count);
+    sqe->buf_group = static_cast<__u16>(group);
+    sqe->user_data = 0;
+    submit_sqes();
+  }
+#else // defined(IOSQE_BUFFER_SELECT)
+  (void)group;
+  (void)count;
+#endif // defined(IOSQE_BUFFER_SELECT)
+}
+
+void io_uring_reactor::do_ring_create(ring& r)
+{
+  io_uring_params params;
+  std::memset(&params, 0, sizeof(params));
+  r.fd_ = static_cast<int>(::syscall(__NR_io_uring_setup, ring_size, &params));
+  if (r.fd_ < 0)
+  {
+    asio::error_code ec(errno,
+        asio::error::get_system_category());
+    asio::detail::throw_error(ec, "io_uring");
+  }
+
+  r.features_ = params.features;
+  r.sq_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  r.cq_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  if (r.features_ & IORING_FEAT_SINGLE_MMAP)
+  {
+    if (r.cq_size_ > r.sq_size_)
+      r.sq_size_ = r.cq_size_;
+    r.cq_size_ = r.sq_size_;
+  }
+  r.sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+
+  r.sq_ptr_ = ::mmap(0, r.sq_size_, PROT_READ | PROT_WRITE,
+      MAP_SHARED | MAP_POPULATE, r.fd_, IORING_OFF_SQ_RING);
+  r.cq_ptr_ = MAP_FAILED;
+  r.sqes_ = static_cast<io_uring_sqe*>(MAP_FAILED);
+  if (r.sq_ptr_ != MAP_FAILED)
+  {
+    if (r.features_ & IORING_FEAT_SINGLE_MMAP)
+      r.cq_ptr_ = r.sq_ptr_;
+    else
+      r.cq_ptr_ = ::mmap(0, r.cq_size_, PROT_READ | PROT_WRITE,
+          MAP_SHARED | MAP_POPULATE, r.fd_, IORING_OFF_CQ_RING);
+  }
+  if (r.cq_ptr_ != MAP_FAILED)
+  {
+    r.sqes_ = static_cast<io_uring_sqe*>(::mmap(0, r.sqes_size_,
+          PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+          r.fd_, IORING_OFF_SQES));
+  }
+  if (r.sqes_ == MAP_FAILED)
+  {
+    asio::error_code ec(errno,
+        asio::error::get_system_category());
+    do_ring_destroy(r);
+    asio::detail::throw_error(ec, "io_uring");
+  }
+
+  char* sq = static_cast<char*>(r.sq_ptr_);
+  r.sq_head_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+  r.sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+  r.sq_mask_ = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+  r.sq_entries_ = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_entries);
+  r.sq_flags_ = reinterpret_cast<unsigned*>(sq + params.sq_off.flags);
+  r.sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+
+  char* cq = static_cast<char*>(r.cq_ptr_);
+  r.cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+  r.cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+  r.cq_mask_ = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+  r.cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+}
+
+void io_uring_reactor::do_ring_destroy(ring& r)
+{
+  if (r.sqes_ != MAP_FAILED)
+    ::munmap(r.sqes_, r.sqes_size_);
+  if (r.cq_ptr_ != MAP_FAILED && r.cq_ptr_ != r.sq_ptr_)
+    ::munmap(r.cq_ptr_, r.cq_size_);
+  if (r.sq_ptr_ != MAP_FAILED)
+    ::munmap(r.sq_ptr_, r.sq_size_);
+  if (r.fd_ != -1)
+    ::close(r.fd_);
+  r.sqes_ = static_cast<io_uring_sqe*>(MAP_FAILED);
+  r.cq_ptr_ = MAP_FAILED;
+  r.sq_ptr_ = MAP_FAILED;
+  r.fd_ = -1;
+}
+
+io_uring_reactor::descriptor_state*
+io_uring_reactor::allocate_descriptor_state()
+{
+  mutex::scoped_lock descriptors_lock(registered_descriptors_mutex_);
+  return registered_descriptors_.alloc(ASIO_CONCURRENCY_HINT_IS_LOCKING(
+        REACTOR_IO, scheduler_.concurrency_hint()));
+}
+
+void io_uring_reactor::free_descriptor_state(
+    io_uring_reactor::descriptor_state* s)
+{
+  mutex::scoped_lock descriptors_lock(registered_descriptors_mutex_);
+  registered_descriptors_.free(s);
+}
+
+void io_uring_reactor::do_add_timer_queue(timer_queue_base& queue)
+{
+  mutex::scoped_lock lock(mutex_);
+  timer_queues_.insert(&queue);
+}
+
+void io_uring_reactor::do_remove_timer_queue(timer_queue_base& queue)
+{
+  mutex::scoped_lock lock(mutex_);
+  timer_queues_.erase(&queue);
+}
+
+void io_uring_reactor::update_timeout()
+{
+  // Replace any outstanding timeout. The removed timeout completes with
+  // ECANCELED, and the removal request's own completion is ignored.
+  if (timeouts_outstanding_ > 0)
+  {
+    if (io_uring_sqe* sqe = get_sqe())
+    {
+      sqe->opcode = IORING_OP_TIMEOUT_REMOVE;
+      sqe->fd = -1;
+      sqe->addr = reinterpret_cast<__u64>(&timer_queues_);
+      sqe->user_data = 0;
+    }
+  }
+
+  if (io_uring_sqe* sqe = get_sqe())
+  {
+    // By default we will wait no longer than 5 minutes. This will ensure that
+    // any changes to the system clock are detected after no longer than this.
+    long usec = timer_queues_.wait_duration_usec(5 * 60 * 1000 * 1000);
+
+    get_expiry(usec, timeout_ts_);
+    sqe->opcode = IORING_OP_TIMEOUT;
+    sqe->fd = -1;
+    sqe->addr = reinterpret_cast<__u64>(&timeout_ts_);
+    sqe->len = 1;
+    sqe->timeout_flags = IORING_TIMEOUT_ABS;
+    sqe->user_data = reinterpret_cast<__u64>(&timer_queues_);
+    ++timeouts_outstanding_;
+  }
+
+  submit_if_waiting();
+}
+
+void io_uring_reactor::get_expiry(long usec, __kernel_timespec& ts)
+{
+  timespec now;
+  ::clock_gettime(CLOCK_MONOTONIC, &now);
+  long long nsec = now.tv_nsec + (usec % 1000000) * 1000LL;
+  ts.tv_sec = now.tv_sec + usec / 1000000 + nsec / 1000000000;
+  ts.tv_nsec = nsec % 1000000000;
+}
+
+io_uring_sqe* io_uring_reactor::get_sqe()
+{
+  unsigned head = __atomic_load_n(ring_.sq_head_, __ATOMIC_ACQUIRE);
+  if (sq_tail_ - head >= *ring_.sq_entries_)
+  {
+    submit_sqes();
+    head = __atomic_load_n(ring_.sq_head_, __ATOMIC_ACQUIRE);
+    if (sq_tail_ - head >= *ring_.sq_entries_)
+      return 0;
+  }
+
+  unsigned index = sq_tail_ & *ring_.sq_mask_;
+  io_uring_sqe* sqe = &ring_.sqes_[index];
+  std::memset(sqe, 0, sizeof(io_uring_sqe));
+  ring_.sq_array_[index] = index;
+  ++sq_tail_;
+  return sqe;
+}
+
+void io_uring_reactor::submit_sqes()
+{
+  __atomic_store_n(ring_.sq_tail_, sq_tail_, __ATOMIC_RELEASE);
+  unsigned to_submit = sq_tail_
+    - __atomic_load_n(ring_.sq_head_, __ATOMIC_ACQUIRE);
+  while (to_submit > 0 && ::syscall(__NR_io_uring_enter,
+        ring_.fd_, to_submit, 0, 0, 0, 0) < 0 && errno == EINTR)
+  {
+  }
+}
+
+void io_uring_reactor::submit_if_waiting()
+{
+  if (waiting_)
+    submit_sqes();
+}
+
+bool io_uring_reactor::arm_head_op(descriptor_state* descriptor_data,
+    int op_type, bool allow_completion)
+{
+  reactor_op* op = descriptor_data->op_queue_[op_type].front();
+
+  mutex::scoped_lock lock(mutex_);
+
+  io_uring_sqe* sqe = get_sqe();
+  if (!sqe)
+  {
+    op->ec_ = asio::error::no_buffer_space;
+    return false;
+  }
+
+  bool completion = allow_completion && op->prepare(sqe);
+  if (!completion)
+  {
+    static const short flag[max_ops] = { POLLIN, POLLOUT, POLLPRI };
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = descriptor_data->descriptor_;
+    sqe->poll_events = flag[op_type] | POLLERR | POLLHUP;
+  }
+  sqe->user_data = make_user_data(descriptor_data, op_type);
+
+  descriptor_data->in_flight_[op_type] = true;
+  descriptor_data->completion_[op_type] = completion;
+  descriptor_data->cancel_requested_[op_type] = false;
+  ++descriptor_data->num_in_flight_;
+
+  submit_if_waiting();
+  return true;
+}
+
+void io_uring_reactor::cancel_head_op(
+    descriptor_state* descriptor_data, int op_type)
+{
+  if (!descriptor_data->in_flight_[op_type]
+      || descriptor_data->cancel_requested_[op_type])
+    return;
+
+  mutex::scoped_lock lock(mutex_);
+
+  if (io_uring_sqe* sqe = get_sqe())
+  {
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->addr = make_user_data(descriptor_data, op_type);
+    sqe->user_data = 0;
+    descriptor_data->cancel_requested_[op_type] = true;
+    submit_if_waiting();
+  }
+}
+
+void io_uring_reactor::cancel_all_ops(
+    descriptor_state* descriptor_data, op_queue<operation>& ops)
+{
+  for (int i = 0; i < max_ops; ++i)
+  {
+    // An operation with a submission in flight stays at the head of its queue
+    // until the kernel reports the outcome of the cancellation.
+    reactor_op* in_flight_op = 0;
+    if (descriptor_data->in_flight_[i])
+    {
+      in_flight_op = descriptor_data->op_queue_[i].front();
+      descriptor_data->op_queue_[i].pop();
+    }
+
+    while (reactor_op* op = descriptor_data->op_queue_[i].front())
+    {
+      op->ec_ = asio::error::operation_aborted;
+      descriptor_data->op_queue_[i].pop();
+      ops.push(op);
+    }
+
+    if (in_flight_op)
+    {
+      descriptor_data->op_queue_[i].push(in_flight_op);
+      cancel_head_op(descriptor_data, i);
+    }
+  }
+}
+
+void io_uring_reactor::complete_descriptor_op(
+    descriptor_state* descriptor_data, int op_type,
+    int result, unsigned flags, op_queue<operation>& ops)
+{
+  mutex::scoped_lock descriptor_lock(descriptor_data->mutex_);
+
+  if (!descriptor_data->in_flight_[op_type])
+    return;
+
+  descriptor_data->in_flight_[op_type] = false;
+  --descriptor_data->num_in_flight_;
+  bool cancelled = descriptor_data->cancel_requested_[op_type];
+  descriptor_data->cancel_requested_[op_type] = false;
+
+  bool allow_completion = true;
+  if (reactor_op* op = descriptor_data->op_queue_[op_type].front())
+  {
+    if (descriptor_data->completion_[op_type])
+    {
+      // The kernel has performed the operation, unless it was cancelled
+      // before it could do so.
+      reactor_op::status status = reactor_op::not_done;
+      if (result != -ECANCELED)
+        status = op->complete_submission(result, flags);
+      if (status == reactor_op::not_done
+          && (cancelled || result == -ECANCELED))
+      {
+        op->ec_ = asio::error::operation_aborted;
+        status = reactor_op::done;
+      }
+
+      if (status != reactor_op::not_done)
+      {
+        descriptor_data->op_queue_[op_type].pop();
+        ops.push(op);
+        descriptor_data->try_speculative_[op_type]
+          = (status == reactor_op::done);
+      }
+      else
+      {
+        // The operation could not be completed without blocking. Wait for
+        // readiness instead to avoid spinning on the submission.
+        allow_completion = false;
+      }
+    }
+    else if (cancelled || descriptor_data->shutdown_)
+    {
+      op->ec_ = asio::error::operation_aborted;
+      descriptor_data->op_queue_[op_type].pop();
+      ops.push(op);
+    }
+    else
+    {
+      // The descriptor is ready, so perform as many operations as possible.
+      descriptor_data->try_speculative_[op_type] = true;
+      while (reactor_op* ready_op = descriptor_data->op_queue_[op_type].front())
+      {
+        if (reactor_op::status status = ready_op->perform())
+        {
+          descriptor_data->op_queue_[op_type].pop();
+          ops.push(ready_op);
+          if (status == reactor_op::done_and_exhausted)
+          {
+            descriptor_data->try_speculative_[op_type] = false;
+            break;
+          }
+        }
+        else
+          break;
+      }
+    }
+  }
+
+  if (!descriptor_data->shutdown_)
+  {
+    while (!descriptor_data->op_queue_[op_type].empty()
+        && !arm_head_op(descriptor_data, op_type, allow_completion))
+    {
+      ops.push(descriptor_data->op_queue_[op_type].front());
+      descriptor_data->op_queue_[op_type].pop();
+    }
+  }
+
+  if (descriptor_data->cleanup_pending_ && descriptor_data->num_in_flight_ == 0)
+  {
+    descriptor_lock.unlock();
+    free_descriptor_state(descriptor_data);
+  }
+}
+
+io_uring_reactor::descriptor_state::descriptor_state(bool locking)
+  : mutex_(locking)
+{
+}
+
+} // namespace detail
+} // namespace asio
+
+#include "../../detail/pop_options.hpp"
+
+#endif // defined(ASIO_HAS_IO_URING)
+
+#endif // ASIO_DETAIL_IMPL_IO_URING_REACTOR_IPP
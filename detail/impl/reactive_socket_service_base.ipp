@@ -21,6 +21,7 @@
   && !defined(ASIO_WINDOWS_RUNTIME)
 
 #include "../../detail/reactive_socket_service_base.hpp"
+#include "../../detail/scheduler.hpp"
 
 #include "../../detail/push_options.hpp"
 
@@ -29,7 +30,11 @@ namespace detail {
 
 reactive_socket_service_base::reactive_socket_service_base(
     execution_context& context)
-  : reactor_(use_service<reactor>(context))
+  : reactor_(use_service<reactor>(context)),
+    busy_poll_usec_(use_service<scheduler>(
+          context).options().socket_busy_poll_usec()),
+    flatten_size_(use_service<scheduler>(
+          context).options().gather_flatten_size())
 {
   reactor_.init_task();
 }
@@ -168,6 +173,48 @@ asio::error_code reactive_socket_service_base::cancel(
   return ec;
 }
 
+asio::error_code reactive_socket_service_base::zero_copy(
+    reactive_socket_service_base::base_implementation_type& impl,
+    bool mode, asio::error_code& ec)
+{
+  if (!is_open(impl))
+  {
+    ec = asio::error::bad_descriptor;
+    return ec;
+  }
+
+#if defined(ASIO_HAS_MSG_ZEROCOPY)
+  if (mode)
+  {
+    // The option is left set when zero-copy is disabled, as it has no effect
+    // on sends made without MSG_ZEROCOPY.
+    int optval = 1;
+    if (socket_ops::setsockopt(impl.socket_, impl.state_, SOL_SOCKET,
+          SO_ZEROCOPY, &optval, sizeof(optval), ec) != 0)
+    {
+      if (ec == asio::error::no_protocol_option)
+        ec = asio::error::operation_not_supported;
+      return ec;
+    }
+
+    impl.state_ |= socket_ops::zero_copy;
+  }
+  else
+  {
+    impl.state_ &= ~socket_ops::zero_copy;
+  }
+
+  ec = asio::error_code();
+#else // defined(ASIO_HAS_MSG_ZEROCOPY)
+  if (mode)
+    ec = asio::error::operation_not_supported;
+  else
+    ec = asio::error_code();
+#endif // defined(ASIO_HAS_MSG_ZEROCOPY)
+
+  return ec;
+}
+
 asio::error_code reactive_socket_service_base::do_open(
     reactive_socket_service_base::base_implementation_type& impl,
     int af, int type, int protocol, asio::error_code& ec)
@@ -196,6 +243,7 @@ asio::error_code reactive_socket_service_base::do_open(
   case SOCK_DGRAM: impl.state_ = socket_ops::datagram_oriented; break;
   default: impl.state_ = 0; break;
   }
+  set_busy_poll(impl);
   ec = asio::error_code();
   return ec;
 }
@@ -227,10 +275,27 @@ asio::error_code reactive_socket_service_base::do_assign(
   default: impl.state_ = 0; break;
   }
   impl.state_ |= socket_ops::possible_dup;
+  set_busy_poll(impl);
   ec = asio::error_code();
   return ec;
 }
 
+void reactive_socket_service_base::set_busy_poll(
+    reactive_socket_service_base::base_implementation_type& impl)
+{
+#if defined(SO_BUSY_POLL)
+  if (busy_poll_usec_ > 0 && (impl.state_
+        & (socket_ops::stream_oriented | socket_ops::datagram_oriented)))
+  {
+    asio::error_code ignored_ec;
+    socket_ops::setsockopt(impl.socket_, impl.state_, SOL_SOCKET,
+        SO_BUSY_POLL, &busy_poll_usec_, sizeof(busy_poll_usec_), ignored_ec);
+  }
+#else // defined(SO_BUSY_POLL)
+  (void)impl;
+#endif // defined(SO_BUSY_POLL)
+}
+
 void reactive_socket_service_base::start_op(
     reactive_socket_service_base::base_implementation_type& impl,
     int op_type, reactor_op* op, bool is_continuation,
@@ -17,6 +17,7 @@
 
 #include "../../detail/config.hpp"
 
+#include "../../detail/chrono.hpp"
 #include "../../detail/concurrency_hint.hpp"
 #include "../../detail/event.hpp"
 #include "../../detail/limits.hpp"
@@ -61,7 +62,10 @@ struct scheduler::task_cleanup
     this_thread_->private_outstanding_work = 0;
 
     // Enqueue the completed operations and reinsert the task at the end of
-    // the operation queue.
+    // the operation queue. When the thread has its own queue the completed
+    // operations stay with it, where idle threads may steal them.
+    if (this_thread_->has_local_queue)
+      scheduler_->push_local(*this_thread_, this_thread_->private_op_queue);
     lock_->lock();
     scheduler_->task_interrupted_ = true;
     scheduler_->op_queue_.push(this_thread_->private_op_queue);
@@ -92,8 +96,16 @@ struct scheduler::work_cleanup
 #if defined(ASIO_HAS_THREADS)
     if (!this_thread_->private_op_queue.empty())
     {
-      lock_->lock();
-      scheduler_->op_queue_.push(this_thread_->private_op_queue);
+      if (this_thread_->has_local_queue)
+      {
+        scheduler_->push_local(*this_thread_,
+            this_thread_->private_op_queue);
+      }
+      else
+      {
+        lock_->lock();
+        scheduler_->op_queue_.push(this_thread_->private_op_queue);
+      }
     }
 #endif // defined(ASIO_HAS_THREADS)
   }
@@ -103,8 +115,30 @@ struct scheduler::work_cleanup
   thread_info* this_thread_;
 };
 
+struct scheduler::sleep_cleanup
+{
+  ~sleep_cleanup()
+  {
+    --scheduler_->sleeping_threads_;
+  }
+
+  scheduler* scheduler_;
+};
+
+struct scheduler::local_queue_cleanup
+{
+  ~local_queue_cleanup()
+  {
+    scheduler_->unregister_local_queue(*this_thread_);
+  }
+
+  scheduler* scheduler_;
+  thread_info* this_thread_;
+};
+
 scheduler::scheduler(asio::execution_context& ctx,
-    int concurrency_hint, bool own_thread)
+    int concurrency_hint, bool own_thread,
+    const io_context_options& options)
   : asio::detail::execution_context_service_base<scheduler>(ctx),
     one_thread_(concurrency_hint == 1
         || !ASIO_CONCURRENCY_HINT_IS_LOCKING(
@@ -116,9 +150,20 @@ scheduler::scheduler(asio::execution_context& ctx,
     task_(0),
     task_interrupted_(true),
     outstanding_work_(0),
+    sleeping_threads_(0),
     stopped_(false),
     shutdown_(false),
+    busy_poll_spin_usec_(0),
+    busy_poll_block_usec_(0),
     concurrency_hint_(concurrency_hint),
+    options_(options),
+    arena_(options.handler_arena_blocks() > 0
+        ? handler_arena::create(options.handler_arena_blocks()) : 0),
+    work_stealing_(!one_thread_
+        && ASIO_CONCURRENCY_HINT_IS_WORK_STEALING(concurrency_hint)),
+    local_queues_(0),
+    next_victim_(0),
+    idle_threads_(0),
     thread_(0)
 {
   ASIO_HANDLER_TRACKING_INIT;
@@ -142,6 +187,11 @@ scheduler::~scheduler()
     thread_->join();
     delete thread_;
   }
+
+  // Blocks allocated from the arena may outlive the scheduler, in which case
+  // the arena is destroyed when the last of them is deallocated.
+  if (arena_)
+    arena_->release();
 }
 
 void scheduler::shutdown()
@@ -161,6 +211,7 @@ void scheduler::shutdown()
   }
 
   // Destroy handler objects.
+  injected_ops_.pop_all(op_queue_);
   while (!op_queue_.empty())
   {
     operation* o = op_queue_.front();
@@ -195,8 +246,22 @@ std::size_t scheduler::run(asio::error_code& ec)
 
   thread_info this_thread;
   this_thread.private_outstanding_work = 0;
+  this_thread.set_arena(arena_);
   thread_call_stack::context ctx(this, this_thread);
 
+  if (work_stealing_)
+  {
+    register_local_queue(this_thread);
+    local_queue_cleanup on_exit = { this, &this_thread };
+    (void)on_exit;
+
+    std::size_t n = 0;
+    for (; do_run_one_local(this_thread, ec); )
+      if (n != (std::numeric_limits<std::size_t>::max)())
+        ++n;
+    return n;
+  }
+
   mutex::scoped_lock lock(mutex_);
 
   std::size_t n = 0;
@@ -217,8 +282,18 @@ std::size_t scheduler::run_one(asio::error_code& ec)
 
   thread_info this_thread;
   this_thread.private_outstanding_work = 0;
+  this_thread.set_arena(arena_);
   thread_call_stack::context ctx(this, this_thread);
 
+  if (work_stealing_)
+  {
+    register_local_queue(this_thread);
+    local_queue_cleanup on_exit = { this, &this_thread };
+    (void)on_exit;
+
+    return do_run_one_local(this_thread, ec);
+  }
+
   mutex::scoped_lock lock(mutex_);
 
   return do_run_one(lock, this_thread, ec);
@@ -235,6 +310,7 @@ std::size_t scheduler::wait_one(long usec, asio::error_code& ec)
 
   thread_info this_thread;
   this_thread.private_outstanding_work = 0;
+  this_thread.set_arena(arena_);
   thread_call_stack::context ctx(this, this_thread);
 
   mutex::scoped_lock lock(mutex_);
@@ -253,6 +329,7 @@ std::size_t scheduler::poll(asio::error_code& ec)
 
   thread_info this_thread;
   this_thread.private_outstanding_work = 0;
+  this_thread.set_arena(arena_);
   thread_call_stack::context ctx(this, this_thread);
 
   mutex::scoped_lock lock(mutex_);
@@ -284,6 +361,7 @@ std::size_t scheduler::poll_one(asio::error_code& ec)
 
   thread_info this_thread;
   this_thread.private_outstanding_work = 0;
+  this_thread.set_arena(arena_);
   thread_call_stack::context ctx(this, this_thread);
 
   mutex::scoped_lock lock(mutex_);
@@ -328,6 +406,24 @@ void scheduler::post_immediate_completion(
     scheduler::operation* op, bool is_continuation)
 {
 #if defined(ASIO_HAS_THREADS)
+  if (work_stealing_)
+  {
+    if (thread_info_base* this_thread = thread_call_stack::contains(this))
+    {
+      thread_info* info = static_cast<thread_info*>(this_thread);
+      if (info->has_local_queue)
+      {
+        // The operation may be stolen and completed before the current
+        // handler returns, so the work cannot be counted privately.
+        work_started();
+        op_queue<operation> ops;
+        ops.push(op);
+        push_local(*info, ops);
+        return;
+      }
+    }
+  }
+
   if (one_thread_ || is_continuation)
   {
     if (thread_info_base* this_thread = thread_call_stack::contains(this))
@@ -342,6 +438,12 @@ void scheduler::post_immediate_completion(
 #endif // defined(ASIO_HAS_THREADS)
 
   work_started();
+  if (!thread_call_stack::contains(this))
+  {
+    post_injected(op);
+    return;
+  }
+
   mutex::scoped_lock lock(mutex_);
   op_queue_.push(op);
   wake_one_thread_and_unlock(lock);
@@ -350,6 +452,21 @@ void scheduler::post_immediate_completion(
 void scheduler::post_deferred_completion(scheduler::operation* op)
 {
 #if defined(ASIO_HAS_THREADS)
+  if (work_stealing_)
+  {
+    if (thread_info_base* this_thread = thread_call_stack::contains(this))
+    {
+      thread_info* info = static_cast<thread_info*>(this_thread);
+      if (info->has_local_queue)
+      {
+        op_queue<operation> ops;
+        ops.push(op);
+        push_local(*info, ops);
+        return;
+      }
+    }
+  }
+
   if (one_thread_)
   {
     if (thread_info_base* this_thread = thread_call_stack::contains(this))
@@ -371,6 +488,19 @@ void scheduler::post_deferred_completions(
   if (!ops.empty())
   {
 #if defined(ASIO_HAS_THREADS)
+    if (work_stealing_)
+    {
+      if (thread_info_base* this_thread = thread_call_stack::contains(this))
+      {
+        thread_info* info = static_cast<thread_info*>(this_thread);
+        if (info->has_local_queue)
+        {
+          push_local(*info, ops);
+          return;
+        }
+      }
+    }
+
     if (one_thread_)
     {
       if (thread_info_base* this_thread = thread_call_stack::contains(this))
@@ -391,6 +521,12 @@ void scheduler::do_dispatch(
     scheduler::operation* op)
 {
   work_started();
+  if (!thread_call_stack::contains(this))
+  {
+    post_injected(op);
+    return;
+  }
+
   mutex::scoped_lock lock(mutex_);
   op_queue_.push(op);
   wake_one_thread_and_unlock(lock);
@@ -409,6 +545,8 @@ std::size_t scheduler::do_run_one(mutex::scoped_lock& lock,
 {
   while (!stopped_)
   {
+    injected_ops_.pop_all(op_queue_);
+
     if (!op_queue_.empty())
     {
       // Prepare to execute first handler from queue.
@@ -418,7 +556,10 @@ std::size_t scheduler::do_run_one(mutex::scoped_lock& lock,
 
       if (o == &task_operation_)
       {
-        task_interrupted_ = more_handlers;
+        bool busy_poll = !more_handlers && options_.busy_poll_usec() > 0;
+        if (!more_handlers && !busy_poll && !prepare_to_sleep())
+          more_handlers = true;
+        task_interrupted_ = more_handlers || busy_poll;
 
         if (more_handlers && !one_thread_)
           wakeup_event_.unlock_and_signal_one(lock);
@@ -431,7 +572,16 @@ std::size_t scheduler::do_run_one(mutex::scoped_lock& lock,
         // Run the task. May throw an exception. Only block if the operation
         // queue is empty and we're not polling, otherwise we want to return
         // as soon as possible.
-        task_->run(more_handlers ? 0 : -1, this_thread.private_op_queue);
+        if (busy_poll)
+          run_task_busy_poll(lock, this_thread);
+        else if (more_handlers)
+          task_->run(0, this_thread.private_op_queue);
+        else
+        {
+          sleep_cleanup on_wake = { this };
+          (void)on_wake;
+          task_->run(-1, this_thread.private_op_queue);
+        }
       }
       else
       {
@@ -452,10 +602,11 @@ std::size_t scheduler::do_run_one(mutex::scoped_lock& lock,
         return 1;
       }
     }
-    else
+    else if (prepare_to_sleep())
     {
       wakeup_event_.clear(lock);
       wakeup_event_.wait(lock);
+      --sleeping_threads_;
     }
   }
 
@@ -469,11 +620,18 @@ std::size_t scheduler::do_wait_one(mutex::scoped_lock& lock,
   if (stopped_)
     return 0;
 
+  injected_ops_.pop_all(op_queue_);
+
   operation* o = op_queue_.front();
   if (o == 0)
   {
-    wakeup_event_.clear(lock);
-    wakeup_event_.wait_for_usec(lock, usec);
+    if (prepare_to_sleep())
+    {
+      wakeup_event_.clear(lock);
+      wakeup_event_.wait_for_usec(lock, usec);
+      --sleeping_threads_;
+      injected_ops_.pop_all(op_queue_);
+    }
     usec = 0; // Wait at most once.
     o = op_queue_.front();
   }
@@ -482,6 +640,9 @@ std::size_t scheduler::do_wait_one(mutex::scoped_lock& lock,
   {
     op_queue_.pop();
     bool more_handlers = (!op_queue_.empty());
+    if (!more_handlers && usec != 0 && !prepare_to_sleep())
+      more_handlers = true;
+    bool sleeping = !more_handlers && usec != 0;
 
     task_interrupted_ = more_handlers;
 
@@ -497,7 +658,14 @@ std::size_t scheduler::do_wait_one(mutex::scoped_lock& lock,
       // Run the task. May throw an exception. Only block if the operation
       // queue is empty and we're not polling, otherwise we want to return
       // as soon as possible.
-      task_->run(more_handlers ? 0 : usec, this_thread.private_op_queue);
+      if (sleeping)
+      {
+        sleep_cleanup on_wake = { this };
+        (void)on_wake;
+        task_->run(usec, this_thread.private_op_queue);
+      }
+      else
+        task_->run(0, this_thread.private_op_queue);
     }
 
     o = op_queue_.front();
@@ -539,6 +707,8 @@ std::size_t scheduler::do_poll_one(mutex::scoped_lock& lock,
   if (stopped_)
     return 0;
 
+  injected_ops_.pop_all(op_queue_);
+
   operation* o = op_queue_.front();
   if (o == &task_operation_)
   {
@@ -586,12 +756,329 @@ std::size_t scheduler::do_poll_one(mutex::scoped_lock& lock,
   return 1;
 }
 
+std::size_t scheduler::do_run_one_local(
+    scheduler::thread_info& this_thread,
+    const asio::error_code& ec)
+{
+  for (;;)
+  {
+    // Prefer handlers from the thread's own queue, but check the shared queue
+    // periodically so that the task and foreign posts are not starved.
+    bool check_local = this_thread.local_run_count < local_run_limit;
+    if (check_local)
+    {
+      asio::detail::mutex::scoped_lock local_lock(this_thread.local_mutex);
+      if (this_thread.local_stop_requested)
+        return 0;
+
+      if (operation* o = this_thread.local_op_queue.front())
+      {
+        this_thread.local_op_queue.pop();
+        --this_thread.local_op_count;
+        ++this_thread.local_run_count;
+        local_lock.unlock();
+
+        std::size_t task_result = o->task_result_;
+
+        // Ensure the count of outstanding work is decremented on block exit.
+        work_cleanup on_exit = { this, 0, &this_thread };
+        (void)on_exit;
+
+        // Complete the operation. May throw an exception. Deletes the object.
+        o->complete(this, ec, task_result);
+
+        return 1;
+      }
+    }
+    this_thread.local_run_count = 0;
+
+    mutex::scoped_lock lock(mutex_);
+
+    if (stopped_)
+      return 0;
+
+    injected_ops_.pop_all(op_queue_);
+
+    if (!op_queue_.empty())
+    {
+      // Prepare to execute first handler from queue.
+      operation* o = op_queue_.front();
+      op_queue_.pop();
+      bool more_handlers = (!op_queue_.empty());
+
+      if (o == &task_operation_)
+      {
+        asio::detail::mutex::scoped_lock local_lock(this_thread.local_mutex);
+        bool more_local_handlers = (this_thread.local_op_count > 0);
+        local_lock.unlock();
+
+        bool busy_poll = !more_handlers && !more_local_handlers
+          && options_.busy_poll_usec() > 0;
+        if (!more_handlers && !more_local_handlers
+            && !busy_poll && !prepare_to_sleep())
+          more_handlers = true;
+        task_interrupted_ = more_handlers || busy_poll;
+
+        if (more_handlers && !one_thread_)
+          wakeup_event_.unlock_and_signal_one(lock);
+        else
+          lock.unlock();
+
+        task_cleanup on_exit = { this, &lock, &this_thread };
+        (void)on_exit;
+
+        // Run the task. May throw an exception. Only block if there are no
+        // other handlers for this thread to run.
+        if (busy_poll)
+          run_task_busy_poll(lock, this_thread);
+        else if (more_handlers || more_local_handlers)
+          task_->run(0, this_thread.private_op_queue);
+        else
+        {
+          sleep_cleanup on_wake = { this };
+          (void)on_wake;
+          task_->run(-1, this_thread.private_op_queue);
+        }
+      }
+      else
+      {
+        std::size_t task_result = o->task_result_;
+
+        if (more_handlers && !one_thread_)
+          wake_one_thread_and_unlock(lock);
+        else
+          lock.unlock();
+
+        // Ensure the count of outstanding work is decremented on block exit.
+        work_cleanup on_exit = { this, &lock, &this_thread };
+        (void)on_exit;
+
+        // Complete the operation. May throw an exception. Deletes the object.
+        o->complete(this, ec, task_result);
+
+        return 1;
+      }
+    }
+    else if (!check_local)
+    {
+      // The thread's own queue was skipped, so go back to it.
+    }
+    else
+    {
+      // Look for work in the other threads' queues before blocking. The
+      // thread is counted as idle first, so that any handlers pushed after
+      // the queues are checked will result in a wakeup.
+      ++idle_threads_;
+      if (!steal(this_thread) && prepare_to_sleep())
+      {
+        wakeup_event_.clear(lock);
+        wakeup_event_.wait(lock);
+        --sleeping_threads_;
+      }
+      --idle_threads_;
+    }
+  }
+}
+
+void scheduler::register_local_queue(scheduler::thread_info& this_thread)
+{
+  mutex::scoped_lock lock(mutex_);
+  this_thread.has_local_queue = true;
+  this_thread.local_stop_requested = stopped_;
+  this_thread.prev_local = 0;
+  this_thread.next_local = local_queues_;
+  if (local_queues_)
+    local_queues_->prev_local = &this_thread;
+  local_queues_ = &this_thread;
+}
+
+void scheduler::unregister_local_queue(scheduler::thread_info& this_thread)
+{
+  mutex::scoped_lock lock(mutex_);
+
+  if (this_thread.prev_local)
+    this_thread.prev_local->next_local = this_thread.next_local;
+  else
+    local_queues_ = this_thread.next_local;
+  if (this_thread.next_local)
+    this_thread.next_local->prev_local = this_thread.prev_local;
+  if (next_victim_ == &this_thread)
+    next_victim_ = this_thread.next_local;
+
+  asio::detail::mutex::scoped_lock local_lock(this_thread.local_mutex);
+  this_thread.has_local_queue = false;
+  this_thread.local_op_count = 0;
+  bool more_handlers = !this_thread.local_op_queue.empty();
+  op_queue_.push(this_thread.local_op_queue);
+  local_lock.unlock();
+
+  if (more_handlers)
+    wake_one_thread_and_unlock(lock);
+}
+
+void scheduler::push_local(scheduler::thread_info& this_thread,
+    op_queue<scheduler::operation>& ops)
+{
+  asio::detail::mutex::scoped_lock local_lock(this_thread.local_mutex);
+  while (operation* op = ops.front())
+  {
+    ops.pop();
+    this_thread.local_op_queue.push(op);
+    ++this_thread.local_op_count;
+  }
+  local_lock.unlock();
+
+  if (idle_threads_ > 0)
+  {
+    mutex::scoped_lock lock(mutex_);
+    if (!wakeup_event_.maybe_unlock_and_signal_one(lock))
+      lock.unlock();
+  }
+}
+
+bool scheduler::steal(scheduler::thread_info& this_thread)
+{
+  thread_info* start = next_victim_ ? next_victim_ : local_queues_;
+  thread_info* victim = start;
+  while (victim)
+  {
+    if (victim != &this_thread)
+    {
+      // Take the older half of the victim's handlers.
+      op_queue<operation> ops;
+      asio::detail::mutex::scoped_lock victim_lock(victim->local_mutex);
+      std::size_t n = (victim->local_op_count + 1) / 2;
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        operation* op = victim->local_op_queue.front();
+        victim->local_op_queue.pop();
+        ops.push(op);
+      }
+      victim->local_op_count -= n;
+      victim_lock.unlock();
+
+      if (n > 0)
+      {
+        asio::detail::mutex::scoped_lock local_lock(this_thread.local_mutex);
+        this_thread.local_op_queue.push(ops);
+        this_thread.local_op_count += n;
+        next_victim_ = victim->next_local;
+        return true;
+      }
+    }
+
+    victim = victim->next_local ? victim->next_local : local_queues_;
+    if (victim == start)
+      break;
+  }
+
+  return false;
+}
+
+void scheduler::run_task_busy_poll(mutex::scoped_lock& lock,
+    scheduler::thread_info& this_thread)
+{
+#if defined(ASIO_HAS_STD_CHRONO)
+  typedef chrono::steady_clock clock_type;
+  const clock_type::time_point start = clock_type::now();
+  const clock_type::time_point deadline =
+    start + chrono::microseconds(options_.busy_poll_usec());
+
+  for (;;)
+  {
+    task_->run(0, this_thread.private_op_queue);
+    clock_type::time_point now = clock_type::now();
+
+    lock.lock();
+
+    bool found_work = !this_thread.private_op_queue.empty()
+      || !op_queue_.empty() || !injected_ops_.empty() || stopped_;
+    if (found_work || now >= deadline)
+    {
+      busy_poll_spin_usec_.add(chrono::duration_cast<chrono::microseconds>(
+            now - start).count());
+
+      if (found_work || !prepare_to_sleep())
+      {
+        lock.unlock();
+        return;
+      }
+
+      // Nothing arrived while polling, so allow other threads to interrupt
+      // the task and block.
+      task_interrupted_ = false;
+      lock.unlock();
+
+      {
+        sleep_cleanup on_wake = { this };
+        (void)on_wake;
+        task_->run(-1, this_thread.private_op_queue);
+      }
+      clock_type::time_point end = clock_type::now();
+
+      lock.lock();
+      busy_poll_block_usec_.add(chrono::duration_cast<chrono::microseconds>(
+            end - now).count());
+      lock.unlock();
+      return;
+    }
+
+    lock.unlock();
+  }
+#else // defined(ASIO_HAS_STD_CHRONO)
+  lock.lock();
+  bool sleeping = prepare_to_sleep();
+  task_interrupted_ = !sleeping;
+  lock.unlock();
+
+  if (sleeping)
+  {
+    sleep_cleanup on_wake = { this };
+    (void)on_wake;
+    task_->run(-1, this_thread.private_op_queue);
+  }
+  else
+    task_->run(0, this_thread.private_op_queue);
+#endif // defined(ASIO_HAS_STD_CHRONO)
+}
+
+bool scheduler::prepare_to_sleep()
+{
+  ++sleeping_threads_;
+  if (injected_ops_.empty())
+    return true;
+
+  --sleeping_threads_;
+  injected_ops_.pop_all(op_queue_);
+  return false;
+}
+
+void scheduler::post_injected(scheduler::operation* op)
+{
+  // Operations from threads that are not running the scheduler are queued
+  // without taking the mutex. A thread only needs to be woken if the queue
+  // was empty, since otherwise the thread that pushed the first operation
+  // has already done so, and only if a thread is sleeping, since a running
+  // thread checks the queue before it goes to sleep.
+  if (injected_ops_.push(op) && sleeping_threads_ > 0)
+  {
+    mutex::scoped_lock lock(mutex_);
+    wake_one_thread_and_unlock(lock);
+  }
+}
+
 void scheduler::stop_all_threads(
     mutex::scoped_lock& lock)
 {
   stopped_ = true;
   wakeup_event_.signal_all(lock);
 
+  for (thread_info* t = local_queues_; t != 0; t = t->next_local)
+  {
+    asio::detail::mutex::scoped_lock local_lock(t->local_mutex);
+    t->local_stop_requested = true;
+  }
+
   if (!task_interrupted_ && task_)
   {
     task_interrupted_ = true;
@@ -16,6 +16,7 @@
 #endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
 
 #include "../../detail/call_stack.hpp"
+#include "../../detail/chrono.hpp"
 #include "../../detail/fenced_block.hpp"
 #include "../../detail/handler_invoke_helpers.hpp"
 #include "../../detail/recycling_allocator.hpp"
@@ -56,13 +57,7 @@ public:
 
     ~on_invoker_exit()
     {
-      this_->impl_->mutex_->lock();
-      this_->impl_->ready_queue_.push(this_->impl_->waiting_queue_);
-      bool more_handlers = this_->impl_->locked_ =
-        !this_->impl_->ready_queue_.empty();
-      this_->impl_->mutex_->unlock();
-
-      if (more_handlers)
+      if (push_waiting_to_ready_queue(this_->impl_))
       {
         Executor ex(this_->work_.get_executor());
         recycling_allocator<void> allocator;
@@ -80,14 +75,57 @@ public:
     on_invoker_exit on_exit = { this };
     (void)on_exit;
 
-    // Run all ready handlers. No lock is required since the ready queue is
+    // The statistics are written only here, within the strand, so they need
+    // no read-modify-write operations.
+    strand_impl* impl = impl_.get();
+    impl->turns_.store(impl->turns_.load() + 1);
+    if (impl->ready_count_ > impl->max_queue_depth_.load())
+      impl->max_queue_depth_.store(impl->ready_count_);
+
+    // The limits may be changed by another thread at any time. Changes take
+    // effect from the next turn.
+    const std::size_t max_handlers = impl->max_handlers_per_turn_.load();
+#if defined(ASIO_HAS_STD_CHRONO)
+    typedef chrono::steady_clock clock_type;
+    const long max_usec = impl->max_usec_per_turn_.load();
+    const clock_type::time_point start =
+      max_usec > 0 ? clock_type::now() : clock_type::time_point();
+    long usec = 0;
+#endif // defined(ASIO_HAS_STD_CHRONO)
+
+    // Run the ready handlers, until the turn's budget is exhausted. Any that
+    // remain are run after the strand is rescheduled, giving other work a
+    // chance to run first. No lock is required since the ready queue is
     // accessed only within the strand.
     asio::error_code ec;
-    while (scheduler_operation* o = impl_->ready_queue_.front())
+    std::size_t handlers = 0;
+    while (scheduler_operation* o = impl->ready_queue_.front())
     {
-      impl_->ready_queue_.pop();
-      o->complete(impl_.get(), ec, 0);
+      impl->ready_queue_.pop();
+      --impl->ready_count_;
+      o->complete(impl, ec, 0);
+
+      bool out_of_budget = ++handlers == max_handlers;
+#if defined(ASIO_HAS_STD_CHRONO)
+      if (max_usec > 0)
+      {
+        usec = static_cast<long>(chrono::duration_cast<chrono::microseconds>(
+              clock_type::now() - start).count());
+        out_of_budget = out_of_budget || usec >= max_usec;
+      }
+#endif // defined(ASIO_HAS_STD_CHRONO)
+
+      if (out_of_budget && !impl->ready_queue_.empty())
+      {
+        impl->preemptions_.store(impl->preemptions_.load() + 1);
+        break;
+      }
     }
+
+#if defined(ASIO_HAS_STD_CHRONO)
+    if (usec > 0)
+      impl->run_time_usec_.store(impl->run_time_usec_.load() + usec);
+#endif // defined(ASIO_HAS_STD_CHRONO)
   }
 
 private:
@@ -26,7 +26,9 @@ namespace detail {
 strand_executor_service::strand_executor_service(execution_context& ctx)
   : execution_context_service_base<strand_executor_service>(ctx),
     mutex_(),
+#if !defined(ASIO_HAS_THREADS) || !defined(ASIO_HAS_STD_ATOMIC)
     salt_(0),
+#endif // !defined(ASIO_HAS_THREADS) || !defined(ASIO_HAS_STD_ATOMIC)
     impl_list_(0)
 {
 }
@@ -40,11 +42,27 @@ void strand_executor_service::shutdown()
   strand_impl* impl = impl_list_;
   while (impl)
   {
+#if defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
+    scheduler_operation* waiting = impl->state_.exchange(
+        shutdown_state(), std::memory_order_acquire);
+    while (waiting && waiting != locked_state()
+        && waiting != shutdown_state())
+    {
+      scheduler_operation* next = op_queue_access::next(waiting);
+      ops.push(waiting);
+      waiting = next;
+    }
+    ops.push(impl->ready_queue_);
+    impl->ready_count_ = 0;
+#else // defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
     impl->mutex_->lock();
     impl->shutdown_ = true;
+    impl->waiting_count_ = 0;
     ops.push(impl->waiting_queue_);
     ops.push(impl->ready_queue_);
+    impl->ready_count_ = 0;
     impl->mutex_->unlock();
+#endif // defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
     impl = impl->next_;
   }
 }
@@ -53,8 +71,15 @@ strand_executor_service::implementation_type
 strand_executor_service::create_implementation()
 {
   implementation_type new_impl(new strand_impl);
+  new_impl->ready_count_ = 0;
+#if defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
+  new_impl->state_.store(0, std::memory_order_relaxed);
+
+  asio::detail::mutex::scoped_lock lock(mutex_);
+#else // defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
   new_impl->locked_ = false;
   new_impl->shutdown_ = false;
+  new_impl->waiting_count_ = 0;
 
   asio::detail::mutex::scoped_lock lock(mutex_);
 
@@ -67,6 +92,7 @@ strand_executor_service::create_implementation()
   if (!mutexes_[mutex_index].get())
     mutexes_[mutex_index].reset(new mutex);
   new_impl->mutex_ = mutexes_[mutex_index].get();
+#endif // defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
 
   // Insert implementation into linked list of all implementations.
   new_impl->next_ = impl_list_;
@@ -92,6 +118,111 @@ strand_executor_service::strand_impl::~strand_impl()
     next_->prev_= prev_;
 }
 
+void* strand_executor_service::strand_impl::operator new(std::size_t size)
+{
+  // The start of the allocated memory is stored just before the object.
+  void* memory = ::operator new(
+      size + sizeof(void*) + cache_line_size - 1);
+  std::size_t address = reinterpret_cast<std::size_t>(memory) + sizeof(void*);
+  std::size_t offset = address % cache_line_size;
+  void** pointer = reinterpret_cast<void**>(
+      address + (offset ? cache_line_size - offset : 0));
+  pointer[-1] = memory;
+  return pointer;
+}
+
+void strand_executor_service::strand_impl::operator delete(void* pointer)
+{
+  if (pointer)
+    ::operator delete(static_cast<void**>(pointer)[-1]);
+}
+
+#if defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
+
+bool strand_executor_service::enqueue(const implementation_type& impl,
+    scheduler_operation* op)
+{
+  scheduler_operation* state = impl->state_.load(std::memory_order_relaxed);
+  for (;;)
+  {
+    if (state == shutdown_state())
+    {
+      op->destroy();
+      return false;
+    }
+    else if (state == 0)
+    {
+      // The function is acquiring the strand lock and so is responsible for
+      // scheduling the strand.
+      if (impl->state_.compare_exchange_weak(state, locked_state(),
+            std::memory_order_acquire, std::memory_order_relaxed))
+      {
+        impl->ready_queue_.push(op);
+        ++impl->ready_count_;
+        return true;
+      }
+    }
+    else
+    {
+      // Some other function already holds the strand lock. Enqueue for later.
+      op_queue_access::next(op, state);
+      if (impl->state_.compare_exchange_weak(state, op,
+            std::memory_order_release, std::memory_order_relaxed))
+        return false;
+    }
+  }
+}
+
+bool strand_executor_service::push_waiting_to_ready_queue(
+    const implementation_type& impl)
+{
+  scheduler_operation* state = impl->state_.load(std::memory_order_relaxed);
+  for (;;)
+  {
+    if (state == shutdown_state())
+    {
+      return false;
+    }
+    else if (state == locked_state())
+    {
+      // No handlers are waiting, so the lock is released unless there are
+      // ready handlers left over from an upcall that exited via an exception.
+      if (!impl->ready_queue_.empty())
+        return true;
+      if (impl->state_.compare_exchange_weak(state, 0,
+            std::memory_order_release, std::memory_order_relaxed))
+        return false;
+    }
+    else
+    {
+      // Take the waiting handlers, which are linked in reverse order, while
+      // retaining the lock.
+      if (impl->state_.compare_exchange_weak(state, locked_state(),
+            std::memory_order_acquire, std::memory_order_relaxed))
+      {
+        scheduler_operation* reversed = 0;
+        while (state != locked_state())
+        {
+          scheduler_operation* next = op_queue_access::next(state);
+          op_queue_access::next(state, reversed);
+          reversed = state;
+          state = next;
+        }
+        while (reversed)
+        {
+          scheduler_operation* next = op_queue_access::next(reversed);
+          impl->ready_queue_.push(reversed);
+          ++impl->ready_count_;
+          reversed = next;
+        }
+        return true;
+      }
+    }
+  }
+}
+
+#else // defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
+
 bool strand_executor_service::enqueue(const implementation_type& impl,
     scheduler_operation* op)
 {
@@ -106,6 +237,7 @@ bool strand_executor_service::enqueue(const implementation_type& impl,
   {
     // Some other function already holds the strand lock. Enqueue for later.
     impl->waiting_queue_.push(op);
+    ++impl->waiting_count_;
     impl->mutex_->unlock();
     return false;
   }
@@ -116,10 +248,25 @@ bool strand_executor_service::enqueue(const implementation_type& impl,
     impl->locked_ = true;
     impl->mutex_->unlock();
     impl->ready_queue_.push(op);
+    ++impl->ready_count_;
     return true;
   }
 }
 
+bool strand_executor_service::push_waiting_to_ready_queue(
+    const implementation_type& impl)
+{
+  impl->mutex_->lock();
+  impl->ready_queue_.push(impl->waiting_queue_);
+  impl->ready_count_ += impl->waiting_count_;
+  impl->waiting_count_ = 0;
+  bool more_handlers = impl->locked_ = !impl->ready_queue_.empty();
+  impl->mutex_->unlock();
+  return more_handlers;
+}
+
+#endif // defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
+
 bool strand_executor_service::running_in_this_thread(
     const implementation_type& impl)
 {
@@ -0,0 +1,97 @@
+//
+// detail/impl/zero_copy_tracker.ipp
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2020 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_DETAIL_IMPL_ZERO_COPY_TRACKER_IPP
+#define ASIO_DETAIL_IMPL_ZERO_COPY_TRACKER_IPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "../../detail/config.hpp"
+
+#if defined(ASIO_HAS_MSG_ZEROCOPY)
+
+#include <cerrno>
+#include <linux/errqueue.h>
+#include "../../detail/zero_copy_tracker.hpp"
+#include "../../error.hpp"
+
+#if !defined(SO_EE_ORIGIN_ZEROCOPY)
+# define SO_EE_ORIGIN_ZEROCOPY 5
+#endif // !defined(SO_EE_ORIGIN_ZEROCOPY)
+
+#if !defined(SO_EE_CODE_ZEROCOPY_COPIED)
+# define SO_EE_CODE_ZEROCOPY_COPIED 1
+#endif // !defined(SO_EE_CODE_ZEROCOPY_COPIED)
+
+#include "../../detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+bool zero_copy_tracker::all_released(socket_type s, asio::error_code& ec)
+{
+  ec = asio::error_code();
+
+  while (confirmed_ != sent_)
+  {
+    union
+    {
+      cmsghdr header;
+      char data[CMSG_SPACE(sizeof(sock_extended_err))];
+    } control;
+
+    msghdr msg = msghdr();
+    msg.msg_control = control.data;
+    msg.msg_controllen = sizeof(control.data);
+
+    if (::recvmsg(s, &msg, MSG_ERRQUEUE) < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      if (errno != EAGAIN && errno != EWOULDBLOCK)
+        ec = asio::error_code(errno, asio::error::get_system_category());
+      return false;
+    }
+
+    // The error queue may also hold errors that are unrelated to zero-copy
+    // sends. These are discarded.
+    for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg))
+    {
+      if ((cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR)
+          || (cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR))
+      {
+        const sock_extended_err* err =
+          reinterpret_cast<const sock_extended_err*>(CMSG_DATA(cmsg));
+        if (err->ee_origin == SO_EE_ORIGIN_ZEROCOPY && err->ee_errno == 0)
+        {
+          // The notification covers the inclusive range of send numbers from
+          // ee_info to ee_data.
+          confirmed_ += err->ee_data - err->ee_info + 1;
+          if (err->ee_code & SO_EE_CODE_ZEROCOPY_COPIED)
+            copied_ = true;
+        }
+      }
+    }
+  }
+
+  return true;
+}
+
+} // namespace detail
+} // namespace asio
+
+#include "../../detail/pop_options.hpp"
+
+#endif // defined(ASIO_HAS_MSG_ZEROCOPY)
+
+#endif // ASIO_DETAIL_IMPL_ZERO_COPY_TRACKER_IPP
@@ -0,0 +1,403 @@
+//
+// detail/io_uring_reactor.hpp
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2020 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_DETAIL_IO_URING_REACTOR_HPP
+#define ASIO_DETAIL_IO_URING_REACTOR_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "../detail/config.hpp"
+
+#if defined(ASIO_HAS_IO_URING)
+
+#include <vector>
+#include <linux/io_uring.h>
+#include "../detail/conditionally_enabled_mutex.hpp"
+#include "../detail/limits.hpp"
+#include "../detail/object_pool.hpp"
+#include "../detail/op_queue.hpp"
+#include "../detail/reactor_op.hpp"
+#include "../detail/socket_types.hpp"
+#include "../detail/timer_queue_base.hpp"
+#include "../detail/timer_queue_set.hpp"
+#include "../detail/wait_op.hpp"
+#include "../detail/zero_copy_tracker.hpp"
+#include "../execution_context.hpp"
+
+#include "../detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+// A reactor implementation that drives all descriptor operations through a
+// Linux io_uring instance. Operations that know how to describe themselves as
+// a submission queue entry (see reactor_op::prepare) are performed to
+// completion by the kernel. All other operations are performed when a one-shot
+// poll submission reports that the descriptor is ready. Submissions are queued
+// and passed to the kernel in a batch each time the scheduler runs the task,
+// unless a thread is already blocked waiting for completions.
+class io_uring_reactor
+  : public execution_context_service_base<io_uring_reactor>
+{
+private:
+  // The mutex type used by this reactor.
+  typedef conditionally_enabled_mutex mutex;
+
+public:
+  enum op_types { read_op = 0, write_op = 1,
+    connect_op = 1, except_op = 2, max_ops = 3 };
+
+  // Per-descriptor queues.
+  class descriptor_state
+  {
+    friend class io_uring_reactor;
+    friend class object_pool_access;
+
+    descriptor_state* next_;
+    descriptor_state* prev_;
+
+    mutex mutex_;
+    int descriptor_;
+    op_queue<reactor_op> op_queue_[max_ops];
+    bool try_speculative_[max_ops];
+
+    // Whether a submission is outstanding for the head of each queue, and
+    // whether that submission performs the operation or only polls.
+    bool in_flight_[max_ops];
+    bool completion_[max_ops];
+    bool cancel_requested_[max_ops];
+    int num_in_flight_;
+
+    bool shutdown_;
+    bool cleanup_pending_;
+
+#if defined(ASIO_HAS_MSG_ZEROCOPY)
+    zero_copy_tracker zero_copy_;
+#endif // defined(ASIO_HAS_MSG_ZEROCOPY)
+
+    ASIO_DECL descriptor_state(bool locking);
+  };
+
+  // Per-descriptor data.
+  typedef descriptor_state* per_descriptor_data;
+
+  // Constructor.
+  ASIO_DECL io_uring_reactor(asio::execution_context& ctx);
+
+  // Destructor.
+  ASIO_DECL ~io_uring_reactor();
+
+  // Destroy all user-defined handler objects owned by the service.
+  ASIO_DECL void shutdown();
+
+  // Recreate internal descriptors following a fork.
+  ASIO_DECL void notify_fork(
+      asio::execution_context::fork_event fork_ev);
+
+  // Initialise the task.
+  ASIO_DECL void init_task();
+
+  // Register a socket with the reactor. Returns 0 on success, system error
+  // code on failure.
+  ASIO_DECL int register_descriptor(socket_type descriptor,
+      per_descriptor_data& descriptor_data);
+
+  // Register a descriptor with an associated single operation. Returns 0 on
+  // success, system error code on failure.
+  ASIO_DECL int register_internal_descriptor(
+      int op_type, socket_type descriptor,
+      per_descriptor_data& descriptor_data, reactor_op* op);
+
+  // Move descriptor registration from one descriptor_data object to another.
+  ASIO_DECL void move_descriptor(socket_type descriptor,
+      per_descriptor_data& target_descriptor_data,
+      per_descriptor_data& source_descriptor_data);
+
+  // Post a reactor operation for immediate completion.
+  void post_immediate_completion(reactor_op* op, bool is_continuation)
+  {
+    scheduler_.post_immediate_completion(op, is_continuation);
+  }
+
+  // Start a new operation. The reactor operation will be performed when the
+  // given descriptor is flagged as ready, or an error has occurred.
+  ASIO_DECL void start_op(int op_type, socket_type descriptor,
+      per_descriptor_data& descriptor_data, reactor_op* op,
+      bool is_continuation, bool allow_speculative);
+
+  // Cancel all operations associated with the given descriptor. The
+  // handlers associated with the descriptor will be invoked with the
+  // operation_aborted error.
+  ASIO_DECL void cancel_ops(socket_type descriptor,
+      per_descriptor_data& descriptor_data);
+
+  // Cancel any operations that are running against the descriptor and remove
+  // its registration from the reactor. The reactor resources associated with
+  // the descriptor must be released by calling cleanup_descriptor_data.
+  ASIO_DECL void deregister_descriptor(socket_type descriptor,
+      per_descriptor_data& descriptor_data, bool closing);
+
+  // Remove the descriptor's registration from the reactor. The reactor
+  // resources associated with the descriptor must be released by calling
+  // cleanup_descriptor_data.
+  ASIO_DECL void deregister_internal_descriptor(
+      socket_type descriptor, per_descriptor_data& descriptor_data);
+
+  // Perform any post-deregistration cleanup tasks associated with the
+  // descriptor data.
+  ASIO_DECL void cleanup_descriptor_data(
+      per_descriptor_data& descriptor_data);
+
+#if defined(ASIO_HAS_MSG_ZEROCOPY)
+  // Get the object that tracks the zero-copy sends made on a descriptor. It
+  // may be used only by the descriptor's operations, which are performed with
+  // the descriptor's lock held.
+  zero_copy_tracker* get_zero_copy_tracker(
+      per_descriptor_data& descriptor_data)
+  {
+    return descriptor_data ? &descriptor_data->zero_copy_ : 0;
+  }
+#endif // defined(ASIO_HAS_MSG_ZEROCOPY)
+
+  // Add a new timer queue to the reactor.
+  template <typename Time_Traits>
+  void add_timer_queue(timer_queue<Time_Traits>& timer_queue);
+
+  // Remove a timer queue from the reactor.
+  template <typename Time_Traits>
+  void remove_timer_queue(timer_queue<Time_Traits>& timer_queue);
+
+  // Schedule a new operation in the given timer queue to expire at the
+  // specified absolute time.
+  template <typename Time_Traits>
+  void schedule_timer(timer_queue<Time_Traits>& queue,
+      const typename Time_Traits::time_type& time,
+      typename timer_queue<Time_Traits>::per_timer_data& timer, wait_op* op);
+
+  // Cancel the timer operations associated with the given token. Returns the
+  // number of operations that have been posted or dispatched.
+  template <typename Time_Traits>
+  std::size_t cancel_timer(timer_queue<Time_Traits>& queue,
+      typename timer_queue<Time_Traits>::per_timer_data& timer,
+      std::size_t max_cancelled = (std::numeric_limits<std::size_t>::max)());
+
+  // Move the timer operations associated with the given timer.
+  template <typename Time_Traits>
+  void move_timer(timer_queue<Time_Traits>& queue,
+      typename timer_queue<Time_Traits>::per_timer_data& target,
+      typename timer_queue<Time_Traits>::per_timer_data& source);
+
+  // Submit any queued entries and wait until interrupted or completions are
+  // ready to be dispatched.
+  ASIO_DECL void run(long usec, op_queue<operation>& ops);
+
+  // Interrupt the wait for completions.
+  ASIO_DECL void interrupt();
+
+  // Give the kernel a group of equally sized buffers from which receive
+  // operations may select one when data arrives. Returns the group's
+  // identifier, or -1 if the buffers could not be submitted, in which case ec
+  // is set. The kernel may still refuse the buffers after the group is
+  // returned, as reported by buffer_group_error().
+  ASIO_DECL int register_buffers(void* data, std::size_t buffer_size,
+      std::size_t count, asio::error_code& ec);
+
+  // Get the error with which the kernel most recently refused buffers for a
+  // group, if any.
+  ASIO_DECL asio::error_code buffer_group_error(int group);
+
+  // Return a buffer that was consumed by a receive operation to its group.
+  // Returns false if the buffer could not be returned.
+  ASIO_DECL bool provide_buffer(int group, void* data,
+      std::size_t buffer_size, std::size_t index);
+
+  // Remove any buffers that the kernel still holds from a group.
+  ASIO_DECL void unregister_buffers(int group, std::size_t count);
+
+  // Release memory retained for reuse. Descriptor state objects are kept until
+  // the reactor is destroyed, so this does nothing.
+  void trim()
+  {
+  }
+
+private:
+  // The number of entries in the submission queue.
+  enum { ring_size = 1024 };
+
+  // The ring buffers shared with the kernel.
+  struct ring
+  {
+    int fd_;
+    unsigned features_;
+    void* sq_ptr_;
+    std::size_t sq_size_;
+    void* cq_ptr_;
+    std::size_t cq_size_;
+    io_uring_sqe* sqes_;
+    std::size_t sqes_size_;
+    unsigned* sq_head_;
+    unsigned* sq_tail_;
+    unsigned* sq_mask_;
+    unsigned* sq_entries_;
+    unsigned* sq_flags_;
+    unsigned* sq_array_;
+    unsigned* cq_head_;
+    unsigned* cq_tail_;
+    unsigned* cq_mask_;
+    io_uring_cqe* cqes_;
+  };
+
+  // Create the ring. Throws an exception if the ring cannot be created.
+  ASIO_DECL static void do_ring_create(ring& r);
+
+  // Destroy the ring.
+  ASIO_DECL static void do_ring_destroy(ring& r);
+
+  // Allocate a new descriptor state object.
+  ASIO_DECL descriptor_state* allocate_descriptor_state();
+
+  // Free an existing descriptor state object.
+  ASIO_DECL void free_descriptor_state(descriptor_state* s);
+
+  // Helper function to add a new timer queue.
+  ASIO_DECL void do_add_timer_queue(timer_queue_base& queue);
+
+  // Helper function to remove a timer queue.
+  ASIO_DECL void do_remove_timer_queue(timer_queue_base& queue);
+
+  // Called to recalculate and update the timeout. Assumes mutex_ is held.
+  ASIO_DECL void update_timeout();
+
+  // Get the absolute CLOCK_MONOTONIC time that is the given number of
+  // microseconds from now.
+  ASIO_DECL static void get_expiry(long usec, __kernel_timespec& ts);
+
+  // Get a free submission queue entry, flushing queued entries to the kernel
+  // if the ring is full. Assumes mutex_ is held. Returns 0 on failure.
+  ASIO_DECL io_uring_sqe* get_sqe();
+
+  // Pass queued entries to the kernel. Assumes mutex_ is held.
+  ASIO_DECL void submit_sqes();
+
+  // Pass queued entries to the kernel immediately if a thread is blocked
+  // waiting for completions. Otherwise they will be submitted as a batch the
+  // next time the task is run. Assumes mutex_ is held.
+  ASIO_DECL void submit_if_waiting();
+
+  // Queue a submission for the operation at the head of the given queue. If
+  // allow_completion is false, or the operation cannot be performed by the
+  // kernel, a poll for readiness is queued instead. Assumes the descriptor's
+  // mutex is held. Returns false if no submission could be queued, in which
+  // case the operation's error code has been set.
+  ASIO_DECL bool arm_head_op(descriptor_state* descriptor_data,
+      int op_type, bool allow_completion);
+
+  // Queue a cancellation request for the outstanding submission of the given
+  // queue. Assumes the descriptor's mutex is held.
+  ASIO_DECL void cancel_head_op(descriptor_state* descriptor_data,
+      int op_type);
+
+  // Dequeue all operations that are not in flight, marking them as aborted,
+  // and cancel the in-flight ones. Assumes the descriptor's mutex is held.
+  ASIO_DECL void cancel_all_ops(descriptor_state* descriptor_data,
+      op_queue<operation>& ops);
+
+  // Process a completion for a descriptor's queue.
+  ASIO_DECL void complete_descriptor_op(descriptor_state* descriptor_data,
+      int op_type, int result, unsigned flags, op_queue<operation>& ops);
+
+  // Encode and decode the user data associated with descriptor submissions.
+  static __u64 make_user_data(descriptor_state* s, int op_type)
+  {
+    return reinterpret_cast<__u64>(s) | static_cast<__u64>(op_type);
+  }
+
+  // The low bits of the user data of a submission that provides buffers,
+  // which no descriptor operation type uses. The group is held in the bits
+  // above them.
+  enum { buffer_op_tag = max_ops };
+
+  // Encode the user data for a submission that provides buffers to a group.
+  static __u64 make_buffer_user_data(int group)
+  {
+    return (static_cast<__u64>(group) << 2) | buffer_op_tag;
+  }
+
+  // Determine whether user data belongs to a submission that provides
+  // buffers.
+  static bool is_buffer_user_data(__u64 user_data)
+  {
+    return (user_data & 3) == buffer_op_tag;
+  }
+
+  // The scheduler implementation used to post completions.
+  scheduler& scheduler_;
+
+  // Mutex to protect access to the submission queue and the timer queues.
+  mutex mutex_;
+
+  // The io_uring instance.
+  ring ring_;
+
+  // The tail of the submission queue, including entries that have been
+  // queued but not yet published to the kernel.
+  unsigned sq_tail_;
+
+  // Whether a thread is blocked waiting for completions.
+  bool waiting_;
+
+  // The timer queues.
+  timer_queue_set timer_queues_;
+
+  // The absolute expiry time of the outstanding timeout submission.
+  __kernel_timespec timeout_ts_;
+
+  // The number of timeout submissions that have not yet completed.
+  int timeouts_outstanding_;
+
+  // The absolute expiry time for a bounded wait.
+  __kernel_timespec wait_ts_;
+
+  // The number of bounded wait timeout submissions that have not yet
+  // completed.
+  int wait_timeouts_outstanding_;
+
+  // Whether the service has been shut down.
+  bool shutdown_;
+
+  // The identifier to be given to the next group of provided buffers.
+  int next_buffer_group_;
+
+  // The errors with which the kernel refused buffers, indexed by group, or
+  // zero where it has not.
+  std::vector<int> buffer_group_errors_;
+
+  // Mutex to protect access to the registered descriptors.
+  mutex registered_descriptors_mutex_;
+
+  // Keep track of all registered descriptors.
+  object_pool<descriptor_state> registered_descriptors_;
+};
+
+} // namespace detail
+} // namespace asio
+
+#include "../detail/pop_options.hpp"
+
+#include "../detail/impl/io_uring_reactor.hpp"
+#if defined(ASIO_HEADER_ONLY)
+#include "../detail/impl/io_uring_reactor.ipp"
+#endif // defined(ASIO_HEADER_ONLY)
+
+#endif // defined(ASIO_HAS_IO_URING)
+
+#endif // ASIO_DETAIL_IO_URING_REACTOR_HPP
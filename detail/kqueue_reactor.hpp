@@ -182,6 +182,12 @@ public:
   // Interrupt the kqueue loop.
   ASIO_DECL void interrupt();
 
+  // Release memory retained for reuse. Descriptor state objects are kept until
+  // the reactor is destroyed, so this does nothing.
+  void trim()
+  {
+  }
+
 private:
   // Create the kqueue file descriptor. Throws an exception if the descriptor
   // cannot be created.
@@ -0,0 +1,138 @@
+//
+// detail/mpsc_op_queue.hpp
+// ~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2020 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_DETAIL_MPSC_OP_QUEUE_HPP
+#define ASIO_DETAIL_MPSC_OP_QUEUE_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "../detail/config.hpp"
+#include "../detail/noncopyable.hpp"
+#include "../detail/op_queue.hpp"
+
+#if defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
+# include <atomic>
+#else // defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
+# include "../detail/mutex.hpp"
+#endif // defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
+
+#include "../detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+// An intrusive queue of operations that may be pushed to by any number of
+// threads concurrently, and that is emptied in a single step. Where atomics
+// are available pushing is lock-free: operations are linked onto a stack with
+// compare-and-swap, and the stack is reversed when it is taken so that
+// operations are returned in the order they were pushed.
+template <typename Operation>
+class mpsc_op_queue
+  : private noncopyable
+{
+public:
+  // Constructor.
+  mpsc_op_queue()
+#if defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
+    : head_(0)
+#endif // defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
+  {
+  }
+
+  // Destructor destroys all operations.
+  ~mpsc_op_queue()
+  {
+    op_queue<Operation> ops;
+    pop_all(ops);
+  }
+
+  // Add an operation to the queue. Returns true if the queue was empty.
+  bool push(Operation* h)
+  {
+#if defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
+    Operation* head = head_.load(std::memory_order_relaxed);
+    do
+      op_queue_access::next(h, head);
+    while (!head_.compare_exchange_weak(head, h));
+    return head == 0;
+#else // defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
+    mutex::scoped_lock lock(mutex_);
+    bool was_empty = ops_.empty();
+    ops_.push(h);
+    return was_empty;
+#endif // defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
+  }
+
+  // Whether the queue is empty.
+  bool empty() const
+  {
+#if defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
+    return head_.load() == 0;
+#else // defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
+    mutex::scoped_lock lock(mutex_);
+    return ops_.empty();
+#endif // defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
+  }
+
+  // Move all operations to the back of the given queue, in the order in which
+  // they were pushed. Returns true if any operations were moved.
+  template <typename OtherOperation>
+  bool pop_all(op_queue<OtherOperation>& q)
+  {
+#if defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
+    if (head_.load(std::memory_order_relaxed) == 0)
+      return false;
+
+    Operation* head = head_.exchange(0, std::memory_order_acquire);
+    Operation* reversed = 0;
+    while (head)
+    {
+      Operation* next = op_queue_access::next(head);
+      op_queue_access::next(head, reversed);
+      reversed = head;
+      head = next;
+    }
+
+    while (reversed)
+    {
+      Operation* next = op_queue_access::next(reversed);
+      q.push(reversed);
+      reversed = next;
+    }
+    return true;
+#else // defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
+    mutex::scoped_lock lock(mutex_);
+    bool was_empty = ops_.empty();
+    q.push(ops_);
+    return !was_empty;
+#endif // defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
+  }
+
+private:
+#if defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
+  // The most recently pushed operation.
+  std::atomic<Operation*> head_;
+#else // defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
+  // Mutex to protect access to the queue.
+  mutable mutex mutex_;
+
+  // The queued operations.
+  op_queue<Operation> ops_;
+#endif // defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
+};
+
+} // namespace detail
+} // namespace asio
+
+#include "../detail/pop_options.hpp"
+
+#endif // ASIO_DETAIL_MPSC_OP_QUEUE_HPP
@@ -56,6 +56,11 @@ public:
   void interrupt()
   {
   }
+
+  // No-op.
+  void trim()
+  {
+  }
 };
 
 } // namespace detail
@@ -15,6 +15,10 @@
 # pragma once
 #endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
 
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <vector>
 #include "../detail/noncopyable.hpp"
 
 #include "../detail/push_options.hpp"
@@ -29,21 +33,21 @@ class object_pool_access
 {
 public:
   template <typename Object>
-  static Object* create()
+  static Object* create(void* p)
   {
-    return new Object;
+    return new (p) Object;
   }
 
   template <typename Object, typename Arg>
-  static Object* create(Arg arg)
+  static Object* create(void* p, Arg arg)
   {
-    return new Object(arg);
+    return new (p) Object(arg);
   }
 
   template <typename Object>
   static void destroy(Object* o)
   {
-    delete o;
+    o->~Object();
   }
 
   template <typename Object>
@@ -59,6 +63,16 @@ public:
   }
 };
 
+// A pool of objects that are linked into a list while they are in use. Freed
+// objects are kept, still constructed, for reuse by later allocations, and
+// the memory they occupy is never released while an object is constructed in
+// it. This allows a freed object to be safely accessed by code that has not
+// yet noticed that it has been freed.
+//
+// Objects are constructed in slabs of contiguous memory, each starting on its
+// own cache line, so that objects used by different threads do not share
+// cache lines. Retained objects may be destroyed by calling trim(), which
+// also releases any slab that no longer contains a constructed object.
 template <typename Object>
 class object_pool
   : private noncopyable
@@ -67,7 +81,10 @@ public:
   // Constructor.
   object_pool()
     : live_list_(0),
-      free_list_(0)
+      free_list_(0),
+      free_count_(0),
+      unused_list_(0),
+      slabs_(0)
   {
   }
 
@@ -76,6 +93,13 @@ public:
   {
     destroy_list(live_list_);
     destroy_list(free_list_);
+    while (slabs_)
+    {
+      slab* s = slabs_;
+      slabs_ = s->next_;
+      ::operator delete(s->memory_);
+      delete s;
+    }
   }
 
   // Get the object at the start of the live list.
@@ -84,21 +108,30 @@ public:
     return live_list_;
   }
 
+  // Get the number of freed objects that are retained for reuse.
+  std::size_t free_count() const
+  {
+    return free_count_;
+  }
+
   // Allocate a new object.
   Object* alloc()
   {
     Object* o = free_list_;
     if (o)
+    {
       free_list_ = object_pool_access::next(free_list_);
+      --free_count_;
+    }
     else
-      o = object_pool_access::create<Object>();
-
-    object_pool_access::next(o) = live_list_;
-    object_pool_access::prev(o) = 0;
-    if (live_list_)
-      object_pool_access::prev(live_list_) = o;
-    live_list_ = o;
+    {
+      void* p = alloc_unused();
+      unused_guard guard = { this, p };
+      o = object_pool_access::create<Object>(p);
+      guard.p_ = 0;
+    }
 
+    link_live(o);
     return o;
   }
 
@@ -108,16 +141,19 @@ public:
   {
     Object* o = free_list_;
     if (o)
+    {
       free_list_ = object_pool_access::next(free_list_);
+      --free_count_;
+    }
     else
-      o = object_pool_access::create<Object>(arg);
-
-    object_pool_access::next(o) = live_list_;
-    object_pool_access::prev(o) = 0;
-    if (live_list_)
-      object_pool_access::prev(live_list_) = o;
-    live_list_ = o;
+    {
+      void* p = alloc_unused();
+      unused_guard guard = { this, p };
+      o = object_pool_access::create<Object>(p, arg);
+      guard.p_ = 0;
+    }
 
+    link_live(o);
     return o;
   }
 
@@ -142,9 +178,154 @@ public:
     object_pool_access::next(o) = free_list_;
     object_pool_access::prev(o) = 0;
     free_list_ = o;
+    ++free_count_;
+  }
+
+  // Destroy freed objects until no more than max_free remain, skipping any
+  // object for which can_destroy returns false. The objects freed longest ago
+  // are destroyed first. Slabs left with no constructed objects are released.
+  template <typename Predicate>
+  void trim(std::size_t max_free, Predicate can_destroy)
+  {
+    if (free_count_ <= max_free)
+      return;
+
+    // The free list holds the most recently freed objects at its front.
+    std::size_t kept = 0;
+    Object** link = &free_list_;
+    while (*link && free_count_ > max_free)
+    {
+      Object* o = *link;
+      if (kept < max_free || !can_destroy(o))
+      {
+        ++kept;
+        link = &object_pool_access::next(o);
+      }
+      else
+      {
+        *link = object_pool_access::next(o);
+        --free_count_;
+        object_pool_access::destroy(o);
+        free_unused(o);
+      }
+    }
+
+    release_unused_slabs();
   }
 
 private:
+  // The size of a cache line, used to align each object.
+  enum { cache_line_size = 64 };
+
+  // The distance between adjacent objects in a slab.
+  enum { object_stride = (sizeof(Object) + cache_line_size - 1)
+    / cache_line_size * cache_line_size };
+
+  // The number of objects in each slab, which occupies about 16KB.
+  enum { objects_per_slab = object_stride < 16384
+    ? 16384 / object_stride : 1 };
+
+  // A block of memory from which objects are constructed.
+  struct slab
+  {
+    slab* next_;
+    void* memory_;
+    char* begin_;
+  };
+
+  // A slot in a slab in which no object is constructed.
+  struct unused
+  {
+    unused* next_;
+  };
+
+  // Returns a slot to the unused list if constructing an object throws.
+  struct unused_guard
+  {
+    object_pool* pool_;
+    void* p_;
+    ~unused_guard() { if (p_) pool_->free_unused(p_); }
+  };
+
+  // Insert an object at the start of the live list.
+  void link_live(Object* o)
+  {
+    object_pool_access::next(o) = live_list_;
+    object_pool_access::prev(o) = 0;
+    if (live_list_)
+      object_pool_access::prev(live_list_) = o;
+    live_list_ = o;
+  }
+
+  // Get memory for a new object, allocating a new slab if required.
+  void* alloc_unused()
+  {
+    if (!unused_list_)
+    {
+      slab* s = new slab;
+      s->memory_ = ::operator new(
+          objects_per_slab * object_stride + cache_line_size - 1);
+      std::size_t offset = reinterpret_cast<std::size_t>(s->memory_)
+        % cache_line_size;
+      s->begin_ = static_cast<char*>(s->memory_)
+        + (offset ? cache_line_size - offset : 0);
+      s->next_ = slabs_;
+      slabs_ = s;
+
+      for (std::size_t i = objects_per_slab; i > 0; --i)
+        free_unused(s->begin_ + (i - 1) * object_stride);
+    }
+
+    unused* u = unused_list_;
+    unused_list_ = u->next_;
+    return u;
+  }
+
+  // Return memory in which no object is constructed to the unused list.
+  void free_unused(void* p)
+  {
+    unused* u = static_cast<unused*>(p);
+    u->next_ = unused_list_;
+    unused_list_ = u;
+  }
+
+  // Release every slab in which no object is constructed.
+  void release_unused_slabs()
+  {
+    std::vector<char*> slots;
+    for (unused* u = unused_list_; u; u = u->next_)
+      slots.push_back(reinterpret_cast<char*>(u));
+    std::sort(slots.begin(), slots.end());
+
+    bool released = false;
+    slab** link = &slabs_;
+    while (*link)
+    {
+      slab* s = *link;
+      std::vector<char*>::iterator first = std::lower_bound(
+          slots.begin(), slots.end(), s->begin_);
+      std::vector<char*>::iterator last = std::lower_bound(
+          first, slots.end(), s->begin_ + objects_per_slab * object_stride);
+      if (last - first == static_cast<std::ptrdiff_t>(objects_per_slab))
+      {
+        slots.erase(first, last);
+        *link = s->next_;
+        ::operator delete(s->memory_);
+        delete s;
+        released = true;
+      }
+      else
+        link = &s->next_;
+    }
+
+    if (released)
+    {
+      unused_list_ = 0;
+      for (std::size_t i = slots.size(); i > 0; --i)
+        free_unused(slots[i - 1]);
+    }
+  }
+
   // Helper function to destroy all elements in a list.
   void destroy_list(Object* list)
   {
@@ -161,6 +342,15 @@ private:
 
   // The free list.
   Object* free_list_;
+
+  // The number of objects on the free list.
+  std::size_t free_count_;
+
+  // The slots in which no object is constructed.
+  unused* unused_list_;
+
+  // The slabs from which objects are constructed.
+  slab* slabs_;
 };
 
 } // namespace detail
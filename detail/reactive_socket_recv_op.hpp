@@ -43,6 +43,10 @@ public:
       buffers_(buffers),
       flags_(flags)
   {
+#if defined(ASIO_HAS_IO_URING)
+    this->set_submission_funcs(&reactive_socket_recv_op_base::do_prepare,
+        &reactive_socket_recv_op_base::do_submission);
+#endif // defined(ASIO_HAS_IO_URING)
   }
 
   static status do_perform(reactor_op* base)
@@ -82,6 +86,65 @@ public:
     return result;
   }
 
+#if defined(ASIO_HAS_IO_URING)
+  static bool do_prepare(reactor_op* base, io_uring_sqe* sqe)
+  {
+    reactive_socket_recv_op_base* o(
+        static_cast<reactive_socket_recv_op_base*>(base));
+
+    typedef buffer_sequence_adapter<asio::mutable_buffer,
+        MutableBufferSequence> bufs_type;
+
+    // Only a single buffer can be received without keeping a copy of the
+    // native buffer array alive for the duration of the submission.
+    asio::mutable_buffer buffer = bufs_type::first(o->buffers_);
+    if (!bufs_type::is_single_buffer)
+      if (bufs_type(o->buffers_).total_size() != buffer.size())
+        return false;
+
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = o->socket_;
+    sqe->addr = reinterpret_cast<__u64>(buffer.data());
+    sqe->len = static_cast<__u32>(buffer.size());
+    sqe->msg_flags = static_cast<__u32>(o->flags_);
+    return buffer.size() == sqe->len;
+  }
+
+  static status do_submission(reactor_op* base, int result, unsigned)
+  {
+    reactive_socket_recv_op_base* o(
+        static_cast<reactive_socket_recv_op_base*>(base));
+
+    typedef buffer_sequence_adapter<asio::mutable_buffer,
+        MutableBufferSequence> bufs_type;
+
+    if (result < 0)
+    {
+      o->ec_ = asio::error_code(-result,
+          asio::error::get_system_category());
+      o->bytes_transferred_ = 0;
+      if (o->ec_ == asio::error::interrupted
+          || o->ec_ == asio::error::would_block
+          || o->ec_ == asio::error::try_again)
+        return not_done;
+    }
+    else
+    {
+      o->ec_ = asio::error_code();
+      o->bytes_transferred_ = result;
+      if ((o->state_ & socket_ops::stream_oriented) != 0 && result == 0)
+        o->ec_ = asio::error::eof;
+    }
+
+    ASIO_HANDLER_REACTOR_OPERATION((*o, "io_uring_recv",
+          o->ec_, o->bytes_transferred_));
+
+    // A short read means the socket's receive buffer has been drained.
+    return o->bytes_transferred_ < bufs_type::first(o->buffers_).size()
+      ? done_and_exhausted : done;
+  }
+#endif // defined(ASIO_HAS_IO_URING)
+
 private:
   socket_type socket_;
   socket_ops::state_type state_;
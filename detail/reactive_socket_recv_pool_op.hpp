@@ -0,0 +1,238 @@
+//
+// detail/reactive_socket_recv_pool_op.hpp
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2020 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_DETAIL_REACTIVE_SOCKET_RECV_POOL_OP_HPP
+#define ASIO_DETAIL_REACTIVE_SOCKET_RECV_POOL_OP_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "../detail/config.hpp"
+#include "../buffer.hpp"
+#include "../buffer_pool.hpp"
+#include "../detail/bind_handler.hpp"
+#include "../detail/fenced_block.hpp"
+#include "../detail/memory.hpp"
+#include "../detail/reactor_op.hpp"
+#include "../detail/socket_ops.hpp"
+
+#include "../detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+class reactive_socket_recv_pool_op_base : public reactor_op
+{
+public:
+  reactive_socket_recv_pool_op_base(const asio::error_code& success_ec,
+      socket_type socket, socket_ops::state_type state, buffer_pool& pool,
+      int group, socket_base::message_flags flags, func_type complete_func)
+    : reactor_op(success_ec,
+        &reactive_socket_recv_pool_op_base::do_perform, complete_func),
+      socket_(socket),
+      state_(state),
+      pool_(pool),
+      group_(group),
+      flags_(flags)
+  {
+#if defined(ASIO_HAS_IO_URING)
+    if (group_ >= 0)
+      this->set_submission_funcs(
+          &reactive_socket_recv_pool_op_base::do_prepare,
+          &reactive_socket_recv_pool_op_base::do_submission);
+#endif // defined(ASIO_HAS_IO_URING)
+  }
+
+  static status do_perform(reactor_op* base)
+  {
+    reactive_socket_recv_pool_op_base* o(
+        static_cast<reactive_socket_recv_pool_op_base*>(base));
+
+    // A buffer is taken from the pool only once the socket is ready. When the
+    // kernel holds the pool's buffers, the receive is left for a submission
+    // that lets the kernel select one.
+    void* data = o->pool_.acquire();
+    if (!data)
+    {
+      if (o->group_ >= 0)
+        return not_done;
+      o->ec_ = asio::error::no_buffer_space;
+      o->bytes_transferred_ = 0;
+      return done;
+    }
+
+    status result = socket_ops::non_blocking_recv1(o->socket_,
+        data, o->pool_.buffer_size(), o->flags_,
+        (o->state_ & socket_ops::stream_oriented) != 0,
+        o->ec_, o->bytes_transferred_) ? done : not_done;
+
+    ASIO_HANDLER_REACTOR_OPERATION((*o, "non_blocking_recv",
+          o->ec_, o->bytes_transferred_));
+
+    o->take_buffer(data);
+
+    if (result == done)
+      if ((o->state_ & socket_ops::stream_oriented) != 0)
+        if (o->bytes_transferred_ == 0)
+          result = done_and_exhausted;
+
+    return result;
+  }
+
+#if defined(ASIO_HAS_IO_URING)
+  static bool do_prepare(reactor_op* base, io_uring_sqe* sqe)
+  {
+    reactive_socket_recv_pool_op_base* o(
+        static_cast<reactive_socket_recv_pool_op_base*>(base));
+
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = o->socket_;
+    sqe->addr = 0;
+    sqe->len = static_cast<__u32>(o->pool_.buffer_size());
+    sqe->msg_flags = static_cast<__u32>(o->flags_);
+    sqe->flags |= IOSQE_BUFFER_SELECT;
+    sqe->buf_group = static_cast<__u16>(o->group_);
+    return true;
+  }
+
+  static status do_submission(reactor_op* base, int result, unsigned flags)
+  {
+    reactive_socket_recv_pool_op_base* o(
+        static_cast<reactive_socket_recv_pool_op_base*>(base));
+
+    void* data = 0;
+    if (flags & IORING_CQE_F_BUFFER)
+      data = o->pool_.get_buffer(flags >> IORING_CQE_BUFFER_SHIFT);
+
+    if (result < 0)
+    {
+      o->ec_ = asio::error_code(-result,
+          asio::error::get_system_category());
+      o->bytes_transferred_ = 0;
+      if (o->ec_ == asio::error::interrupted
+          || o->ec_ == asio::error::would_block
+          || o->ec_ == asio::error::try_again)
+      {
+        if (data)
+          o->pool_.release(asio::mutable_buffer(data, 0));
+        return not_done;
+      }
+
+      // Report why the group has no buffers, if the kernel refused them.
+      if (o->ec_ == asio::error::no_buffer_space)
+        if (asio::error_code group_ec = o->pool_.group_error())
+          o->ec_ = group_ec;
+    }
+    else
+    {
+      o->ec_ = asio::error_code();
+      o->bytes_transferred_ = result;
+      if ((o->state_ & socket_ops::stream_oriented) != 0 && result == 0)
+        o->ec_ = asio::error::eof;
+    }
+
+    ASIO_HANDLER_REACTOR_OPERATION((*o, "io_uring_recv",
+          o->ec_, o->bytes_transferred_));
+
+    if (data)
+      o->take_buffer(data);
+
+    // A short read means the socket's receive buffer has been drained.
+    return o->bytes_transferred_ < o->pool_.buffer_size()
+      ? done_and_exhausted : done;
+  }
+#endif // defined(ASIO_HAS_IO_URING)
+
+protected:
+  // The filled part of the buffer, which is passed to the handler.
+  asio::mutable_buffer buffer_;
+
+private:
+  // Keep the buffer if data was received into it, otherwise return it to the
+  // pool.
+  void take_buffer(void* data)
+  {
+    if (!this->ec_ && this->bytes_transferred_ > 0)
+      buffer_ = asio::mutable_buffer(data, this->bytes_transferred_);
+    else
+      pool_.release(asio::mutable_buffer(data, 0));
+  }
+
+  socket_type socket_;
+  socket_ops::state_type state_;
+  buffer_pool& pool_;
+  int group_;
+  socket_base::message_flags flags_;
+};
+
+template <typename Handler, typename IoExecutor>
+class reactive_socket_recv_pool_op :
+  public reactive_socket_recv_pool_op_base
+{
+public:
+  ASIO_DEFINE_HANDLER_PTR(reactive_socket_recv_pool_op);
+
+  reactive_socket_recv_pool_op(const asio::error_code& success_ec,
+      socket_type socket, socket_ops::state_type state, buffer_pool& pool,
+      int group, socket_base::message_flags flags,
+      Handler& handler, const IoExecutor& io_ex)
+    : reactive_socket_recv_pool_op_base(success_ec, socket, state, pool,
+        group, flags, &reactive_socket_recv_pool_op::do_complete),
+      handler_(ASIO_MOVE_CAST(Handler)(handler)),
+      io_executor_(io_ex)
+  {
+    handler_work<Handler, IoExecutor>::start(handler_, io_executor_);
+  }
+
+  static void do_complete(void* owner, operation* base,
+      const asio::error_code& /*ec*/,
+      std::size_t /*bytes_transferred*/)
+  {
+    // Take ownership of the handler object.
+    reactive_socket_recv_pool_op* o(
+        static_cast<reactive_socket_recv_pool_op*>(base));
+    ptr p = { asio::detail::addressof(o->handler_), o, o };
+    handler_work<Handler, IoExecutor> w(o->handler_, o->io_executor_);
+
+    ASIO_HANDLER_COMPLETION((*o));
+
+    // Make a copy of the handler so that the memory can be deallocated before
+    // the upcall is made. Even if we're not about to make an upcall, a
+    // sub-object of the handler may be the true owner of the memory associated
+    // with the handler. Consequently, a local copy of the handler is required
+    // to ensure that any owning sub-object remains valid until after we have
+    // deallocated the memory here.
+    detail::binder2<Handler, asio::error_code, asio::mutable_buffer>
+      handler(o->handler_, o->ec_, o->buffer_);
+    p.h = asio::detail::addressof(handler.handler_);
+    p.reset();
+
+    // Make the upcall if required.
+    if (owner)
+    {
+      fenced_block b(fenced_block::half);
+      ASIO_HANDLER_INVOCATION_BEGIN((handler.arg1_, handler.arg2_.size()));
+      w.complete(handler, handler.handler_);
+      ASIO_HANDLER_INVOCATION_END;
+    }
+  }
+
+private:
+  Handler handler_;
+  IoExecutor io_executor_;
+};
+
+} // namespace detail
+} // namespace asio
+
+#include "../detail/pop_options.hpp"
+
+#endif // ASIO_DETAIL_REACTIVE_SOCKET_RECV_POOL_OP_HPP
@@ -34,15 +34,20 @@ class reactive_socket_send_op_base : public reactor_op
 public:
   reactive_socket_send_op_base(const asio::error_code& success_ec,
       socket_type socket, socket_ops::state_type state,
-      const ConstBufferSequence& buffers,
-      socket_base::message_flags flags, func_type complete_func)
+      const ConstBufferSequence& buffers, socket_base::message_flags flags,
+      std::size_t flatten_size, func_type complete_func)
     : reactor_op(success_ec,
         &reactive_socket_send_op_base::do_perform, complete_func),
       socket_(socket),
       state_(state),
       buffers_(buffers),
-      flags_(flags)
+      flags_(flags),
+      flatten_size_(flatten_size)
   {
+#if defined(ASIO_HAS_IO_URING)
+    this->set_submission_funcs(&reactive_socket_send_op_base::do_prepare,
+        &reactive_socket_send_op_base::do_submission);
+#endif // defined(ASIO_HAS_IO_URING)
   }
 
   static status do_perform(reactor_op* base)
@@ -66,17 +71,16 @@ public:
           if (o->bytes_transferred_ < bufs_type::first(o->buffers_).size())
             result = done_and_exhausted;
     }
+    else if (o->flatten_size_ > 0)
+    {
+      flattened_buffer_sequence_adapter<ConstBufferSequence> bufs(
+          o->buffers_, o->flatten_size_);
+      result = o->perform_gather(bufs);
+    }
     else
     {
       bufs_type bufs(o->buffers_);
-      result = socket_ops::non_blocking_send(o->socket_,
-            bufs.buffers(), bufs.count(), o->flags_,
-            o->ec_, o->bytes_transferred_) ? done : not_done;
-
-      if (result == done)
-        if ((o->state_ & socket_ops::stream_oriented) != 0)
-          if (o->bytes_transferred_ < bufs.total_size())
-            result = done_and_exhausted;
+      result = o->perform_gather(bufs);
     }
 
     ASIO_HANDLER_REACTOR_OPERATION((*o, "non_blocking_send",
@@ -85,11 +89,85 @@ public:
     return result;
   }
 
+#if defined(ASIO_HAS_IO_URING)
+  static bool do_prepare(reactor_op* base, io_uring_sqe* sqe)
+  {
+    reactive_socket_send_op_base* o(
+        static_cast<reactive_socket_send_op_base*>(base));
+
+    typedef buffer_sequence_adapter<asio::const_buffer,
+        ConstBufferSequence> bufs_type;
+
+    // Only a single buffer can be sent without keeping a copy of the native
+    // buffer array alive for the duration of the submission.
+    asio::const_buffer buffer = bufs_type::first(o->buffers_);
+    if (!bufs_type::is_single_buffer)
+      if (asio::buffer_size(o->buffers_) != buffer.size())
+        return false;
+
+    sqe->opcode = IORING_OP_SEND;
+    sqe->fd = o->socket_;
+    sqe->addr = reinterpret_cast<__u64>(buffer.data());
+    sqe->len = static_cast<__u32>(buffer.size());
+    sqe->msg_flags = static_cast<__u32>(o->flags_ | MSG_NOSIGNAL);
+    return buffer.size() == sqe->len;
+  }
+
+  static status do_submission(reactor_op* base, int result, unsigned)
+  {
+    reactive_socket_send_op_base* o(
+        static_cast<reactive_socket_send_op_base*>(base));
+
+    typedef buffer_sequence_adapter<asio::const_buffer,
+        ConstBufferSequence> bufs_type;
+
+    if (result < 0)
+    {
+      o->ec_ = asio::error_code(-result,
+          asio::error::get_system_category());
+      o->bytes_transferred_ = 0;
+      if (o->ec_ == asio::error::interrupted
+          || o->ec_ == asio::error::would_block
+          || o->ec_ == asio::error::try_again)
+        return not_done;
+    }
+    else
+    {
+      o->ec_ = asio::error_code();
+      o->bytes_transferred_ = result;
+    }
+
+    ASIO_HANDLER_REACTOR_OPERATION((*o, "io_uring_send",
+          o->ec_, o->bytes_transferred_));
+
+    // A short write means the socket's send buffer is full.
+    return o->bytes_transferred_ < bufs_type::first(o->buffers_).size()
+      ? done_and_exhausted : done;
+  }
+#endif // defined(ASIO_HAS_IO_URING)
+
 private:
+  // Send the buffers translated by an adapter.
+  template <typename Adapter>
+  status perform_gather(Adapter& bufs)
+  {
+    status result = socket_ops::non_blocking_send(socket_,
+          bufs.buffers(), bufs.count(), flags_,
+          ec_, bytes_transferred_) ? done : not_done;
+
+    if (result == done)
+      if ((state_ & socket_ops::stream_oriented) != 0)
+        if (bytes_transferred_ < bufs.total_size())
+          result = done_and_exhausted;
+
+    return result;
+  }
+
   socket_type socket_;
   socket_ops::state_type state_;
   ConstBufferSequence buffers_;
   socket_base::message_flags flags_;
+  std::size_t flatten_size_;
 };
 
 template <typename ConstBufferSequence, typename Handler, typename IoExecutor>
@@ -102,9 +180,10 @@ public:
   reactive_socket_send_op(const asio::error_code& success_ec,
       socket_type socket, socket_ops::state_type state,
       const ConstBufferSequence& buffers, socket_base::message_flags flags,
-      Handler& handler, const IoExecutor& io_ex)
+      std::size_t flatten_size, Handler& handler, const IoExecutor& io_ex)
     : reactive_socket_send_op_base<ConstBufferSequence>(success_ec, socket,
-        state, buffers, flags, &reactive_socket_send_op::do_complete),
+        state, buffers, flags, flatten_size,
+        &reactive_socket_send_op::do_complete),
       handler_(ASIO_MOVE_CAST(Handler)(handler)),
       io_executor_(io_ex)
   {
@@ -0,0 +1,232 @@
+//
+// detail/reactive_socket_send_zero_copy_op.hpp
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2020 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_DETAIL_REACTIVE_SOCKET_SEND_ZERO_COPY_OP_HPP
+#define ASIO_DETAIL_REACTIVE_SOCKET_SEND_ZERO_COPY_OP_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "../detail/config.hpp"
+
+#if defined(ASIO_HAS_MSG_ZEROCOPY)
+
+#include "../detail/bind_handler.hpp"
+#include "../detail/buffer_sequence_adapter.hpp"
+#include "../detail/fenced_block.hpp"
+#include "../detail/memory.hpp"
+#include "../detail/reactor_op.hpp"
+#include "../detail/socket_ops.hpp"
+#include "../detail/zero_copy_tracker.hpp"
+
+#include "../detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+template <typename ConstBufferSequence>
+class reactive_socket_send_zero_copy_op_base : public reactor_op
+{
+public:
+  reactive_socket_send_zero_copy_op_base(const asio::error_code& success_ec,
+      socket_type socket, zero_copy_tracker* tracker,
+      const ConstBufferSequence& buffers,
+      socket_base::message_flags flags, func_type complete_func)
+    : reactor_op(success_ec,
+        &reactive_socket_send_zero_copy_op_base::do_perform, complete_func),
+      socket_(socket),
+      tracker_(tracker),
+      buffers_(buffers),
+      flags_(flags),
+      sent_(false)
+  {
+#if defined(ASIO_HAS_IO_URING)
+    this->set_submission_funcs(
+        &reactive_socket_send_zero_copy_op_base::do_prepare,
+        &reactive_socket_send_zero_copy_op_base::do_submission);
+#endif // defined(ASIO_HAS_IO_URING)
+  }
+
+  static status do_perform(reactor_op* base)
+  {
+    reactive_socket_send_zero_copy_op_base* o(
+        static_cast<reactive_socket_send_zero_copy_op_base*>(base));
+
+    // Once the data has been sent, the operation waits until the kernel has
+    // released the buffers.
+    if (o->sent_)
+      return o->check_released();
+
+    typedef buffer_sequence_adapter<asio::const_buffer,
+        ConstBufferSequence> bufs_type;
+
+    bufs_type bufs(o->buffers_);
+    socket_base::message_flags flags = o->flags_;
+    if (o->tracker_->enabled()
+        && bufs.total_size() >= zero_copy_tracker::min_send_size)
+      flags |= MSG_ZEROCOPY;
+
+    bool finished = socket_ops::non_blocking_send(o->socket_,
+        bufs.buffers(), bufs.count(), flags,
+        o->ec_, o->bytes_transferred_);
+
+    // The kernel refuses a zero-copy send if pinning the pages would exceed
+    // the socket's limit on option memory. Copy the data instead.
+    if (finished && (flags & MSG_ZEROCOPY) != 0
+        && o->ec_ == asio::error::no_buffer_space)
+    {
+      flags &= ~MSG_ZEROCOPY;
+      finished = socket_ops::non_blocking_send(o->socket_,
+          bufs.buffers(), bufs.count(), flags,
+          o->ec_, o->bytes_transferred_);
+    }
+
+    ASIO_HANDLER_REACTOR_OPERATION((*o, "non_blocking_send",
+          o->ec_, o->bytes_transferred_));
+
+    if (!finished)
+      return not_done;
+
+    if (!o->ec_ && (flags & MSG_ZEROCOPY) != 0)
+    {
+      o->tracker_->record_send();
+      o->sent_ = true;
+      return o->check_released();
+    }
+
+    return o->bytes_transferred_ < bufs.total_size()
+      ? done_and_exhausted : done;
+  }
+
+#if defined(ASIO_HAS_IO_URING)
+  static bool do_prepare(reactor_op* base, io_uring_sqe* sqe)
+  {
+    reactive_socket_send_zero_copy_op_base* o(
+        static_cast<reactive_socket_send_zero_copy_op_base*>(base));
+
+    // The data is sent when the socket is ready. The kernel's notification
+    // that it has released the buffers is then awaited using a poll that
+    // completes only when the error queue is not empty.
+    if (!o->sent_)
+      return false;
+
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = o->socket_;
+    sqe->poll_events = POLLERR;
+    return true;
+  }
+
+  static status do_submission(reactor_op* base, int result, unsigned)
+  {
+    reactive_socket_send_zero_copy_op_base* o(
+        static_cast<reactive_socket_send_zero_copy_op_base*>(base));
+
+    if (result < 0)
+    {
+      o->ec_ = asio::error_code(-result,
+          asio::error::get_system_category());
+      return done;
+    }
+
+    return o->check_released();
+  }
+#endif // defined(ASIO_HAS_IO_URING)
+
+private:
+  // Determine whether the kernel has released the buffers. The data has been
+  // sent, so a failure to read the notifications is reported only if it
+  // leaves the state of the buffers unknown.
+  status check_released()
+  {
+    asio::error_code ec;
+    if (tracker_->all_released(socket_, ec))
+      return done;
+    if (ec)
+    {
+      ec_ = ec;
+      return done;
+    }
+    return not_done;
+  }
+
+  socket_type socket_;
+  zero_copy_tracker* tracker_;
+  ConstBufferSequence buffers_;
+  socket_base::message_flags flags_;
+  bool sent_;
+};
+
+template <typename ConstBufferSequence, typename Handler, typename IoExecutor>
+class reactive_socket_send_zero_copy_op :
+  public reactive_socket_send_zero_copy_op_base<ConstBufferSequence>
+{
+public:
+  ASIO_DEFINE_HANDLER_PTR(reactive_socket_send_zero_copy_op);
+
+  reactive_socket_send_zero_copy_op(const asio::error_code& success_ec,
+      socket_type socket, zero_copy_tracker* tracker,
+      const ConstBufferSequence& buffers, socket_base::message_flags flags,
+      Handler& handler, const IoExecutor& io_ex)
+    : reactive_socket_send_zero_copy_op_base<ConstBufferSequence>(
+        success_ec, socket, tracker, buffers, flags,
+        &reactive_socket_send_zero_copy_op::do_complete),
+      handler_(ASIO_MOVE_CAST(Handler)(handler)),
+      io_executor_(io_ex)
+  {
+    handler_work<Handler, IoExecutor>::start(handler_, io_executor_);
+  }
+
+  static void do_complete(void* owner, operation* base,
+      const asio::error_code& /*ec*/,
+      std::size_t /*bytes_transferred*/)
+  {
+    // Take ownership of the handler object.
+    reactive_socket_send_zero_copy_op* o(
+        static_cast<reactive_socket_send_zero_copy_op*>(base));
+    ptr p = { asio::detail::addressof(o->handler_), o, o };
+    handler_work<Handler, IoExecutor> w(o->handler_, o->io_executor_);
+
+    ASIO_HANDLER_COMPLETION((*o));
+
+    // Make a copy of the handler so that the memory can be deallocated before
+    // the upcall is made. Even if we're not about to make an upcall, a
+    // sub-object of the handler may be the true owner of the memory associated
+    // with the handler. Consequently, a local copy of the handler is required
+    // to ensure that any owning sub-object remains valid until after we have
+    // deallocated the memory here.
+    detail::binder2<Handler, asio::error_code, std::size_t>
+      handler(o->handler_, o->ec_, o->bytes_transferred_);
+    p.h = asio::detail::addressof(handler.handler_);
+    p.reset();
+
+    // Make the upcall if required.
+    if (owner)
+    {
+      fenced_block b(fenced_block::half);
+      ASIO_HANDLER_INVOCATION_BEGIN((handler.arg1_, handler.arg2_));
+      w.complete(handler, handler.handler_);
+      ASIO_HANDLER_INVOCATION_END;
+    }
+  }
+
+private:
+  Handler handler_;
+  IoExecutor io_executor_;
+};
+
+} // namespace detail
+} // namespace asio
+
+#include "../detail/pop_options.hpp"
+
+#endif // defined(ASIO_HAS_MSG_ZEROCOPY)
+
+#endif // ASIO_DETAIL_REACTIVE_SOCKET_SEND_ZERO_COPY_OP_HPP
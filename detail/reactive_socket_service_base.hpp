@@ -28,8 +28,10 @@
 #include "../detail/memory.hpp"
 #include "../detail/reactive_null_buffers_op.hpp"
 #include "../detail/reactive_socket_recv_op.hpp"
+#include "../detail/reactive_socket_recv_pool_op.hpp"
 #include "../detail/reactive_socket_recvmsg_op.hpp"
 #include "../detail/reactive_socket_send_op.hpp"
+#include "../detail/reactive_socket_send_zero_copy_op.hpp"
 #include "../detail/reactive_wait_op.hpp"
 #include "../detail/reactor.hpp"
 #include "../detail/reactor_op.hpp"
@@ -166,6 +168,16 @@ public:
     return ec;
   }
 
+  // Gets whether asynchronous sends avoid copying data into the kernel.
+  bool zero_copy(const base_implementation_type& impl) const
+  {
+    return (impl.state_ & socket_ops::zero_copy) != 0;
+  }
+
+  // Sets whether asynchronous sends avoid copying data into the kernel.
+  ASIO_DECL asio::error_code zero_copy(base_implementation_type& impl,
+      bool mode, asio::error_code& ec);
+
   // Wait for the socket to become ready to read, ready to write, or to have
   // pending error conditions.
   asio::error_code wait(base_implementation_type& impl,
@@ -246,6 +258,13 @@ public:
           impl.state_, bufs_type::first(buffers).data(),
           bufs_type::first(buffers).size(), flags, ec);
     }
+    else if (flatten_size_ > 0)
+    {
+      flattened_buffer_sequence_adapter<ConstBufferSequence> bufs(
+          buffers, flatten_size_);
+      return socket_ops::sync_send(impl.socket_, impl.state_,
+          bufs.buffers(), bufs.count(), flags, bufs.all_empty(), ec);
+    }
     else
     {
       bufs_type bufs(buffers);
@@ -274,13 +293,40 @@ public:
     bool is_continuation =
       asio_handler_cont_helpers::is_continuation(handler);
 
+#if defined(ASIO_HAS_MSG_ZEROCOPY)
+    if ((impl.state_ & socket_ops::zero_copy) != 0)
+    {
+      if (zero_copy_tracker* tracker =
+          reactor_.get_zero_copy_tracker(impl.reactor_data_))
+      {
+        // Allocate and construct an operation to wrap the handler.
+        typedef reactive_socket_send_zero_copy_op<
+            ConstBufferSequence, Handler, IoExecutor> op;
+        typename op::ptr p = { asio::detail::addressof(handler),
+          op::ptr::allocate(handler), 0 };
+        p.p = new (p.v) op(success_ec_, impl.socket_,
+            tracker, buffers, flags, handler, io_ex);
+
+        ASIO_HANDLER_CREATION((reactor_.context(), *p.p, "socket",
+              &impl, impl.socket_, "async_send(zero_copy)"));
+
+        start_op(impl, reactor::write_op, p.p, is_continuation, true,
+            ((impl.state_ & socket_ops::stream_oriented)
+              && buffer_sequence_adapter<asio::const_buffer,
+                ConstBufferSequence>::all_empty(buffers)));
+        p.v = p.p = 0;
+        return;
+      }
+    }
+#endif // defined(ASIO_HAS_MSG_ZEROCOPY)
+
     // Allocate and construct an operation to wrap the handler.
     typedef reactive_socket_send_op<
         ConstBufferSequence, Handler, IoExecutor> op;
     typename op::ptr p = { asio::detail::addressof(handler),
       op::ptr::allocate(handler), 0 };
-    p.p = new (p.v) op(success_ec_, impl.socket_,
-        impl.state_, buffers, flags, handler, io_ex);
+    p.p = new (p.v) op(success_ec_, impl.socket_, impl.state_,
+        buffers, flags, flatten_size_, handler, io_ex);
 
     ASIO_HANDLER_CREATION((reactor_.context(), *p.p, "socket",
           &impl, impl.socket_, "async_send"));
@@ -379,6 +425,35 @@ public:
     p.v = p.p = 0;
   }
 
+  // Start an asynchronous receive into a buffer taken from a pool when data
+  // arrives. The pool must be valid for the lifetime of the asynchronous
+  // operation.
+  template <typename Handler, typename IoExecutor>
+  void async_receive(base_implementation_type& impl,
+      buffer_pool& pool, socket_base::message_flags flags,
+      Handler& handler, const IoExecutor& io_ex)
+  {
+    bool is_continuation =
+      asio_handler_cont_helpers::is_continuation(handler);
+
+    // Allocate and construct an operation to wrap the handler.
+    typedef reactive_socket_recv_pool_op<Handler, IoExecutor> op;
+    typename op::ptr p = { asio::detail::addressof(handler),
+      op::ptr::allocate(handler), 0 };
+    p.p = new (p.v) op(success_ec_, impl.socket_, impl.state_, pool,
+        pool.buffer_group(&reactor_), flags, handler, io_ex);
+
+    ASIO_HANDLER_CREATION((reactor_.context(), *p.p, "socket",
+          &impl, impl.socket_, "async_receive(buffer_pool)"));
+
+    start_op(impl,
+        (flags & socket_base::message_out_of_band)
+          ? reactor::except_op : reactor::read_op,
+        p.p, is_continuation,
+        (flags & socket_base::message_out_of_band) == 0, false);
+    p.v = p.p = 0;
+  }
+
   // Wait until data can be received without blocking.
   template <typename Handler, typename IoExecutor>
   void async_receive(base_implementation_type& impl,
@@ -506,6 +581,10 @@ protected:
       base_implementation_type& impl, int type,
       const native_handle_type& native_socket, asio::error_code& ec);
 
+  // Apply the busy poll setting from the io_context options to a newly opened
+  // or assigned socket. Errors are ignored.
+  ASIO_DECL void set_busy_poll(base_implementation_type& impl);
+
   // Start the asynchronous read or write operation.
   ASIO_DECL void start_op(base_implementation_type& impl, int op_type,
       reactor_op* op, bool is_continuation, bool is_non_blocking, bool noop);
@@ -524,6 +603,13 @@ protected:
 
   // Cached success value to avoid accessing category singleton.
   const asio::error_code success_ec_;
+
+  // The value of SO_BUSY_POLL to set on new sockets, or 0 to leave it unset.
+  const int busy_poll_usec_;
+
+  // Buffers in a gather send that are smaller than this are copied, or 0 to
+  // send every buffer separately.
+  const std::size_t flatten_size_;
 };
 
 } // namespace detail
@@ -17,7 +17,9 @@
 
 #include "../detail/reactor_fwd.hpp"
 
-#if defined(ASIO_HAS_EPOLL)
+#if defined(ASIO_HAS_IO_URING)
+#include "../detail/io_uring_reactor.hpp"
+#elif defined(ASIO_HAS_EPOLL)
 #include "../detail/epoll_reactor.hpp"
 #elif defined(ASIO_HAS_KQUEUE)
 #include "../detail/kqueue_reactor.hpp"
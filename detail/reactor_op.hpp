@@ -18,6 +18,10 @@
 #include "../detail/config.hpp"
 #include "../detail/operation.hpp"
 
+#if defined(ASIO_HAS_IO_URING)
+# include <linux/io_uring.h>
+#endif // defined(ASIO_HAS_IO_URING)
+
 #include "../detail/push_options.hpp"
 
 namespace asio {
@@ -43,6 +47,22 @@ public:
     return perform_func_(this);
   }
 
+#if defined(ASIO_HAS_IO_URING)
+  // Prepare a submission queue entry that performs the operation to
+  // completion. Returns false if the operation must wait for readiness.
+  bool prepare(io_uring_sqe* sqe)
+  {
+    return prepare_func_ ? prepare_func_(this, sqe) : false;
+  }
+
+  // Record the result and flags of a completed submission. Returns not_done
+  // if the operation needs to be submitted again.
+  status complete_submission(int result, unsigned flags)
+  {
+    return submission_func_(this, result, flags);
+  }
+#endif // defined(ASIO_HAS_IO_URING)
+
 protected:
   typedef status (*perform_func_type)(reactor_op*);
 
@@ -52,11 +72,32 @@ protected:
       ec_(success_ec),
       bytes_transferred_(0),
       perform_func_(perform_func)
+#if defined(ASIO_HAS_IO_URING)
+      , prepare_func_(0),
+      submission_func_(0)
+#endif // defined(ASIO_HAS_IO_URING)
+  {
+  }
+
+#if defined(ASIO_HAS_IO_URING)
+  typedef bool (*prepare_func_type)(reactor_op*, io_uring_sqe*);
+  typedef status (*submission_func_type)(reactor_op*, int, unsigned);
+
+  // Allow the operation to be performed by a completion-based submission.
+  void set_submission_funcs(prepare_func_type prepare_func,
+      submission_func_type submission_func)
   {
+    prepare_func_ = prepare_func;
+    submission_func_ = submission_func;
   }
+#endif // defined(ASIO_HAS_IO_URING)
 
 private:
   perform_func_type perform_func_;
+#if defined(ASIO_HAS_IO_URING)
+  prepare_func_type prepare_func_;
+  submission_func_type submission_func_;
+#endif // defined(ASIO_HAS_IO_URING)
 };
 
 } // namespace detail
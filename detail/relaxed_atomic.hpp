@@ -0,0 +1,136 @@
+//
+// detail/relaxed_atomic.hpp
+// ~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2020 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_DETAIL_RELAXED_ATOMIC_HPP
+#define ASIO_DETAIL_RELAXED_ATOMIC_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "../detail/config.hpp"
+#include "../detail/noncopyable.hpp"
+
+#if !defined(ASIO_HAS_THREADS)
+// Nothing to include.
+#elif defined(ASIO_HAS_STD_ATOMIC)
+# include <atomic>
+#else // defined(ASIO_HAS_STD_ATOMIC)
+# include "../detail/mutex.hpp"
+#endif // defined(ASIO_HAS_STD_ATOMIC)
+
+#include "../detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+// A value, such as a statistic or a tuning parameter, that is updated by one
+// thread and may be read or written by any other without synchronising with
+// anything else. Where atomics are available every access uses relaxed
+// ordering.
+template <typename T>
+class relaxed_atomic
+  : private noncopyable
+{
+public:
+  // Constructor.
+  explicit relaxed_atomic(T value = T())
+    : value_(value)
+  {
+  }
+
+  // Get the value.
+  T load() const
+  {
+#if !defined(ASIO_HAS_THREADS)
+    return value_;
+#elif defined(ASIO_HAS_STD_ATOMIC)
+    return value_.load(std::memory_order_relaxed);
+#else // defined(ASIO_HAS_STD_ATOMIC)
+    mutex::scoped_lock lock(mutex_);
+    return value_;
+#endif // defined(ASIO_HAS_STD_ATOMIC)
+  }
+
+  // Set the value.
+  void store(T value)
+  {
+#if !defined(ASIO_HAS_THREADS)
+    value_ = value;
+#elif defined(ASIO_HAS_STD_ATOMIC)
+    value_.store(value, std::memory_order_relaxed);
+#else // defined(ASIO_HAS_STD_ATOMIC)
+    mutex::scoped_lock lock(mutex_);
+    value_ = value;
+#endif // defined(ASIO_HAS_STD_ATOMIC)
+  }
+
+  // Add to the value, returning the result.
+  T add(T value)
+  {
+#if !defined(ASIO_HAS_THREADS)
+    return value_ += value;
+#elif defined(ASIO_HAS_STD_ATOMIC)
+    return value_.fetch_add(value, std::memory_order_relaxed) + value;
+#else // defined(ASIO_HAS_STD_ATOMIC)
+    mutex::scoped_lock lock(mutex_);
+    return value_ += value;
+#endif // defined(ASIO_HAS_STD_ATOMIC)
+  }
+
+  // Subtract from the value, returning the result.
+  T subtract(T value)
+  {
+#if !defined(ASIO_HAS_THREADS)
+    return value_ -= value;
+#elif defined(ASIO_HAS_STD_ATOMIC)
+    return value_.fetch_sub(value, std::memory_order_relaxed) - value;
+#else // defined(ASIO_HAS_STD_ATOMIC)
+    mutex::scoped_lock lock(mutex_);
+    return value_ -= value;
+#endif // defined(ASIO_HAS_STD_ATOMIC)
+  }
+
+  // Set the value to the larger of its current value and the one given.
+  void raise(T value)
+  {
+#if !defined(ASIO_HAS_THREADS)
+    if (value_ < value)
+      value_ = value;
+#elif defined(ASIO_HAS_STD_ATOMIC)
+    T current = value_.load(std::memory_order_relaxed);
+    while (current < value && !value_.compare_exchange_weak(
+          current, value, std::memory_order_relaxed))
+    {
+    }
+#else // defined(ASIO_HAS_STD_ATOMIC)
+    mutex::scoped_lock lock(mutex_);
+    if (value_ < value)
+      value_ = value;
+#endif // defined(ASIO_HAS_STD_ATOMIC)
+  }
+
+private:
+#if !defined(ASIO_HAS_THREADS)
+  T value_;
+#elif defined(ASIO_HAS_STD_ATOMIC)
+  std::atomic<T> value_;
+#else // defined(ASIO_HAS_STD_ATOMIC)
+  mutable mutex mutex_;
+  T value_;
+#endif // defined(ASIO_HAS_STD_ATOMIC)
+};
+
+} // namespace detail
+} // namespace asio
+
+#include "../detail/pop_options.hpp"
+
+#endif // ASIO_DETAIL_RELAXED_ATOMIC_HPP
@@ -19,11 +19,16 @@
 
 #include "../error_code.hpp"
 #include "../execution_context.hpp"
+#include "../io_context_options.hpp"
 #include "../detail/atomic_count.hpp"
 #include "../detail/conditionally_enabled_event.hpp"
 #include "../detail/conditionally_enabled_mutex.hpp"
+#include "../detail/cstdint.hpp"
+#include "../detail/handler_arena.hpp"
+#include "../detail/mpsc_op_queue.hpp"
 #include "../detail/op_queue.hpp"
 #include "../detail/reactor_fwd.hpp"
+#include "../detail/relaxed_atomic.hpp"
 #include "../detail/scheduler_operation.hpp"
 #include "../detail/thread.hpp"
 #include "../detail/thread_context.hpp"
@@ -45,7 +50,8 @@ public:
   // Constructor. Specifies the number of concurrent threads that are likely to
   // run the scheduler. If set to 1 certain optimisation are performed.
   ASIO_DECL scheduler(asio::execution_context& ctx,
-      int concurrency_hint = 0, bool own_thread = true);
+      int concurrency_hint = 0, bool own_thread = true,
+      const io_context_options& options = io_context_options());
 
   // Destructor.
   ASIO_DECL ~scheduler();
@@ -98,6 +104,12 @@ public:
       stop();
   }
 
+  // Get the number of units of outstanding work.
+  std::size_t outstanding_work() const
+  {
+    return static_cast<std::size_t>(outstanding_work_);
+  }
+
   // Return whether a handler can be dispatched immediately.
   bool can_dispatch()
   {
@@ -131,6 +143,41 @@ public:
     return concurrency_hint_;
   }
 
+  // Get the options that were used to initialise the scheduler.
+  const io_context_options& options() const
+  {
+    return options_;
+  }
+
+  // Get the total time, in microseconds, that the task has spent polling
+  // without blocking when busy polling is enabled. May be called from any
+  // thread.
+  uint64_t busy_poll_spin_usec() const
+  {
+    return busy_poll_spin_usec_.load();
+  }
+
+  // Get the total time, in microseconds, that the task has spent blocked
+  // after polling found nothing when busy polling is enabled. May be called
+  // from any thread.
+  uint64_t busy_poll_block_usec() const
+  {
+    return busy_poll_block_usec_.load();
+  }
+
+  // Get the number of bytes currently allocated from the handler arena.
+  std::size_t arena_bytes_allocated() const
+  {
+    return arena_ ? arena_->bytes_allocated() : 0;
+  }
+
+  // Get the largest number of bytes allocated from the handler arena at one
+  // time.
+  std::size_t arena_peak_bytes_allocated() const
+  {
+    return arena_ ? arena_->peak_bytes_allocated() : 0;
+  }
+
 private:
   // The mutex type used by this scheduler.
   typedef conditionally_enabled_mutex mutex;
@@ -153,6 +200,46 @@ private:
   ASIO_DECL std::size_t do_poll_one(mutex::scoped_lock& lock,
       thread_info& this_thread, const asio::error_code& ec);
 
+  // Run at most one operation, taking it from the thread's local queue, the
+  // shared queue or another thread's local queue. May block.
+  ASIO_DECL std::size_t do_run_one_local(
+      thread_info& this_thread, const asio::error_code& ec);
+
+  // Add the thread to the list of threads that have a local queue.
+  ASIO_DECL void register_local_queue(thread_info& this_thread);
+
+  // Remove the thread from the list of threads that have a local queue,
+  // moving any handlers remaining in its queue to the shared queue.
+  ASIO_DECL void unregister_local_queue(thread_info& this_thread);
+
+  // Add operations to the thread's local queue, waking an idle thread so
+  // that it may steal them.
+  ASIO_DECL void push_local(thread_info& this_thread,
+      op_queue<operation>& ops);
+
+  // Move some operations from another thread's local queue to this thread's
+  // local queue. Assumes mutex_ is held. Returns false if there was nothing
+  // to steal.
+  ASIO_DECL bool steal(thread_info& this_thread);
+
+  // Run the task, polling it and the operation queue without blocking for up
+  // to the busy poll time before blocking. Must be called with the lock
+  // released and task_interrupted_ set, so that other threads do not
+  // interrupt the task while it is polling.
+  ASIO_DECL void run_task_busy_poll(mutex::scoped_lock& lock,
+      thread_info& this_thread);
+
+  // Record that the calling thread is about to block. Returns false, having
+  // moved the injected operations to the main queue, if there are injected
+  // operations, in which case the thread must not block. Assumes mutex_ is
+  // held. The caller must decrement sleeping_threads_ after blocking, using
+  // sleep_cleanup when the blocking call may throw.
+  ASIO_DECL bool prepare_to_sleep();
+
+  // Enqueue an operation posted from a thread that is not running the
+  // scheduler, waking a sleeping thread if required.
+  ASIO_DECL void post_injected(operation* op);
+
   // Stop the task and all idle threads.
   ASIO_DECL void stop_all_threads(mutex::scoped_lock& lock);
 
@@ -172,6 +259,14 @@ private:
   struct work_cleanup;
   friend struct work_cleanup;
 
+  // Helper class to decrement the count of sleeping threads on block exit.
+  struct sleep_cleanup;
+  friend struct sleep_cleanup;
+
+  // Helper class to remove a thread's local queue on block exit.
+  struct local_queue_cleanup;
+  friend struct local_queue_cleanup;
+
   // Whether to optimise for single-threaded use cases.
   const bool one_thread_;
 
@@ -199,15 +294,50 @@ private:
   // The queue of handlers that are ready to be delivered.
   op_queue<operation> op_queue_;
 
+  // Handlers posted from threads that are not running the scheduler. They
+  // are moved to op_queue_ by the threads that run the scheduler.
+  mpsc_op_queue<operation> injected_ops_;
+
+  // The number of threads that are blocked, or about to block, waiting for
+  // work.
+  atomic_count sleeping_threads_;
+
   // Flag to indicate that the dispatcher has been stopped.
   bool stopped_;
 
   // Flag to indicate that the dispatcher has been shut down.
   bool shutdown_;
 
+  // The time spent polling and blocked by the task when busy polling.
+  relaxed_atomic<uint64_t> busy_poll_spin_usec_;
+  relaxed_atomic<uint64_t> busy_poll_block_usec_;
+
   // The concurrency hint used to initialise the scheduler.
   const int concurrency_hint_;
 
+  // The options used to initialise the scheduler.
+  const io_context_options options_;
+
+  // The arena from which threads running the scheduler allocate handler
+  // memory, if enabled.
+  handler_arena* arena_;
+
+  // The number of consecutive handlers a thread runs from its local queue
+  // before it checks the shared queue.
+  enum { local_run_limit = 64 };
+
+  // Whether each thread has its own queue that idle threads may steal from.
+  const bool work_stealing_;
+
+  // The threads that have a local queue.
+  thread_info* local_queues_;
+
+  // The thread whose local queue is the first to be checked when stealing.
+  thread_info* next_victim_;
+
+  // The number of threads that have found no work and are about to block.
+  atomic_count idle_threads_;
+
   // The thread that is running the scheduler.
   asio::detail::thread* thread_;
 };
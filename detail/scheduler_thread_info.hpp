@@ -15,6 +15,8 @@
 # pragma once
 #endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
 
+#include <cstddef>
+#include "../detail/mutex.hpp"
 #include "../detail/op_queue.hpp"
 #include "../detail/thread_info_base.hpp"
 
@@ -28,8 +30,32 @@ class scheduler_operation;
 
 struct scheduler_thread_info : public thread_info_base
 {
+  scheduler_thread_info()
+    : private_outstanding_work(0),
+      local_op_count(0),
+      local_run_count(0),
+      has_local_queue(false),
+      local_stop_requested(false),
+      next_local(0),
+      prev_local(0)
+  {
+  }
+
   op_queue<scheduler_operation> private_op_queue;
   long private_outstanding_work;
+
+  // The thread's queue of ready handlers when the scheduler uses work
+  // stealing. Other threads may steal from it, so it has its own mutex.
+  mutex local_mutex;
+  op_queue<scheduler_operation> local_op_queue;
+  std::size_t local_op_count;
+  std::size_t local_run_count;
+  bool has_local_queue;
+  bool local_stop_requested;
+
+  // Links in the scheduler's list of threads that have a local queue.
+  scheduler_thread_info* next_local;
+  scheduler_thread_info* prev_local;
 };
 
 } // namespace detail
@@ -160,6 +160,12 @@ public:
   // Interrupt the select loop.
   ASIO_DECL void interrupt();
 
+  // Release memory retained for reuse. Nothing is retained, so this does
+  // nothing.
+  void trim()
+  {
+  }
+
 private:
 #if defined(ASIO_HAS_IOCP)
   // Run the select loop in the thread.
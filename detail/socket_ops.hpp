@@ -52,7 +52,10 @@ enum
   datagram_oriented = 32,
 
   // The socket may have been dup()-ed.
-  possible_dup = 64
+  possible_dup = 64,
+
+  // The user wants asynchronous sends to avoid copying data into the kernel.
+  zero_copy = 128
 };
 
 typedef unsigned char state_type;
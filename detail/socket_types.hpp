@@ -359,6 +359,9 @@ typedef int signed_size_type;
 # define ASIO_OS_DEF_SO_SNDLOWAT SO_SNDLOWAT
 # define ASIO_OS_DEF_SO_RCVLOWAT SO_RCVLOWAT
 # define ASIO_OS_DEF_SO_REUSEADDR SO_REUSEADDR
+# if defined(SO_REUSEPORT)
+#  define ASIO_OS_DEF_SO_REUSEPORT SO_REUSEPORT
+# endif // defined(SO_REUSEPORT)
 # define ASIO_OS_DEF_TCP_NODELAY TCP_NODELAY
 # define ASIO_OS_DEF_IP_MULTICAST_IF IP_MULTICAST_IF
 # define ASIO_OS_DEF_IP_MULTICAST_TTL IP_MULTICAST_TTL
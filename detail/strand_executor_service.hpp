@@ -17,14 +17,20 @@
 
 #include "../detail/config.hpp"
 #include "../detail/atomic_count.hpp"
+#include "../detail/cstdint.hpp"
 #include "../detail/executor_op.hpp"
 #include "../detail/memory.hpp"
 #include "../detail/mutex.hpp"
 #include "../detail/op_queue.hpp"
+#include "../detail/relaxed_atomic.hpp"
 #include "../detail/scheduler_operation.hpp"
 #include "../detail/scoped_ptr.hpp"
 #include "../execution_context.hpp"
 
+#if defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
+# include <atomic>
+#endif // defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
+
 #include "../detail/push_options.hpp"
 
 namespace asio {
@@ -41,9 +47,37 @@ public:
   public:
     ASIO_DECL ~strand_impl();
 
+    // Implementations are allocated on a cache line boundary, so that the
+    // state, which is written by every thread that adds a handler, does not
+    // share a cache line with another object.
+    ASIO_DECL static void* operator new(std::size_t size);
+    ASIO_DECL static void operator delete(void* pointer);
+
   private:
     friend class strand_executor_service;
 
+    // The size of a cache line.
+    enum { cache_line_size = 64 };
+
+#if defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
+    // The state of the strand, which is one of:
+    //
+    // - null, when no handler holds the strand's lock;
+    // - locked_state(), when the lock is held and no handlers are waiting;
+    // - shutdown_state(), when the strand will accept no further handlers; or
+    // - the most recently added of the handlers that are waiting on the
+    //   strand, linked in reverse order to locked_state().
+    //
+    // The waiting handlers should not be run until after the next time the
+    // strand is scheduled. Each handler is added with a compare-and-swap, so
+    // that no mutex is needed.
+    std::atomic<scheduler_operation*> state_;
+
+    // Keeps the fields used only from within the strand off the state's cache
+    // line.
+    char state_padding_[cache_line_size
+      - sizeof(std::atomic<scheduler_operation*>)];
+#else // defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
     // Mutex to protect access to internal data.
     mutex* mutex_;
 
@@ -61,11 +95,31 @@ public:
     // modified while the mutex is locked.
     op_queue<scheduler_operation> waiting_queue_;
 
+    // The number of handlers in the waiting queue.
+    std::size_t waiting_count_;
+#endif // defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
+
     // The handlers that are ready to be run. Logically speaking, these are the
     // handlers that hold the strand's lock. The ready queue is only modified
-    // from within the strand and so may be accessed without locking the mutex.
+    // from within the strand and so may be accessed without locking.
     op_queue<scheduler_operation> ready_queue_;
 
+    // The number of handlers in the ready queue.
+    std::size_t ready_count_;
+
+    // The maximum number of handlers to run, and the maximum time to spend
+    // running them, each time the strand is scheduled. Zero means no limit.
+    // They may be set from any thread, and are read at the start of a turn.
+    relaxed_atomic<std::size_t> max_handlers_per_turn_;
+    relaxed_atomic<long> max_usec_per_turn_;
+
+    // Statistics, which are only modified from within the strand but may be
+    // read from any thread.
+    relaxed_atomic<std::size_t> turns_;
+    relaxed_atomic<std::size_t> preemptions_;
+    relaxed_atomic<std::size_t> max_queue_depth_;
+    relaxed_atomic<uint64_t> run_time_usec_;
+
     // Pointers to adjacent handle implementations in linked list.
     strand_impl* next_;
     strand_impl* prev_;
@@ -104,6 +158,60 @@ public:
   ASIO_DECL static bool running_in_this_thread(
       const implementation_type& impl);
 
+  // Get the maximum number of handlers to run each time the strand is
+  // scheduled.
+  static std::size_t max_handlers_per_turn(const implementation_type& impl)
+  {
+    return impl->max_handlers_per_turn_.load();
+  }
+
+  // Set the maximum number of handlers to run each time the strand is
+  // scheduled.
+  static void max_handlers_per_turn(
+      const implementation_type& impl, std::size_t n)
+  {
+    impl->max_handlers_per_turn_.store(n);
+  }
+
+  // Get the maximum time to spend running handlers each time the strand is
+  // scheduled.
+  static long max_usec_per_turn(const implementation_type& impl)
+  {
+    return impl->max_usec_per_turn_.load();
+  }
+
+  // Set the maximum time to spend running handlers each time the strand is
+  // scheduled.
+  static void max_usec_per_turn(const implementation_type& impl, long usec)
+  {
+    impl->max_usec_per_turn_.store(usec);
+  }
+
+  // Get the number of times the strand has been scheduled.
+  static std::size_t turns(const implementation_type& impl)
+  {
+    return impl->turns_.load();
+  }
+
+  // Get the number of times the strand has been rescheduled because it ran
+  // out of budget.
+  static std::size_t preemptions(const implementation_type& impl)
+  {
+    return impl->preemptions_.load();
+  }
+
+  // Get the largest number of handlers ready at the start of a turn.
+  static std::size_t max_queue_depth(const implementation_type& impl)
+  {
+    return impl->max_queue_depth_.load();
+  }
+
+  // Get the total time spent running handlers during timed turns.
+  static uint64_t run_time_usec(const implementation_type& impl)
+  {
+    return impl->run_time_usec_.load();
+  }
+
 private:
   friend class strand_impl;
   template <typename Executor> class invoker;
@@ -112,9 +220,30 @@ private:
   ASIO_DECL static bool enqueue(const implementation_type& impl,
       scheduler_operation* op);
 
+  // Moves the waiting handlers to the ready queue. Releases the lock if no
+  // handlers are ready, otherwise returns true to indicate that the strand
+  // must be scheduled again.
+  ASIO_DECL static bool push_waiting_to_ready_queue(
+      const implementation_type& impl);
+
+#if defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
+  // Special values of a strand's state. Operations are suitably aligned, so
+  // these are never the addresses of real handlers.
+  static scheduler_operation* locked_state()
+  {
+    return reinterpret_cast<scheduler_operation*>(static_cast<std::size_t>(1));
+  }
+
+  static scheduler_operation* shutdown_state()
+  {
+    return reinterpret_cast<scheduler_operation*>(static_cast<std::size_t>(2));
+  }
+#endif // defined(ASIO_HAS_THREADS) && defined(ASIO_HAS_STD_ATOMIC)
+
   // Mutex to protect access to the service-wide state.
   mutex mutex_;
 
+#if !defined(ASIO_HAS_THREADS) || !defined(ASIO_HAS_STD_ATOMIC)
   // Number of mutexes shared between all strand objects.
   enum { num_mutexes = 193 };
 
@@ -124,6 +253,7 @@ private:
   // Extra value used when hashing to prevent recycled memory locations from
   // getting the same mutex.
   std::size_t salt_;
+#endif // !defined(ASIO_HAS_THREADS) || !defined(ASIO_HAS_STD_ATOMIC)
 
   // The head of a linked list of all implementations.
   strand_impl* impl_list_;
@@ -15,8 +15,8 @@
 # pragma once
 #endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
 
-#include <climits>
 #include <cstddef>
+#include "../detail/handler_arena.hpp"
 #include "../detail/noncopyable.hpp"
 
 #include "../detail/push_options.hpp"
@@ -30,29 +30,32 @@ class thread_info_base
 public:
   struct default_tag
   {
-    enum { mem_index = 0 };
   };
 
   struct awaitable_frame_tag
   {
-    enum { mem_index = 1 };
   };
 
   struct executor_function_tag
   {
-    enum { mem_index = 2 };
   };
 
   thread_info_base()
+    : arena_(0),
+      max_cached_blocks_(default_max_cached_blocks),
+      cache_hits_(0),
+      cache_misses_(0)
   {
-    for (int i = 0; i < max_mem_index; ++i)
+    for (int i = 0; i < num_size_classes; ++i)
+    {
       reusable_memory_[i] = 0;
+      reusable_count_[i] = 0;
+    }
   }
 
   ~thread_info_base()
   {
-    for (int i = 0; i < max_mem_index; ++i)
-      ::operator delete(reusable_memory_[i]);
+    trim(0);
   }
 
   static void* allocate(thread_info_base* this_thread, std::size_t size)
@@ -66,55 +69,162 @@ public:
     deallocate(default_tag(), this_thread, pointer, size);
   }
 
+  // Memory is cached by size rather than by purpose, so that blocks freed by
+  // one kind of operation can be reused by another of a similar size. Each
+  // block is followed by a tag that identifies blocks from an arena.
   template <typename Purpose>
   static void* allocate(Purpose, thread_info_base* this_thread,
       std::size_t size)
   {
-    std::size_t chunks = (size + chunk_size - 1) / chunk_size;
+    int size_class = get_size_class(size + handler_arena::tag_size);
 
-    if (this_thread && this_thread->reusable_memory_[Purpose::mem_index])
+    if (this_thread)
     {
-      void* const pointer = this_thread->reusable_memory_[Purpose::mem_index];
-      this_thread->reusable_memory_[Purpose::mem_index] = 0;
+      if (this_thread->arena_)
+        if (void* pointer = this_thread->arena_->allocate(size))
+          return pointer;
 
-      unsigned char* const mem = static_cast<unsigned char*>(pointer);
-      if (static_cast<std::size_t>(mem[0]) >= chunks)
+      if (size_class < num_size_classes
+          && this_thread->reusable_memory_[size_class])
       {
-        mem[size] = mem[0];
-        return pointer;
+        ++this_thread->cache_hits_;
+        --this_thread->reusable_count_[size_class];
+        return handler_arena::tag_unowned(
+            this_thread->pop_block(size_class), size);
       }
 
-      ::operator delete(pointer);
+      ++this_thread->cache_misses_;
     }
 
-    void* const pointer = ::operator new(chunks * chunk_size + 1);
-    unsigned char* const mem = static_cast<unsigned char*>(pointer);
-    mem[size] = (chunks <= UCHAR_MAX) ? static_cast<unsigned char>(chunks) : 0;
-    return pointer;
+    if (size_class < num_size_classes)
+      return handler_arena::tag_unowned(
+          ::operator new(get_block_size(size_class)), size);
+    return handler_arena::tag_unowned(
+        ::operator new(size + handler_arena::tag_size), size);
   }
 
   template <typename Purpose>
   static void deallocate(Purpose, thread_info_base* this_thread,
       void* pointer, std::size_t size)
   {
-    if (size <= chunk_size * UCHAR_MAX)
+    // A block from an arena may be deallocated by any thread.
+    if (handler_arena* arena = handler_arena::find(pointer, size))
     {
-      if (this_thread && this_thread->reusable_memory_[Purpose::mem_index] == 0)
-      {
-        unsigned char* const mem = static_cast<unsigned char*>(pointer);
-        mem[0] = mem[size];
-        this_thread->reusable_memory_[Purpose::mem_index] = pointer;
-        return;
-      }
+      arena->deallocate(pointer);
+      return;
+    }
+
+    int size_class = get_size_class(size + handler_arena::tag_size);
+
+    if (this_thread && size_class < num_size_classes
+        && this_thread->reusable_count_[size_class]
+          < this_thread->max_cached_blocks_)
+    {
+      ++this_thread->reusable_count_[size_class];
+      *static_cast<void**>(pointer) = this_thread->reusable_memory_[size_class];
+      this_thread->reusable_memory_[size_class] = pointer;
+      return;
     }
 
     ::operator delete(pointer);
   }
 
+  // Set the arena from which the thread allocates memory, in preference to
+  // its cache.
+  void set_arena(handler_arena* arena)
+  {
+    arena_ = arena;
+  }
+
+  // Get the maximum number of blocks of each size that are cached.
+  std::size_t max_cached_blocks() const
+  {
+    return max_cached_blocks_;
+  }
+
+  // Set the maximum number of blocks of each size that are cached, releasing
+  // any cached blocks in excess of the new limit.
+  void max_cached_blocks(std::size_t n)
+  {
+    max_cached_blocks_ = n;
+    trim(n);
+  }
+
+  // Release cached blocks until no more than the specified number of blocks
+  // of each size remain.
+  void trim(std::size_t n)
+  {
+    for (int i = 0; i < num_size_classes; ++i)
+    {
+      for (; reusable_count_[i] > n; --reusable_count_[i])
+        ::operator delete(pop_block(i));
+    }
+  }
+
+  // Get the number of bytes in cached blocks.
+  std::size_t cached_bytes() const
+  {
+    std::size_t bytes = 0;
+    for (int i = 0; i < num_size_classes; ++i)
+      bytes += reusable_count_[i] * get_block_size(i);
+    return bytes;
+  }
+
+  // Get the number of allocations that reused a cached block.
+  std::size_t cache_hits() const
+  {
+    return cache_hits_;
+  }
+
+  // Get the number of allocations that required new memory.
+  std::size_t cache_misses() const
+  {
+    return cache_misses_;
+  }
+
 private:
-  enum { chunk_size = 4 };
-  enum { max_mem_index = 3 };
-  void* reusable_memory_[max_mem_index];
+  // Blocks are allocated in sizes that are powers of two, from the smallest
+  // block size up to that of the largest size class. Larger allocations are
+  // not cached.
+  enum { smallest_block_size = 64 };
+  enum { num_size_classes = 8 };
+  enum { default_max_cached_blocks = 4 };
+
+  // Get the size class for an allocation, or num_size_classes if it is too
+  // large to be cached.
+  static int get_size_class(std::size_t size)
+  {
+    int size_class = 0;
+    std::size_t block_size = smallest_block_size;
+    while (block_size < size && size_class < num_size_classes)
+    {
+      block_size *= 2;
+      ++size_class;
+    }
+    return size_class;
+  }
+
+  // Get the size of the blocks in a size class.
+  static std::size_t get_block_size(int size_class)
+  {
+    return static_cast<std::size_t>(smallest_block_size) << size_class;
+  }
+
+  // Remove the first block from a size class's list of cached blocks. Each
+  // cached block holds a pointer to the next.
+  void* pop_block(int size_class)
+  {
+    void* pointer = reusable_memory_[size_class];
+    reusable_memory_[size_class] = *static_cast<void**>(pointer);
+    return pointer;
+  }
+
+  handler_arena* arena_;
+  void* reusable_memory_[num_size_classes];
+  std::size_t reusable_count_[num_size_classes];
+  std::size_t max_cached_blocks_;
+  std::size_t cache_hits_;
+  std::size_t cache_misses_;
 };
 
 } // namespace detail
@@ -0,0 +1,55 @@
+//
+// detail/timer_queue_wheel.hpp
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2020 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_DETAIL_TIMER_QUEUE_WHEEL_HPP
+#define ASIO_DETAIL_TIMER_QUEUE_WHEEL_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "../detail/config.hpp"
+#include "../detail/chrono_time_traits.hpp"
+#include "../detail/timer_queue.hpp"
+#include "../detail/timer_wheel.hpp"
+#include "../timer_wheel_traits.hpp"
+
+#include "../detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+// Template specialisation for waitable timers that use a timing wheel.
+template <typename Clock, long Tick_Usec, typename WaitTraits>
+class timer_queue<chrono_time_traits<Clock,
+    timer_wheel_wait_traits<Clock, Tick_Usec, WaitTraits> > >
+  : public timer_wheel<chrono_time_traits<Clock,
+      timer_wheel_wait_traits<Clock, Tick_Usec, WaitTraits> >, Tick_Usec>
+{
+};
+
+#if defined(ASIO_HAS_BOOST_DATE_TIME)
+
+// Template specialisation for deadline timers that use a timing wheel.
+template <typename Time, long Tick_Usec, typename TimeTraits>
+class timer_queue<timer_wheel_time_traits<Time, Tick_Usec, TimeTraits> >
+  : public timer_wheel<
+      timer_wheel_time_traits<Time, Tick_Usec, TimeTraits>, Tick_Usec>
+{
+};
+
+#endif // defined(ASIO_HAS_BOOST_DATE_TIME)
+
+} // namespace detail
+} // namespace asio
+
+#include "../detail/pop_options.hpp"
+
+#endif // ASIO_DETAIL_TIMER_QUEUE_WHEEL_HPP
@@ -0,0 +1,566 @@
+//
+// detail/timer_wheel.hpp
+// ~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2020 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_DETAIL_TIMER_WHEEL_HPP
+#define ASIO_DETAIL_TIMER_WHEEL_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "../detail/config.hpp"
+#include <cstddef>
+#include "../detail/cstdint.hpp"
+#include "../detail/date_time_fwd.hpp"
+#include "../detail/limits.hpp"
+#include "../detail/op_queue.hpp"
+#include "../detail/timer_queue_base.hpp"
+#include "../detail/wait_op.hpp"
+#include "../error.hpp"
+
+#include "../detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+// A hierarchical timing wheel. Expiry times are rounded up to a whole number
+// of ticks, measured from the wheel's construction, so that timers never fire
+// early but may fire up to one tick late. Each level of the wheel has 64
+// slots, and each slot of a level spans all 64 slots of the level below it.
+// Enqueuing and cancelling a timer are constant time operations. A timer is
+// moved down one level at most once per level as its expiry approaches.
+template <typename Time_Traits, long Tick_Usec>
+class timer_wheel
+  : public timer_queue_base
+{
+public:
+  // The time type.
+  typedef typename Time_Traits::time_type time_type;
+
+  // The duration type.
+  typedef typename Time_Traits::duration_type duration_type;
+
+  // Per-timer data.
+  class per_timer_data
+  {
+  public:
+    per_timer_data() :
+      tick_(0), slot_(no_slot),
+      next_(0), prev_(0),
+      slot_next_(0), slot_prev_(0)
+    {
+    }
+
+  private:
+    friend class timer_wheel;
+
+    // The operations waiting on the timer.
+    op_queue<wait_op> op_queue_;
+
+    // The tick at which the timer expires.
+    uint64_t tick_;
+
+    // The index of the list in which the timer is held, or no_slot.
+    std::size_t slot_;
+
+    // Pointers to adjacent timers in the linked list of active timers.
+    per_timer_data* next_;
+    per_timer_data* prev_;
+
+    // Pointers to adjacent timers in the list in which the timer is held.
+    per_timer_data* slot_next_;
+    per_timer_data* slot_prev_;
+  };
+
+  // Constructor.
+  timer_wheel()
+    : origin_(Time_Traits::now()),
+      current_tick_(0),
+      timers_(0)
+  {
+    for (std::size_t i = 0; i < num_levels; ++i)
+      occupied_[i] = 0;
+    for (std::size_t i = 0; i < num_slots; ++i)
+      slots_[i] = 0;
+  }
+
+  // Add a new timer to the queue. Returns true if this is the timer that is
+  // earliest in the queue, in which case the reactor's event demultiplexing
+  // function call may need to be interrupted and restarted.
+  bool enqueue_timer(const time_type& time, per_timer_data& timer, wait_op* op)
+  {
+    bool earliest = false;
+
+    // Enqueue the timer object.
+    if (timer.prev_ == 0 && &timer != timers_)
+    {
+      // No slot is required for timers that never expire.
+      if (!this->is_positive_infinity(time))
+      {
+        // The reactor needs to wake earlier only if the new timer brings
+        // forward the next tick at which the wheel needs attention.
+        uint64_t old_tick = 0, new_tick = 0;
+        bool had_tick = next_event_tick(old_tick);
+        timer.tick_ = to_tick(time);
+        link_slot(timer);
+        next_event_tick(new_tick);
+        earliest = timer.slot_ == ready_slot
+          || !had_tick || new_tick < old_tick;
+      }
+
+      // Insert the new timer into the linked list of active timers.
+      timer.next_ = timers_;
+      timer.prev_ = 0;
+      if (timers_)
+        timers_->prev_ = &timer;
+      timers_ = &timer;
+    }
+
+    // Enqueue the individual timer operation.
+    timer.op_queue_.push(op);
+
+    // Interrupt reactor only if newly added timer is first to expire.
+    return earliest;
+  }
+
+  // Whether there are no timers in the queue.
+  virtual bool empty() const
+  {
+    return timers_ == 0;
+  }
+
+  // Get the time for the timer that is earliest in the queue.
+  virtual long wait_duration_msec(long max_duration) const
+  {
+    int64_t usec = 0;
+    if (!wait_duration(usec))
+      return max_duration;
+    if (usec <= 0)
+      return 0;
+    int64_t msec = usec / 1000;
+    if (msec == 0)
+      return 1;
+    if (msec > max_duration)
+      return max_duration;
+    return static_cast<long>(msec);
+  }
+
+  // Get the time for the timer that is earliest in the queue.
+  virtual long wait_duration_usec(long max_duration) const
+  {
+    int64_t usec = 0;
+    if (!wait_duration(usec))
+      return max_duration;
+    if (usec <= 0)
+      return 0;
+    if (usec > max_duration)
+      return max_duration;
+    return static_cast<long>(usec);
+  }
+
+  // Dequeue all timers not later than the current time.
+  virtual void get_ready_timers(op_queue<operation>& ops)
+  {
+    if (slots_[ready_slot])
+      expire_slot(ready_slot, ops);
+
+    int64_t elapsed = elapsed_usec();
+    if (elapsed < 0)
+      return;
+    uint64_t now_tick = static_cast<uint64_t>(elapsed) / Tick_Usec;
+
+    // Step from one occupied slot to the next, expiring the timers in each
+    // slot of the first level, until reaching the current tick.
+    uint64_t tick = 0;
+    while (next_event_tick(tick) && tick <= now_tick)
+    {
+      advance(tick);
+      std::size_t slot = static_cast<std::size_t>(tick & slot_mask);
+      if (slots_[slot])
+        expire_slot(slot, ops);
+    }
+
+    if (now_tick >= current_tick_)
+      advance(now_tick + 1);
+  }
+
+  // Dequeue all timers.
+  virtual void get_all_timers(op_queue<operation>& ops)
+  {
+    while (timers_)
+    {
+      per_timer_data* timer = timers_;
+      timers_ = timers_->next_;
+      ops.push(timer->op_queue_);
+      timer->next_ = 0;
+      timer->prev_ = 0;
+      timer->slot_ = no_slot;
+      timer->slot_next_ = 0;
+      timer->slot_prev_ = 0;
+    }
+
+    for (std::size_t i = 0; i < num_levels; ++i)
+      occupied_[i] = 0;
+    for (std::size_t i = 0; i < num_slots; ++i)
+      slots_[i] = 0;
+  }
+
+  // Cancel and dequeue operations for the given timer.
+  std::size_t cancel_timer(per_timer_data& timer, op_queue<operation>& ops,
+      std::size_t max_cancelled = (std::numeric_limits<std::size_t>::max)())
+  {
+    std::size_t num_cancelled = 0;
+    if (timer.prev_ != 0 || &timer == timers_)
+    {
+      while (wait_op* op = (num_cancelled != max_cancelled)
+          ? timer.op_queue_.front() : 0)
+      {
+        op->ec_ = asio::error::operation_aborted;
+        timer.op_queue_.pop();
+        ops.push(op);
+        ++num_cancelled;
+      }
+      if (timer.op_queue_.empty())
+        remove_timer(timer);
+    }
+    return num_cancelled;
+  }
+
+  // Move operations from one timer to another, empty timer.
+  void move_timer(per_timer_data& target, per_timer_data& source)
+  {
+    target.op_queue_.push(source.op_queue_);
+
+    target.tick_ = source.tick_;
+    target.slot_ = source.slot_;
+    source.slot_ = no_slot;
+
+    if (target.slot_ != no_slot)
+    {
+      if (slots_[target.slot_] == &source)
+        slots_[target.slot_] = &target;
+      if (source.slot_prev_)
+        source.slot_prev_->slot_next_ = &target;
+      if (source.slot_next_)
+        source.slot_next_->slot_prev_ = &target;
+    }
+    target.slot_next_ = source.slot_next_;
+    target.slot_prev_ = source.slot_prev_;
+    source.slot_next_ = 0;
+    source.slot_prev_ = 0;
+
+    if (timers_ == &source)
+      timers_ = &target;
+    if (source.prev_)
+      source.prev_->next_ = &target;
+    if (source.next_)
+      source.next_->prev_= &target;
+    target.next_ = source.next_;
+    target.prev_ = source.prev_;
+    source.next_ = 0;
+    source.prev_ = 0;
+  }
+
+private:
+  // The number of bits used to select a slot within a level.
+  static const std::size_t slot_bits = 6;
+
+  // The number of slots in a level.
+  static const std::size_t slots_per_level = 64;
+
+  // Mask to select a slot within a level.
+  static const uint64_t slot_mask = 63;
+
+  // The number of levels. With a tick of one millisecond the wheel spans more
+  // than two years, and later timers are held in the overflow list.
+  static const std::size_t num_levels = 6;
+
+  // The list of timers that had already expired when they were enqueued.
+  static const std::size_t ready_slot = num_levels * slots_per_level;
+
+  // The list of timers that are beyond the range of the wheel.
+  static const std::size_t overflow_slot = ready_slot + 1;
+
+  // The total number of lists.
+  static const std::size_t num_slots = overflow_slot + 1;
+
+  // Indicates that a timer is not held in any list.
+  static const std::size_t no_slot = num_slots;
+
+  // Get the number of microseconds since the wheel was constructed.
+  int64_t elapsed_usec() const
+  {
+    return Time_Traits::to_posix_duration(
+        Time_Traits::subtract(Time_Traits::now(), origin_)).total_microseconds();
+  }
+
+  // Convert an expiry time to a tick, rounding up.
+  uint64_t to_tick(const time_type& time) const
+  {
+    int64_t usec = Time_Traits::to_posix_duration(
+        Time_Traits::subtract(time, origin_)).total_microseconds();
+    if (usec <= 0)
+      return 0;
+    return (static_cast<uint64_t>(usec) + (Tick_Usec - 1)) / Tick_Usec;
+  }
+
+  // Get the number of microseconds until the next tick at which the wheel
+  // needs attention. Returns false if there is no such tick.
+  bool wait_duration(int64_t& usec) const
+  {
+    if (slots_[ready_slot])
+    {
+      usec = 0;
+      return true;
+    }
+
+    uint64_t tick = 0;
+    if (!next_event_tick(tick))
+      return false;
+
+    // The tick may be far beyond the current time if it marks the end of the
+    // wheel's range.
+    const uint64_t max_tick =
+      static_cast<uint64_t>((std::numeric_limits<int64_t>::max)()) / Tick_Usec;
+    if (tick > max_tick)
+      tick = max_tick;
+
+    usec = static_cast<int64_t>(tick * Tick_Usec) - elapsed_usec();
+    return true;
+  }
+
+  // Find the first occupied slot of a level at or after the given slot.
+  // Returns slots_per_level if there is none.
+  static std::size_t find_slot(uint64_t occupied, std::size_t slot)
+  {
+    if (slot >= slots_per_level)
+      return slots_per_level;
+    uint64_t bits = occupied & (~static_cast<uint64_t>(0) << slot);
+    if (bits == 0)
+      return slots_per_level;
+#if defined(__GNUC__)
+    return static_cast<std::size_t>(__builtin_ctzll(bits));
+#else // defined(__GNUC__)
+    std::size_t n = 0;
+    for (std::size_t shift = 32; shift > 0; shift /= 2)
+    {
+      if ((bits & ((static_cast<uint64_t>(1) << shift) - 1)) == 0)
+      {
+        bits >>= shift;
+        n += shift;
+      }
+    }
+    return n;
+#endif // defined(__GNUC__)
+  }
+
+  // Find the next tick at which the wheel needs attention, either because
+  // timers expire or because a slot's timers must be moved to a lower level.
+  // Returns false if the wheel holds no timers.
+  bool next_event_tick(uint64_t& tick) const
+  {
+    // The slots of the first level hold timers for exactly one tick.
+    std::size_t slot = find_slot(occupied_[0],
+        static_cast<std::size_t>(current_tick_ & slot_mask));
+    if (slot < slots_per_level)
+    {
+      tick = (current_tick_ & ~slot_mask) | slot;
+      return true;
+    }
+
+    // The slots of higher levels are visited at the tick where they begin.
+    // Slots at or before the current position of a level are always empty.
+    for (std::size_t level = 1; level < num_levels; ++level)
+    {
+      std::size_t shift = level * slot_bits;
+      slot = find_slot(occupied_[level],
+          static_cast<std::size_t>((current_tick_ >> shift) & slot_mask) + 1);
+      if (slot < slots_per_level)
+      {
+        tick = ((current_tick_ >> (shift + slot_bits)) << (shift + slot_bits))
+          | (static_cast<uint64_t>(slot) << shift);
+        return true;
+      }
+    }
+
+    // Overflowed timers are reconsidered when the wheel wraps around.
+    if (slots_[overflow_slot])
+    {
+      std::size_t shift = num_levels * slot_bits;
+      tick = ((current_tick_ >> shift) + 1) << shift;
+      return true;
+    }
+
+    return false;
+  }
+
+  // Move the wheel forward to the given tick. There must be no occupied slots
+  // before the tick.
+  void advance(uint64_t tick)
+  {
+    if (tick == current_tick_)
+      return;
+    current_tick_ = tick;
+
+    if ((tick & slot_mask) != 0)
+      return;
+
+    // At the start of a slot on a higher level, move the slot's timers down to
+    // the lower levels, starting with the highest level so that timers can
+    // cascade through several levels.
+    if ((tick & ((static_cast<uint64_t>(1) << (num_levels * slot_bits)) - 1))
+        == 0)
+      relink_slot(overflow_slot);
+    for (std::size_t level = num_levels - 1; level > 0; --level)
+    {
+      std::size_t shift = level * slot_bits;
+      if ((tick & ((static_cast<uint64_t>(1) << shift) - 1)) == 0)
+        relink_slot(level * slots_per_level
+            + static_cast<std::size_t>((tick >> shift) & slot_mask));
+    }
+  }
+
+  // Add a timer to the list for its tick, relative to the current tick.
+  void link_slot(per_timer_data& timer)
+  {
+    std::size_t slot = ready_slot;
+    if (timer.tick_ >= current_tick_)
+    {
+      // Use the lowest level at which the timer's tick and the current tick
+      // share a slot on the level above.
+      std::size_t level = 0;
+      while (level < num_levels
+          && (timer.tick_ >> ((level + 1) * slot_bits))
+            != (current_tick_ >> ((level + 1) * slot_bits)))
+        ++level;
+
+      if (level == num_levels)
+        slot = overflow_slot;
+      else
+      {
+        std::size_t index = static_cast<std::size_t>(
+            (timer.tick_ >> (level * slot_bits)) & slot_mask);
+        occupied_[level] |= static_cast<uint64_t>(1) << index;
+        slot = level * slots_per_level + index;
+      }
+    }
+
+    timer.slot_ = slot;
+    timer.slot_prev_ = 0;
+    timer.slot_next_ = slots_[slot];
+    if (slots_[slot])
+      slots_[slot]->slot_prev_ = &timer;
+    slots_[slot] = &timer;
+  }
+
+  // Remove a timer from the list in which it is held.
+  void unlink_slot(per_timer_data& timer)
+  {
+    std::size_t slot = timer.slot_;
+    if (slot == no_slot)
+      return;
+
+    if (slots_[slot] == &timer)
+    {
+      slots_[slot] = timer.slot_next_;
+      if (slots_[slot] == 0 && slot < ready_slot)
+        occupied_[slot / slots_per_level] &=
+          ~(static_cast<uint64_t>(1) << (slot % slots_per_level));
+    }
+    if (timer.slot_prev_)
+      timer.slot_prev_->slot_next_ = timer.slot_next_;
+    if (timer.slot_next_)
+      timer.slot_next_->slot_prev_ = timer.slot_prev_;
+    timer.slot_ = no_slot;
+    timer.slot_next_ = 0;
+    timer.slot_prev_ = 0;
+  }
+
+  // Empty a list, adding each of its timers to the list for its tick.
+  void relink_slot(std::size_t slot)
+  {
+    per_timer_data* timer = slots_[slot];
+    slots_[slot] = 0;
+    if (slot < ready_slot)
+      occupied_[slot / slots_per_level] &=
+        ~(static_cast<uint64_t>(1) << (slot % slots_per_level));
+
+    while (timer)
+    {
+      per_timer_data* next = timer->slot_next_;
+      link_slot(*timer);
+      timer = next;
+    }
+  }
+
+  // Empty a list, dequeuing all of its timers.
+  void expire_slot(std::size_t slot, op_queue<operation>& ops)
+  {
+    while (per_timer_data* timer = slots_[slot])
+    {
+      ops.push(timer->op_queue_);
+      remove_timer(*timer);
+    }
+  }
+
+  // Remove a timer from the wheel and list of timers.
+  void remove_timer(per_timer_data& timer)
+  {
+    unlink_slot(timer);
+
+    // Remove the timer from the linked list of active timers.
+    if (timers_ == &timer)
+      timers_ = timer.next_;
+    if (timer.prev_)
+      timer.prev_->next_ = timer.next_;
+    if (timer.next_)
+      timer.next_->prev_= timer.prev_;
+    timer.next_ = 0;
+    timer.prev_ = 0;
+  }
+
+  // Determine if the specified absolute time is positive infinity.
+  template <typename Time_Type>
+  static bool is_positive_infinity(const Time_Type&)
+  {
+    return false;
+  }
+
+  // Determine if the specified absolute time is positive infinity.
+  template <typename T, typename TimeSystem>
+  static bool is_positive_infinity(
+      const boost::date_time::base_time<T, TimeSystem>& time)
+  {
+    return time.is_pos_infinity();
+  }
+
+  // The time from which ticks are counted.
+  time_type origin_;
+
+  // The first tick that has not yet been processed.
+  uint64_t current_tick_;
+
+  // The head of a linked list of all active timers.
+  per_timer_data* timers_;
+
+  // A bit for each slot of each level, set if the slot holds any timers.
+  uint64_t occupied_[num_levels];
+
+  // The heads of the lists of timers held in each slot of each level,
+  // followed by the ready and overflow lists.
+  per_timer_data* slots_[num_slots];
+};
+
+} // namespace detail
+} // namespace asio
+
+#include "../detail/pop_options.hpp"
+
+#endif // ASIO_DETAIL_TIMER_WHEEL_HPP
@@ -108,6 +108,13 @@ public:
       stop();
   }
 
+  // Get the number of units of outstanding work.
+  std::size_t outstanding_work() const
+  {
+    return static_cast<std::size_t>(
+        ::InterlockedExchangeAdd(&outstanding_work_, 0));
+  }
+
   // Return whether a handler can be dispatched immediately.
   bool can_dispatch()
   {
@@ -250,7 +257,7 @@ private:
   auto_handle iocp_;
 
   // The count of unfinished work.
-  long outstanding_work_;
+  mutable long outstanding_work_;
 
   // Flag to indicate whether the event loop has been stopped.
   mutable long stopped_;
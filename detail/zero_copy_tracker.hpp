@@ -0,0 +1,98 @@
+//
+// detail/zero_copy_tracker.hpp
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2020 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_DETAIL_ZERO_COPY_TRACKER_HPP
+#define ASIO_DETAIL_ZERO_COPY_TRACKER_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "../detail/config.hpp"
+
+#if defined(ASIO_HAS_MSG_ZEROCOPY)
+
+#include <cstddef>
+#include "../detail/cstdint.hpp"
+#include "../detail/socket_types.hpp"
+#include "../error_code.hpp"
+
+#if !defined(SO_ZEROCOPY)
+# define SO_ZEROCOPY 60
+#endif // !defined(SO_ZEROCOPY)
+
+#if !defined(MSG_ZEROCOPY)
+# define MSG_ZEROCOPY 0x4000000
+#endif // !defined(MSG_ZEROCOPY)
+
+#include "../detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+// Tracks the zero-copy sends made on a descriptor. The kernel numbers each
+// send made with MSG_ZEROCOPY and, once it has finished with the user's
+// buffer, reports a range of these numbers on the socket's error queue. All
+// functions must be called with the descriptor's lock held.
+class zero_copy_tracker
+{
+public:
+  // Sends smaller than this are copied, as pinning the pages costs more than
+  // copying them.
+  enum { min_send_size = 10240 };
+
+  // Reset the tracker for a newly registered descriptor.
+  void reset()
+  {
+    sent_ = 0;
+    confirmed_ = 0;
+    copied_ = false;
+  }
+
+  // Whether sends should still be made with MSG_ZEROCOPY. The kernel may
+  // report that it copied the data anyway, e.g. because the destination is a
+  // loopback address, after which zero-copy is only a cost.
+  bool enabled() const
+  {
+    return !copied_;
+  }
+
+  // Record that a send made with MSG_ZEROCOPY was accepted by the kernel.
+  void record_send()
+  {
+    ++sent_;
+  }
+
+  // Read the notifications from the socket's error queue, and determine
+  // whether the kernel has released the buffers of all recorded sends.
+  ASIO_DECL bool all_released(socket_type s, asio::error_code& ec);
+
+private:
+  // The number of zero-copy sends made, and the number the kernel has
+  // reported as complete. Both wrap around together.
+  uint32_t sent_;
+  uint32_t confirmed_;
+
+  // Whether the kernel has reported that it copied a send's data.
+  bool copied_;
+};
+
+} // namespace detail
+} // namespace asio
+
+#include "../detail/pop_options.hpp"
+
+#if defined(ASIO_HEADER_ONLY)
+#include "../detail/impl/zero_copy_tracker.ipp"
+#endif // defined(ASIO_HEADER_ONLY)
+
+#endif // defined(ASIO_HAS_MSG_ZEROCOPY)
+
+#endif // ASIO_DETAIL_ZERO_COPY_TRACKER_HPP
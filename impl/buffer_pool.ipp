@@ -0,0 +1,120 @@
+//
+// impl/buffer_pool.ipp
+// ~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2020 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_IMPL_BUFFER_POOL_IPP
+#define ASIO_IMPL_BUFFER_POOL_IPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "../detail/config.hpp"
+#include <limits>
+#include <new>
+#include "../buffer_pool.hpp"
+#include "../io_context.hpp"
+#include "../detail/reactor.hpp"
+#include "../detail/throw_error.hpp"
+#include "../error.hpp"
+
+#include "../detail/push_options.hpp"
+
+namespace asio {
+
+buffer_pool::buffer_pool(io_context& ctx,
+    std::size_t buffer_size, std::size_t buffer_count)
+  : data_(0),
+    buffer_size_(buffer_size),
+    buffer_count_(buffer_count)
+#if defined(ASIO_HAS_IO_URING)
+    , reactor_(&use_service<detail::reactor>(ctx)),
+    group_(-1)
+#endif // defined(ASIO_HAS_IO_URING)
+{
+  (void)ctx;
+
+  if (buffer_size == 0 || buffer_count == 0 || buffer_count
+      > (std::numeric_limits<std::size_t>::max)() / buffer_size)
+  {
+    asio::error_code ec(asio::error::invalid_argument);
+    asio::detail::throw_error(ec, "buffer_pool");
+  }
+
+  data_ = static_cast<unsigned char*>(
+      ::operator new(buffer_size * buffer_count));
+
+#if defined(ASIO_HAS_IO_URING)
+  // Give the buffers to the kernel, which then selects one as each receive
+  // completes. If it cannot take them, a buffer is instead taken from the
+  // pool when a socket is ready to read.
+  asio::error_code ec;
+  group_ = reactor_->register_buffers(data_, buffer_size, buffer_count, ec);
+  if (group_ >= 0)
+    return;
+#endif // defined(ASIO_HAS_IO_URING)
+
+  free_buffers_.reserve(buffer_count);
+  for (std::size_t i = buffer_count; i > 0; --i)
+    free_buffers_.push_back(get_buffer(i - 1));
+}
+
+buffer_pool::~buffer_pool()
+{
+#if defined(ASIO_HAS_IO_URING)
+  if (group_ >= 0)
+    reactor_->unregister_buffers(group_, buffer_count_);
+#endif // defined(ASIO_HAS_IO_URING)
+
+  ::operator delete(data_);
+}
+
+void buffer_pool::release(const mutable_buffer& buffer)
+{
+  unsigned char* p = static_cast<unsigned char*>(buffer.data());
+  if (p < data_ || p >= data_ + buffer_size_ * buffer_count_)
+    return;
+
+  std::size_t index = (p - data_) / buffer_size_;
+
+#if defined(ASIO_HAS_IO_URING)
+  if (group_ >= 0)
+    if (reactor_->provide_buffer(group_,
+          get_buffer(index), buffer_size_, index))
+      return;
+#endif // defined(ASIO_HAS_IO_URING)
+
+  detail::mutex::scoped_lock lock(mutex_);
+  free_buffers_.push_back(get_buffer(index));
+}
+
+asio::error_code buffer_pool::group_error() const
+{
+#if defined(ASIO_HAS_IO_URING)
+  if (group_ >= 0)
+    return reactor_->buffer_group_error(group_);
+#endif // defined(ASIO_HAS_IO_URING)
+  return asio::error_code();
+}
+
+void* buffer_pool::acquire()
+{
+  detail::mutex::scoped_lock lock(mutex_);
+  if (free_buffers_.empty())
+    return 0;
+  void* p = free_buffers_.back();
+  free_buffers_.pop_back();
+  return p;
+}
+
+} // namespace asio
+
+#include "../detail/pop_options.hpp"
+
+#endif // ASIO_IMPL_BUFFER_POOL_IPP
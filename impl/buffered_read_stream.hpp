@@ -31,30 +31,21 @@ namespace asio {
 template <typename Stream>
 std::size_t buffered_read_stream<Stream>::fill()
 {
-  detail::buffer_resize_guard<detail::buffered_stream_storage>
-    resize_guard(storage_);
-  std::size_t previous_size = storage_.size();
-  storage_.resize(storage_.capacity());
-  storage_.resize(previous_size + next_layer_.read_some(buffer(
-          storage_.data() + previous_size,
-          storage_.size() - previous_size)));
-  resize_guard.commit();
-  return storage_.size() - previous_size;
+  std::size_t space = storage_.capacity() - storage_.size();
+  std::size_t bytes_read = next_layer_.read_some(storage_.prepare());
+  storage_.commit(bytes_read);
+  storage_.record_fill(space, bytes_read);
+  return bytes_read;
 }
 
 template <typename Stream>
 std::size_t buffered_read_stream<Stream>::fill(asio::error_code& ec)
 {
-  detail::buffer_resize_guard<detail::buffered_stream_storage>
-    resize_guard(storage_);
-  std::size_t previous_size = storage_.size();
-  storage_.resize(storage_.capacity());
-  storage_.resize(previous_size + next_layer_.read_some(buffer(
-          storage_.data() + previous_size,
-          storage_.size() - previous_size),
-        ec));
-  resize_guard.commit();
-  return storage_.size() - previous_size;
+  std::size_t space = storage_.capacity() - storage_.size();
+  std::size_t bytes_read = next_layer_.read_some(storage_.prepare(), ec);
+  storage_.commit(bytes_read);
+  storage_.record_fill(space, bytes_read);
+  return bytes_read;
 }
 
 namespace detail
@@ -64,9 +55,9 @@ namespace detail
   {
   public:
     buffered_fill_handler(detail::buffered_stream_storage& storage,
-        std::size_t previous_size, ReadHandler& handler)
+        std::size_t space, ReadHandler& handler)
       : storage_(storage),
-        previous_size_(previous_size),
+        space_(space),
         handler_(ASIO_MOVE_CAST(ReadHandler)(handler))
     {
     }
@@ -74,14 +65,14 @@ namespace detail
 #if defined(ASIO_HAS_MOVE)
     buffered_fill_handler(const buffered_fill_handler& other)
       : storage_(other.storage_),
-        previous_size_(other.previous_size_),
+        space_(other.space_),
         handler_(other.handler_)
     {
     }
 
     buffered_fill_handler(buffered_fill_handler&& other)
       : storage_(other.storage_),
-        previous_size_(other.previous_size_),
+        space_(other.space_),
         handler_(ASIO_MOVE_CAST(ReadHandler)(other.handler_))
     {
     }
@@ -90,13 +81,14 @@ namespace detail
     void operator()(const asio::error_code& ec,
         const std::size_t bytes_transferred)
     {
-      storage_.resize(previous_size_ + bytes_transferred);
+      storage_.commit(bytes_transferred);
+      storage_.record_fill(space_, bytes_transferred);
       handler_(ec, bytes_transferred);
     }
 
   //private:
     detail::buffered_stream_storage& storage_;
-    std::size_t previous_size_;
+    std::size_t space_;
     ReadHandler handler_;
   };
 
@@ -185,14 +177,10 @@ namespace detail
       ASIO_READ_HANDLER_CHECK(ReadHandler, handler) type_check;
 
       non_const_lvalue<ReadHandler> handler2(handler);
-      std::size_t previous_size = storage->size();
-      storage->resize(storage->capacity());
-      next_layer_.async_read_some(
-          buffer(
-            storage->data() + previous_size,
-            storage->size() - previous_size),
+      std::size_t space = storage->capacity() - storage->size();
+      next_layer_.async_read_some(storage->prepare(),
           buffered_fill_handler<typename decay<ReadHandler>::type>(
-            *storage, previous_size, handler2.value));
+            *storage, space, handler2.value));
     }
 
   private:
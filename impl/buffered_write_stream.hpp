@@ -30,8 +30,7 @@ namespace asio {
 template <typename Stream>
 std::size_t buffered_write_stream<Stream>::flush()
 {
-  std::size_t bytes_written = write(next_layer_,
-      buffer(storage_.data(), storage_.size()));
+  std::size_t bytes_written = write(next_layer_, storage_.data());
   storage_.consume(bytes_written);
   return bytes_written;
 }
@@ -40,8 +39,7 @@ template <typename Stream>
 std::size_t buffered_write_stream<Stream>::flush(asio::error_code& ec)
 {
   std::size_t bytes_written = write(next_layer_,
-      buffer(storage_.data(), storage_.size()),
-      transfer_all(), ec);
+      storage_.data(), transfer_all(), ec);
   storage_.consume(bytes_written);
   return bytes_written;
 }
@@ -170,7 +168,7 @@ namespace detail
       ASIO_WRITE_HANDLER_CHECK(WriteHandler, handler) type_check;
 
       non_const_lvalue<WriteHandler> handler2(handler);
-      async_write(next_layer_, buffer(storage->data(), storage->size()),
+      async_write(next_layer_, storage->data(),
           buffered_flush_handler<typename decay<WriteHandler>::type>(
             *storage, handler2.value));
     }
@@ -296,15 +294,9 @@ namespace detail
       }
       else
       {
-        using asio::buffer_size;
-        std::size_t orig_size = storage_.size();
-        std::size_t space_avail = storage_.capacity() - orig_size;
-        std::size_t bytes_avail = buffer_size(buffers_);
-        std::size_t length = bytes_avail < space_avail
-          ? bytes_avail : space_avail;
-        storage_.resize(orig_size + length);
         const std::size_t bytes_copied = asio::buffer_copy(
-            storage_.data() + orig_size, buffers_, length);
+            storage_.prepare(), buffers_);
+        storage_.commit(bytes_copied);
         handler_(ec, bytes_copied);
       }
     }
@@ -490,14 +482,9 @@ template <typename ConstBufferSequence>
 std::size_t buffered_write_stream<Stream>::copy(
     const ConstBufferSequence& buffers)
 {
-  using asio::buffer_size;
-  std::size_t orig_size = storage_.size();
-  std::size_t space_avail = storage_.capacity() - orig_size;
-  std::size_t bytes_avail = buffer_size(buffers);
-  std::size_t length = bytes_avail < space_avail ? bytes_avail : space_avail;
-  storage_.resize(orig_size + length);
-  return asio::buffer_copy(
-      storage_.data() + orig_size, buffers, length);
+  std::size_t bytes_copied = asio::buffer_copy(storage_.prepare(), buffers);
+  storage_.commit(bytes_copied);
+  return bytes_copied;
 }
 
 } // namespace asio
@@ -0,0 +1,106 @@
+//
+// impl/delimiter_set.ipp
+// ~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2020 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_IMPL_DELIMITER_SET_IPP
+#define ASIO_IMPL_DELIMITER_SET_IPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "../detail/config.hpp"
+#include "../delimiter_set.hpp"
+
+#include "../detail/push_options.hpp"
+
+namespace asio {
+
+void delimiter_set::compile(const std::vector<std::string>& delimiters)
+{
+  typedef detail::delimiter_automaton automaton;
+  const std::size_t n = automaton::alphabet_size;
+  const uint32_t absent = ~uint32_t(0);
+
+  detail::shared_ptr<automaton> a(new automaton);
+  a->next.assign(n, absent);
+  a->depth.assign(1, 0);
+  a->accept.assign(1, 0);
+  a->first_byte = -1;
+
+  // Build a trie of the delimiters, and determine whether they all start
+  // with the same byte.
+  bool shared_first_byte = true;
+  for (std::size_t i = 0; i < delimiters.size(); ++i)
+  {
+    const std::string& delimiter = delimiters[i];
+    std::size_t state = 0;
+    for (std::size_t j = 0; j < delimiter.size(); ++j)
+    {
+      std::size_t c = static_cast<unsigned char>(delimiter[j]);
+      if (a->next[state * n + c] == absent)
+      {
+        a->next[state * n + c] = static_cast<uint32_t>(a->depth.size());
+        a->next.resize(a->next.size() + n, absent);
+        a->depth.push_back(j + 1);
+        a->accept.push_back(0);
+      }
+      state = a->next[state * n + c];
+    }
+    a->accept[state] = 1;
+
+    if (delimiter.empty())
+      shared_first_byte = false;
+    else if (a->first_byte < 0)
+      a->first_byte = static_cast<unsigned char>(delimiter[0]);
+    else if (a->first_byte != static_cast<unsigned char>(delimiter[0]))
+      shared_first_byte = false;
+  }
+  if (!shared_first_byte)
+    a->first_byte = -1;
+
+  // Turn the trie into a deterministic automaton. The states are visited in
+  // breadth-first order, so that each state's failure state, which represents
+  // a shorter prefix, is complete before the state itself.
+  std::vector<std::size_t> failure(a->depth.size(), 0);
+  std::vector<std::size_t> queue;
+  for (std::size_t c = 0; c < n; ++c)
+  {
+    if (a->next[c] == absent)
+      a->next[c] = 0;
+    else
+      queue.push_back(a->next[c]);
+  }
+  for (std::size_t head = 0; head < queue.size(); ++head)
+  {
+    std::size_t state = queue[head];
+    a->accept[state] |= a->accept[failure[state]];
+    for (std::size_t c = 0; c < n; ++c)
+    {
+      uint32_t target = a->next[failure[state] * n + c];
+      if (a->next[state * n + c] == absent)
+      {
+        a->next[state * n + c] = target;
+      }
+      else
+      {
+        failure[a->next[state * n + c]] = target;
+        queue.push_back(a->next[state * n + c]);
+      }
+    }
+  }
+
+  automaton_ = a;
+}
+
+} // namespace asio
+
+#include "../detail/pop_options.hpp"
+
+#endif // ASIO_IMPL_DELIMITER_SET_IPP
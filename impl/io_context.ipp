@@ -19,6 +19,7 @@
 #include "../io_context.hpp"
 #include "../detail/concurrency_hint.hpp"
 #include "../detail/limits.hpp"
+#include "../detail/reactor.hpp"
 #include "../detail/scoped_ptr.hpp"
 #include "../detail/service_registry.hpp"
 #include "../detail/throw_error.hpp"
@@ -45,6 +46,18 @@ io_context::io_context(int concurrency_hint)
 {
 }
 
+io_context::io_context(const io_context_options& options)
+#if defined(ASIO_HAS_IOCP)
+  : impl_(add_impl(new impl_type(*this, options.concurrency_hint() == 1
+          ? ASIO_CONCURRENCY_HINT_1 : options.concurrency_hint(), false)))
+#else // defined(ASIO_HAS_IOCP)
+  : impl_(add_impl(new impl_type(*this, options.concurrency_hint() == 1
+          ? ASIO_CONCURRENCY_HINT_1 : options.concurrency_hint(), false,
+        options)))
+#endif // defined(ASIO_HAS_IOCP)
+{
+}
+
 io_context::impl_type& io_context::add_impl(io_context::impl_type* impl)
 {
   asio::detail::scoped_ptr<impl_type> scoped_impl(impl);
@@ -131,6 +144,68 @@ void io_context::restart()
   impl_.restart();
 }
 
+std::size_t io_context::reactor_event_count() const
+{
+#if defined(ASIO_HAS_EPOLL) && !defined(ASIO_HAS_IO_URING)
+  io_context& ctx = const_cast<io_context&>(*this);
+  if (has_service<detail::reactor>(ctx))
+    return use_service<detail::reactor>(ctx).last_event_count();
+#endif // defined(ASIO_HAS_EPOLL) && !defined(ASIO_HAS_IO_URING)
+  return 0;
+}
+
+std::size_t io_context::reactor_batch_size() const
+{
+#if defined(ASIO_HAS_EPOLL) && !defined(ASIO_HAS_IO_URING)
+  io_context& ctx = const_cast<io_context&>(*this);
+  if (has_service<detail::reactor>(ctx))
+    return use_service<detail::reactor>(ctx).batch_size();
+#endif // defined(ASIO_HAS_EPOLL) && !defined(ASIO_HAS_IO_URING)
+  return 0;
+}
+
+uint64_t io_context::busy_poll_spin_usec() const
+{
+#if defined(ASIO_HAS_IOCP)
+  return 0;
+#else // defined(ASIO_HAS_IOCP)
+  return impl_.busy_poll_spin_usec();
+#endif // defined(ASIO_HAS_IOCP)
+}
+
+uint64_t io_context::busy_poll_block_usec() const
+{
+#if defined(ASIO_HAS_IOCP)
+  return 0;
+#else // defined(ASIO_HAS_IOCP)
+  return impl_.busy_poll_block_usec();
+#endif // defined(ASIO_HAS_IOCP)
+}
+
+void io_context::trim()
+{
+  if (has_service<detail::reactor>(*this))
+    use_service<detail::reactor>(*this).trim();
+}
+
+std::size_t io_context::arena_bytes_allocated() const
+{
+#if defined(ASIO_HAS_IOCP)
+  return 0;
+#else // defined(ASIO_HAS_IOCP)
+  return impl_.arena_bytes_allocated();
+#endif // defined(ASIO_HAS_IOCP)
+}
+
+std::size_t io_context::arena_peak_bytes_allocated() const
+{
+#if defined(ASIO_HAS_IOCP)
+  return 0;
+#else // defined(ASIO_HAS_IOCP)
+  return impl_.arena_peak_bytes_allocated();
+#endif // defined(ASIO_HAS_IOCP)
+}
+
 io_context::service::service(asio::io_context& owner)
   : execution_context::service(owner)
 {
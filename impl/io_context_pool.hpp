@@ -0,0 +1,119 @@
+//
+// impl/io_context_pool.hpp
+// ~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2020 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_IMPL_IO_CONTEXT_POOL_HPP
+#define ASIO_IMPL_IO_CONTEXT_POOL_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "../detail/throw_error.hpp"
+#include "../error.hpp"
+
+#include "../detail/push_options.hpp"
+
+namespace asio {
+
+template <typename Protocol, typename Executor>
+void io_context_pool::open_reuseport_acceptor(
+    basic_socket_acceptor<Protocol, Executor>& acceptor,
+    const typename Protocol::endpoint& endpoint, int backlog)
+{
+  asio::error_code ec;
+  open_reuseport_acceptor(acceptor, endpoint, backlog, ec);
+  asio::detail::throw_error(ec, "open_reuseport_acceptor");
+}
+
+template <typename Protocol, typename Executor>
+ASIO_SYNC_OP_VOID io_context_pool::open_reuseport_acceptor(
+    basic_socket_acceptor<Protocol, Executor>& acceptor,
+    const typename Protocol::endpoint& endpoint,
+    int backlog, asio::error_code& ec)
+{
+#if defined(ASIO_OS_DEF_SO_REUSEPORT)
+  acceptor.open(endpoint.protocol(), ec);
+  if (!ec)
+    acceptor.set_option(socket_base::reuse_address(true), ec);
+  if (!ec)
+    acceptor.set_option(socket_base::reuse_port(true), ec);
+  if (!ec)
+    acceptor.bind(endpoint, ec);
+  if (!ec)
+    acceptor.listen(backlog, ec);
+  if (ec)
+  {
+    asio::error_code ignored_ec;
+    acceptor.close(ignored_ec);
+  }
+#else // defined(ASIO_OS_DEF_SO_REUSEPORT)
+  (void)acceptor;
+  (void)endpoint;
+  (void)backlog;
+  ec = asio::error::operation_not_supported;
+#endif // defined(ASIO_OS_DEF_SO_REUSEPORT)
+  ASIO_SYNC_OP_VOID_RETURN(ec);
+}
+
+#if defined(ASIO_HAS_MOVE)
+
+template <typename Endpoint>
+std::vector<basic_socket_acceptor<typename Endpoint::protocol_type> >
+io_context_pool::make_reuseport_acceptors(
+    const Endpoint& endpoint, int backlog)
+{
+  asio::error_code ec;
+  std::vector<basic_socket_acceptor<typename Endpoint::protocol_type> >
+    acceptors(make_reuseport_acceptors(endpoint, backlog, ec));
+  asio::detail::throw_error(ec, "make_reuseport_acceptors");
+  return acceptors;
+}
+
+template <typename Endpoint>
+std::vector<basic_socket_acceptor<typename Endpoint::protocol_type> >
+io_context_pool::make_reuseport_acceptors(
+    const Endpoint& endpoint, int backlog, asio::error_code& ec)
+{
+  typedef basic_socket_acceptor<typename Endpoint::protocol_type> acceptor_type;
+
+  std::vector<acceptor_type> acceptors;
+  acceptors.reserve(contexts_.size());
+
+  // If the operating system chooses the port for the first acceptor, the
+  // remaining acceptors must be bound to that same port.
+  Endpoint bound_endpoint(endpoint);
+  for (std::size_t i = 0; i < contexts_.size(); ++i)
+  {
+#if defined(ASIO_HAS_VARIADIC_TEMPLATES)
+    acceptors.emplace_back(*contexts_[i]);
+#else // defined(ASIO_HAS_VARIADIC_TEMPLATES)
+    acceptor_type acceptor(*contexts_[i]);
+    acceptors.push_back(ASIO_MOVE_CAST(acceptor_type)(acceptor));
+#endif // defined(ASIO_HAS_VARIADIC_TEMPLATES)
+    open_reuseport_acceptor(acceptors.back(), bound_endpoint, backlog, ec);
+    if (!ec && i == 0)
+      bound_endpoint = acceptors.back().local_endpoint(ec);
+    if (ec)
+    {
+      acceptors.clear();
+      break;
+    }
+  }
+
+  return acceptors;
+}
+
+#endif // defined(ASIO_HAS_MOVE)
+
+} // namespace asio
+
+#include "../detail/pop_options.hpp"
+
+#endif // ASIO_IMPL_IO_CONTEXT_POOL_HPP
@@ -0,0 +1,155 @@
+//
+// impl/io_context_pool.ipp
+// ~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2020 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_IMPL_IO_CONTEXT_POOL_IPP
+#define ASIO_IMPL_IO_CONTEXT_POOL_IPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "../detail/config.hpp"
+#include "../detail/affinity_thread_function.hpp"
+#include "../detail/thread.hpp"
+#include "../io_context_pool.hpp"
+
+#include "../detail/push_options.hpp"
+
+namespace asio {
+
+struct io_context_pool::thread_function
+{
+  detail::io_context_impl* impl_;
+
+  void operator()()
+  {
+    asio::error_code ec;
+    impl_->run(ec);
+  }
+};
+
+io_context_pool::io_context_pool()
+  : next_(0)
+{
+  std::size_t pool_size = detail::thread::hardware_concurrency();
+  init(pool_size ? pool_size : 1,
+      io_context_options().concurrency_hint(1), thread_affinity());
+}
+
+io_context_pool::io_context_pool(std::size_t pool_size)
+  : next_(0)
+{
+  init(pool_size, io_context_options().concurrency_hint(1), thread_affinity());
+}
+
+io_context_pool::io_context_pool(std::size_t pool_size,
+    const io_context_options& options)
+  : next_(0)
+{
+  init(pool_size, options, thread_affinity());
+}
+
+io_context_pool::io_context_pool(std::size_t pool_size,
+    const thread_affinity& affinity)
+  : next_(0)
+{
+  init(pool_size, io_context_options().concurrency_hint(1), affinity);
+}
+
+io_context_pool::io_context_pool(std::size_t pool_size,
+    const io_context_options& options, const thread_affinity& affinity)
+  : next_(0)
+{
+  init(pool_size, options, affinity);
+}
+
+io_context_pool::~io_context_pool()
+{
+  stop();
+  join();
+}
+
+io_context& io_context_pool::get_io_context(selection_type selection)
+{
+  std::size_t start = static_cast<std::size_t>(
+      static_cast<unsigned long>(++next_) % contexts_.size());
+
+  if (selection == least_loaded)
+  {
+    // Begin the search at a different position each time, so that load is
+    // spread evenly between io_context objects that are equally busy.
+    std::size_t best = start;
+    std::size_t best_load = use_service<detail::io_context_impl>(
+        *contexts_[start]).outstanding_work();
+    for (std::size_t i = 1; i < contexts_.size() && best_load > 0; ++i)
+    {
+      std::size_t n = (start + i) % contexts_.size();
+      std::size_t load = use_service<detail::io_context_impl>(
+          *contexts_[n]).outstanding_work();
+      if (load < best_load)
+      {
+        best = n;
+        best_load = load;
+      }
+    }
+    return *contexts_[best];
+  }
+
+  return *contexts_[start];
+}
+
+void io_context_pool::stop()
+{
+  for (std::size_t i = 0; i < contexts_.size(); ++i)
+    contexts_[i]->stop();
+}
+
+void io_context_pool::join()
+{
+  if (!threads_.empty())
+  {
+    for (std::size_t i = 0; i < contexts_.size(); ++i)
+      use_service<detail::io_context_impl>(*contexts_[i]).work_finished();
+    threads_.join();
+  }
+}
+
+void io_context_pool::init(std::size_t pool_size,
+    const io_context_options& options, const thread_affinity& affinity)
+{
+  if (pool_size == 0)
+    pool_size = 1;
+
+  contexts_.reserve(pool_size);
+  for (std::size_t i = 0; i < pool_size; ++i)
+    contexts_.push_back(detail::shared_ptr<io_context>(
+          new io_context(options)));
+
+  // Each thread keeps running until join() is called, even if its io_context
+  // runs out of work in the meantime.
+  for (std::size_t i = 0; i < contexts_.size(); ++i)
+  {
+    detail::io_context_impl& impl =
+      use_service<detail::io_context_impl>(*contexts_[i]);
+    impl.work_started();
+    thread_function f = { &impl };
+    if (affinity.empty())
+      threads_.create_thread(f);
+    else
+      threads_.create_thread(
+          detail::affinity_thread_function<thread_function>(f, affinity, i));
+  }
+}
+
+} // namespace asio
+
+#include "../detail/pop_options.hpp"
+
+#endif // ASIO_IMPL_IO_CONTEXT_POOL_IPP
@@ -16,6 +16,7 @@
 #endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
 
 #include <algorithm>
+#include <cstring>
 #include <string>
 #include <vector>
 #include <utility>
@@ -23,6 +24,7 @@
 #include "../associated_executor.hpp"
 #include "../buffer.hpp"
 #include "../buffers_iterator.hpp"
+#include "../delimiter_set.hpp"
 #include "../detail/bind_handler.hpp"
 #include "../detail/handler_alloc_helpers.hpp"
 #include "../detail/handler_cont_helpers.hpp"
@@ -39,36 +41,148 @@ namespace asio {
 
 namespace detail
 {
-  // Algorithm that finds a subsequence of equal values in a sequence. Returns
-  // (iterator,true) if a full match was found, in which case the iterator
-  // points to the beginning of the match. Returns (iterator,false) if a
-  // partial match was found at the end of the first sequence, in which case
-  // the iterator points to the beginning of the partial match. Returns
-  // (last1,false) if no full or partial match was found.
-  template <typename Iterator1, typename Iterator2>
-  std::pair<Iterator1, bool> partial_search(
-      Iterator1 first1, Iterator1 last1, Iterator2 first2, Iterator2 last2)
-  {
-    for (Iterator1 iter1 = first1; iter1 != last1; ++iter1)
-    {
-      Iterator1 test_iter1 = iter1;
-      Iterator2 test_iter2 = first2;
-      for (;; ++test_iter1, ++test_iter2)
+  // Find the first occurrence of a character in a sequence of buffers,
+  // starting from the given position. Each buffer is searched using memchr,
+  // which the C library implements with vector instructions selected for the
+  // running CPU. Returns (position,true) if a match was found, in which case
+  // the position is that of the match. Returns (size,false) if no match was
+  // found, where size is the total size of the buffers.
+  template <typename Iterator>
+  std::pair<std::size_t, bool> find_delimiter(Iterator begin,
+      Iterator end, std::size_t position, char delim)
+  {
+    std::size_t offset = 0;
+    for (Iterator iter = begin; iter != end; ++iter)
+    {
+      const_buffer buffer(*iter);
+      std::size_t size = buffer.size();
+      if (position < offset + size)
       {
-        if (test_iter2 == last2)
-          return std::make_pair(iter1, true);
-        if (test_iter1 == last1)
+        const char* data = static_cast<const char*>(buffer.data());
+        std::size_t skip = position > offset ? position - offset : 0;
+        using namespace std; // For memchr.
+        if (const void* match = memchr(data + skip, delim, size - skip))
         {
-          if (test_iter2 != first2)
-            return std::make_pair(iter1, false);
-          else
-            break;
+          return std::make_pair(offset
+              + (static_cast<const char*>(match) - data), true);
         }
-        if (*test_iter1 != *test_iter2)
+      }
+      offset += size;
+    }
+    return std::make_pair(offset, false);
+  }
+
+  template <typename ConstBufferSequence>
+  inline std::pair<std::size_t, bool> find_delimiter(
+      const ConstBufferSequence& buffers, std::size_t position, char delim)
+  {
+    return find_delimiter(asio::buffer_sequence_begin(buffers),
+        asio::buffer_sequence_end(buffers), position, delim);
+  }
+
+  // Compare the start of a sequence of buffers with a string. Returns 1 if
+  // the buffers start with the whole string, 0 if they differ from the
+  // string, and -1 if the buffers end before the string does.
+  template <typename Iterator>
+  int starts_with(Iterator begin, Iterator end,
+      const char* delim, std::size_t length)
+  {
+    for (Iterator iter = begin; iter != end && length > 0; ++iter)
+    {
+      const_buffer buffer(*iter);
+      std::size_t n = buffer.size() < length ? buffer.size() : length;
+      using namespace std; // For memcmp.
+      if (memcmp(buffer.data(), delim, n) != 0)
+        return 0;
+      delim += n;
+      length -= n;
+    }
+    return length == 0 ? 1 : -1;
+  }
+
+  // Find the first occurrence of a string in a sequence of buffers, starting
+  // from the given position. Candidates are located using memchr, and a match
+  // may span buffers. Returns (position,true) if a full match was found, in
+  // which case the position is that of the match. Returns (position,false) if
+  // a partial match was found at the end of the buffers, in which case the
+  // position is that of the partial match. Returns (size,false) if no full or
+  // partial match was found, where size is the total size of the buffers. An
+  // empty string matches at the first byte at or after the position, so it
+  // does not match when there is no data left to search.
+  template <typename Iterator>
+  std::pair<std::size_t, bool> partial_search(Iterator begin, Iterator end,
+      std::size_t position, const char* delim, std::size_t length)
+  {
+    std::size_t offset = 0;
+    for (Iterator iter = begin; iter != end; ++iter)
+    {
+      const_buffer buffer(*iter);
+      std::size_t size = buffer.size();
+      const char* data = static_cast<const char*>(buffer.data());
+      std::size_t i = position > offset ? position - offset : 0;
+      if (length == 0 && i < size)
+        return std::make_pair(offset + i, true);
+      while (i < size)
+      {
+        using namespace std; // For memchr and memcmp.
+        const void* candidate = memchr(data + i, delim[0], size - i);
+        if (!candidate)
           break;
+        i = static_cast<const char*>(candidate) - data;
+        if (size - i >= length)
+        {
+          if (memcmp(data + i, delim, length) == 0)
+            return std::make_pair(offset + i, true);
+        }
+        else if (memcmp(data + i, delim, size - i) == 0)
+        {
+          Iterator next = iter;
+          int result = starts_with(++next, end,
+              delim + (size - i), length - (size - i));
+          if (result != 0)
+            return std::make_pair(offset + i, result > 0);
+        }
+        ++i;
       }
+      offset += size;
     }
-    return std::make_pair(last1, false);
+    return std::make_pair(offset, false);
+  }
+
+  template <typename ConstBufferSequence>
+  inline std::pair<std::size_t, bool> partial_search(
+      const ConstBufferSequence& buffers, std::size_t position,
+      const char* delim, std::size_t length)
+  {
+    return partial_search(asio::buffer_sequence_begin(buffers),
+        asio::buffer_sequence_end(buffers), position, delim, length);
+  }
+  // Apply a match condition to a sequence of buffers, starting from the given
+  // position. Returns (position,true) if a full match was found, in which
+  // case the position is that of the end of the match. Returns
+  // (position,false) otherwise, in which case the position is that of the
+  // beginning of a partial match, or the total size of the buffers if there
+  // is no partial match.
+  template <typename MatchCondition, typename ConstBufferSequence>
+  std::pair<std::size_t, bool> match_buffers(MatchCondition& match_condition,
+      const ConstBufferSequence& buffers, std::size_t position)
+  {
+    typedef buffers_iterator<ConstBufferSequence> iterator;
+    iterator begin = iterator::begin(buffers);
+    iterator start_pos = begin + position;
+    iterator end = iterator::end(buffers);
+    std::pair<iterator, bool> result = match_condition(start_pos, end);
+    return std::make_pair(
+        static_cast<std::size_t>(result.first - begin), result.second);
+  }
+
+  // A delimiter_set scans the buffers directly.
+  template <typename ConstBufferSequence>
+  inline std::pair<std::size_t, bool> match_buffers(
+      delimiter_set& delimiters, const ConstBufferSequence& buffers,
+      std::size_t position)
+  {
+    return delimiters.search(buffers, position);
   }
 } // namespace detail
 
@@ -106,24 +220,21 @@ std::size_t read_until(SyncReadStream& s,
   {
     // Determine the range of the data to be searched.
     typedef typename DynamicBuffer_v1::const_buffers_type buffers_type;
-    typedef buffers_iterator<buffers_type> iterator;
     buffers_type data_buffers = b.data();
-    iterator begin = iterator::begin(data_buffers);
-    iterator start_pos = begin + search_position;
-    iterator end = iterator::end(data_buffers);
 
     // Look for a match.
-    iterator iter = std::find(start_pos, end, delim);
-    if (iter != end)
+    std::pair<std::size_t, bool> result = detail::find_delimiter(
+        data_buffers, search_position, delim);
+    if (result.second)
     {
       // Found a match. We're done.
       ec = asio::error_code();
-      return iter - begin + 1;
+      return result.first + 1;
     }
     else
     {
       // No match. Next search can start with the new data.
-      search_position = end - begin;
+      search_position = result.first;
     }
 
     // Check if buffer is full.
@@ -176,33 +287,22 @@ std::size_t read_until(SyncReadStream& s,
   {
     // Determine the range of the data to be searched.
     typedef typename DynamicBuffer_v1::const_buffers_type buffers_type;
-    typedef buffers_iterator<buffers_type> iterator;
     buffers_type data_buffers = b.data();
-    iterator begin = iterator::begin(data_buffers);
-    iterator start_pos = begin + search_position;
-    iterator end = iterator::end(data_buffers);
 
     // Look for a match.
-    std::pair<iterator, bool> result = detail::partial_search(
-        start_pos, end, delim.begin(), delim.end());
-    if (result.first != end)
+    std::pair<std::size_t, bool> result = detail::partial_search(
+        data_buffers, search_position, delim.data(), delim.length());
+    if (result.second)
     {
-      if (result.second)
-      {
-        // Full match. We're done.
-        ec = asio::error_code();
-        return result.first - begin + delim.length();
-      }
-      else
-      {
-        // Partial match. Next search needs to start from beginning of match.
-        search_position = result.first - begin;
-      }
+      // Full match. We're done.
+      ec = asio::error_code();
+      return result.first + delim.length();
     }
     else
     {
-      // No match. Next search can start with the new data.
-      search_position = end - begin;
+      // Partial match, or no match. Next search needs to start from the
+      // beginning of the partial match, or with the new data.
+      search_position = result.first;
     }
 
     // Check if buffer is full.
@@ -346,29 +446,22 @@ std::size_t read_until(SyncReadStream& s,
   {
     // Determine the range of the data to be searched.
     typedef typename DynamicBuffer_v1::const_buffers_type buffers_type;
-    typedef buffers_iterator<buffers_type> iterator;
     buffers_type data_buffers = b.data();
-    iterator begin = iterator::begin(data_buffers);
-    iterator start_pos = begin + search_position;
-    iterator end = iterator::end(data_buffers);
 
     // Look for a match.
-    std::pair<iterator, bool> result = match_condition(start_pos, end);
+    std::pair<std::size_t, bool> result = detail::match_buffers(
+        match_condition, data_buffers, search_position);
     if (result.second)
     {
       // Full match. We're done.
       ec = asio::error_code();
-      return result.first - begin;
-    }
-    else if (result.first != end)
-    {
-      // Partial match. Next search needs to start from beginning of match.
-      search_position = result.first - begin;
+      return result.first;
     }
     else
     {
-      // No match. Next search can start with the new data.
-      search_position = end - begin;
+      // Partial match, or no match. Next search needs to start from the
+      // beginning of the partial match, or with the new data.
+      search_position = result.first;
     }
 
     // Check if buffer is full.
@@ -489,25 +582,22 @@ std::size_t read_until(SyncReadStream& s, DynamicBuffer_v2 buffers,
   {
     // Determine the range of the data to be searched.
     typedef typename DynamicBuffer_v2::const_buffers_type buffers_type;
-    typedef buffers_iterator<buffers_type> iterator;
     buffers_type data_buffers =
       const_cast<const DynamicBuffer_v2&>(b).data(0, b.size());
-    iterator begin = iterator::begin(data_buffers);
-    iterator start_pos = begin + search_position;
-    iterator end = iterator::end(data_buffers);
 
     // Look for a match.
-    iterator iter = std::find(start_pos, end, delim);
-    if (iter != end)
+    std::pair<std::size_t, bool> result = detail::find_delimiter(
+        data_buffers, search_position, delim);
+    if (result.second)
     {
       // Found a match. We're done.
       ec = asio::error_code();
-      return iter - begin + 1;
+      return result.first + 1;
     }
     else
     {
       // No match. Next search can start with the new data.
-      search_position = end - begin;
+      search_position = result.first;
     }
 
     // Check if buffer is full.
@@ -558,34 +648,23 @@ std::size_t read_until(SyncReadStream& s, DynamicBuffer_v2 buffers,
   {
     // Determine the range of the data to be searched.
     typedef typename DynamicBuffer_v2::const_buffers_type buffers_type;
-    typedef buffers_iterator<buffers_type> iterator;
     buffers_type data_buffers =
       const_cast<const DynamicBuffer_v2&>(b).data(0, b.size());
-    iterator begin = iterator::begin(data_buffers);
-    iterator start_pos = begin + search_position;
-    iterator end = iterator::end(data_buffers);
 
     // Look for a match.
-    std::pair<iterator, bool> result = detail::partial_search(
-        start_pos, end, delim.begin(), delim.end());
-    if (result.first != end)
+    std::pair<std::size_t, bool> result = detail::partial_search(
+        data_buffers, search_position, delim.data(), delim.length());
+    if (result.second)
     {
-      if (result.second)
-      {
-        // Full match. We're done.
-        ec = asio::error_code();
-        return result.first - begin + delim.length();
-      }
-      else
-      {
-        // Partial match. Next search needs to start from beginning of match.
-        search_position = result.first - begin;
-      }
+      // Full match. We're done.
+      ec = asio::error_code();
+      return result.first + delim.length();
     }
     else
     {
-      // No match. Next search can start with the new data.
-      search_position = end - begin;
+      // Partial match, or no match. Next search needs to start from the
+      // beginning of the partial match, or with the new data.
+      search_position = result.first;
     }
 
     // Check if buffer is full.
@@ -726,30 +805,23 @@ std::size_t read_until(SyncReadStream& s, DynamicBuffer_v2 buffers,
   {
     // Determine the range of the data to be searched.
     typedef typename DynamicBuffer_v2::const_buffers_type buffers_type;
-    typedef buffers_iterator<buffers_type> iterator;
     buffers_type data_buffers =
       const_cast<const DynamicBuffer_v2&>(b).data(0, b.size());
-    iterator begin = iterator::begin(data_buffers);
-    iterator start_pos = begin + search_position;
-    iterator end = iterator::end(data_buffers);
 
     // Look for a match.
-    std::pair<iterator, bool> result = match_condition(start_pos, end);
+    std::pair<std::size_t, bool> result = detail::match_buffers(
+        match_condition, data_buffers, search_position);
     if (result.second)
     {
       // Full match. We're done.
       ec = asio::error_code();
-      return result.first - begin;
-    }
-    else if (result.first != end)
-    {
-      // Partial match. Next search needs to start from beginning of match.
-      search_position = result.first - begin;
+      return result.first;
     }
     else
     {
-      // No match. Next search can start with the new data.
-      search_position = end - begin;
+      // Partial match, or no match. Next search needs to start from the
+      // beginning of the partial match, or with the new data.
+      search_position = result.first;
     }
 
     // Check if buffer is full.
@@ -832,18 +904,15 @@ namespace detail
             // Determine the range of the data to be searched.
             typedef typename DynamicBuffer_v1::const_buffers_type
               buffers_type;
-            typedef buffers_iterator<buffers_type> iterator;
             buffers_type data_buffers = buffers_.data();
-            iterator begin = iterator::begin(data_buffers);
-            iterator start_pos = begin + search_position_;
-            iterator end = iterator::end(data_buffers);
 
             // Look for a match.
-            iterator iter = std::find(start_pos, end, delim_);
-            if (iter != end)
+            std::pair<std::size_t, bool> result = detail::find_delimiter(
+                data_buffers, search_position_, delim_);
+            if (result.second)
             {
               // Found a match. We're done.
-              search_position_ = iter - begin + 1;
+              search_position_ = result.first + 1;
               bytes_to_read = 0;
             }
 
@@ -858,7 +927,7 @@ namespace detail
             else
             {
               // Next search can start with the new data.
-              search_position_ = end - begin;
+              search_position_ = result.first;
               bytes_to_read = std::min<std::size_t>(
                     std::max<std::size_t>(512,
                       buffers_.capacity() - buffers_.size()),
@@ -1127,19 +1196,15 @@ namespace detail
             // Determine the range of the data to be searched.
             typedef typename DynamicBuffer_v1::const_buffers_type
               buffers_type;
-            typedef buffers_iterator<buffers_type> iterator;
             buffers_type data_buffers = buffers_.data();
-            iterator begin = iterator::begin(data_buffers);
-            iterator start_pos = begin + search_position_;
-            iterator end = iterator::end(data_buffers);
 
             // Look for a match.
-            std::pair<iterator, bool> result = detail::partial_search(
-                start_pos, end, delim_.begin(), delim_.end());
-            if (result.first != end && result.second)
+            std::pair<std::size_t, bool> result = detail::partial_search(
+                data_buffers, search_position_, delim_.data(), delim_.length());
+            if (result.second)
             {
               // Full match. We're done.
-              search_position_ = result.first - begin + delim_.length();
+              search_position_ = result.first + delim_.length();
               bytes_to_read = 0;
             }
 
@@ -1153,17 +1218,9 @@ namespace detail
             // Need to read some more data.
             else
             {
-              if (result.first != end)
-              {
-                // Partial match. Next search needs to start from beginning of
-                // match.
-                search_position_ = result.first - begin;
-              }
-              else
-              {
-                // Next search can start with the new data.
-                search_position_ = end - begin;
-              }
+              // Partial match, or no match. Next search needs to start from
+              // the beginning of the partial match, or with the new data.
+              search_position_ = result.first;
 
               bytes_to_read = std::min<std::size_t>(
                     std::max<std::size_t>(512,
@@ -1749,18 +1806,15 @@ namespace detail
             // Determine the range of the data to be searched.
             typedef typename DynamicBuffer_v1::const_buffers_type
               buffers_type;
-            typedef buffers_iterator<buffers_type> iterator;
             buffers_type data_buffers = buffers_.data();
-            iterator begin = iterator::begin(data_buffers);
-            iterator start_pos = begin + search_position_;
-            iterator end = iterator::end(data_buffers);
 
             // Look for a match.
-            std::pair<iterator, bool> result = match_condition_(start_pos, end);
+            std::pair<std::size_t, bool> result = detail::match_buffers(
+                match_condition_, data_buffers, search_position_);
             if (result.second)
             {
               // Full match. We're done.
-              search_position_ = result.first - begin;
+              search_position_ = result.first;
               bytes_to_read = 0;
             }
 
@@ -1774,17 +1828,9 @@ namespace detail
             // Need to read some more data.
             else
             {
-              if (result.first != end)
-              {
-                // Partial match. Next search needs to start from beginning of
-                // match.
-                search_position_ = result.first - begin;
-              }
-              else
-              {
-                // Next search can start with the new data.
-                search_position_ = end - begin;
-              }
+              // Partial match, or no match. Next search needs to start from
+              // the beginning of the partial match, or with the new data.
+              search_position_ = result.first;
 
               bytes_to_read = std::min<std::size_t>(
                     std::max<std::size_t>(512,
@@ -2126,20 +2172,17 @@ namespace detail
             // Determine the range of the data to be searched.
             typedef typename DynamicBuffer_v2::const_buffers_type
               buffers_type;
-            typedef buffers_iterator<buffers_type> iterator;
             buffers_type data_buffers =
               const_cast<const DynamicBuffer_v2&>(buffers_).data(
                   0, buffers_.size());
-            iterator begin = iterator::begin(data_buffers);
-            iterator start_pos = begin + search_position_;
-            iterator end = iterator::end(data_buffers);
 
             // Look for a match.
-            iterator iter = std::find(start_pos, end, delim_);
-            if (iter != end)
+            std::pair<std::size_t, bool> result = detail::find_delimiter(
+                data_buffers, search_position_, delim_);
+            if (result.second)
             {
               // Found a match. We're done.
-              search_position_ = iter - begin + 1;
+              search_position_ = result.first + 1;
               bytes_to_read_ = 0;
             }
 
@@ -2154,7 +2197,7 @@ namespace detail
             else
             {
               // Next search can start with the new data.
-              search_position_ = end - begin;
+              search_position_ = result.first;
               bytes_to_read_ = std::min<std::size_t>(
                     std::max<std::size_t>(512,
                       buffers_.capacity() - buffers_.size()),
@@ -2426,21 +2469,17 @@ namespace detail
             // Determine the range of the data to be searched.
             typedef typename DynamicBuffer_v2::const_buffers_type
               buffers_type;
-            typedef buffers_iterator<buffers_type> iterator;
             buffers_type data_buffers =
               const_cast<const DynamicBuffer_v2&>(buffers_).data(
                   0, buffers_.size());
-            iterator begin = iterator::begin(data_buffers);
-            iterator start_pos = begin + search_position_;
-            iterator end = iterator::end(data_buffers);
 
             // Look for a match.
-            std::pair<iterator, bool> result = detail::partial_search(
-                start_pos, end, delim_.begin(), delim_.end());
-            if (result.first != end && result.second)
+            std::pair<std::size_t, bool> result = detail::partial_search(
+                data_buffers, search_position_, delim_.data(), delim_.length());
+            if (result.second)
             {
               // Full match. We're done.
-              search_position_ = result.first - begin + delim_.length();
+              search_position_ = result.first + delim_.length();
               bytes_to_read_ = 0;
             }
 
@@ -2454,17 +2493,9 @@ namespace detail
             // Need to read some more data.
             else
             {
-              if (result.first != end)
-              {
-                // Partial match. Next search needs to start from beginning of
-                // match.
-                search_position_ = result.first - begin;
-              }
-              else
-              {
-                // Next search can start with the new data.
-                search_position_ = end - begin;
-              }
+              // Partial match, or no match. Next search needs to start from
+              // the beginning of the partial match, or with the new data.
+              search_position_ = result.first;
 
               bytes_to_read_ = std::min<std::size_t>(
                     std::max<std::size_t>(512,
@@ -3061,20 +3092,17 @@ namespace detail
             // Determine the range of the data to be searched.
             typedef typename DynamicBuffer_v2::const_buffers_type
               buffers_type;
-            typedef buffers_iterator<buffers_type> iterator;
             buffers_type data_buffers =
               const_cast<const DynamicBuffer_v2&>(buffers_).data(
                   0, buffers_.size());
-            iterator begin = iterator::begin(data_buffers);
-            iterator start_pos = begin + search_position_;
-            iterator end = iterator::end(data_buffers);
 
             // Look for a match.
-            std::pair<iterator, bool> result = match_condition_(start_pos, end);
+            std::pair<std::size_t, bool> result = detail::match_buffers(
+                match_condition_, data_buffers, search_position_);
             if (result.second)
             {
               // Full match. We're done.
-              search_position_ = result.first - begin;
+              search_position_ = result.first;
               bytes_to_read_ = 0;
             }
 
@@ -3088,17 +3116,9 @@ namespace detail
             // Need to read some more data.
             else
             {
-              if (result.first != end)
-              {
-                // Partial match. Next search needs to start from beginning of
-                // match.
-                search_position_ = result.first - begin;
-              }
-              else
-              {
-                // Next search can start with the new data.
-                search_position_ = end - begin;
-              }
+              // Partial match, or no match. Next search needs to start from
+              // the beginning of the partial match, or with the new data.
+              search_position_ = result.first;
 
               bytes_to_read_ = std::min<std::size_t>(
                     std::max<std::size_t>(512,
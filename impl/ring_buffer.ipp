@@ -0,0 +1,138 @@
+//
+// impl/ring_buffer.ipp
+// ~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2020 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_IMPL_RING_BUFFER_IPP
+#define ASIO_IMPL_RING_BUFFER_IPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "../detail/config.hpp"
+
+#if defined(ASIO_HAS_RING_BUFFER)
+
+#include <cerrno>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "../error.hpp"
+#include "../ring_buffer.hpp"
+#include "../detail/throw_error.hpp"
+
+#if !defined(MFD_CLOEXEC)
+# define MFD_CLOEXEC 0x0001U
+#endif // !defined(MFD_CLOEXEC)
+
+#include "../detail/push_options.hpp"
+
+namespace asio {
+
+ring_buffer::ring_buffer(std::size_t capacity)
+  : memory_(0),
+    capacity_(0),
+    head_(0),
+    size_(0),
+    prepared_(0)
+{
+  reserve(capacity > 0 ? capacity : 1);
+}
+
+ring_buffer::~ring_buffer()
+{
+  unmap_memory(memory_, capacity_);
+}
+
+void ring_buffer::reserve(std::size_t n)
+{
+  if (n <= capacity_)
+    return;
+
+  std::size_t page_size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+  std::size_t new_capacity = (n + page_size - 1) / page_size * page_size;
+
+  asio::error_code ec;
+  unsigned char* new_memory = map_memory(new_capacity, ec);
+  asio::detail::throw_error(ec, "ring_buffer");
+
+  // The readable bytes are contiguous in the old mapping, and are copied to
+  // the start of the new one.
+  if (size_ > 0)
+    std::memcpy(new_memory, memory_ + head_, size_);
+
+  unmap_memory(memory_, capacity_);
+  memory_ = new_memory;
+  capacity_ = new_capacity;
+  head_ = 0;
+}
+
+unsigned char* ring_buffer::map_memory(
+    std::size_t size, asio::error_code& ec)
+{
+  int fd = static_cast<int>(::syscall(__NR_memfd_create,
+        "asio-ring-buffer", MFD_CLOEXEC));
+  if (fd == -1)
+  {
+    ec = asio::error_code(errno, asio::error::get_system_category());
+    return 0;
+  }
+
+  if (::ftruncate(fd, static_cast<off_t>(size)) != 0)
+  {
+    ec = asio::error_code(errno, asio::error::get_system_category());
+    ::close(fd);
+    return 0;
+  }
+
+  // Reserve a range of addresses for both mappings, then replace each half of
+  // it with a mapping of the same memory.
+  void* base = ::mmap(0, size * 2, PROT_NONE,
+      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (base == MAP_FAILED)
+  {
+    ec = asio::error_code(errno, asio::error::get_system_category());
+    ::close(fd);
+    return 0;
+  }
+
+  unsigned char* memory = static_cast<unsigned char*>(base);
+  for (int i = 0; i < 2; ++i)
+  {
+    if (::mmap(memory + size * i, size, PROT_READ | PROT_WRITE,
+          MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED)
+    {
+      ec = asio::error_code(errno, asio::error::get_system_category());
+      ::munmap(base, size * 2);
+      ::close(fd);
+      return 0;
+    }
+  }
+
+  // The mappings keep the memory alive.
+  ::close(fd);
+
+  ec = asio::error_code();
+  return memory;
+}
+
+void ring_buffer::unmap_memory(unsigned char* memory, std::size_t size)
+{
+  if (memory)
+    ::munmap(memory, size * 2);
+}
+
+} // namespace asio
+
+#include "../detail/pop_options.hpp"
+
+#endif // defined(ASIO_HAS_RING_BUFFER)
+
+#endif // ASIO_IMPL_RING_BUFFER_IPP
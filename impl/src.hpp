@@ -19,21 +19,28 @@
 # error Do not compile Asio library source with ASIO_HEADER_ONLY defined
 #endif
 
+#include "../impl/buffer_pool.ipp"
+#include "../impl/delimiter_set.ipp"
 #include "../impl/error.ipp"
 #include "../impl/error_code.ipp"
 #include "../impl/execution_context.ipp"
 #include "../impl/executor.ipp"
 #include "../impl/handler_alloc_hook.ipp"
 #include "../impl/io_context.ipp"
+#include "../impl/io_context_pool.ipp"
+#include "../impl/ring_buffer.ipp"
 #include "../impl/serial_port_base.ipp"
 #include "../impl/system_context.ipp"
+#include "../impl/thread_affinity.ipp"
 #include "../impl/thread_pool.ipp"
 #include "../detail/impl/buffer_sequence_adapter.ipp"
 #include "../detail/impl/descriptor_ops.ipp"
 #include "../detail/impl/dev_poll_reactor.ipp"
 #include "../detail/impl/epoll_reactor.ipp"
 #include "../detail/impl/eventfd_select_interrupter.ipp"
+#include "../detail/impl/handler_arena.ipp"
 #include "../detail/impl/handler_tracking.ipp"
+#include "../detail/impl/io_uring_reactor.ipp"
 #include "../detail/impl/kqueue_reactor.ipp"
 #include "../detail/impl/null_event.ipp"
 #include "../detail/impl/pipe_select_interrupter.ipp"
@@ -69,6 +76,7 @@
 #include "../detail/impl/winrt_ssocket_service_base.ipp"
 #include "../detail/impl/winrt_timer_scheduler.ipp"
 #include "../detail/impl/winsock_init.ipp"
+#include "../detail/impl/zero_copy_tracker.ipp"
 #include "../generic/detail/impl/endpoint.ipp"
 #include "../ip/impl/address.ipp"
 #include "../ip/impl/address_v4.ipp"
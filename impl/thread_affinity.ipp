@@ -0,0 +1,210 @@
+//
+// impl/thread_affinity.ipp
+// ~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2020 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_IMPL_THREAD_AFFINITY_IPP
+#define ASIO_IMPL_THREAD_AFFINITY_IPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "../detail/config.hpp"
+#include <algorithm>
+#include <cstdio>
+#include "../detail/throw_error.hpp"
+#include "../error.hpp"
+#include "../thread_affinity.hpp"
+
+#if defined(ASIO_WINDOWS) || defined(__CYGWIN__)
+# include "../detail/socket_types.hpp"
+#elif defined(__linux__)
+# include <pthread.h>
+# include <sched.h>
+# include <unistd.h>
+# include <sys/syscall.h>
+#endif // defined(__linux__)
+
+#include "../detail/push_options.hpp"
+
+namespace asio {
+
+thread_affinity thread_affinity::numa_node(int node)
+{
+  asio::error_code ec;
+  thread_affinity affinity = numa_node(node, ec);
+  asio::detail::throw_error(ec, "numa_node");
+  return affinity;
+}
+
+thread_affinity thread_affinity::numa_node(int node, asio::error_code& ec)
+{
+  thread_affinity affinity;
+
+#if defined(__linux__)
+  if (node < 0)
+  {
+    ec = asio::error::invalid_argument;
+    return affinity;
+  }
+
+  // The node's CPUs are listed as comma-separated ranges, e.g. "0-3,8-11".
+  char path[64];
+  std::sprintf(path, "/sys/devices/system/node/node%d/cpulist", node);
+  std::FILE* file = std::fopen(path, "r");
+  if (!file)
+  {
+    ec = asio::error::invalid_argument;
+    return affinity;
+  }
+
+  unsigned long first = 0;
+  while (std::fscanf(file, "%lu", &first) == 1)
+  {
+    unsigned long last = first;
+    int c = std::fgetc(file);
+    if (c == '-')
+    {
+      if (std::fscanf(file, "%lu", &last) != 1)
+        break;
+      c = std::fgetc(file);
+    }
+    for (unsigned long cpu = first; cpu <= last; ++cpu)
+      affinity.add_cpu(cpu);
+    if (c != ',')
+      break;
+  }
+  std::fclose(file);
+
+  affinity.numa_node_ = node;
+  ec = asio::error_code();
+#else // defined(__linux__)
+  (void)node;
+  ec = asio::error::operation_not_supported;
+#endif // defined(__linux__)
+
+  return affinity;
+}
+
+thread_affinity& thread_affinity::add_cpu(std::size_t cpu)
+{
+  std::vector<std::size_t>::iterator iter =
+    std::lower_bound(cpus_.begin(), cpus_.end(), cpu);
+  if (iter == cpus_.end() || *iter != cpu)
+    cpus_.insert(iter, cpu);
+  return *this;
+}
+
+bool thread_affinity::contains(std::size_t cpu) const
+{
+  return std::binary_search(cpus_.begin(), cpus_.end(), cpu);
+}
+
+void thread_affinity::apply(std::size_t thread_index) const
+{
+  asio::error_code ec;
+  apply(thread_index, ec);
+  asio::detail::throw_error(ec, "apply");
+}
+
+ASIO_SYNC_OP_VOID thread_affinity::apply(
+    std::size_t thread_index, asio::error_code& ec) const
+{
+  if (cpus_.empty())
+  {
+    ec = asio::error_code();
+    ASIO_SYNC_OP_VOID_RETURN(ec);
+  }
+
+  // Bind to a single CPU when distributing threads, otherwise to all of them.
+  std::size_t begin = 0, end = cpus_.size();
+  if (distribute_)
+  {
+    begin = thread_index % cpus_.size();
+    end = begin + 1;
+  }
+
+#if defined(ASIO_WINDOWS_APP) || defined(UNDER_CE)
+  (void)begin;
+  (void)end;
+  ec = asio::error::operation_not_supported;
+#elif defined(ASIO_WINDOWS) || defined(__CYGWIN__)
+  DWORD_PTR mask = 0;
+  for (std::size_t i = begin; i < end; ++i)
+  {
+    if (cpus_[i] >= sizeof(DWORD_PTR) * 8)
+    {
+      ec = asio::error::invalid_argument;
+      ASIO_SYNC_OP_VOID_RETURN(ec);
+    }
+    mask |= static_cast<DWORD_PTR>(1) << cpus_[i];
+  }
+
+  if (::SetThreadAffinityMask(::GetCurrentThread(), mask) == 0)
+  {
+    DWORD last_error = ::GetLastError();
+    ec = asio::error_code(last_error,
+        asio::error::get_system_category());
+    ASIO_SYNC_OP_VOID_RETURN(ec);
+  }
+
+  ec = asio::error_code();
+#elif defined(__linux__) && defined(CPU_SET)
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  for (std::size_t i = begin; i < end; ++i)
+  {
+    if (cpus_[i] >= CPU_SETSIZE)
+    {
+      ec = asio::error::invalid_argument;
+      ASIO_SYNC_OP_VOID_RETURN(ec);
+    }
+    CPU_SET(cpus_[i], &cpu_set);
+  }
+
+  int error = ::pthread_setaffinity_np(
+      ::pthread_self(), sizeof(cpu_set), &cpu_set);
+  if (error != 0)
+  {
+    ec = asio::error_code(error,
+        asio::error::get_system_category());
+    ASIO_SYNC_OP_VOID_RETURN(ec);
+  }
+
+# if defined(SYS_set_mempolicy)
+  // Prefer the node's memory for pages first touched by this thread. This is
+  // only a preference, so failure (e.g. where the call is not permitted) is
+  // not treated as an error.
+  if (numa_node_ >= 0)
+  {
+    const int mpol_preferred = 1;
+    const std::size_t bits_per_long = sizeof(unsigned long) * 8;
+    std::vector<unsigned long> node_mask(numa_node_ / bits_per_long + 1);
+    node_mask[numa_node_ / bits_per_long] =
+      1UL << (numa_node_ % bits_per_long);
+    ::syscall(SYS_set_mempolicy, mpol_preferred, &node_mask[0],
+        node_mask.size() * bits_per_long + 1);
+  }
+# endif // defined(SYS_set_mempolicy)
+
+  ec = asio::error_code();
+#else
+  (void)begin;
+  (void)end;
+  ec = asio::error::operation_not_supported;
+#endif
+
+  ASIO_SYNC_OP_VOID_RETURN(ec);
+}
+
+} // namespace asio
+
+#include "../detail/pop_options.hpp"
+
+#endif // ASIO_IMPL_THREAD_AFFINITY_IPP
@@ -16,6 +16,7 @@
 #endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
 
 #include "../detail/config.hpp"
+#include "../detail/affinity_thread_function.hpp"
 #include "../thread_pool.hpp"
 
 #include "../detail/push_options.hpp"
@@ -53,6 +54,19 @@ thread_pool::thread_pool(std::size_t num_threads)
   threads_.create_threads(f, num_threads);
 }
 
+thread_pool::thread_pool(std::size_t num_threads,
+    const thread_affinity& affinity)
+  : scheduler_(add_scheduler(new detail::scheduler(
+          *this, num_threads == 1 ? 1 : 0, false)))
+{
+  scheduler_.work_started();
+
+  thread_function f = { &scheduler_ };
+  for (std::size_t i = 0; i < num_threads; ++i)
+    threads_.create_thread(
+        detail::affinity_thread_function<thread_function>(f, affinity, i));
+}
+
 thread_pool::~thread_pool()
 {
   stop();
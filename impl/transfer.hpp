@@ -0,0 +1,654 @@
+//
+// impl/transfer.hpp
+// ~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2020 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_IMPL_TRANSFER_HPP
+#define ASIO_IMPL_TRANSFER_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include <limits>
+#include "../associated_allocator.hpp"
+#include "../associated_executor.hpp"
+#include "../detail/bind_handler.hpp"
+#include "../detail/descriptor_ops.hpp"
+#include "../detail/handler_alloc_helpers.hpp"
+#include "../detail/handler_cont_helpers.hpp"
+#include "../detail/handler_invoke_helpers.hpp"
+#include "../detail/handler_tracking.hpp"
+#include "../detail/handler_type_requirements.hpp"
+#include "../detail/memory.hpp"
+#include "../detail/noncopyable.hpp"
+#include "../detail/non_const_lvalue.hpp"
+#include "../detail/type_traits.hpp"
+#include "../error.hpp"
+#include "../post.hpp"
+
+#include "../detail/push_options.hpp"
+
+namespace asio {
+
+namespace detail
+{
+  // The kernel pipe through which a splice-based transfer moves its data. It
+  // is shared by the copies of the operation, and closed when the last of them
+  // is destroyed.
+  class transfer_pipe
+    : private noncopyable
+  {
+  public:
+    transfer_pipe()
+    {
+      descriptors_[0] = -1;
+      descriptors_[1] = -1;
+    }
+
+    ~transfer_pipe()
+    {
+      asio::error_code ignored_ec;
+      descriptor_ops::state_type state = 0;
+      if (descriptors_[0] != -1)
+        descriptor_ops::close(descriptors_[0], state, ignored_ec);
+      state = 0;
+      if (descriptors_[1] != -1)
+        descriptor_ops::close(descriptors_[1], state, ignored_ec);
+    }
+
+    void open(asio::error_code& ec)
+    {
+      descriptor_ops::create_pipe(descriptors_, ec);
+    }
+
+    int read_end() const
+    {
+      return descriptors_[0];
+    }
+
+    int write_end() const
+    {
+      return descriptors_[1];
+    }
+
+  private:
+    int descriptors_[2];
+  };
+
+  template <typename AsyncReadStream, typename AsyncWriteStream,
+      typename TransferHandler>
+  class transfer_op
+  {
+  public:
+    transfer_op(AsyncReadStream& source, AsyncWriteStream& destination,
+        std::size_t size, TransferHandler& handler)
+      : source_(source),
+        destination_(destination),
+        size_(size),
+        total_transferred_(0),
+        buffered_(0),
+        start_(0),
+        handler_(ASIO_MOVE_CAST(TransferHandler)(handler))
+    {
+    }
+
+#if defined(ASIO_HAS_MOVE)
+    transfer_op(const transfer_op& other)
+      : source_(other.source_),
+        destination_(other.destination_),
+        pipe_(other.pipe_),
+        size_(other.size_),
+        total_transferred_(other.total_transferred_),
+        buffered_(other.buffered_),
+        start_(other.start_),
+        handler_(other.handler_)
+    {
+    }
+
+    transfer_op(transfer_op&& other)
+      : source_(other.source_),
+        destination_(other.destination_),
+        pipe_(ASIO_MOVE_CAST(shared_ptr<transfer_pipe>)(other.pipe_)),
+        size_(other.size_),
+        total_transferred_(other.total_transferred_),
+        buffered_(other.buffered_),
+        start_(other.start_),
+        handler_(ASIO_MOVE_CAST(TransferHandler)(other.handler_))
+    {
+    }
+#endif // defined(ASIO_HAS_MOVE)
+
+    void operator()(asio::error_code ec, int start = 0)
+    {
+      if ((start_ = start) == 1)
+        open(ec);
+
+      if (!ec)
+      {
+        switch (transfer(ec))
+        {
+        case wait_for_source:
+          {
+            ASIO_HANDLER_LOCATION((__FILE__, __LINE__, "async_transfer"));
+            source_.async_wait(AsyncReadStream::wait_read,
+                ASIO_MOVE_CAST(transfer_op)(*this));
+          }
+          return;
+        case wait_for_destination:
+          {
+            ASIO_HANDLER_LOCATION((__FILE__, __LINE__, "async_transfer"));
+            destination_.async_wait(AsyncWriteStream::wait_write,
+                ASIO_MOVE_CAST(transfer_op)(*this));
+          }
+          return;
+        default:
+          break;
+        }
+      }
+
+      if (start_)
+      {
+        ASIO_HANDLER_LOCATION((__FILE__, __LINE__, "async_transfer"));
+        asio::post(destination_.get_executor(),
+            detail::bind_handler(ASIO_MOVE_CAST(transfer_op)(*this), ec));
+        return;
+      }
+
+      handler_(static_cast<const asio::error_code&>(ec),
+          static_cast<const std::size_t&>(total_transferred_));
+    }
+
+  //private:
+    // The default capacity of a pipe. The kernel rejects some splice lengths
+    // that are far larger than a pipe can hold.
+    enum { pipe_capacity = 65536 };
+
+    enum transfer_result
+    {
+      complete,
+      wait_for_source,
+      wait_for_destination
+    };
+
+    void open(asio::error_code& ec)
+    {
+      pipe_.reset(new transfer_pipe);
+      pipe_->open(ec);
+      if (!ec)
+        source_.native_non_blocking(true, ec);
+      if (!ec)
+        destination_.native_non_blocking(true, ec);
+    }
+
+    // Move as much data as possible without blocking. The pipe is refilled
+    // only once it is empty, so a splice into it that cannot proceed is always
+    // waiting for the source.
+    transfer_result transfer(asio::error_code& ec)
+    {
+      for (;;)
+      {
+        std::size_t bytes = 0;
+        if (buffered_ == 0)
+        {
+          if (total_transferred_ == size_)
+            return complete;
+
+          std::size_t max_size = size_ - total_transferred_;
+          if (max_size > pipe_capacity)
+            max_size = pipe_capacity;
+          if (!descriptor_ops::non_blocking_splice(source_.native_handle(),
+                pipe_->write_end(), max_size, ec, bytes))
+            return wait_for_source;
+          if (ec)
+            return complete;
+          if (bytes == 0)
+          {
+            if (size_ != (std::numeric_limits<std::size_t>::max)())
+              ec = asio::error::eof;
+            return complete;
+          }
+
+          buffered_ = bytes;
+        }
+        else
+        {
+          if (!descriptor_ops::non_blocking_splice(pipe_->read_end(),
+                destination_.native_handle(), buffered_, ec, bytes))
+            return wait_for_destination;
+          if (ec)
+            return complete;
+
+          buffered_ -= bytes;
+          total_transferred_ += bytes;
+        }
+      }
+    }
+
+    AsyncReadStream& source_;
+    AsyncWriteStream& destination_;
+    shared_ptr<transfer_pipe> pipe_;
+    std::size_t size_;
+    std::size_t total_transferred_;
+    std::size_t buffered_;
+    int start_;
+    TransferHandler handler_;
+  };
+
+  template <typename AsyncReadStream, typename AsyncWriteStream,
+      typename TransferHandler>
+  inline asio_handler_allocate_is_deprecated
+  asio_handler_allocate(std::size_t size,
+      transfer_op<AsyncReadStream, AsyncWriteStream,
+        TransferHandler>* this_handler)
+  {
+#if defined(ASIO_NO_DEPRECATED)
+    asio_handler_alloc_helpers::allocate(size, this_handler->handler_);
+    return asio_handler_allocate_is_no_longer_used();
+#else // defined(ASIO_NO_DEPRECATED)
+    return asio_handler_alloc_helpers::allocate(
+        size, this_handler->handler_);
+#endif // defined(ASIO_NO_DEPRECATED)
+  }
+
+  template <typename AsyncReadStream, typename AsyncWriteStream,
+      typename TransferHandler>
+  inline asio_handler_deallocate_is_deprecated
+  asio_handler_deallocate(void* pointer, std::size_t size,
+      transfer_op<AsyncReadStream, AsyncWriteStream,
+        TransferHandler>* this_handler)
+  {
+    asio_handler_alloc_helpers::deallocate(
+        pointer, size, this_handler->handler_);
+#if defined(ASIO_NO_DEPRECATED)
+    return asio_handler_deallocate_is_no_longer_used();
+#endif // defined(ASIO_NO_DEPRECATED)
+  }
+
+  template <typename AsyncReadStream, typename AsyncWriteStream,
+      typename TransferHandler>
+  inline bool asio_handler_is_continuation(
+      transfer_op<AsyncReadStream, AsyncWriteStream,
+        TransferHandler>* this_handler)
+  {
+    return this_handler->start_ == 0 ? true
+      : asio_handler_cont_helpers::is_continuation(
+          this_handler->handler_);
+  }
+
+  template <typename Function, typename AsyncReadStream,
+      typename AsyncWriteStream, typename TransferHandler>
+  inline asio_handler_invoke_is_deprecated
+  asio_handler_invoke(Function& function,
+      transfer_op<AsyncReadStream, AsyncWriteStream,
+        TransferHandler>* this_handler)
+  {
+    asio_handler_invoke_helpers::invoke(
+        function, this_handler->handler_);
+#if defined(ASIO_NO_DEPRECATED)
+    return asio_handler_invoke_is_no_longer_used();
+#endif // defined(ASIO_NO_DEPRECATED)
+  }
+
+  template <typename Function, typename AsyncReadStream,
+      typename AsyncWriteStream, typename TransferHandler>
+  inline asio_handler_invoke_is_deprecated
+  asio_handler_invoke(const Function& function,
+      transfer_op<AsyncReadStream, AsyncWriteStream,
+        TransferHandler>* this_handler)
+  {
+    asio_handler_invoke_helpers::invoke(
+        function, this_handler->handler_);
+#if defined(ASIO_NO_DEPRECATED)
+    return asio_handler_invoke_is_no_longer_used();
+#endif // defined(ASIO_NO_DEPRECATED)
+  }
+
+  template <typename AsyncReadStream, typename AsyncWriteStream>
+  class initiate_async_transfer
+  {
+  public:
+    typedef typename AsyncWriteStream::executor_type executor_type;
+
+    initiate_async_transfer(AsyncReadStream& source,
+        AsyncWriteStream& destination)
+      : source_(source),
+        destination_(destination)
+    {
+    }
+
+    executor_type get_executor() const ASIO_NOEXCEPT
+    {
+      return destination_.get_executor();
+    }
+
+    template <typename TransferHandler>
+    void operator()(ASIO_MOVE_ARG(TransferHandler) handler,
+        std::size_t size) const
+    {
+      // If you get an error on the following line it means that your handler
+      // does not meet the documented type requirements for a WriteHandler.
+      ASIO_WRITE_HANDLER_CHECK(TransferHandler, handler) type_check;
+
+      non_const_lvalue<TransferHandler> handler2(handler);
+      transfer_op<AsyncReadStream, AsyncWriteStream,
+        typename decay<TransferHandler>::type>(
+          source_, destination_, size, handler2.value)(
+            asio::error_code(), 1);
+    }
+
+  private:
+    AsyncReadStream& source_;
+    AsyncWriteStream& destination_;
+  };
+
+  template <typename AsyncWriteStream, typename TransferHandler>
+  class transfer_file_op
+  {
+  public:
+    transfer_file_op(int file, uint64_t offset, std::size_t size,
+        AsyncWriteStream& destination, TransferHandler& handler)
+      : file_(file),
+        offset_(offset),
+        size_(size),
+        total_transferred_(0),
+        destination_(destination),
+        start_(0),
+        handler_(ASIO_MOVE_CAST(TransferHandler)(handler))
+    {
+    }
+
+#if defined(ASIO_HAS_MOVE)
+    transfer_file_op(const transfer_file_op& other)
+      : file_(other.file_),
+        offset_(other.offset_),
+        size_(other.size_),
+        total_transferred_(other.total_transferred_),
+        destination_(other.destination_),
+        start_(other.start_),
+        handler_(other.handler_)
+    {
+    }
+
+    transfer_file_op(transfer_file_op&& other)
+      : file_(other.file_),
+        offset_(other.offset_),
+        size_(other.size_),
+        total_transferred_(other.total_transferred_),
+        destination_(other.destination_),
+        start_(other.start_),
+        handler_(ASIO_MOVE_CAST(TransferHandler)(other.handler_))
+    {
+    }
+#endif // defined(ASIO_HAS_MOVE)
+
+    void operator()(asio::error_code ec, int start = 0)
+    {
+      if ((start_ = start) == 1)
+        destination_.native_non_blocking(true, ec);
+
+      if (!ec && !transfer(ec))
+      {
+        {
+          ASIO_HANDLER_LOCATION((__FILE__, __LINE__, "async_transfer_file"));
+          destination_.async_wait(AsyncWriteStream::wait_write,
+              ASIO_MOVE_CAST(transfer_file_op)(*this));
+        }
+        return;
+      }
+
+      if (start_)
+      {
+        ASIO_HANDLER_LOCATION((__FILE__, __LINE__, "async_transfer_file"));
+        asio::post(destination_.get_executor(),
+            detail::bind_handler(
+              ASIO_MOVE_CAST(transfer_file_op)(*this), ec));
+        return;
+      }
+
+      handler_(static_cast<const asio::error_code&>(ec),
+          static_cast<const std::size_t&>(total_transferred_));
+    }
+
+  //private:
+    // Send as much data as possible without blocking. Returns false if the
+    // operation must wait for the destination to become writable.
+    bool transfer(asio::error_code& ec)
+    {
+      while (total_transferred_ < size_)
+      {
+        std::size_t bytes = 0;
+        if (!descriptor_ops::non_blocking_sendfile(
+              destination_.native_handle(), file_, offset_,
+              size_ - total_transferred_, ec, bytes))
+          return false;
+        if (ec)
+          return true;
+        if (bytes == 0)
+        {
+          ec = asio::error::eof;
+          return true;
+        }
+        total_transferred_ += bytes;
+      }
+      return true;
+    }
+
+    int file_;
+    uint64_t offset_;
+    std::size_t size_;
+    std::size_t total_transferred_;
+    AsyncWriteStream& destination_;
+    int start_;
+    TransferHandler handler_;
+  };
+
+  template <typename AsyncWriteStream, typename TransferHandler>
+  inline asio_handler_allocate_is_deprecated
+  asio_handler_allocate(std::size_t size,
+      transfer_file_op<AsyncWriteStream, TransferHandler>* this_handler)
+  {
+#if defined(ASIO_NO_DEPRECATED)
+    asio_handler_alloc_helpers::allocate(size, this_handler->handler_);
+    return asio_handler_allocate_is_no_longer_used();
+#else // defined(ASIO_NO_DEPRECATED)
+    return asio_handler_alloc_helpers::allocate(
+        size, this_handler->handler_);
+#endif // defined(ASIO_NO_DEPRECATED)
+  }
+
+  template <typename AsyncWriteStream, typename TransferHandler>
+  inline asio_handler_deallocate_is_deprecated
+  asio_handler_deallocate(void* pointer, std::size_t size,
+      transfer_file_op<AsyncWriteStream, TransferHandler>* this_handler)
+  {
+    asio_handler_alloc_helpers::deallocate(
+        pointer, size, this_handler->handler_);
+#if defined(ASIO_NO_DEPRECATED)
+    return asio_handler_deallocate_is_no_longer_used();
+#endif // defined(ASIO_NO_DEPRECATED)
+  }
+
+  template <typename AsyncWriteStream, typename TransferHandler>
+  inline bool asio_handler_is_continuation(
+      transfer_file_op<AsyncWriteStream, TransferHandler>* this_handler)
+  {
+    return this_handler->start_ == 0 ? true
+      : asio_handler_cont_helpers::is_continuation(
+          this_handler->handler_);
+  }
+
+  template <typename Function, typename AsyncWriteStream,
+      typename TransferHandler>
+  inline asio_handler_invoke_is_deprecated
+  asio_handler_invoke(Function& function,
+      transfer_file_op<AsyncWriteStream, TransferHandler>* this_handler)
+  {
+    asio_handler_invoke_helpers::invoke(
+        function, this_handler->handler_);
+#if defined(ASIO_NO_DEPRECATED)
+    return asio_handler_invoke_is_no_longer_used();
+#endif // defined(ASIO_NO_DEPRECATED)
+  }
+
+  template <typename Function, typename AsyncWriteStream,
+      typename TransferHandler>
+  inline asio_handler_invoke_is_deprecated
+  asio_handler_invoke(const Function& function,
+      transfer_file_op<AsyncWriteStream, TransferHandler>* this_handler)
+  {
+    asio_handler_invoke_helpers::invoke(
+        function, this_handler->handler_);
+#if defined(ASIO_NO_DEPRECATED)
+    return asio_handler_invoke_is_no_longer_used();
+#endif // defined(ASIO_NO_DEPRECATED)
+  }
+
+  template <typename AsyncWriteStream>
+  class initiate_async_transfer_file
+  {
+  public:
+    typedef typename AsyncWriteStream::executor_type executor_type;
+
+    explicit initiate_async_transfer_file(AsyncWriteStream& destination)
+      : destination_(destination)
+    {
+    }
+
+    executor_type get_executor() const ASIO_NOEXCEPT
+    {
+      return destination_.get_executor();
+    }
+
+    template <typename TransferHandler>
+    void operator()(ASIO_MOVE_ARG(TransferHandler) handler,
+        int file, uint64_t offset, std::size_t size) const
+    {
+      // If you get an error on the following line it means that your handler
+      // does not meet the documented type requirements for a WriteHandler.
+      ASIO_WRITE_HANDLER_CHECK(TransferHandler, handler) type_check;
+
+      non_const_lvalue<TransferHandler> handler2(handler);
+      transfer_file_op<AsyncWriteStream,
+        typename decay<TransferHandler>::type>(
+          file, offset, size, destination_, handler2.value)(
+            asio::error_code(), 1);
+    }
+
+  private:
+    AsyncWriteStream& destination_;
+  };
+} // namespace detail
+
+#if !defined(GENERATING_DOCUMENTATION)
+
+template <typename AsyncReadStream, typename AsyncWriteStream,
+    typename TransferHandler, typename Allocator>
+struct associated_allocator<
+    detail::transfer_op<AsyncReadStream, AsyncWriteStream, TransferHandler>,
+    Allocator>
+{
+  typedef typename associated_allocator<TransferHandler, Allocator>::type type;
+
+  static type get(
+      const detail::transfer_op<AsyncReadStream,
+        AsyncWriteStream, TransferHandler>& h,
+      const Allocator& a = Allocator()) ASIO_NOEXCEPT
+  {
+    return associated_allocator<TransferHandler, Allocator>::get(
+        h.handler_, a);
+  }
+};
+
+template <typename AsyncReadStream, typename AsyncWriteStream,
+    typename TransferHandler, typename Executor>
+struct associated_executor<
+    detail::transfer_op<AsyncReadStream, AsyncWriteStream, TransferHandler>,
+    Executor>
+{
+  typedef typename associated_executor<TransferHandler, Executor>::type type;
+
+  static type get(
+      const detail::transfer_op<AsyncReadStream,
+        AsyncWriteStream, TransferHandler>& h,
+      const Executor& ex = Executor()) ASIO_NOEXCEPT
+  {
+    return associated_executor<TransferHandler, Executor>::get(
+        h.handler_, ex);
+  }
+};
+
+template <typename AsyncWriteStream,
+    typename TransferHandler, typename Allocator>
+struct associated_allocator<
+    detail::transfer_file_op<AsyncWriteStream, TransferHandler>,
+    Allocator>
+{
+  typedef typename associated_allocator<TransferHandler, Allocator>::type type;
+
+  static type get(
+      const detail::transfer_file_op<AsyncWriteStream, TransferHandler>& h,
+      const Allocator& a = Allocator()) ASIO_NOEXCEPT
+  {
+    return associated_allocator<TransferHandler, Allocator>::get(
+        h.handler_, a);
+  }
+};
+
+template <typename AsyncWriteStream,
+    typename TransferHandler, typename Executor>
+struct associated_executor<
+    detail::transfer_file_op<AsyncWriteStream, TransferHandler>,
+    Executor>
+{
+  typedef typename associated_executor<TransferHandler, Executor>::type type;
+
+  static type get(
+      const detail::transfer_file_op<AsyncWriteStream, TransferHandler>& h,
+      const Executor& ex = Executor()) ASIO_NOEXCEPT
+  {
+    return associated_executor<TransferHandler, Executor>::get(
+        h.handler_, ex);
+  }
+};
+
+#endif // !defined(GENERATING_DOCUMENTATION)
+
+template <typename AsyncReadStream, typename AsyncWriteStream,
+    ASIO_COMPLETION_TOKEN_FOR(void (asio::error_code,
+      std::size_t)) TransferHandler>
+inline ASIO_INITFN_AUTO_RESULT_TYPE(TransferHandler,
+    void (asio::error_code, std::size_t))
+async_transfer(AsyncReadStream& source, AsyncWriteStream& destination,
+    std::size_t size, ASIO_MOVE_ARG(TransferHandler) handler)
+{
+  return async_initiate<TransferHandler,
+    void (asio::error_code, std::size_t)>(
+      detail::initiate_async_transfer<AsyncReadStream, AsyncWriteStream>(
+        source, destination), handler, size);
+}
+
+template <typename AsyncWriteStream,
+    ASIO_COMPLETION_TOKEN_FOR(void (asio::error_code,
+      std::size_t)) TransferHandler>
+inline ASIO_INITFN_AUTO_RESULT_TYPE(TransferHandler,
+    void (asio::error_code, std::size_t))
+async_transfer_file(int file, uint64_t offset, std::size_t size,
+    AsyncWriteStream& destination, ASIO_MOVE_ARG(TransferHandler) handler)
+{
+  return async_initiate<TransferHandler,
+    void (asio::error_code, std::size_t)>(
+      detail::initiate_async_transfer_file<AsyncWriteStream>(destination),
+      handler, file, offset, size);
+}
+
+} // namespace asio
+
+#include "../detail/pop_options.hpp"
+
+#endif // ASIO_IMPL_TRANSFER_HPP
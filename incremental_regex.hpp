@@ -0,0 +1,167 @@
+//
+// incremental_regex.hpp
+// ~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2020 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_INCREMENTAL_REGEX_HPP
+#define ASIO_INCREMENTAL_REGEX_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "detail/config.hpp"
+
+#if defined(ASIO_HAS_BOOST_REGEX) \
+  || defined(GENERATING_DOCUMENTATION)
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include <boost/regex.hpp>
+#include "detail/cstdint.hpp"
+#include "detail/limits.hpp"
+#include "detail/memory.hpp"
+
+#include "detail/push_options.hpp"
+
+namespace asio {
+
+/// A regular expression match condition that limits how much data is
+/// searched again after each read.
+/**
+ * When read_until is given a regular expression and the data ends with a
+ * partial match, the next search after more data arrives starts from the
+ * beginning of the partial match. A partial match that keeps growing, such as
+ * a long record that has not yet been terminated, is therefore searched again
+ * in full after every read, at a cost that grows with the square of its
+ * length.
+ *
+ * The incremental_regex class is a match condition for read_until and
+ * async_read_until that bounds this cost. When the data ends with a partial
+ * match, the next search resumes from the beginning of the partial match or
+ * @c lookback bytes before the end of the data already searched, whichever
+ * is later. Data that is not part of a partial match is never searched
+ * again. Each search therefore examines at most @c lookback bytes in
+ * addition to the data that has arrived since the previous search.
+ *
+ * A match that would have started before the resume position is instead
+ * found starting at that position, if the expression matches there. Since
+ * read_until returns the position of the end of the match, the result is
+ * unaffected for an expression that describes the end of a record, such as
+ * <tt>"\\r\\n\\r\\n"</tt>, provided that @c lookback is at least the length
+ * of that ending. An expression that must match from the start of a record
+ * requires a @c lookback no less than the longest such record.
+ *
+ * Copies of an incremental_regex share a count of the bytes searched, which
+ * may be used to measure the cost of each call to read_until.
+ *
+ * @par Thread Safety
+ * @e Distinct @e objects: Safe.@n
+ * @e Shared @e objects: Unsafe. Copies of an object are treated as the same
+ * object.
+ *
+ * @par Example
+ * Reading lines that may be very long:
+ * @code asio::incremental_regex expr(boost::regex("\r?\n"), 2);
+ * std::uint64_t before = expr.bytes_scanned();
+ * std::size_t n = asio::read_until(sock, asio::dynamic_buffer(data), expr);
+ * std::uint64_t scanned = expr.bytes_scanned() - before; @endcode
+ */
+class incremental_regex
+{
+public:
+  /// The result type of the match condition. Required by is_match_condition.
+  typedef bool result_type;
+
+  /// Construct a match condition from a regular expression.
+  /**
+   * @param expr The regular expression to be matched.
+   *
+   * @param lookback The maximum number of bytes, before the end of the data
+   * already searched, from which a search is resumed. The default imposes no
+   * limit, which gives the same results as passing the regular expression
+   * to read_until directly.
+   */
+  explicit incremental_regex(const boost::regex& expr,
+      std::size_t lookback = (std::numeric_limits<std::size_t>::max)())
+    : expr_(expr),
+      lookback_(lookback),
+      bytes_scanned_(new uint64_t(0))
+  {
+  }
+
+  /// Get the regular expression.
+  const boost::regex& expression() const
+  {
+    return expr_;
+  }
+
+  /// Get the maximum number of bytes from which a search is resumed.
+  std::size_t lookback() const
+  {
+    return lookback_;
+  }
+
+  /// Get the total number of bytes searched by this object and its copies.
+  uint64_t bytes_scanned() const
+  {
+    return *bytes_scanned_;
+  }
+
+  /// Search a range of bytes for a match.
+  /**
+   * This function implements the match condition requirements of read_until.
+   * The iterator type must be a random access iterator whose value type is
+   * convertible to @c char, such as buffers_iterator.
+   *
+   * @returns <tt>(i, true)</tt> if a match was found, where @c i refers to
+   * the end of the match. Returns <tt>(i, false)</tt> if the range ends with
+   * a partial match, where @c i refers to the position from which the next
+   * search should resume. Otherwise returns <tt>(end, false)</tt>.
+   */
+  template <typename Iterator>
+  std::pair<Iterator, bool> operator()(Iterator begin, Iterator end) const
+  {
+    *bytes_scanned_ += static_cast<uint64_t>(end - begin);
+
+    boost::match_results<Iterator,
+      typename std::vector<boost::sub_match<Iterator> >::allocator_type>
+        match_results;
+    if (!regex_search(begin, end, match_results, expr_,
+          boost::match_default | boost::match_partial))
+      return std::make_pair(end, false);
+
+    if (match_results[0].matched)
+      return std::make_pair(match_results[0].second, true);
+
+    Iterator resume = match_results[0].first;
+    if (static_cast<std::size_t>(end - resume) > lookback_)
+      resume = end - static_cast<std::ptrdiff_t>(lookback_);
+    return std::make_pair(resume, false);
+  }
+
+private:
+  // The regular expression.
+  boost::regex expr_;
+
+  // The maximum number of bytes from which a search is resumed.
+  std::size_t lookback_;
+
+  // The number of bytes searched, shared between copies.
+  detail::shared_ptr<uint64_t> bytes_scanned_;
+};
+
+} // namespace asio
+
+#include "detail/pop_options.hpp"
+
+#endif // defined(ASIO_HAS_BOOST_REGEX)
+       //   || defined(GENERATING_DOCUMENTATION)
+
+#endif // ASIO_INCREMENTAL_REGEX_HPP
@@ -20,9 +20,11 @@
 #include <stdexcept>
 #include <typeinfo>
 #include "async_result.hpp"
+#include "detail/cstdint.hpp"
 #include "detail/wrapped_handler.hpp"
 #include "error_code.hpp"
 #include "execution_context.hpp"
+#include "io_context_options.hpp"
 
 #if defined(ASIO_HAS_CHRONO)
 #include "detail/chrono.hpp"
@@ -213,6 +215,15 @@ public:
    */
   ASIO_DECL explicit io_context(int concurrency_hint);
 
+  /// Constructor.
+  /**
+   * Construct with a set of options that tune the implementation.
+   *
+   * @param options The options used to configure the io_context, including
+   * the concurrency hint.
+   */
+  ASIO_DECL explicit io_context(const io_context_options& options);
+
   /// Destructor.
   /**
    * On destruction, the io_context performs the following sequence of
@@ -493,6 +504,86 @@ public:
    */
   ASIO_DECL void restart();
 
+  /// Get the number of events returned by the most recent reactor wait.
+  /**
+   * When the io_context uses epoll, this is the number of readiness events
+   * returned by the most recent call to @c epoll_wait. Returns 0 for other
+   * reactor implementations, or if the reactor has not yet been created.
+   *
+   * This function may be called from any thread.
+   */
+  ASIO_DECL std::size_t reactor_event_count() const;
+
+  /// Get the number of events that the next reactor wait may return.
+  /**
+   * When the io_context uses epoll, this is the maximum number of readiness
+   * events that the next call to @c epoll_wait may return. It is fixed by the
+   * io_context_options::reactor_batch_size() option, unless
+   * io_context_options::adaptive_reactor_batch() is set. Returns 0 for other
+   * reactor implementations, or if the reactor has not yet been created.
+   *
+   * This function may be called from any thread.
+   */
+  ASIO_DECL std::size_t reactor_batch_size() const;
+
+  /// Get the total time that threads have spent busy polling for work.
+  /**
+   * Returns the total time, in microseconds, that threads running the
+   * io_context have spent polling the reactor without blocking. Returns 0
+   * unless busy polling is enabled by the
+   * io_context_options::busy_poll_usec() option.
+   *
+   * This function may be called from any thread.
+   */
+  ASIO_DECL uint64_t busy_poll_spin_usec() const;
+
+  /// Get the total time that threads have spent blocked after busy polling.
+  /**
+   * Returns the total time, in microseconds, that threads running the
+   * io_context have spent blocked in the reactor after busy polling found no
+   * work. Returns 0 unless busy polling is enabled by the
+   * io_context_options::busy_poll_usec() option.
+   *
+   * This function may be called from any thread.
+   */
+  ASIO_DECL uint64_t busy_poll_block_usec() const;
+
+  /// Release memory that the io_context retains for reuse.
+  /**
+   * The io_context keeps some of the memory it allocates for each socket or
+   * descriptor after the object is closed, so that it can be reused. This
+   * function releases memory that is no longer needed, and may be called when
+   * the io_context is idle after a burst of activity. The memory is released
+   * asynchronously, by a thread that is running the io_context. Currently
+   * only the epoll reactor releases memory.
+   *
+   * With the default options, a descriptor that is closed is not removed
+   * from the reactor explicitly, which saves a system call, and so its
+   * memory cannot be released. Once this function has been called, closed
+   * descriptors are removed explicitly, and their memory is released by the
+   * next call.
+   *
+   * The amount of memory retained may also be bounded by the
+   * io_context_options::max_free_descriptor_states() option.
+   */
+  ASIO_DECL void trim();
+
+  /// Get the number of bytes currently allocated from the handler memory
+  /// arena.
+  /**
+   * Returns 0 unless the arena is enabled by the
+   * io_context_options::handler_arena_blocks() option.
+   */
+  ASIO_DECL std::size_t arena_bytes_allocated() const;
+
+  /// Get the largest number of bytes that have been allocated from the
+  /// handler memory arena at one time.
+  /**
+   * Returns 0 unless the arena is enabled by the
+   * io_context_options::handler_arena_blocks() option.
+   */
+  ASIO_DECL std::size_t arena_peak_bytes_allocated() const;
+
 #if !defined(ASIO_NO_DEPRECATED)
   /// (Deprecated: Use restart().) Reset the io_context in preparation for a
   /// subsequent run() invocation.
@@ -0,0 +1,275 @@
+//
+// io_context_options.hpp
+// ~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2020 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_IO_CONTEXT_OPTIONS_HPP
+#define ASIO_IO_CONTEXT_OPTIONS_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "detail/config.hpp"
+#include <cstddef>
+#include "detail/concurrency_hint.hpp"
+#include "detail/limits.hpp"
+
+#include "detail/push_options.hpp"
+
+namespace asio {
+
+/// Options used to configure an io_context when it is constructed.
+/**
+ * The setters return a reference to the object, so that options may be
+ * chained:
+ *
+ * @code asio::io_context io_context(
+ *     asio::io_context_options()
+ *       .concurrency_hint(4)
+ *       .reactor_batch_size(512)); @endcode
+ *
+ * Options that do not apply to the platform's implementation are ignored.
+ */
+class io_context_options
+{
+public:
+  /// Construct with the default options.
+  io_context_options()
+    : concurrency_hint_(ASIO_CONCURRENCY_HINT_DEFAULT),
+      reactor_batch_size_(128),
+      max_reactor_batch_size_(4096),
+      adaptive_reactor_batch_(false),
+      busy_poll_usec_(0),
+      socket_busy_poll_usec_(0),
+      timer_slack_usec_(0),
+      handler_arena_blocks_(0),
+      max_free_descriptor_states_((std::numeric_limits<std::size_t>::max)()),
+      gather_flatten_size_(0)
+  {
+  }
+
+  /// Get the hint about the required level of concurrency.
+  int concurrency_hint() const
+  {
+    return concurrency_hint_;
+  }
+
+  /// Set the hint about the required level of concurrency.
+  io_context_options& concurrency_hint(int hint)
+  {
+    concurrency_hint_ = hint;
+    return *this;
+  }
+
+  /// Get the number of readiness events the reactor fetches from the kernel
+  /// in each call.
+  std::size_t reactor_batch_size() const
+  {
+    return reactor_batch_size_;
+  }
+
+  /// Set the number of readiness events the reactor fetches from the kernel
+  /// in each call.
+  /**
+   * When adaptive batching is enabled this is the smallest batch size that
+   * the reactor will use. Defaults to 128.
+   */
+  io_context_options& reactor_batch_size(std::size_t n)
+  {
+    reactor_batch_size_ = n;
+    return *this;
+  }
+
+  /// Get the largest batch size used when adaptive batching is enabled.
+  std::size_t max_reactor_batch_size() const
+  {
+    return max_reactor_batch_size_;
+  }
+
+  /// Set the largest batch size used when adaptive batching is enabled.
+  /**
+   * Defaults to 4096.
+   */
+  io_context_options& max_reactor_batch_size(std::size_t n)
+  {
+    max_reactor_batch_size_ = n;
+    return *this;
+  }
+
+  /// Get whether the reactor adapts its batch size to the load.
+  bool adaptive_reactor_batch() const
+  {
+    return adaptive_reactor_batch_;
+  }
+
+  /// Set whether the reactor adapts its batch size to the load.
+  /**
+   * When enabled, the batch size is doubled each time a call fills the whole
+   * batch, and halved each time a call returns less than a quarter of it.
+   * Defaults to false.
+   */
+  io_context_options& adaptive_reactor_batch(bool enabled)
+  {
+    adaptive_reactor_batch_ = enabled;
+    return *this;
+  }
+
+  /// Get the time, in microseconds, that a thread polls for work before it
+  /// blocks.
+  long busy_poll_usec() const
+  {
+    return busy_poll_usec_;
+  }
+
+  /// Set the time, in microseconds, that a thread polls for work before it
+  /// blocks.
+  /**
+   * When non-zero, a thread that runs the reactor with no handlers ready
+   * repeatedly polls both the reactor and the handler queue, without
+   * blocking, for up to this long. Only then does it block waiting for
+   * events. This trades CPU time for lower wakeup latency. Has no effect
+   * unless std::chrono is available. Defaults to 0.
+   */
+  io_context_options& busy_poll_usec(long usec)
+  {
+    busy_poll_usec_ = usec;
+    return *this;
+  }
+
+  /// Get the value of the @c SO_BUSY_POLL option applied to sockets.
+  int socket_busy_poll_usec() const
+  {
+    return socket_busy_poll_usec_;
+  }
+
+  /// Set the value of the @c SO_BUSY_POLL option applied to sockets.
+  /**
+   * When non-zero, each stream and datagram socket opened or assigned on the
+   * io_context has its @c SO_BUSY_POLL option set to this many microseconds.
+   * Failure to set the option is ignored. Has no effect on platforms that do
+   * not support the option. Defaults to 0.
+   */
+  io_context_options& socket_busy_poll_usec(int usec)
+  {
+    socket_busy_poll_usec_ = usec;
+    return *this;
+  }
+
+  /// Get the time, in microseconds, by which timers may complete late.
+  long timer_slack_usec() const
+  {
+    return timer_slack_usec_;
+  }
+
+  /// Set the time, in microseconds, by which timers may complete late.
+  /**
+   * By default the reactor wakes as soon as the earliest timer expires. When
+   * a slack is set, it may instead wake up to this long afterwards, and then
+   * completes every timer that has expired by that time. Timers that expire
+   * close together are therefore handled by a single wakeup, and the
+   * reactor's own timer is reprogrammed less often. Timers never complete
+   * before their expiry time. Currently only honoured by the epoll reactor.
+   * Defaults to 0.
+   */
+  io_context_options& timer_slack_usec(long usec)
+  {
+    timer_slack_usec_ = usec;
+    return *this;
+  }
+
+  /// Get the number of blocks of each size in the handler memory arena.
+  std::size_t handler_arena_blocks() const
+  {
+    return handler_arena_blocks_;
+  }
+
+  /// Set the number of blocks of each size in the handler memory arena.
+  /**
+   * When non-zero, the io_context reserves a fixed amount of memory when it
+   * is constructed, divided into this many blocks of each of the sizes 64,
+   * 128, 256, 512, 1024 and 2048 bytes. Memory for asynchronous operations
+   * and handlers started by threads running the io_context is then allocated
+   * from these blocks. An allocation that is too large, or for which no
+   * block is free, uses the usual per-thread cache instead. The memory in use
+   * is reported by io_context::arena_bytes_allocated() and
+   * io_context::arena_peak_bytes_allocated(). Not supported by the Windows
+   * I/O completion port implementation. Defaults to 0.
+   */
+  io_context_options& handler_arena_blocks(std::size_t n)
+  {
+    handler_arena_blocks_ = n;
+    return *this;
+  }
+
+  /// Get the number of freed per-descriptor reactor objects that are retained
+  /// for reuse.
+  std::size_t max_free_descriptor_states() const
+  {
+    return max_free_descriptor_states_;
+  }
+
+  /// Set the number of freed per-descriptor reactor objects that are retained
+  /// for reuse.
+  /**
+   * The reactor keeps an object for each registered descriptor. When a
+   * descriptor is closed its object is kept for reuse by a later descriptor.
+   * By default every such object is retained until the io_context is
+   * destroyed, so memory use remains at its peak after a burst of
+   * connections. When a limit is set, objects beyond it are destroyed and
+   * their memory is released. This requires each descriptor to be removed
+   * from the reactor explicitly as it is closed, which costs an additional
+   * system call. Objects may also be released on demand by calling
+   * io_context::trim(). Currently only honoured by the epoll reactor.
+   */
+  io_context_options& max_free_descriptor_states(std::size_t n)
+  {
+    max_free_descriptor_states_ = n;
+    return *this;
+  }
+
+  /// Get the size below which buffers in a gather send are copied.
+  std::size_t gather_flatten_size() const
+  {
+    return gather_flatten_size_;
+  }
+
+  /// Set the size below which buffers in a gather send are copied.
+  /**
+   * Each buffer passed to the kernel in a gather send costs it some work, so
+   * for buffers of a few bytes it is cheaper to copy the data. When non-zero,
+   * a socket send of a buffer sequence copies runs of adjacent buffers smaller
+   * than this many bytes into a single buffer, up to 4096 bytes per send. A
+   * small buffer that has no small neighbour is not copied. Has no effect on
+   * zero-copy sends, or with the Windows I/O completion port implementation.
+   * Defaults to 0.
+   */
+  io_context_options& gather_flatten_size(std::size_t n)
+  {
+    gather_flatten_size_ = n;
+    return *this;
+  }
+
+private:
+  int concurrency_hint_;
+  std::size_t reactor_batch_size_;
+  std::size_t max_reactor_batch_size_;
+  bool adaptive_reactor_batch_;
+  long busy_poll_usec_;
+  int socket_busy_poll_usec_;
+  long timer_slack_usec_;
+  std::size_t handler_arena_blocks_;
+  std::size_t max_free_descriptor_states_;
+  std::size_t gather_flatten_size_;
+};
+
+} // namespace asio
+
+#include "detail/pop_options.hpp"
+
+#endif // ASIO_IO_CONTEXT_OPTIONS_HPP
@@ -0,0 +1,268 @@
+//
+// io_context_pool.hpp
+// ~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2020 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_IO_CONTEXT_POOL_HPP
+#define ASIO_IO_CONTEXT_POOL_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "detail/config.hpp"
+#include <cstddef>
+#include <vector>
+#include "basic_socket_acceptor.hpp"
+#include "detail/atomic_count.hpp"
+#include "detail/memory.hpp"
+#include "detail/noncopyable.hpp"
+#include "detail/thread_group.hpp"
+#include "error_code.hpp"
+#include "io_context.hpp"
+#include "io_context_options.hpp"
+#include "socket_base.hpp"
+#include "thread_affinity.hpp"
+
+#include "detail/push_options.hpp"
+
+namespace asio {
+
+/// A fixed-size pool of io_context objects, each run by its own thread.
+/**
+ * The io_context_pool class provides one io_context per thread, rather than
+ * many threads sharing a single io_context. Work that is started on one of
+ * the pool's io_context objects is only ever performed by that io_context's
+ * thread, so that the state associated with the work stays on one core.
+ *
+ * @par Sharded acceptors
+ *
+ * Where the platform supports the @c SO_REUSEPORT socket option, the pool can
+ * open one listening acceptor per io_context, all bound to the same endpoint.
+ * The operating system then distributes incoming connections between them.
+ * An acceptor's asynchronous accept operations create each new socket on the
+ * acceptor's own io_context, so an accepted connection is handled by the same
+ * thread that accepted it.
+ *
+ * For example:
+ *
+ * @code asio::io_context_pool pool(4);
+ *
+ * std::vector<asio::ip::tcp::acceptor> acceptors =
+ *   pool.make_reuseport_acceptors(
+ *       asio::ip::tcp::endpoint(asio::ip::tcp::v4(), 8080));
+ *
+ * for (std::size_t i = 0; i < acceptors.size(); ++i)
+ *   start_accept(acceptors[i]);
+ *
+ * pool.join(); @endcode
+ *
+ * @par Distributing other work
+ *
+ * Work that is not tied to an acceptor, such as outgoing connections, may be
+ * given to an io_context chosen by the get_io_context() function.
+ */
+class io_context_pool
+  : private noncopyable
+{
+public:
+  /// The policy used to choose an io_context for new work.
+  enum selection_type
+  {
+    /// Choose each io_context in turn.
+    round_robin,
+
+    /// Choose the io_context that has the least outstanding work.
+    least_loaded
+  };
+
+  /// Constructs a pool with one io_context per hardware thread.
+  ASIO_DECL io_context_pool();
+
+  /// Constructs a pool with a specified number of io_context objects.
+  ASIO_DECL explicit io_context_pool(std::size_t pool_size);
+
+  /// Constructs a pool with a specified number of io_context objects, each of
+  /// which is created with the specified options.
+  ASIO_DECL io_context_pool(std::size_t pool_size,
+      const io_context_options& options);
+
+  /// Constructs a pool with a specified number of io_context objects, whose
+  /// threads are bound to the specified CPUs.
+  /**
+   * The thread of the io_context at position @c i in the pool is the @c i'th
+   * thread to use the affinity. When the affinity distributes threads, each
+   * io_context is therefore run on its own CPU.
+   */
+  ASIO_DECL io_context_pool(std::size_t pool_size,
+      const thread_affinity& affinity);
+
+  /// Constructs a pool with a specified number of io_context objects, each of
+  /// which is created with the specified options, and whose threads are bound
+  /// to the specified CPUs.
+  ASIO_DECL io_context_pool(std::size_t pool_size,
+      const io_context_options& options, const thread_affinity& affinity);
+
+  /// Destructor.
+  /**
+   * Automatically stops and joins the pool, if not explicitly done beforehand.
+   * The io_context objects are then destroyed.
+   */
+  ASIO_DECL ~io_context_pool();
+
+  /// Get the number of io_context objects in the pool.
+  std::size_t size() const
+  {
+    return contexts_.size();
+  }
+
+  /// Get the io_context at the specified position in the pool.
+  io_context& get_io_context(std::size_t index)
+  {
+    return *contexts_[index];
+  }
+
+  /// Choose an io_context for new work.
+  /**
+   * This function is thread-safe.
+   *
+   * @param selection The policy used to choose the io_context. When
+   * least_loaded is specified, the load of an io_context is measured by the
+   * number of its asynchronous operations and handlers that have not yet
+   * completed.
+   */
+  ASIO_DECL io_context& get_io_context(
+      selection_type selection = round_robin);
+
+  /// Stops the threads.
+  /**
+   * This function stops all of the io_context objects as soon as possible. As
+   * a result of calling @c stop(), pending handlers may never be invoked.
+   */
+  ASIO_DECL void stop();
+
+  /// Joins the threads.
+  /**
+   * This function blocks until the threads in the pool have completed. If @c
+   * stop() is not called prior to @c join(), the @c join() call will wait
+   * until none of the io_context objects has outstanding work.
+   */
+  ASIO_DECL void join();
+
+  /// Open an acceptor that shares its endpoint with other acceptors.
+  /**
+   * This function opens the acceptor, sets the @c SO_REUSEADDR and
+   * @c SO_REUSEPORT options, binds it to the specified endpoint and puts it
+   * into the listening state.
+   *
+   * @param acceptor The acceptor to be opened. It must not already be open.
+   *
+   * @param endpoint The endpoint to which the acceptor will be bound.
+   *
+   * @param backlog The maximum length of the queue of pending connections.
+   *
+   * @throws asio::system_error Thrown on failure, including on platforms
+   * that do not support the @c SO_REUSEPORT option. The acceptor is closed.
+   */
+  template <typename Protocol, typename Executor>
+  static void open_reuseport_acceptor(
+      basic_socket_acceptor<Protocol, Executor>& acceptor,
+      const typename Protocol::endpoint& endpoint,
+      int backlog = socket_base::max_listen_connections);
+
+  /// Open an acceptor that shares its endpoint with other acceptors.
+  /**
+   * This function opens the acceptor, sets the @c SO_REUSEADDR and
+   * @c SO_REUSEPORT options, binds it to the specified endpoint and puts it
+   * into the listening state.
+   *
+   * @param acceptor The acceptor to be opened. It must not already be open.
+   *
+   * @param endpoint The endpoint to which the acceptor will be bound.
+   *
+   * @param backlog The maximum length of the queue of pending connections.
+   *
+   * @param ec Set to indicate what error occurred, if any. On failure the
+   * acceptor is closed. Set to asio::error::operation_not_supported on
+   * platforms that do not support the @c SO_REUSEPORT option.
+   */
+  template <typename Protocol, typename Executor>
+  static ASIO_SYNC_OP_VOID open_reuseport_acceptor(
+      basic_socket_acceptor<Protocol, Executor>& acceptor,
+      const typename Protocol::endpoint& endpoint,
+      int backlog, asio::error_code& ec);
+
+#if defined(ASIO_HAS_MOVE) || defined(GENERATING_DOCUMENTATION)
+  /// Open one acceptor per io_context, all bound to the same endpoint.
+  /**
+   * The acceptor at position @c i in the returned vector uses the io_context
+   * at position @c i in the pool. If the endpoint's port is zero, the port
+   * chosen by the operating system for the first acceptor is used for all of
+   * them.
+   *
+   * @param endpoint The endpoint to which the acceptors will be bound.
+   *
+   * @param backlog The maximum length of each acceptor's queue of pending
+   * connections.
+   *
+   * @throws asio::system_error Thrown on failure, including on platforms
+   * that do not support the @c SO_REUSEPORT option.
+   */
+  template <typename Endpoint>
+  std::vector<basic_socket_acceptor<typename Endpoint::protocol_type> >
+  make_reuseport_acceptors(const Endpoint& endpoint,
+      int backlog = socket_base::max_listen_connections);
+
+  /// Open one acceptor per io_context, all bound to the same endpoint.
+  /**
+   * The acceptor at position @c i in the returned vector uses the io_context
+   * at position @c i in the pool. If the endpoint's port is zero, the port
+   * chosen by the operating system for the first acceptor is used for all of
+   * them.
+   *
+   * @param endpoint The endpoint to which the acceptors will be bound.
+   *
+   * @param backlog The maximum length of each acceptor's queue of pending
+   * connections.
+   *
+   * @param ec Set to indicate what error occurred, if any. On failure an
+   * empty vector is returned.
+   */
+  template <typename Endpoint>
+  std::vector<basic_socket_acceptor<typename Endpoint::protocol_type> >
+  make_reuseport_acceptors(const Endpoint& endpoint,
+      int backlog, asio::error_code& ec);
+#endif // defined(ASIO_HAS_MOVE) || defined(GENERATING_DOCUMENTATION)
+
+private:
+  struct thread_function;
+
+  // Helper function to create the io_context objects and start the threads.
+  ASIO_DECL void init(std::size_t pool_size,
+      const io_context_options& options, const thread_affinity& affinity);
+
+  // The io_context objects in the pool.
+  std::vector<detail::shared_ptr<io_context> > contexts_;
+
+  // The position of the next io_context to be chosen.
+  detail::atomic_count next_;
+
+  // The threads in the pool.
+  detail::thread_group threads_;
+};
+
+} // namespace asio
+
+#include "detail/pop_options.hpp"
+
+#include "impl/io_context_pool.hpp"
+#if defined(ASIO_HEADER_ONLY)
+#include "impl/io_context_pool.ipp"
+#endif // defined(ASIO_HEADER_ONLY)
+
+#endif // ASIO_IO_CONTEXT_POOL_HPP
@@ -0,0 +1,234 @@
+//
+// recycling_allocator.hpp
+// ~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2020 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_RECYCLING_ALLOCATOR_HPP
+#define ASIO_RECYCLING_ALLOCATOR_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "detail/config.hpp"
+#include <cstddef>
+#include "detail/recycling_allocator.hpp"
+#include "detail/thread_context.hpp"
+#include "detail/thread_info_base.hpp"
+
+#include "detail/push_options.hpp"
+
+namespace asio {
+
+/// An allocator that caches memory blocks in the calling thread for reuse.
+/**
+ * Each thread that is running an io_context or thread_pool keeps a small
+ * cache of recently freed memory blocks, grouped by size. Asio obtains the
+ * memory for its internal operations from this cache, and the
+ * recycling_allocator makes the same cache available to programs. When a
+ * thread that is not running an io_context or thread_pool uses the
+ * allocator, memory is obtained from and returned to the global heap.
+ *
+ * The allocator may be associated with a handler using bind_allocator, so
+ * that the memory for a function submitted to an executor is recycled. The
+ * frames of coroutines started with co_spawn always use the cache.
+ *
+ * The static member functions max_cached_blocks() and trim() control the
+ * cache of the calling thread. They have no effect when the calling thread
+ * is not running an io_context or thread_pool. The cache lasts only as long
+ * as the thread's call to @c run(), or similar, so a limit set while the
+ * thread runs one io_context does not apply to the next.
+ *
+ * @par Example
+ * Release the memory retained by a worker thread after a burst of activity:
+ * @code asio::post(io_context,
+ *     []
+ *     {
+ *       asio::recycling_allocator<void>::trim();
+ *     }); @endcode
+ */
+template <typename T>
+class recycling_allocator
+{
+public:
+  /// The type of object allocated by the recycling allocator.
+  typedef T value_type;
+
+  /// Rebind the allocator to another value_type.
+  template <typename U>
+  struct rebind
+  {
+    /// The rebound @c allocator type.
+    typedef recycling_allocator<U> other;
+  };
+
+  /// Default constructor.
+  ASIO_CONSTEXPR recycling_allocator() ASIO_NOEXCEPT
+  {
+  }
+
+  /// Converting constructor.
+  template <typename U>
+  ASIO_CONSTEXPR recycling_allocator(
+      const recycling_allocator<U>&) ASIO_NOEXCEPT
+  {
+  }
+
+  /// Equality operator. Always returns true.
+  ASIO_CONSTEXPR bool operator==(
+      const recycling_allocator&) const ASIO_NOEXCEPT
+  {
+    return true;
+  }
+
+  /// Inequality operator. Always returns false.
+  ASIO_CONSTEXPR bool operator!=(
+      const recycling_allocator&) const ASIO_NOEXCEPT
+  {
+    return false;
+  }
+
+  /// Allocate memory for the specified number of values.
+  T* allocate(std::size_t n)
+  {
+    return detail::recycling_allocator<T>().allocate(n);
+  }
+
+  /// Deallocate memory for the specified number of values.
+  void deallocate(T* p, std::size_t n)
+  {
+    detail::recycling_allocator<T>().deallocate(p, n);
+  }
+
+  /// Get the maximum number of blocks of each size that the calling thread
+  /// retains for reuse.
+  /**
+   * @returns The limit, or 0 if the calling thread has no cache.
+   */
+  static std::size_t max_cached_blocks()
+  {
+    if (detail::thread_info_base* this_thread = top_of_thread_call_stack())
+      return this_thread->max_cached_blocks();
+    return 0;
+  }
+
+  /// Set the maximum number of blocks of each size that the calling thread
+  /// retains for reuse.
+  /**
+   * Cached blocks in excess of the new limit are released immediately. A
+   * limit of 0 disables the cache. The default limit is 4.
+   */
+  static void max_cached_blocks(std::size_t n)
+  {
+    if (detail::thread_info_base* this_thread = top_of_thread_call_stack())
+      this_thread->max_cached_blocks(n);
+  }
+
+  /// Release all of the blocks that the calling thread retains for reuse.
+  /**
+   * The limit on the number of retained blocks is unchanged, so that the
+   * cache refills as memory is subsequently freed.
+   */
+  static void trim()
+  {
+    if (detail::thread_info_base* this_thread = top_of_thread_call_stack())
+      this_thread->trim(0);
+  }
+
+  /// Get the number of bytes in the blocks that the calling thread retains
+  /// for reuse.
+  static std::size_t cached_bytes()
+  {
+    if (detail::thread_info_base* this_thread = top_of_thread_call_stack())
+      return this_thread->cached_bytes();
+    return 0;
+  }
+
+private:
+  static detail::thread_info_base* top_of_thread_call_stack()
+  {
+    return detail::thread_context::thread_call_stack::top();
+  }
+};
+
+/// A proto-allocator that caches memory blocks in the calling thread for
+/// reuse.
+template <>
+class recycling_allocator<void>
+{
+public:
+  /// No values are allocated by a proto-allocator.
+  typedef void value_type;
+
+  /// Rebind the allocator to another value_type.
+  template <typename U>
+  struct rebind
+  {
+    /// The rebound @c allocator type.
+    typedef recycling_allocator<U> other;
+  };
+
+  /// Default constructor.
+  ASIO_CONSTEXPR recycling_allocator() ASIO_NOEXCEPT
+  {
+  }
+
+  /// Converting constructor.
+  template <typename U>
+  ASIO_CONSTEXPR recycling_allocator(
+      const recycling_allocator<U>&) ASIO_NOEXCEPT
+  {
+  }
+
+  /// Equality operator. Always returns true.
+  ASIO_CONSTEXPR bool operator==(
+      const recycling_allocator&) const ASIO_NOEXCEPT
+  {
+    return true;
+  }
+
+  /// Inequality operator. Always returns false.
+  ASIO_CONSTEXPR bool operator!=(
+      const recycling_allocator&) const ASIO_NOEXCEPT
+  {
+    return false;
+  }
+
+  /// Get the maximum number of blocks of each size that the calling thread
+  /// retains for reuse.
+  static std::size_t max_cached_blocks()
+  {
+    return recycling_allocator<char>::max_cached_blocks();
+  }
+
+  /// Set the maximum number of blocks of each size that the calling thread
+  /// retains for reuse.
+  static void max_cached_blocks(std::size_t n)
+  {
+    recycling_allocator<char>::max_cached_blocks(n);
+  }
+
+  /// Release all of the blocks that the calling thread retains for reuse.
+  static void trim()
+  {
+    recycling_allocator<char>::trim();
+  }
+
+  /// Get the number of bytes in the blocks that the calling thread retains
+  /// for reuse.
+  static std::size_t cached_bytes()
+  {
+    return recycling_allocator<char>::cached_bytes();
+  }
+};
+
+} // namespace asio
+
+#include "detail/pop_options.hpp"
+
+#endif // ASIO_RECYCLING_ALLOCATOR_HPP
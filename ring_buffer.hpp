@@ -0,0 +1,452 @@
+//
+// ring_buffer.hpp
+// ~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2020 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_RING_BUFFER_HPP
+#define ASIO_RING_BUFFER_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "detail/config.hpp"
+
+#if defined(ASIO_HAS_RING_BUFFER) \
+  || defined(GENERATING_DOCUMENTATION)
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include "buffer.hpp"
+#include "error_code.hpp"
+#include "detail/limits.hpp"
+#include "detail/noncopyable.hpp"
+#include "detail/throw_exception.hpp"
+
+#include "detail/push_options.hpp"
+
+namespace asio {
+
+/// A circular buffer whose contents are always contiguous in memory.
+/**
+ * The ring_buffer class holds a sequence of bytes in a circular region of
+ * memory. The region is mapped twice, at adjacent virtual addresses, so that
+ * a sequence that wraps past the end of the region continues into the second
+ * mapping. The readable bytes, and the space following them, are therefore
+ * each represented by a single contiguous buffer, and consuming data from the
+ * front never moves the remaining data.
+ *
+ * The capacity is rounded up to a multiple of the system's page size. When
+ * more space is needed than the capacity allows, the buffer is remapped with
+ * at least twice the capacity and its contents are copied. Reserve enough
+ * capacity up front to avoid this.
+ *
+ * A ring_buffer is used with the I/O functions through the DynamicBuffer
+ * returned by @c dynamic_buffer(), which refers to the ring_buffer without
+ * owning it.
+ *
+ * @par Thread Safety
+ * @e Distinct @e objects: Safe.@n
+ * @e Shared @e objects: Unsafe.
+ *
+ * @par Example
+ * Reading lines from a socket:
+ * @code asio::ring_buffer ring(65536);
+ * std::size_t n = asio::read_until(sock, asio::dynamic_buffer(ring), '\n');
+ * std::string line(static_cast<const char*>(ring.data().data()), n);
+ * ring.consume(n); @endcode
+ */
+class ring_buffer
+  : private noncopyable
+{
+public:
+  /// Construct a ring buffer with at least the specified capacity.
+  /**
+   * @throws asio::system_error Thrown if the memory could not be mapped.
+   */
+  ASIO_DECL explicit ring_buffer(std::size_t capacity);
+
+  /// Destroy the ring buffer, releasing its memory.
+  ASIO_DECL ~ring_buffer();
+
+  /// Get the number of readable bytes.
+  std::size_t size() const ASIO_NOEXCEPT
+  {
+    return size_;
+  }
+
+  /// Get the number of bytes the buffer can hold without being remapped.
+  std::size_t capacity() const ASIO_NOEXCEPT
+  {
+    return capacity_;
+  }
+
+  /// Get a buffer that represents the readable bytes.
+  /**
+   * @note The returned buffer is invalidated by any member function that
+   * adds bytes to the buffer.
+   */
+  mutable_buffer data() ASIO_NOEXCEPT
+  {
+    return mutable_buffer(memory_ + head_, size_);
+  }
+
+  /// Get a buffer that represents the readable bytes.
+  /**
+   * @note The returned buffer is invalidated by any member function that
+   * adds bytes to the buffer.
+   */
+  const_buffer data() const ASIO_NOEXCEPT
+  {
+    return const_buffer(memory_ + head_, size_);
+  }
+
+  /// Get a buffer that represents space following the readable bytes.
+  /**
+   * Ensures that the space can accommodate @c n bytes, remapping the buffer
+   * if necessary.
+   *
+   * @throws std::length_error If <tt>size() + n</tt> overflows.
+   *
+   * @throws asio::system_error Thrown if the buffer had to be remapped and
+   * the memory could not be mapped.
+   */
+  mutable_buffer prepare(std::size_t n)
+  {
+    reserve_additional(n);
+    prepared_ = n;
+    return mutable_buffer(memory_ + head_ + size_, n);
+  }
+
+  /// Make bytes written to the prepared space readable.
+  /**
+   * @param n The number of bytes to append to the readable bytes. If @c n is
+   * greater than the size of the prepared space, the whole prepared space is
+   * appended and no error is issued.
+   */
+  void commit(std::size_t n) ASIO_NOEXCEPT
+  {
+    size_ += (std::min)(n, prepared_);
+    prepared_ = 0;
+  }
+
+  /// Remove bytes from the front of the readable bytes.
+  /**
+   * If @c n is greater than the number of readable bytes, the buffer is
+   * emptied and no error is issued.
+   */
+  void consume(std::size_t n) ASIO_NOEXCEPT
+  {
+    n = (std::min)(n, size_);
+    size_ -= n;
+    head_ = size_ == 0 ? 0 : (head_ + n) % capacity_;
+  }
+
+  /// Make @c n more bytes readable, without writing them.
+  /**
+   * @throws std::length_error If <tt>size() + n</tt> overflows.
+   *
+   * @throws asio::system_error Thrown if the buffer had to be remapped and
+   * the memory could not be mapped.
+   */
+  void grow(std::size_t n)
+  {
+    reserve_additional(n);
+    size_ += n;
+    prepared_ = 0;
+  }
+
+  /// Remove bytes from the back of the readable bytes.
+  /**
+   * If @c n is greater than the number of readable bytes, the buffer is
+   * emptied and no error is issued.
+   */
+  void shrink(std::size_t n) ASIO_NOEXCEPT
+  {
+    size_ -= (std::min)(n, size_);
+    if (size_ == 0)
+      head_ = 0;
+  }
+
+  /// Ensure that the buffer can hold at least @c n bytes without being
+  /// remapped.
+  /**
+   * @throws asio::system_error Thrown if the memory could not be mapped.
+   */
+  ASIO_DECL void reserve(std::size_t n);
+
+private:
+  // Map memory of the given size twice, at adjacent addresses.
+  ASIO_DECL static unsigned char* map_memory(
+      std::size_t size, asio::error_code& ec);
+
+  // Unmap memory mapped by map_memory.
+  ASIO_DECL static void unmap_memory(unsigned char* memory, std::size_t size);
+
+  // Ensure there is space for n bytes after the readable bytes.
+  void reserve_additional(std::size_t n)
+  {
+    if (n > (std::numeric_limits<std::size_t>::max)() - size_)
+    {
+      std::length_error ex("ring_buffer too long");
+      asio::detail::throw_exception(ex);
+    }
+
+    if (size_ + n > capacity_)
+      reserve((std::max)(size_ + n, capacity_ * 2));
+  }
+
+  // The start of the two adjacent mappings of the memory.
+  unsigned char* memory_;
+
+  // The size of the memory, which is the size of each mapping.
+  std::size_t capacity_;
+
+  // The offset of the first readable byte in the memory.
+  std::size_t head_;
+
+  // The number of readable bytes.
+  std::size_t size_;
+
+  // The size of the space most recently prepared.
+  std::size_t prepared_;
+};
+
+/// Adapt a ring_buffer to the DynamicBuffer requirements.
+/**
+ * The readable bytes of the ring buffer form both the input sequence of
+ * DynamicBuffer_v1 and the underlying memory of DynamicBuffer_v2.
+ */
+class dynamic_ring_buffer
+{
+public:
+  /// The type used to represent a sequence of constant buffers that refers to
+  /// the underlying memory.
+  typedef ASIO_CONST_BUFFER const_buffers_type;
+
+  /// The type used to represent a sequence of mutable buffers that refers to
+  /// the underlying memory.
+  typedef ASIO_MUTABLE_BUFFER mutable_buffers_type;
+
+  /// Construct a dynamic buffer from a ring buffer.
+  /**
+   * @param ring The ring buffer to be used as backing storage for the dynamic
+   * buffer. The object stores a reference to the ring buffer and the user is
+   * responsible for ensuring that the ring buffer object remains valid while
+   * the dynamic_ring_buffer object, and copies of the object, are in use.
+   *
+   * @param maximum_size Specifies a maximum size for the buffer, in bytes.
+   */
+  explicit dynamic_ring_buffer(ring_buffer& ring,
+      std::size_t maximum_size =
+        (std::numeric_limits<std::size_t>::max)()) ASIO_NOEXCEPT
+    : ring_(ring),
+      max_size_(maximum_size)
+  {
+  }
+
+  /// @b DynamicBuffer_v2: Copy construct a dynamic buffer.
+  dynamic_ring_buffer(const dynamic_ring_buffer& other) ASIO_NOEXCEPT
+    : ring_(other.ring_),
+      max_size_(other.max_size_)
+  {
+  }
+
+  /// @b DynamicBuffer_v1: Get the size of the input sequence.
+  /// @b DynamicBuffer_v2: Get the current size of the underlying memory.
+  /**
+   * @returns The number of readable bytes in the ring buffer if less than
+   * max_size(). Otherwise returns max_size().
+   */
+  std::size_t size() const ASIO_NOEXCEPT
+  {
+    return (std::min)(ring_.size(), max_size());
+  }
+
+  /// Get the maximum size of the dynamic buffer.
+  std::size_t max_size() const ASIO_NOEXCEPT
+  {
+    return max_size_;
+  }
+
+  /// Get the maximum size that the buffer may grow to without triggering
+  /// remapping.
+  std::size_t capacity() const ASIO_NOEXCEPT
+  {
+    return (std::min)(ring_.capacity(), max_size());
+  }
+
+#if !defined(ASIO_NO_DYNAMIC_BUFFER_V1)
+  /// @b DynamicBuffer_v1: Get a list of buffers that represents the input
+  /// sequence.
+  /**
+   * @note The returned object is invalidated by any @c dynamic_ring_buffer
+   * or @c ring_buffer member function that adds bytes to the buffer.
+   */
+  const_buffers_type data() const ASIO_NOEXCEPT
+  {
+    return const_buffers_type(
+        static_cast<const ring_buffer&>(ring_).data());
+  }
+#endif // !defined(ASIO_NO_DYNAMIC_BUFFER_V1)
+
+  /// @b DynamicBuffer_v2: Get a sequence of buffers that represents the
+  /// underlying memory.
+  /**
+   * @param pos Position of the first byte to represent in the buffer sequence
+   *
+   * @param n The number of bytes to return in the buffer sequence. If the
+   * underlying memory is shorter, the buffer sequence represents as many bytes
+   * as are available.
+   *
+   * @note The returned object is invalidated by any @c dynamic_ring_buffer
+   * or @c ring_buffer member function that adds bytes to the buffer.
+   */
+  mutable_buffers_type data(std::size_t pos, std::size_t n) ASIO_NOEXCEPT
+  {
+    return mutable_buffers_type(asio::buffer(ring_.data() + pos, n));
+  }
+
+  /// @b DynamicBuffer_v2: Get a sequence of buffers that represents the
+  /// underlying memory.
+  /**
+   * @param pos Position of the first byte to represent in the buffer sequence
+   *
+   * @param n The number of bytes to return in the buffer sequence. If the
+   * underlying memory is shorter, the buffer sequence represents as many bytes
+   * as are available.
+   *
+   * @note The returned object is invalidated by any @c dynamic_ring_buffer
+   * or @c ring_buffer member function that adds bytes to the buffer.
+   */
+  const_buffers_type data(std::size_t pos,
+      std::size_t n) const ASIO_NOEXCEPT
+  {
+    return const_buffers_type(asio::buffer(
+          static_cast<const ring_buffer&>(ring_).data() + pos, n));
+  }
+
+#if !defined(ASIO_NO_DYNAMIC_BUFFER_V1)
+  /// @b DynamicBuffer_v1: Get a list of buffers that represents the output
+  /// sequence, with the given size.
+  /**
+   * Ensures that the output sequence can accommodate @c n bytes, remapping
+   * the ring buffer as necessary.
+   *
+   * @throws std::length_error If <tt>size() + n > max_size()</tt>.
+   *
+   * @note The returned object is invalidated by any @c dynamic_ring_buffer
+   * or @c ring_buffer member function that modifies the input sequence or
+   * output sequence.
+   */
+  mutable_buffers_type prepare(std::size_t n)
+  {
+    check_size(n);
+    return mutable_buffers_type(ring_.prepare(n));
+  }
+
+  /// @b DynamicBuffer_v1: Move bytes from the output sequence to the input
+  /// sequence.
+  /**
+   * @param n The number of bytes to append from the start of the output
+   * sequence to the end of the input sequence. The remainder of the output
+   * sequence is discarded.
+   *
+   * Requires a preceding call <tt>prepare(x)</tt> where <tt>x >= n</tt>, and
+   * no intervening operations that modify the input or output sequence.
+   *
+   * @note If @c n is greater than the size of the output sequence, the entire
+   * output sequence is moved to the input sequence and no error is issued.
+   */
+  void commit(std::size_t n) ASIO_NOEXCEPT
+  {
+    ring_.commit(n);
+  }
+#endif // !defined(ASIO_NO_DYNAMIC_BUFFER_V1)
+
+  /// @b DynamicBuffer_v2: Grow the underlying memory by the specified number of
+  /// bytes.
+  /**
+   * @throws std::length_error If <tt>size() + n > max_size()</tt>.
+   */
+  void grow(std::size_t n)
+  {
+    check_size(n);
+    ring_.grow(n);
+  }
+
+  /// @b DynamicBuffer_v2: Shrink the underlying memory by the specified number
+  /// of bytes.
+  /**
+   * Removes @c n bytes from the end of the readable bytes. If @c n is greater
+   * than the number of readable bytes, the ring buffer is emptied.
+   */
+  void shrink(std::size_t n) ASIO_NOEXCEPT
+  {
+    ring_.shrink(n);
+  }
+
+  /// @b DynamicBuffer_v1: Remove characters from the input sequence.
+  /// @b DynamicBuffer_v2: Consume the specified number of bytes from the
+  /// beginning of the underlying memory.
+  /**
+   * Removes @c n bytes from the front of the readable bytes, without moving
+   * the remaining bytes. If @c n is greater than the number of readable bytes,
+   * the ring buffer is emptied and no error is issued.
+   */
+  void consume(std::size_t n) ASIO_NOEXCEPT
+  {
+    ring_.consume(n);
+  }
+
+private:
+  void check_size(std::size_t n) const
+  {
+    if (size() > max_size() || max_size() - size() < n)
+    {
+      std::length_error ex("dynamic_ring_buffer too long");
+      asio::detail::throw_exception(ex);
+    }
+  }
+
+  ring_buffer& ring_;
+  const std::size_t max_size_;
+};
+
+/// Create a new dynamic buffer that represents the given ring buffer.
+/**
+ * @returns <tt>dynamic_ring_buffer(ring)</tt>.
+ */
+inline dynamic_ring_buffer dynamic_buffer(ring_buffer& ring) ASIO_NOEXCEPT
+{
+  return dynamic_ring_buffer(ring);
+}
+
+/// Create a new dynamic buffer that represents the given ring buffer.
+/**
+ * @returns <tt>dynamic_ring_buffer(ring, max_size)</tt>.
+ */
+inline dynamic_ring_buffer dynamic_buffer(ring_buffer& ring,
+    std::size_t max_size) ASIO_NOEXCEPT
+{
+  return dynamic_ring_buffer(ring, max_size);
+}
+
+} // namespace asio
+
+#include "detail/pop_options.hpp"
+
+#if defined(ASIO_HEADER_ONLY)
+#include "impl/ring_buffer.ipp"
+#endif // defined(ASIO_HEADER_ONLY)
+
+#endif // defined(ASIO_HAS_RING_BUFFER)
+       //   || defined(GENERATING_DOCUMENTATION)
+
+#endif // ASIO_RING_BUFFER_HPP
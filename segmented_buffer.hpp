@@ -0,0 +1,698 @@
+//
+// segmented_buffer.hpp
+// ~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2020 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_SEGMENTED_BUFFER_HPP
+#define ASIO_SEGMENTED_BUFFER_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "detail/config.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+#include "buffer.hpp"
+#include "recycling_allocator.hpp"
+#include "detail/assert.hpp"
+#include "detail/handler_arena.hpp"
+#include "detail/limits.hpp"
+#include "detail/noncopyable.hpp"
+#include "detail/throw_exception.hpp"
+
+#include "detail/push_options.hpp"
+
+namespace asio {
+namespace detail {
+
+// A sequence of buffers that represents a range of bytes held in a list of
+// equally sized blocks. Each buffer covers the part of the range that lies
+// within one block.
+template <typename Buffer>
+class segmented_buffer_sequence
+{
+public:
+  typedef Buffer value_type;
+
+  class const_iterator
+  {
+  public:
+    typedef std::ptrdiff_t difference_type;
+    typedef Buffer value_type;
+    typedef const Buffer* pointer;
+    typedef Buffer reference;
+    typedef std::bidirectional_iterator_tag iterator_category;
+
+    const_iterator() ASIO_NOEXCEPT
+      : blocks_(0),
+        block_size_(1),
+        first_(0),
+        last_(0),
+        position_(0)
+    {
+    }
+
+    const_iterator(unsigned char* const* blocks, std::size_t block_size,
+        std::size_t first, std::size_t last,
+        std::size_t position) ASIO_NOEXCEPT
+      : blocks_(blocks),
+        block_size_(block_size),
+        first_(first),
+        last_(last),
+        position_(position)
+    {
+    }
+
+    Buffer operator*() const ASIO_NOEXCEPT
+    {
+      std::size_t offset = position_ % block_size_;
+      return Buffer(blocks_[position_ / block_size_] + offset,
+          (std::min)(block_size_ - offset, last_ - position_));
+    }
+
+    const_iterator& operator++() ASIO_NOEXCEPT
+    {
+      position_ = (std::min)(
+          (position_ / block_size_ + 1) * block_size_, last_);
+      return *this;
+    }
+
+    const_iterator operator++(int) ASIO_NOEXCEPT
+    {
+      const_iterator tmp(*this);
+      ++*this;
+      return tmp;
+    }
+
+    const_iterator& operator--() ASIO_NOEXCEPT
+    {
+      position_ = (std::max)(
+          (position_ - 1) / block_size_ * block_size_, first_);
+      return *this;
+    }
+
+    const_iterator operator--(int) ASIO_NOEXCEPT
+    {
+      const_iterator tmp(*this);
+      --*this;
+      return tmp;
+    }
+
+    friend bool operator==(const const_iterator& a,
+        const const_iterator& b) ASIO_NOEXCEPT
+    {
+      return a.position_ == b.position_;
+    }
+
+    friend bool operator!=(const const_iterator& a,
+        const const_iterator& b) ASIO_NOEXCEPT
+    {
+      return a.position_ != b.position_;
+    }
+
+  private:
+    unsigned char* const* blocks_;
+    std::size_t block_size_;
+    std::size_t first_;
+    std::size_t last_;
+    std::size_t position_;
+  };
+
+  // Construct a sequence for the n bytes starting at the given offset from
+  // the start of the first block.
+  segmented_buffer_sequence(unsigned char* const* blocks,
+      std::size_t block_size, std::size_t offset,
+      std::size_t n) ASIO_NOEXCEPT
+    : blocks_(blocks),
+      block_size_(block_size),
+      offset_(offset),
+      size_(n)
+  {
+  }
+
+  // Convert a sequence of mutable buffers to a sequence of constant buffers.
+  template <typename OtherBuffer>
+  segmented_buffer_sequence(
+      const segmented_buffer_sequence<OtherBuffer>& other) ASIO_NOEXCEPT
+    : blocks_(other.blocks_),
+      block_size_(other.block_size_),
+      offset_(other.offset_),
+      size_(other.size_)
+  {
+  }
+
+  const_iterator begin() const ASIO_NOEXCEPT
+  {
+    return const_iterator(blocks_, block_size_,
+        offset_, offset_ + size_, offset_);
+  }
+
+  const_iterator end() const ASIO_NOEXCEPT
+  {
+    return const_iterator(blocks_, block_size_,
+        offset_, offset_ + size_, offset_ + size_);
+  }
+
+private:
+  template <typename> friend class segmented_buffer_sequence;
+
+  unsigned char* const* blocks_;
+  std::size_t block_size_;
+  std::size_t offset_;
+  std::size_t size_;
+};
+
+} // namespace detail
+
+/// A buffer that holds its bytes in a chain of fixed-size blocks.
+/**
+ * The segmented_buffer class holds a sequence of bytes in a list of blocks of
+ * equal size. The readable bytes, and the space following them, are each
+ * represented by a sequence of buffers with one buffer per block. Adding bytes
+ * allocates blocks at the back of the list, and consuming bytes releases the
+ * blocks at the front that no longer hold readable bytes, so the remaining
+ * bytes are never moved.
+ *
+ * Blocks are obtained from a recycling_allocator. Blocks released by a thread
+ * that is running an io_context are retained in that thread's cache and
+ * reused for subsequent allocations of the same size. The allocator adds a
+ * small tag to each block and rounds it up to a power of two, so use a block
+ * size a little below a power of two, and no larger than 8191 bytes, for
+ * blocks to be retained without waste, and raise
+ * recycling_allocator<void>::max_cached_blocks() if many blocks are released
+ * at once.
+ *
+ * A segmented_buffer is used with the I/O functions through the DynamicBuffer
+ * returned by @c dynamic_buffer(), which refers to the segmented_buffer
+ * without owning it.
+ *
+ * @par Thread Safety
+ * @e Distinct @e objects: Safe.@n
+ * @e Shared @e objects: Unsafe.
+ *
+ * @par Example
+ * Reading lines from a socket:
+ * @code asio::segmented_buffer buf;
+ * std::size_t n = asio::read_until(sock, asio::dynamic_buffer(buf), '\n');
+ * std::string line(asio::buffers_begin(buf.data()),
+ *     asio::buffers_begin(buf.data()) + n);
+ * buf.consume(n); @endcode
+ */
+class segmented_buffer
+  : private noncopyable
+{
+public:
+  /// The type used to represent the readable bytes as a list of buffers.
+#if defined(GENERATING_DOCUMENTATION)
+  typedef implementation_defined const_buffers_type;
+#else
+  typedef detail::segmented_buffer_sequence<const_buffer> const_buffers_type;
+#endif
+
+  /// The type used to represent the readable bytes, or the space following
+  /// them, as a list of buffers.
+#if defined(GENERATING_DOCUMENTATION)
+  typedef implementation_defined mutable_buffers_type;
+#else
+  typedef detail::segmented_buffer_sequence<mutable_buffer>
+    mutable_buffers_type;
+#endif
+
+#if defined(GENERATING_DOCUMENTATION)
+  /// The default size of each block, in bytes. Each block, together with the
+  /// tag added by the allocator, occupies 4096 bytes.
+  static const std::size_t default_block_size = implementation_defined;
+#else
+  ASIO_STATIC_CONSTANT(std::size_t,
+      default_block_size = 4096 - detail::handler_arena::tag_size);
+#endif
+
+  /// Construct an empty segmented buffer.
+  /**
+   * No memory is allocated until bytes are added to the buffer.
+   *
+   * @param block_size The size of each block, in bytes. Must be greater than
+   * zero.
+   */
+  explicit segmented_buffer(std::size_t block_size = default_block_size)
+    : block_size_(block_size),
+      head_(0),
+      size_(0),
+      prepared_(0)
+  {
+    ASIO_ASSERT(block_size > 0);
+  }
+
+  /// Destroy the segmented buffer, releasing its blocks.
+  ~segmented_buffer()
+  {
+    release_blocks(blocks_.size());
+  }
+
+  /// Get the size of each block.
+  std::size_t block_size() const ASIO_NOEXCEPT
+  {
+    return block_size_;
+  }
+
+  /// Get the number of readable bytes.
+  std::size_t size() const ASIO_NOEXCEPT
+  {
+    return size_;
+  }
+
+  /// Get the number of bytes the buffer can hold without allocating blocks.
+  std::size_t capacity() const ASIO_NOEXCEPT
+  {
+    return blocks_.size() * block_size_ - head_;
+  }
+
+  /// Get a list of buffers that represents the readable bytes.
+  /**
+   * @note The returned object is invalidated by any member function that
+   * adds or removes bytes.
+   */
+  mutable_buffers_type data() ASIO_NOEXCEPT
+  {
+    return data(0, size_);
+  }
+
+  /// Get a list of buffers that represents the readable bytes.
+  /**
+   * @note The returned object is invalidated by any member function that
+   * adds or removes bytes.
+   */
+  const_buffers_type data() const ASIO_NOEXCEPT
+  {
+    return data(0, size_);
+  }
+
+  /// Get a list of buffers that represents part of the readable bytes.
+  /**
+   * @param pos Position of the first byte to represent in the buffer sequence.
+   *
+   * @param n The number of bytes to return in the buffer sequence. If fewer
+   * bytes are readable, the buffer sequence represents as many bytes as are
+   * available.
+   *
+   * @note The returned object is invalidated by any member function that
+   * adds or removes bytes.
+   */
+  mutable_buffers_type data(std::size_t pos, std::size_t n) ASIO_NOEXCEPT
+  {
+    pos = (std::min)(pos, size_);
+    return mutable_buffers_type(first_block(), block_size_,
+        head_ + pos, (std::min)(n, size_ - pos));
+  }
+
+  /// Get a list of buffers that represents part of the readable bytes.
+  /**
+   * @param pos Position of the first byte to represent in the buffer sequence.
+   *
+   * @param n The number of bytes to return in the buffer sequence. If fewer
+   * bytes are readable, the buffer sequence represents as many bytes as are
+   * available.
+   *
+   * @note The returned object is invalidated by any member function that
+   * adds or removes bytes.
+   */
+  const_buffers_type data(std::size_t pos,
+      std::size_t n) const ASIO_NOEXCEPT
+  {
+    pos = (std::min)(pos, size_);
+    return const_buffers_type(first_block(), block_size_,
+        head_ + pos, (std::min)(n, size_ - pos));
+  }
+
+  /// Get a list of buffers that represents space following the readable
+  /// bytes.
+  /**
+   * Ensures that the space can accommodate @c n bytes, allocating blocks if
+   * necessary.
+   *
+   * @throws std::length_error If <tt>size() + n</tt> overflows.
+   */
+  mutable_buffers_type prepare(std::size_t n)
+  {
+    reserve_additional(n);
+    prepared_ = n;
+    return mutable_buffers_type(first_block(),
+        block_size_, head_ + size_, n);
+  }
+
+  /// Make bytes written to the prepared space readable.
+  /**
+   * @param n The number of bytes to append to the readable bytes. If @c n is
+   * greater than the size of the prepared space, the whole prepared space is
+   * appended and no error is issued.
+   */
+  void commit(std::size_t n) ASIO_NOEXCEPT
+  {
+    size_ += (std::min)(n, prepared_);
+    prepared_ = 0;
+  }
+
+  /// Remove bytes from the front of the readable bytes.
+  /**
+   * Blocks that no longer hold readable bytes are released. The remaining
+   * bytes are not moved. If @c n is greater than the number of readable
+   * bytes, the buffer is emptied and no error is issued.
+   */
+  void consume(std::size_t n) ASIO_NOEXCEPT
+  {
+    n = (std::min)(n, size_);
+    size_ -= n;
+    head_ += n;
+    std::size_t unused = head_ / block_size_;
+    release_blocks(unused);
+    blocks_.erase(blocks_.begin(), blocks_.begin() + unused);
+    head_ = size_ == 0 ? 0 : head_ - unused * block_size_;
+    prepared_ = 0;
+  }
+
+  /// Make @c n more bytes readable, without writing them.
+  /**
+   * @throws std::length_error If <tt>size() + n</tt> overflows.
+   */
+  void grow(std::size_t n)
+  {
+    reserve_additional(n);
+    size_ += n;
+    prepared_ = 0;
+  }
+
+  /// Remove bytes from the back of the readable bytes.
+  /**
+   * The blocks are retained as space for subsequent bytes. If @c n is greater
+   * than the number of readable bytes, the buffer is emptied and no error is
+   * issued.
+   */
+  void shrink(std::size_t n) ASIO_NOEXCEPT
+  {
+    size_ -= (std::min)(n, size_);
+    if (size_ == 0)
+      head_ = 0;
+    prepared_ = 0;
+  }
+
+  /// Release the blocks that hold no readable bytes.
+  void shrink_to_fit() ASIO_NOEXCEPT
+  {
+    std::size_t used = (head_ + size_ + block_size_ - 1) / block_size_;
+    for (std::size_t i = used; i < blocks_.size(); ++i)
+      allocator_.deallocate(blocks_[i], block_size_);
+    blocks_.resize(used);
+    prepared_ = 0;
+  }
+
+private:
+  // Get a pointer to the list of blocks.
+  unsigned char* const* first_block() const ASIO_NOEXCEPT
+  {
+    return blocks_.empty() ? 0 : &blocks_[0];
+  }
+
+  // Ensure there is space for n bytes after the readable bytes.
+  void reserve_additional(std::size_t n)
+  {
+    std::size_t max_size = (std::numeric_limits<std::size_t>::max)();
+    if (n > max_size - head_ - size_ - block_size_)
+    {
+      std::length_error ex("segmented_buffer too long");
+      asio::detail::throw_exception(ex);
+    }
+
+    std::size_t needed = (head_ + size_ + n + block_size_ - 1) / block_size_;
+    if (needed > blocks_.size())
+    {
+      blocks_.reserve(needed);
+      while (blocks_.size() < needed)
+        blocks_.push_back(allocator_.allocate(block_size_));
+    }
+  }
+
+  // Release the first n blocks, without removing them from the list.
+  void release_blocks(std::size_t n) ASIO_NOEXCEPT
+  {
+    for (std::size_t i = 0; i < n; ++i)
+      allocator_.deallocate(blocks_[i], block_size_);
+  }
+
+  // The allocator used to obtain the blocks.
+  recycling_allocator<unsigned char> allocator_;
+
+  // The blocks, in order.
+  std::vector<unsigned char*> blocks_;
+
+  // The size of each block.
+  std::size_t block_size_;
+
+  // The offset of the first readable byte in the first block.
+  std::size_t head_;
+
+  // The number of readable bytes.
+  std::size_t size_;
+
+  // The size of the space most recently prepared.
+  std::size_t prepared_;
+};
+
+/// Adapt a segmented_buffer to the DynamicBuffer requirements.
+/**
+ * The readable bytes of the segmented buffer form both the input sequence of
+ * DynamicBuffer_v1 and the underlying memory of DynamicBuffer_v2.
+ */
+class dynamic_segmented_buffer
+{
+public:
+  /// The type used to represent a sequence of constant buffers that refers to
+  /// the underlying memory.
+  typedef segmented_buffer::const_buffers_type const_buffers_type;
+
+  /// The type used to represent a sequence of mutable buffers that refers to
+  /// the underlying memory.
+  typedef segmented_buffer::mutable_buffers_type mutable_buffers_type;
+
+  /// Construct a dynamic buffer from a segmented buffer.
+  /**
+   * @param buf The segmented buffer to be used as backing storage for the
+   * dynamic buffer. The object stores a reference to the segmented buffer and
+   * the user is responsible for ensuring that the segmented buffer object
+   * remains valid while the dynamic_segmented_buffer object, and copies of the
+   * object, are in use.
+   *
+   * @param maximum_size Specifies a maximum size for the buffer, in bytes.
+   */
+  explicit dynamic_segmented_buffer(segmented_buffer& buf,
+      std::size_t maximum_size =
+        (std::numeric_limits<std::size_t>::max)()) ASIO_NOEXCEPT
+    : buf_(buf),
+      max_size_(maximum_size)
+  {
+  }
+
+  /// @b DynamicBuffer_v2: Copy construct a dynamic buffer.
+  dynamic_segmented_buffer(
+      const dynamic_segmented_buffer& other) ASIO_NOEXCEPT
+    : buf_(other.buf_),
+      max_size_(other.max_size_)
+  {
+  }
+
+  /// @b DynamicBuffer_v1: Get the size of the input sequence.
+  /// @b DynamicBuffer_v2: Get the current size of the underlying memory.
+  /**
+   * @returns The number of readable bytes in the segmented buffer if less
+   * than max_size(). Otherwise returns max_size().
+   */
+  std::size_t size() const ASIO_NOEXCEPT
+  {
+    return (std::min)(buf_.size(), max_size());
+  }
+
+  /// Get the maximum size of the dynamic buffer.
+  std::size_t max_size() const ASIO_NOEXCEPT
+  {
+    return max_size_;
+  }
+
+  /// Get the maximum size that the buffer may grow to without allocating
+  /// blocks.
+  std::size_t capacity() const ASIO_NOEXCEPT
+  {
+    return (std::min)(buf_.capacity(), max_size());
+  }
+
+#if !defined(ASIO_NO_DYNAMIC_BUFFER_V1)
+  /// @b DynamicBuffer_v1: Get a list of buffers that represents the input
+  /// sequence.
+  /**
+   * @note The returned object is invalidated by any
+   * @c dynamic_segmented_buffer or @c segmented_buffer member function that
+   * modifies the input sequence or output sequence.
+   */
+  const_buffers_type data() const ASIO_NOEXCEPT
+  {
+    return static_cast<const segmented_buffer&>(buf_).data();
+  }
+#endif // !defined(ASIO_NO_DYNAMIC_BUFFER_V1)
+
+  /// @b DynamicBuffer_v2: Get a sequence of buffers that represents the
+  /// underlying memory.
+  /**
+   * @param pos Position of the first byte to represent in the buffer sequence
+   *
+   * @param n The number of bytes to return in the buffer sequence. If the
+   * underlying memory is shorter, the buffer sequence represents as many bytes
+   * as are available.
+   *
+   * @note The returned object is invalidated by any
+   * @c dynamic_segmented_buffer or @c segmented_buffer member function that
+   * modifies the input sequence or output sequence.
+   */
+  mutable_buffers_type data(std::size_t pos, std::size_t n) ASIO_NOEXCEPT
+  {
+    return buf_.data(pos, n);
+  }
+
+  /// @b DynamicBuffer_v2: Get a sequence of buffers that represents the
+  /// underlying memory.
+  /**
+   * @param pos Position of the first byte to represent in the buffer sequence
+   *
+   * @param n The number of bytes to return in the buffer sequence. If the
+   * underlying memory is shorter, the buffer sequence represents as many bytes
+   * as are available.
+   *
+   * @note The returned object is invalidated by any
+   * @c dynamic_segmented_buffer or @c segmented_buffer member function that
+   * modifies the input sequence or output sequence.
+   */
+  const_buffers_type data(std::size_t pos,
+      std::size_t n) const ASIO_NOEXCEPT
+  {
+    return static_cast<const segmented_buffer&>(buf_).data(pos, n);
+  }
+
+#if !defined(ASIO_NO_DYNAMIC_BUFFER_V1)
+  /// @b DynamicBuffer_v1: Get a list of buffers that represents the output
+  /// sequence, with the given size.
+  /**
+   * Ensures that the output sequence can accommodate @c n bytes, allocating
+   * blocks as necessary.
+   *
+   * @throws std::length_error If <tt>size() + n > max_size()</tt>.
+   *
+   * @note The returned object is invalidated by any
+   * @c dynamic_segmented_buffer or @c segmented_buffer member function that
+   * modifies the input sequence or output sequence.
+   */
+  mutable_buffers_type prepare(std::size_t n)
+  {
+    check_size(n);
+    return buf_.prepare(n);
+  }
+
+  /// @b DynamicBuffer_v1: Move bytes from the output sequence to the input
+  /// sequence.
+  /**
+   * @param n The number of bytes to append from the start of the output
+   * sequence to the end of the input sequence. The remainder of the output
+   * sequence is discarded.
+   *
+   * Requires a preceding call <tt>prepare(x)</tt> where <tt>x >= n</tt>, and
+   * no intervening operations that modify the input or output sequence.
+   *
+   * @note If @c n is greater than the size of the output sequence, the entire
+   * output sequence is moved to the input sequence and no error is issued.
+   */
+  void commit(std::size_t n) ASIO_NOEXCEPT
+  {
+    buf_.commit(n);
+  }
+#endif // !defined(ASIO_NO_DYNAMIC_BUFFER_V1)
+
+  /// @b DynamicBuffer_v2: Grow the underlying memory by the specified number of
+  /// bytes.
+  /**
+   * @throws std::length_error If <tt>size() + n > max_size()</tt>.
+   */
+  void grow(std::size_t n)
+  {
+    check_size(n);
+    buf_.grow(n);
+  }
+
+  /// @b DynamicBuffer_v2: Shrink the underlying memory by the specified number
+  /// of bytes.
+  /**
+   * Removes @c n bytes from the end of the readable bytes. If @c n is greater
+   * than the number of readable bytes, the segmented buffer is emptied.
+   */
+  void shrink(std::size_t n) ASIO_NOEXCEPT
+  {
+    buf_.shrink(n);
+  }
+
+  /// @b DynamicBuffer_v1: Remove characters from the input sequence.
+  /// @b DynamicBuffer_v2: Consume the specified number of bytes from the
+  /// beginning of the underlying memory.
+  /**
+   * Removes @c n bytes from the front of the readable bytes, releasing the
+   * blocks that no longer hold readable bytes without moving the remaining
+   * bytes. If @c n is greater than the number of readable bytes, the
+   * segmented buffer is emptied and no error is issued.
+   */
+  void consume(std::size_t n) ASIO_NOEXCEPT
+  {
+    buf_.consume(n);
+  }
+
+private:
+  void check_size(std::size_t n) const
+  {
+    if (size() > max_size() || max_size() - size() < n)
+    {
+      std::length_error ex("dynamic_segmented_buffer too long");
+      asio::detail::throw_exception(ex);
+    }
+  }
+
+  segmented_buffer& buf_;
+  const std::size_t max_size_;
+};
+
+/// Create a new dynamic buffer that represents the given segmented buffer.
+/**
+ * @returns <tt>dynamic_segmented_buffer(buf)</tt>.
+ */
+inline dynamic_segmented_buffer dynamic_buffer(
+    segmented_buffer& buf) ASIO_NOEXCEPT
+{
+  return dynamic_segmented_buffer(buf);
+}
+
+/// Create a new dynamic buffer that represents the given segmented buffer.
+/**
+ * @returns <tt>dynamic_segmented_buffer(buf, max_size)</tt>.
+ */
+inline dynamic_segmented_buffer dynamic_buffer(segmented_buffer& buf,
+    std::size_t max_size) ASIO_NOEXCEPT
+{
+  return dynamic_segmented_buffer(buf, max_size);
+}
+
+} // namespace asio
+
+#include "detail/pop_options.hpp"
+
+#endif // ASIO_SEGMENTED_BUFFER_HPP
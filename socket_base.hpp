@@ -396,6 +396,42 @@ public:
       reuse_address;
 #endif
 
+  /// Socket option to allow several sockets to be bound to the same address,
+  /// with incoming connections or datagrams distributed between them.
+  /**
+   * Implements the SOL_SOCKET/SO_REUSEPORT socket option. Only defined on
+   * platforms that support the option.
+   *
+   * @par Examples
+   * Setting the option:
+   * @code
+   * asio::ip::tcp::acceptor acceptor(my_context);
+   * ...
+   * asio::socket_base::reuse_port option(true);
+   * acceptor.set_option(option);
+   * @endcode
+   *
+   * @par
+   * Getting the current option value:
+   * @code
+   * asio::ip::tcp::acceptor acceptor(my_context);
+   * ...
+   * asio::socket_base::reuse_port option;
+   * acceptor.get_option(option);
+   * bool is_set = option.value();
+   * @endcode
+   *
+   * @par Concepts:
+   * Socket_Option, Boolean_Socket_Option.
+   */
+#if defined(GENERATING_DOCUMENTATION)
+  typedef implementation_defined reuse_port;
+#elif defined(ASIO_OS_DEF_SO_REUSEPORT)
+  typedef asio::detail::socket_option::boolean<
+    ASIO_OS_DEF(SOL_SOCKET), ASIO_OS_DEF(SO_REUSEPORT)>
+      reuse_port;
+#endif
+
   /// Socket option to specify whether the socket lingers on close if unsent
   /// data is present.
   /**
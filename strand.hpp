@@ -243,6 +243,87 @@ public:
     return detail::strand_executor_service::running_in_this_thread(impl_);
   }
 
+  /// Get the maximum number of functions that the strand executes each time
+  /// it is scheduled on its underlying executor.
+  std::size_t max_handlers_per_turn() const ASIO_NOEXCEPT
+  {
+    return detail::strand_executor_service::max_handlers_per_turn(impl_);
+  }
+
+  /// Set the maximum number of functions that the strand executes each time
+  /// it is scheduled on its underlying executor.
+  /**
+   * By default, each time the strand is scheduled it executes every function
+   * that was ready to run, so that a busy strand can occupy a thread for a
+   * long time while other work waits. When a limit is set, the strand stops
+   * after executing that many functions and posts itself to the underlying
+   * executor to execute the rest. A value of 0 means no limit.
+   *
+   * The limit applies to all copies of the strand. It may be set from any
+   * thread, and takes effect from the next time the strand is scheduled.
+   */
+  void max_handlers_per_turn(std::size_t n) const ASIO_NOEXCEPT
+  {
+    detail::strand_executor_service::max_handlers_per_turn(impl_, n);
+  }
+
+  /// Get the maximum time, in microseconds, that the strand spends executing
+  /// functions each time it is scheduled on its underlying executor.
+  long max_usec_per_turn() const ASIO_NOEXCEPT
+  {
+    return detail::strand_executor_service::max_usec_per_turn(impl_);
+  }
+
+  /// Set the maximum time, in microseconds, that the strand spends executing
+  /// functions each time it is scheduled on its underlying executor.
+  /**
+   * When a limit is set, the strand stops once a function completes after
+   * the limit has been reached, and posts itself to the underlying executor
+   * to execute the rest. Setting a limit also enables the measurement
+   * reported by run_time_usec(). A value of 0 means no limit. Requires
+   * @c std::chrono, and is otherwise ignored.
+   *
+   * The limit applies to all copies of the strand. It may be set from any
+   * thread, and takes effect from the next time the strand is scheduled.
+   */
+  void max_usec_per_turn(long usec) const ASIO_NOEXCEPT
+  {
+    detail::strand_executor_service::max_usec_per_turn(impl_, usec);
+  }
+
+  /// Get the number of times the strand has been scheduled on its underlying
+  /// executor.
+  /**
+   * This and the other statistics are updated by the strand as it executes
+   * functions. They may be read from any thread, but are only guaranteed to
+   * be up to date when read from within the strand.
+   */
+  std::size_t turns() const ASIO_NOEXCEPT
+  {
+    return detail::strand_executor_service::turns(impl_);
+  }
+
+  /// Get the number of times the strand has stopped executing functions, and
+  /// posted itself to execute the rest, because a limit was reached.
+  std::size_t preemptions() const ASIO_NOEXCEPT
+  {
+    return detail::strand_executor_service::preemptions(impl_);
+  }
+
+  /// Get the largest number of functions that were ready to run when the
+  /// strand was scheduled.
+  std::size_t max_queue_depth() const ASIO_NOEXCEPT
+  {
+    return detail::strand_executor_service::max_queue_depth(impl_);
+  }
+
+  /// Get the total time, in microseconds, that the strand has spent executing
+  /// functions while a time limit was set.
+  uint64_t run_time_usec() const ASIO_NOEXCEPT
+  {
+    return detail::strand_executor_service::run_time_usec(impl_);
+  }
+
   /// Compare two strands for equality.
   /**
    * Two strands are equal if they refer to the same ordered, non-concurrent
@@ -0,0 +1,109 @@
+//
+// strand_throughput.cpp
+// ~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2020 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Measures the rate at which handlers run on a large number of strands that
+// share the threads of one io_context. Each strand runs a chain of handlers,
+// each of which posts its successor along with one extra handler, so that
+// the strands' queues are both contended and frequently empty.
+
+#include "asio/io_context.hpp"
+#include "asio/post.hpp"
+#include "asio/strand.hpp"
+#include "asio/thread.hpp"
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#if defined(ASIO_HAS_BOOST_BIND)
+# include <boost/bind/bind.hpp>
+#else // defined(ASIO_HAS_BOOST_BIND)
+# include <functional>
+#endif // defined(ASIO_HAS_BOOST_BIND)
+
+#if defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = boost;
+#else // defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = std;
+#endif
+
+#if defined(ASIO_HAS_CHRONO)
+
+typedef asio::strand<asio::io_context::executor_type> strand_type;
+
+void extra()
+{
+}
+
+void step(strand_type* s, int remaining)
+{
+  asio::post(*s, extra);
+  if (remaining > 0)
+    asio::post(*s, bindns::bind(step, s, remaining - 1));
+}
+
+void run(asio::io_context* ioc)
+{
+  ioc->run();
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc != 4)
+  {
+    std::cerr << "Usage: strand_throughput <threads> <strands> <chain>\n";
+    return 1;
+  }
+
+  int thread_count = std::atoi(argv[1]);
+  int strand_count = std::atoi(argv[2]);
+  int chain_length = std::atoi(argv[3]);
+
+  asio::io_context ioc(thread_count);
+  std::vector<strand_type> strands;
+  strands.reserve(strand_count);
+  for (int i = 0; i < strand_count; ++i)
+  {
+    strands.push_back(asio::make_strand(ioc));
+    asio::post(strands.back(),
+        bindns::bind(step, &strands.back(), chain_length - 1));
+  }
+
+  asio::chrono::steady_clock::time_point start
+    = asio::chrono::steady_clock::now();
+
+  std::vector<asio::thread*> threads;
+  for (int i = 0; i < thread_count; ++i)
+    threads.push_back(new asio::thread(bindns::bind(run, &ioc)));
+  for (std::size_t i = 0; i < threads.size(); ++i)
+  {
+    threads[i]->join();
+    delete threads[i];
+  }
+
+  double seconds = asio::chrono::duration_cast<
+    asio::chrono::duration<double> >(
+        asio::chrono::steady_clock::now() - start).count();
+  double handlers = 2.0 * strand_count * chain_length;
+
+  std::cout << thread_count << " threads, " << strand_count << " strands: "
+    << handlers / seconds << " handlers/s\n";
+
+  return 0;
+}
+
+#else // defined(ASIO_HAS_CHRONO)
+
+int main()
+{
+  std::cerr << "std::chrono or Boost.Chrono is required.\n";
+  return 1;
+}
+
+#endif // defined(ASIO_HAS_CHRONO)
@@ -0,0 +1,193 @@
+//
+// basic_stream_socket.cpp
+// ~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2020 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Disable autolinking for unit tests.
+#if !defined(BOOST_ALL_NO_LIB)
+#define BOOST_ALL_NO_LIB 1
+#endif // !defined(BOOST_ALL_NO_LIB)
+
+// Test that header file is self-contained.
+#include "asio/basic_stream_socket.hpp"
+
+#include <vector>
+#include "asio/io_context.hpp"
+#include "asio/ip/tcp.hpp"
+#include "asio/read.hpp"
+#include "asio/write.hpp"
+#include "unit_test.hpp"
+
+#if defined(ASIO_HAS_BOOST_BIND)
+# include <boost/bind/bind.hpp>
+#else // defined(ASIO_HAS_BOOST_BIND)
+# include <functional>
+#endif // defined(ASIO_HAS_BOOST_BIND)
+
+#if defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = boost;
+#else // defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = std;
+#endif
+
+using namespace asio;
+
+#if !defined(ASIO_HAS_IOCP) && !defined(ASIO_WINDOWS_RUNTIME)
+
+// Connect a pair of sockets over the loopback interface.
+void connect_loopback(ip::tcp::socket& client, ip::tcp::socket& server)
+{
+  ip::tcp::acceptor acceptor(client.get_executor(),
+      ip::tcp::endpoint(ip::address_v4::loopback(), 0));
+  client.connect(acceptor.local_endpoint());
+  acceptor.accept(server);
+}
+
+// Zero-copy sends may be enabled only on an open socket, and are reported
+// as unsupported where the platform has no support for them.
+void zero_copy_mode_test()
+{
+  io_context ioc;
+  ip::tcp::socket s(ioc);
+  asio::error_code ec;
+
+  s.zero_copy(true, ec);
+  ASIO_CHECK(ec == asio::error::bad_descriptor);
+  ASIO_CHECK(!s.zero_copy());
+
+  s.open(ip::tcp::v4());
+  s.zero_copy(true, ec);
+#if defined(ASIO_HAS_MSG_ZEROCOPY)
+  ASIO_CHECK(!ec || ec == asio::error::operation_not_supported);
+#else // defined(ASIO_HAS_MSG_ZEROCOPY)
+  ASIO_CHECK(ec == asio::error::operation_not_supported);
+#endif // defined(ASIO_HAS_MSG_ZEROCOPY)
+  ASIO_CHECK(s.zero_copy() == !ec);
+
+  s.zero_copy(false, ec);
+  ASIO_CHECK(!ec);
+  ASIO_CHECK(!s.zero_copy());
+}
+
+struct transfer_result
+{
+  asio::error_code ec;
+  std::size_t bytes;
+  bool called;
+};
+
+void handle_transfer(const asio::error_code& ec,
+    std::size_t bytes, transfer_result* r)
+{
+  r->ec = ec;
+  r->bytes = bytes;
+  r->called = true;
+}
+
+void write_next(ip::tcp::socket* s, const std::vector<char>* data,
+    const std::size_t* sizes, std::size_t count, std::size_t* written,
+    const asio::error_code& ec, std::size_t bytes)
+{
+  if (ec || count == 0)
+    return;
+  *written += bytes;
+  async_write(*s, asio::buffer(&(*data)[*written], sizes[0]),
+      bindns::bind(write_next, s, data, sizes + 1, count - 1, written,
+        bindns::placeholders::_1, bindns::placeholders::_2));
+}
+
+// Sends both above and below the zero-copy threshold deliver their data
+// intact and in order, including after the kernel reports that it copied
+// the data, as it does on loopback.
+void zero_copy_send_test()
+{
+  io_context ioc;
+  ip::tcp::socket client(ioc), server(ioc);
+  connect_loopback(client, server);
+
+  asio::error_code ec;
+  client.zero_copy(true, ec);
+  if (ec)
+    return;
+
+  const std::size_t sizes[] = { 1 << 20, 100, 1 << 20, 20000, 0 };
+  std::size_t total = 0;
+  for (std::size_t i = 0; i < 4; ++i)
+    total += sizes[i];
+
+  std::vector<char> data(total);
+  for (std::size_t i = 0; i < total; ++i)
+    data[i] = static_cast<char>(i * 7 + i / 251);
+
+  std::vector<char> received(total);
+  transfer_result read_result = transfer_result();
+  async_read(server, asio::buffer(received),
+      bindns::bind(handle_transfer, bindns::placeholders::_1,
+        bindns::placeholders::_2, &read_result));
+
+  std::size_t written = 0;
+  write_next(&client, &data, sizes, 5, &written,
+      asio::error_code(), 0);
+  ioc.run();
+
+  ASIO_CHECK(client.zero_copy());
+  ASIO_CHECK(written == total);
+  ASIO_CHECK(read_result.called);
+  ASIO_CHECK(!read_result.ec);
+  ASIO_CHECK(read_result.bytes == total);
+  ASIO_CHECK(received == data);
+}
+
+// A send that the peer does not read can be cancelled, whether or not it has
+// passed its buffers to the kernel.
+void zero_copy_cancel_test()
+{
+  io_context ioc;
+  ip::tcp::socket client(ioc), server(ioc);
+  connect_loopback(client, server);
+
+  asio::error_code ec;
+  client.zero_copy(true, ec);
+  if (ec)
+    return;
+
+  // Larger than the socket buffers, so the send cannot complete.
+  std::vector<char> data(64 << 20);
+  transfer_result result = transfer_result();
+  async_write(client, asio::buffer(data),
+      bindns::bind(handle_transfer, bindns::placeholders::_1,
+        bindns::placeholders::_2, &result));
+
+  for (int i = 0; i < 10; ++i)
+  {
+    ioc.restart();
+    ioc.poll();
+  }
+  ASIO_CHECK(!result.called);
+
+  client.cancel();
+  ioc.restart();
+  ioc.run();
+  ASIO_CHECK(result.called);
+  ASIO_CHECK(result.ec == asio::error::operation_aborted);
+  ASIO_CHECK(result.bytes < data.size());
+}
+
+#endif // !defined(ASIO_HAS_IOCP) && !defined(ASIO_WINDOWS_RUNTIME)
+
+ASIO_TEST_SUITE
+(
+  "basic_stream_socket",
+#if !defined(ASIO_HAS_IOCP) && !defined(ASIO_WINDOWS_RUNTIME)
+  ASIO_TEST_CASE(zero_copy_mode_test)
+  ASIO_TEST_CASE(zero_copy_send_test)
+  ASIO_TEST_CASE(zero_copy_cancel_test)
+#else // !defined(ASIO_HAS_IOCP) && !defined(ASIO_WINDOWS_RUNTIME)
+  ASIO_TEST_CASE(null_test)
+#endif // !defined(ASIO_HAS_IOCP) && !defined(ASIO_WINDOWS_RUNTIME)
+)
@@ -0,0 +1,200 @@
+//
+// buffer_pool.cpp
+// ~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2020 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Disable autolinking for unit tests.
+#if !defined(BOOST_ALL_NO_LIB)
+#define BOOST_ALL_NO_LIB 1
+#endif // !defined(BOOST_ALL_NO_LIB)
+
+// Test that header file is self-contained.
+#include "asio/buffer_pool.hpp"
+
+#include <cstring>
+#include "asio/detail/reactor.hpp"
+#include "asio/executor_work_guard.hpp"
+#include "asio/io_context.hpp"
+#include "asio/local/connect_pair.hpp"
+#include "asio/local/stream_protocol.hpp"
+#include "asio/system_error.hpp"
+#include "asio/write.hpp"
+#include "unit_test.hpp"
+
+#if defined(ASIO_HAS_BOOST_BIND)
+# include <boost/bind/bind.hpp>
+#else // defined(ASIO_HAS_BOOST_BIND)
+# include <functional>
+#endif // defined(ASIO_HAS_BOOST_BIND)
+
+#if defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = boost;
+#else // defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = std;
+#endif
+
+using namespace asio;
+
+// A pool whose buffers, or number of buffers, is zero is rejected.
+void buffer_pool_construct_test()
+{
+  io_context ioc;
+
+  bool thrown = false;
+  try
+  {
+    buffer_pool pool(ioc, 0, 4);
+  }
+  catch (asio::system_error& e)
+  {
+    thrown = (e.code() == asio::error::invalid_argument);
+  }
+  ASIO_CHECK(thrown);
+
+  thrown = false;
+  try
+  {
+    buffer_pool pool(ioc, 64, 0);
+  }
+  catch (asio::system_error& e)
+  {
+    thrown = (e.code() == asio::error::invalid_argument);
+  }
+  ASIO_CHECK(thrown);
+
+  buffer_pool pool(ioc, 64, 4);
+  ASIO_CHECK(pool.buffer_size() == 64);
+  ASIO_CHECK(pool.buffer_count() == 4);
+
+  // Memory from outside the pool is ignored.
+  char other[64];
+  pool.release(asio::buffer(other));
+}
+
+struct receive_result
+{
+  asio::error_code ec;
+  asio::mutable_buffer data;
+  bool called;
+};
+
+void handle_receive(const asio::error_code& ec,
+    const asio::mutable_buffer& data, receive_result* r)
+{
+  r->ec = ec;
+  r->data = data;
+  r->called = true;
+}
+
+#if defined(ASIO_HAS_LOCAL_SOCKETS)
+
+// Received data is passed in a buffer taken from the pool, which may be
+// released and used again. When every buffer is in use, a receive fails.
+void buffer_pool_receive_test()
+{
+  io_context ioc;
+  local::stream_protocol::socket s1(ioc), s2(ioc);
+  local::connect_pair(s1, s2);
+
+  buffer_pool pool(ioc, 16, 1);
+
+  receive_result first = receive_result();
+  s2.async_receive(pool, bindns::bind(handle_receive,
+        bindns::placeholders::_1, bindns::placeholders::_2, &first));
+  asio::write(s1, asio::buffer("hello", 5));
+  ioc.run();
+  ASIO_CHECK(first.called);
+  ASIO_CHECK(!first.ec);
+  ASIO_CHECK(first.data.size() == 5);
+  ASIO_CHECK(std::memcmp(first.data.data(), "hello", 5) == 0);
+
+  // The only buffer is still held, so the next receive fails.
+  receive_result second = receive_result();
+  s2.async_receive(pool, bindns::bind(handle_receive,
+        bindns::placeholders::_1, bindns::placeholders::_2, &second));
+  asio::write(s1, asio::buffer("world", 5));
+  ioc.restart();
+  ioc.run();
+  ASIO_CHECK(second.called);
+  ASIO_CHECK(second.ec == asio::error::no_buffer_space);
+
+  // Once released, the buffer is used again.
+  pool.release(first.data);
+  receive_result third = receive_result();
+  s2.async_receive(pool, bindns::bind(handle_receive,
+        bindns::placeholders::_1, bindns::placeholders::_2, &third));
+  ioc.restart();
+  ioc.run();
+  ASIO_CHECK(third.called);
+  ASIO_CHECK(!third.ec);
+  ASIO_CHECK(third.data.size() == 5);
+  ASIO_CHECK(std::memcmp(third.data.data(), "world", 5) == 0);
+  pool.release(third.data);
+}
+
+#endif // defined(ASIO_HAS_LOCAL_SOCKETS)
+
+// Give the reactor a chance to reap completions.
+void poll_task(io_context& ioc)
+{
+  asio::executor_work_guard<io_context::executor_type>
+    work(ioc.get_executor());
+  ioc.restart();
+  ioc.poll();
+}
+
+// Invalid groups of buffers are rejected when they are registered, and
+// buffers that the kernel refuses are reported as the group's error.
+void buffer_pool_register_test()
+{
+#if defined(ASIO_HAS_IO_URING)
+  io_context ioc;
+  detail::reactor& reactor = use_service<detail::reactor>(ioc);
+  reactor.init_task();
+
+  char data[64];
+  asio::error_code ec;
+  ASIO_CHECK(reactor.register_buffers(data, 0, 1, ec) == -1);
+  ASIO_CHECK(ec == asio::error::invalid_argument);
+  ASIO_CHECK(reactor.register_buffers(data, 64, 0, ec) == -1);
+  ASIO_CHECK(ec == asio::error::invalid_argument);
+  ASIO_CHECK(!reactor.buffer_group_error(-1));
+
+  // Memory at the top of the address space cannot belong to the process.
+  void* bad = reinterpret_cast<void*>(~static_cast<std::size_t>(0xfff));
+  int group = reactor.register_buffers(bad, 4096, 2, ec);
+  if (group >= 0)
+  {
+    ASIO_CHECK(!ec);
+    poll_task(ioc);
+    ASIO_CHECK(!!reactor.buffer_group_error(group));
+  }
+  else
+  {
+    ASIO_CHECK(ec == asio::error::operation_not_supported);
+  }
+
+  int good = reactor.register_buffers(data, 64, 1, ec);
+  if (good >= 0)
+  {
+    poll_task(ioc);
+    ASIO_CHECK(!reactor.buffer_group_error(good));
+    reactor.unregister_buffers(good, 1);
+  }
+#endif // defined(ASIO_HAS_IO_URING)
+}
+
+ASIO_TEST_SUITE
+(
+  "buffer_pool",
+  ASIO_TEST_CASE(buffer_pool_construct_test)
+#if defined(ASIO_HAS_LOCAL_SOCKETS)
+  ASIO_TEST_CASE(buffer_pool_receive_test)
+#endif // defined(ASIO_HAS_LOCAL_SOCKETS)
+  ASIO_TEST_CASE(buffer_pool_register_test)
+)
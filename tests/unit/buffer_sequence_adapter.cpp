@@ -0,0 +1,272 @@
+//
+// buffer_sequence_adapter.cpp
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2020 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Disable autolinking for unit tests.
+#if !defined(BOOST_ALL_NO_LIB)
+#define BOOST_ALL_NO_LIB 1
+#endif // !defined(BOOST_ALL_NO_LIB)
+
+#include "asio/detail/buffer_sequence_adapter.hpp"
+
+#include <cstring>
+#include <string>
+#include <vector>
+#include "asio/io_context.hpp"
+#include "asio/local/connect_pair.hpp"
+#include "asio/local/stream_protocol.hpp"
+#include "asio/read.hpp"
+#include "asio/write.hpp"
+#include "unit_test.hpp"
+
+#if defined(ASIO_HAS_BOOST_BIND)
+# include <boost/bind/bind.hpp>
+#else // defined(ASIO_HAS_BOOST_BIND)
+# include <functional>
+#endif // defined(ASIO_HAS_BOOST_BIND)
+
+#if defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = boost;
+#else // defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = std;
+#endif
+
+using namespace asio;
+
+typedef std::vector<const_buffer> buffer_vector;
+typedef detail::buffer_sequence_adapter<const_buffer, buffer_vector>
+  adapter_type;
+
+const std::size_t max_buffers =
+  detail::buffer_sequence_adapter_base::max_buffers;
+const std::size_t max_gather_buffers =
+  detail::buffer_sequence_adapter_base::max_gather_buffers;
+
+#if !defined(ASIO_WINDOWS) && !defined(__CYGWIN__)
+
+typedef detail::flattened_buffer_sequence_adapter<buffer_vector>
+  flattened_type;
+
+// Concatenate the native buffers of an adapter.
+template <typename Adapter>
+std::string gather(Adapter& bufs)
+{
+  std::string s;
+  for (std::size_t i = 0; i < bufs.count(); ++i)
+    s.append(static_cast<const char*>(bufs.buffers()[i].iov_base),
+        bufs.buffers()[i].iov_len);
+  return s;
+}
+
+#endif // !defined(ASIO_WINDOWS) && !defined(__CYGWIN__)
+
+// A sequence longer than the number of native buffers held in the adapter is
+// passed in full, up to the limit of a gather operation, beyond which it is
+// truncated to its first buffers.
+void buffer_sequence_adapter_limit_test()
+{
+  ASIO_CHECK(max_buffers <= 64);
+  ASIO_CHECK(max_gather_buffers >= max_buffers);
+
+  std::vector<char> data(max_gather_buffers + 100);
+  for (std::size_t i = 0; i < data.size(); ++i)
+    data[i] = static_cast<char>('a' + i % 26);
+
+  const std::size_t sizes[] = { 0, 1, max_buffers, max_buffers + 1,
+    max_gather_buffers, data.size() };
+  for (std::size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i)
+  {
+    buffer_vector v;
+    for (std::size_t j = 0; j < sizes[i]; ++j)
+      v.push_back(asio::buffer(&data[j], 1));
+
+    adapter_type bufs(v);
+    std::size_t expected = (std::min)(sizes[i], max_gather_buffers);
+    ASIO_CHECK(bufs.count() == expected);
+    ASIO_CHECK(bufs.total_size() == expected);
+    ASIO_CHECK(bufs.all_empty() == (expected == 0));
+    ASIO_CHECK(adapter_type::all_empty(v) == (expected == 0));
+#if !defined(ASIO_WINDOWS) && !defined(__CYGWIN__)
+    ASIO_CHECK(gather(bufs) == std::string(&data[0], expected));
+#endif // !defined(ASIO_WINDOWS) && !defined(__CYGWIN__)
+  }
+
+  // Empty buffers at the start do not hide later data.
+  buffer_vector v(max_buffers + 10, const_buffer());
+  v.push_back(asio::buffer(&data[0], 1));
+  ASIO_CHECK(!adapter_type::all_empty(v));
+}
+
+// Adjacent small buffers are copied into one native buffer, while large
+// buffers, and small buffers with no small neighbour, are passed as they are.
+void flattened_buffer_sequence_adapter_test()
+{
+#if !defined(ASIO_WINDOWS) && !defined(__CYGWIN__)
+  const char small[] = "abcdefgh";
+  std::string large(100, 'L');
+
+  {
+    buffer_vector v;
+    for (int i = 0; i < 200; ++i)
+      v.push_back(asio::buffer(small + i % 8, 1));
+    flattened_type bufs(v, 16);
+    ASIO_CHECK(bufs.count() == 1);
+    ASIO_CHECK(bufs.total_size() == 200);
+    std::string expected;
+    for (int i = 0; i < 200; ++i)
+      expected += small[i % 8];
+    ASIO_CHECK(gather(bufs) == expected);
+  }
+
+  {
+    buffer_vector v;
+    v.push_back(asio::buffer(small, 2));
+    v.push_back(asio::buffer(large));
+    v.push_back(asio::buffer(small + 2, 2));
+    v.push_back(const_buffer());
+    v.push_back(asio::buffer(large));
+    flattened_type bufs(v, 16);
+    ASIO_CHECK(bufs.count() == 4);
+    ASIO_CHECK(bufs.buffers()[0].iov_base == small);
+    ASIO_CHECK(bufs.buffers()[1].iov_base == large.data());
+    ASIO_CHECK(gather(bufs) == "ab" + large + "cd" + large);
+  }
+
+  {
+    buffer_vector v;
+    v.push_back(asio::buffer(small, 3));
+    v.push_back(asio::buffer(small + 3, 3));
+    v.push_back(asio::buffer(large));
+    v.push_back(asio::buffer(small + 6, 2));
+    flattened_type bufs(v, 16);
+    ASIO_CHECK(bufs.count() == 3);
+    ASIO_CHECK(bufs.buffers()[0].iov_base != small);
+    ASIO_CHECK(gather(bufs) == "abcdef" + large + "gh");
+  }
+
+  // Once the storage is full, each further buffer takes a native buffer of
+  // its own, up to the limit of a gather operation.
+  {
+    std::vector<char> data(flattened_type::storage_size + max_gather_buffers);
+    for (std::size_t i = 0; i < data.size(); ++i)
+      data[i] = static_cast<char>('a' + i % 26);
+    buffer_vector v;
+    for (std::size_t i = 0; i < data.size(); ++i)
+      v.push_back(asio::buffer(&data[i], 1));
+    flattened_type bufs(v, 16);
+    std::size_t total = flattened_type::storage_size + max_gather_buffers - 1;
+    ASIO_CHECK(bufs.count() == max_gather_buffers);
+    ASIO_CHECK(bufs.total_size() == total);
+    ASIO_CHECK(gather(bufs) == std::string(&data[0], total));
+  }
+
+  {
+    buffer_vector v;
+    flattened_type bufs(v, 16);
+    ASIO_CHECK(bufs.count() == 0);
+    ASIO_CHECK(bufs.all_empty());
+  }
+#endif // !defined(ASIO_WINDOWS) && !defined(__CYGWIN__)
+}
+
+struct write_result
+{
+  asio::error_code ec;
+  std::size_t bytes;
+};
+
+void handle_write(const asio::error_code& ec,
+    std::size_t bytes, write_result* r)
+{
+  r->ec = ec;
+  r->bytes = bytes;
+}
+
+// A long sequence of small buffers is written intact, with and without
+// flattening.
+void gather_write_test()
+{
+#if defined(ASIO_HAS_LOCAL_SOCKETS)
+  std::vector<char> data(20000);
+  for (std::size_t i = 0; i < data.size(); ++i)
+    data[i] = static_cast<char>(i * 31);
+
+  buffer_vector v;
+  for (std::size_t i = 0; i < data.size(); i += 1 + i % 7)
+    v.push_back(asio::buffer(&data[i], (std::min)(
+            static_cast<std::size_t>(1 + i % 7), data.size() - i)));
+  std::size_t total = asio::buffer_size(v);
+  ASIO_CHECK(total == data.size());
+
+  for (std::size_t flatten = 0; flatten <= 8; flatten += 8)
+  {
+    io_context ioc(io_context_options().gather_flatten_size(flatten));
+    local::stream_protocol::socket s1(ioc), s2(ioc);
+    local::connect_pair(s1, s2);
+
+    // A direct send passes at most one adapter's worth of buffers.
+    std::size_t sent = s1.send(v);
+    ASIO_CHECK(sent > 0);
+    ASIO_CHECK(sent <= (flatten ? total : max_gather_buffers * 7));
+
+    write_result w = write_result();
+    async_write(s1, v, bindns::bind(handle_write,
+          bindns::placeholders::_1, bindns::placeholders::_2, &w));
+    std::vector<char> received(sent + total);
+    write_result r = write_result();
+    async_read(s2, asio::buffer(received), bindns::bind(handle_write,
+          bindns::placeholders::_1, bindns::placeholders::_2, &r));
+    ioc.run();
+
+    ASIO_CHECK(!w.ec);
+    ASIO_CHECK(w.bytes == total);
+    ASIO_CHECK(!r.ec);
+    ASIO_CHECK(std::memcmp(&received[0], &data[0], sent) == 0);
+    ASIO_CHECK(std::memcmp(&received[sent], &data[0], total) == 0);
+  }
+#endif // defined(ASIO_HAS_LOCAL_SOCKETS)
+}
+
+// A send of more slices than are held in the adapter, but no more than a
+// gather operation accepts, takes a single call with flattening disabled.
+void long_gather_send_test()
+{
+#if defined(ASIO_HAS_LOCAL_SOCKETS)
+  const std::size_t slices = 1000;
+  if (max_gather_buffers < slices)
+    return;
+
+  std::vector<char> data(slices * 10);
+  for (std::size_t i = 0; i < data.size(); ++i)
+    data[i] = static_cast<char>(i * 7);
+  buffer_vector v;
+  for (std::size_t i = 0; i < slices; ++i)
+    v.push_back(asio::buffer(&data[i * 10], 10));
+
+  io_context ioc(io_context_options().gather_flatten_size(0));
+  local::stream_protocol::socket s1(ioc), s2(ioc);
+  local::connect_pair(s1, s2);
+
+  std::size_t sent = s1.send(v);
+  ASIO_CHECK(sent == data.size());
+
+  std::vector<char> received(data.size());
+  read(s2, asio::buffer(received));
+  ASIO_CHECK(received == data);
+#endif // defined(ASIO_HAS_LOCAL_SOCKETS)
+}
+
+ASIO_TEST_SUITE
+(
+  "buffer_sequence_adapter",
+  ASIO_TEST_CASE(buffer_sequence_adapter_limit_test)
+  ASIO_TEST_CASE(flattened_buffer_sequence_adapter_test)
+  ASIO_TEST_CASE(gather_write_test)
+  ASIO_TEST_CASE(long_gather_send_test)
+)
@@ -0,0 +1,263 @@
+//
+// buffered_stream_storage.cpp
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2020 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Disable autolinking for unit tests.
+#if !defined(BOOST_ALL_NO_LIB)
+#define BOOST_ALL_NO_LIB 1
+#endif // !defined(BOOST_ALL_NO_LIB)
+
+#include "asio/detail/buffered_stream_storage.hpp"
+
+#include <string>
+#include "asio/buffered_read_stream.hpp"
+#include "asio/buffered_write_stream.hpp"
+#include "asio/io_context.hpp"
+#include "asio/local/connect_pair.hpp"
+#include "asio/local/stream_protocol.hpp"
+#include "asio/read.hpp"
+#include "asio/write.hpp"
+#include "unit_test.hpp"
+
+#if defined(ASIO_HAS_BOOST_BIND)
+# include <boost/bind/bind.hpp>
+#else // defined(ASIO_HAS_BOOST_BIND)
+# include <functional>
+#endif // defined(ASIO_HAS_BOOST_BIND)
+
+#if defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = boost;
+#else // defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = std;
+#endif
+
+using asio::detail::buffered_stream_storage;
+
+// Append a string to the unread data.
+void append(buffered_stream_storage& storage, const std::string& s)
+{
+  std::size_t n = asio::buffer_copy(storage.prepare(), asio::buffer(s));
+  storage.commit(n);
+}
+
+template <typename Buffers>
+std::string to_string(const Buffers& buffers)
+{
+  std::string s(asio::buffer_size(buffers), '\0');
+  if (!s.empty())
+    asio::buffer_copy(asio::buffer(&s[0], s.size()), buffers);
+  return s;
+}
+
+// The unread data and the free space each wrap around the end of the memory
+// as two buffers, and consuming data does not move what remains.
+void buffered_stream_storage_wraparound_test()
+{
+  buffered_stream_storage storage(8);
+  ASIO_CHECK(storage.capacity() == 8);
+  ASIO_CHECK(storage.empty());
+  ASIO_CHECK(asio::buffer_size(storage.prepare()) == 8);
+
+  append(storage, "abcdef");
+  const void* f = storage.data()[0].data();
+  storage.consume(5);
+  ASIO_CHECK(storage.size() == 1);
+  ASIO_CHECK(storage.data()[0].data()
+      == static_cast<const unsigned char*>(f) + 5);
+
+  buffered_stream_storage::mutable_buffers_type space = storage.prepare();
+  ASIO_CHECK(space[0].size() == 2);
+  ASIO_CHECK(space[1].size() == 5);
+  ASIO_CHECK(space[1].data() == f);
+
+  append(storage, "ghijklm");
+  ASIO_CHECK(storage.size() == 8);
+  ASIO_CHECK(asio::buffer_size(storage.prepare()) == 0);
+  ASIO_CHECK(storage.data()[0].size() == 3);
+  ASIO_CHECK(storage.data()[1].size() == 5);
+  ASIO_CHECK(to_string(storage.data()) == "fghijklm");
+
+  const buffered_stream_storage& const_storage = storage;
+  ASIO_CHECK(to_string(const_storage.data()) == "fghijklm");
+
+  // The free space follows the data, and wraps in its turn.
+  storage.consume(4);
+  space = storage.prepare();
+  ASIO_CHECK(space[0].size() == 3);
+  ASIO_CHECK(space[1].size() == 1);
+  ASIO_CHECK(space[1].data() == f);
+  ASIO_CHECK(to_string(storage.data()) == "jklm");
+
+  // Emptying the buffer returns to the start of the memory.
+  storage.consume(4);
+  ASIO_CHECK(storage.empty());
+  ASIO_CHECK(storage.prepare()[0].data() == f);
+  ASIO_CHECK(storage.prepare()[0].size() == 8);
+
+  append(storage, "xyz");
+  storage.clear();
+  ASIO_CHECK(storage.empty());
+  ASIO_CHECK(storage.prepare()[0].size() == 8);
+
+  buffered_stream_storage empty(0);
+  ASIO_CHECK(asio::buffer_size(empty.prepare()) == 0);
+  ASIO_CHECK(asio::buffer_size(empty.data()) == 0);
+}
+
+// An adaptive buffer doubles when a read fills its free space, up to a
+// limit, and halves after a run of small reads, down to its initial size. A
+// fixed buffer keeps its size.
+void buffered_stream_storage_adaptive_test()
+{
+  buffered_stream_storage fixed(8);
+  fixed.record_fill(8, 8);
+  ASIO_CHECK(fixed.capacity() == 8);
+
+  buffered_stream_storage storage(8, true);
+  append(storage, "0123456");
+  storage.consume(5);
+  append(storage, "789ab");
+  ASIO_CHECK(storage.data()[1].size() > 0);
+
+  storage.record_fill(8, 8);
+  ASIO_CHECK(storage.capacity() == 16);
+  ASIO_CHECK(to_string(storage.data()) == "56789ab");
+  ASIO_CHECK(storage.data()[1].size() == 0);
+
+  for (int i = 0; i < 10; ++i)
+    storage.record_fill(1, 1);
+  ASIO_CHECK(storage.capacity() == 8 * buffered_stream_storage::max_growth);
+
+  // A read that used a good part of the buffer interrupts a run of small
+  // reads.
+  for (int i = 0; i < buffered_stream_storage::shrink_threshold - 1; ++i)
+    storage.record_fill(100, 1);
+  storage.record_fill(100, 50);
+  for (int i = 0; i < buffered_stream_storage::shrink_threshold - 1; ++i)
+    storage.record_fill(100, 1);
+  ASIO_CHECK(storage.capacity() == 8 * buffered_stream_storage::max_growth);
+  storage.record_fill(100, 1);
+  ASIO_CHECK(storage.capacity() == 4 * buffered_stream_storage::max_growth);
+  ASIO_CHECK(to_string(storage.data()) == "56789ab");
+
+  for (int i = 0; i < 10 * buffered_stream_storage::shrink_threshold; ++i)
+    storage.record_fill(100, 0);
+  ASIO_CHECK(storage.capacity() == 8);
+  ASIO_CHECK(to_string(storage.data()) == "56789ab");
+
+  // The buffer does not shrink while it holds more than half of its
+  // capacity.
+  storage.record_fill(1, 1);
+  ASIO_CHECK(storage.capacity() == 16);
+  append(storage, "cdefghijk");
+  for (int i = 0; i < buffered_stream_storage::shrink_threshold; ++i)
+    storage.record_fill(100, 0);
+  ASIO_CHECK(storage.capacity() == 16);
+}
+
+typedef asio::local::stream_protocol::socket socket_type;
+
+void handle_io(const asio::error_code& ec,
+    std::size_t bytes, asio::error_code* out_ec, std::size_t* out_bytes)
+{
+  *out_ec = ec;
+  *out_bytes = bytes;
+}
+
+// Many small records read through a small buffer arrive intact, whether
+// read synchronously or asynchronously.
+void buffered_read_stream_test()
+{
+#if defined(ASIO_HAS_LOCAL_SOCKETS)
+  asio::io_context ioc;
+  socket_type writer(ioc);
+  asio::buffered_read_stream<socket_type> reader(ioc, 24);
+  asio::local::connect_pair(writer, reader.next_layer());
+
+  std::string data;
+  for (int i = 0; i < 2000; ++i)
+    data += static_cast<char>('a' + i % 26);
+  asio::write(writer, asio::buffer(data));
+
+  std::string received;
+  char record[7];
+  for (std::size_t i = 0; i < 1000 / sizeof(record); ++i)
+  {
+    asio::read(reader, asio::buffer(record));
+    received.append(record, sizeof(record));
+  }
+
+  char peeked[3];
+  ASIO_CHECK(reader.in_avail() > 0);
+  std::size_t n = reader.peek(asio::buffer(peeked));
+  ASIO_CHECK(n > 0);
+  ASIO_CHECK(std::string(peeked, n) == data.substr(received.size(), n));
+
+  std::string rest(data.size() - received.size(), '\0');
+  asio::error_code ec;
+  std::size_t bytes = 0;
+  asio::async_read(reader, asio::buffer(&rest[0], rest.size()),
+      bindns::bind(handle_io, bindns::placeholders::_1,
+        bindns::placeholders::_2, &ec, &bytes));
+  ioc.run();
+  ASIO_CHECK(!ec);
+  received += rest;
+  ASIO_CHECK(received == data);
+#endif // defined(ASIO_HAS_LOCAL_SOCKETS)
+}
+
+// Small writes are collected in the buffer and sent when it is full or
+// flushed.
+void buffered_write_stream_test()
+{
+#if defined(ASIO_HAS_LOCAL_SOCKETS)
+  asio::io_context ioc;
+  socket_type reader(ioc);
+  asio::buffered_write_stream<socket_type> writer(ioc, 16);
+  asio::local::connect_pair(writer.next_layer(), reader);
+
+  std::string data;
+  for (int i = 0; i < 100; ++i)
+  {
+    std::string record(1 + i % 5, static_cast<char>('a' + i % 26));
+    asio::write(writer, asio::buffer(record));
+    data += record;
+  }
+  writer.flush();
+  ASIO_CHECK(reader.available() == data.size());
+
+  std::string more = "0123456789";
+  asio::error_code ec;
+  std::size_t bytes = 0;
+  asio::async_write(writer, asio::buffer(more),
+      bindns::bind(handle_io, bindns::placeholders::_1,
+        bindns::placeholders::_2, &ec, &bytes));
+  ioc.run();
+  ASIO_CHECK(!ec && bytes == more.size());
+  writer.async_flush(bindns::bind(handle_io, bindns::placeholders::_1,
+        bindns::placeholders::_2, &ec, &bytes));
+  ioc.restart();
+  ioc.run();
+  ASIO_CHECK(!ec);
+  data += more;
+
+  std::string received(data.size(), '\0');
+  asio::read(reader, asio::buffer(&received[0], received.size()));
+  ASIO_CHECK(received == data);
+#endif // defined(ASIO_HAS_LOCAL_SOCKETS)
+}
+
+ASIO_TEST_SUITE
+(
+  "buffered_stream_storage",
+  ASIO_TEST_CASE(buffered_stream_storage_wraparound_test)
+  ASIO_TEST_CASE(buffered_stream_storage_adaptive_test)
+  ASIO_TEST_CASE(buffered_read_stream_test)
+  ASIO_TEST_CASE(buffered_write_stream_test)
+)
@@ -0,0 +1,197 @@
+//
+// delimiter_set.cpp
+// ~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2020 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Disable autolinking for unit tests.
+#if !defined(BOOST_ALL_NO_LIB)
+#define BOOST_ALL_NO_LIB 1
+#endif // !defined(BOOST_ALL_NO_LIB)
+
+// Test that header file is self-contained.
+#include "asio/delimiter_set.hpp"
+
+#include <string>
+#include <vector>
+#include "asio/buffers_iterator.hpp"
+#include "asio/io_context.hpp"
+#include "asio/local/connect_pair.hpp"
+#include "asio/local/stream_protocol.hpp"
+#include "asio/read_until.hpp"
+#include "asio/write.hpp"
+#include "unit_test.hpp"
+
+#if defined(ASIO_HAS_BOOST_BIND)
+# include <boost/bind/bind.hpp>
+#else // defined(ASIO_HAS_BOOST_BIND)
+# include <functional>
+#endif // defined(ASIO_HAS_BOOST_BIND)
+
+#if defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = boost;
+#else // defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = std;
+#endif
+
+using asio::delimiter_set;
+
+typedef std::vector<asio::const_buffer> buffer_vector;
+typedef std::pair<std::size_t, bool> search_result;
+
+delimiter_set make_set(const char* a, const char* b = 0, const char* c = 0)
+{
+  std::vector<std::string> v;
+  v.push_back(a);
+  if (b)
+    v.push_back(b);
+  if (c)
+    v.push_back(c);
+  return delimiter_set(v.begin(), v.end());
+}
+
+// Search the data both as one buffer and split into single bytes, and
+// through the match condition interface, and check that they all agree.
+search_result search(const delimiter_set& delims,
+    const std::string& data, std::size_t position = 0)
+{
+  search_result whole = delims.search(asio::buffer(data), position);
+
+  buffer_vector bytes;
+  for (std::size_t i = 0; i < data.size(); ++i)
+    bytes.push_back(asio::buffer(&data[i], 1));
+  ASIO_CHECK(delims.search(bytes, position) == whole);
+
+  typedef asio::buffers_iterator<asio::const_buffer> iterator;
+  asio::const_buffer b = asio::buffer(data);
+  iterator begin = iterator::begin(b);
+  std::pair<iterator, bool> r = delims(begin + position, iterator::end(b));
+  ASIO_CHECK(static_cast<std::size_t>(r.first - begin) == whole.first);
+  ASIO_CHECK(r.second == whole.second);
+
+  return whole;
+}
+
+// The result is the end of whichever delimiter ends first, including when
+// one delimiter is a suffix of another.
+void delimiter_set_suffix_test()
+{
+  delimiter_set delims = make_set("\r\n", "\n", "");
+  ASIO_CHECK(search(delims, "") == search_result(0, true));
+
+  delims = make_set("\r\n", "\n");
+  ASIO_CHECK(search(delims, "abc\ndef") == search_result(4, true));
+  ASIO_CHECK(search(delims, "abc\r\ndef") == search_result(5, true));
+  ASIO_CHECK(search(delims, "abc\r\r\n") == search_result(6, true));
+  ASIO_CHECK(search(delims, "\n") == search_result(1, true));
+  ASIO_CHECK(search(delims, "") == search_result(0, false));
+  ASIO_CHECK(search(delims, "abc") == search_result(3, false));
+  ASIO_CHECK(search(delims, "abc\n", 4) == search_result(4, false));
+
+  delims = make_set("xyz", "yz", "z");
+  ASIO_CHECK(search(delims, "aaxyz") == search_result(5, true));
+  ASIO_CHECK(search(delims, "aayz") == search_result(4, true));
+}
+
+// When delimiters overlap, the first to end wins even if another started
+// earlier, and a failed attempt at one delimiter may begin another.
+void delimiter_set_overlap_test()
+{
+  delimiter_set delims = make_set("abcd", "bc");
+  ASIO_CHECK(search(delims, "xabcd") == search_result(4, true));
+  ASIO_CHECK(search(delims, "xabd") == search_result(4, false));
+
+  delims = make_set("aab");
+  ASIO_CHECK(search(delims, "aaab") == search_result(4, true));
+  ASIO_CHECK(search(delims, "aaaa") == search_result(2, false));
+
+  delims = make_set("abab", "baba");
+  ASIO_CHECK(search(delims, "xababa") == search_result(5, true));
+  ASIO_CHECK(search(delims, "xbab") == search_result(1, false));
+
+  // Delimiters with a shared first byte are located with memchr, and the
+  // automaton must still restart on a repeat of that byte.
+  std::vector<std::string> shared;
+  shared.push_back("\r\n");
+  shared.push_back(std::string("\r\0", 2));
+  shared.push_back("\r\r\r");
+  delims = delimiter_set(shared.begin(), shared.end());
+  ASIO_CHECK(search(delims, "ab\rx\r\n") == search_result(6, true));
+  ASIO_CHECK(search(delims, "ab\r\r\r") == search_result(5, true));
+  ASIO_CHECK(search(delims, "ab\r\r") == search_result(2, false));
+
+  std::vector<std::string> binary;
+  binary.push_back(std::string("\xff\0", 2));
+  delims = delimiter_set(binary.begin(), binary.end());
+  ASIO_CHECK(search(delims, std::string("a\xff\xff\0b", 5))
+      == search_result(4, true));
+}
+
+// A partial match at the end of the data is reported from its start, so a
+// later search of the extended data finds the delimiter.
+void delimiter_set_resume_test()
+{
+  delimiter_set delims = make_set("\r\n\r\n", "\n\n");
+  std::string data = "header\r\n\r";
+  search_result r = search(delims, data);
+  ASIO_CHECK(r == search_result(6, false));
+  data += "\nbody";
+  ASIO_CHECK(search(delims, data, r.first) == search_result(10, true));
+
+  // Copies share the automaton and behave the same.
+  delimiter_set copy(delims);
+  ASIO_CHECK(copy.search(asio::buffer(data), 0) == search_result(10, true));
+}
+
+void handle_read(const asio::error_code& ec, std::size_t bytes,
+    asio::error_code* out_ec, std::size_t* out_bytes)
+{
+  *out_ec = ec;
+  *out_bytes = bytes;
+}
+
+// A delimiter set may be passed to read_until and async_read_until, and
+// finds a delimiter that arrives in more than one read.
+void delimiter_set_read_until_test()
+{
+#if defined(ASIO_HAS_LOCAL_SOCKETS)
+  asio::io_context ioc;
+  asio::local::stream_protocol::socket s1(ioc), s2(ioc);
+  asio::local::connect_pair(s1, s2);
+  delimiter_set delims = make_set("\r\n", "\n");
+
+  std::string data;
+  asio::error_code ec;
+  std::size_t bytes = 0;
+  asio::async_read_until(s2, asio::dynamic_buffer(data), delims,
+      bindns::bind(handle_read, bindns::placeholders::_1,
+        bindns::placeholders::_2, &ec, &bytes));
+  asio::write(s1, asio::buffer("one\r", 4));
+  ioc.poll();
+  ASIO_CHECK(bytes == 0);
+
+  asio::write(s1, asio::buffer("\ntwo\n", 5));
+  ioc.restart();
+  ioc.run();
+  ASIO_CHECK(!ec);
+  ASIO_CHECK(bytes == 5);
+  data.erase(0, bytes);
+
+  std::size_t n = asio::read_until(s2, asio::dynamic_buffer(data), delims);
+  ASIO_CHECK(n == 4);
+  ASIO_CHECK(data == "two\n");
+#endif // defined(ASIO_HAS_LOCAL_SOCKETS)
+}
+
+ASIO_TEST_SUITE
+(
+  "delimiter_set",
+  ASIO_TEST_CASE(delimiter_set_suffix_test)
+  ASIO_TEST_CASE(delimiter_set_overlap_test)
+  ASIO_TEST_CASE(delimiter_set_resume_test)
+  ASIO_TEST_CASE(delimiter_set_read_until_test)
+)
@@ -0,0 +1,188 @@
+//
+// handler_arena.cpp
+// ~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2020 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Disable autolinking for unit tests.
+#if !defined(BOOST_ALL_NO_LIB)
+#define BOOST_ALL_NO_LIB 1
+#endif // !defined(BOOST_ALL_NO_LIB)
+
+#include "asio/detail/handler_arena.hpp"
+
+#include <vector>
+#include "asio/detail/thread.hpp"
+#include "asio/detail/thread_info_base.hpp"
+#include "asio/io_context.hpp"
+#include "asio/post.hpp"
+#include "unit_test.hpp"
+
+#if defined(ASIO_HAS_BOOST_BIND)
+# include <boost/bind/bind.hpp>
+#else // defined(ASIO_HAS_BOOST_BIND)
+# include <functional>
+#endif // defined(ASIO_HAS_BOOST_BIND)
+
+#if defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = boost;
+#else // defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = std;
+#endif
+
+using asio::detail::handler_arena;
+using asio::detail::thread_info_base;
+
+// Blocks are found from their tags, and sizes that do not fit, along with
+// their tags, in a free block are refused.
+void handler_arena_allocate_test()
+{
+  handler_arena* arena = handler_arena::create(2);
+
+  void* a = arena->allocate(10);
+  void* b = arena->allocate(10);
+  ASIO_CHECK(a != 0);
+  ASIO_CHECK(b != 0);
+  ASIO_CHECK(handler_arena::find(a, 10) == arena);
+  ASIO_CHECK(handler_arena::find(b, 10) == arena);
+  ASIO_CHECK(arena->bytes_allocated() == 128);
+
+  // Each size class is used only for the sizes that need it.
+  ASIO_CHECK(arena->allocate(10) == 0);
+  void* c = arena->allocate(100);
+  ASIO_CHECK(c != 0);
+  ASIO_CHECK(handler_arena::find(c, 100) == arena);
+  ASIO_CHECK(arena->bytes_allocated() == 256);
+
+  // The largest block cannot hold its own size as well as the tag.
+  std::size_t largest = static_cast<std::size_t>(
+      handler_arena::smallest_block_size)
+    << (handler_arena::num_size_classes - 1);
+  ASIO_CHECK(arena->allocate(largest) == 0);
+  void* d = arena->allocate(largest / 2);
+  ASIO_CHECK(d != 0);
+  ASIO_CHECK(handler_arena::find(d, largest / 2) == arena);
+
+  arena->deallocate(a);
+  arena->deallocate(b);
+  arena->deallocate(c);
+  arena->deallocate(d);
+  ASIO_CHECK(arena->bytes_allocated() == 0);
+  ASIO_CHECK(arena->peak_bytes_allocated() == 256 + largest);
+
+  // Memory from elsewhere is not mistaken for an arena block.
+  unsigned char other[16];
+  handler_arena::tag_unowned(other, 10);
+  ASIO_CHECK(handler_arena::find(other, 10) == 0);
+
+  arena->release();
+}
+
+void deallocate_blocks(thread_info_base* info,
+    std::vector<void*>* blocks, std::size_t size)
+{
+  for (std::size_t i = 0; i < blocks->size(); ++i)
+    thread_info_base::deallocate(info, (*blocks)[i], size);
+}
+
+// Blocks from an arena go back to it when deallocated by any thread, while
+// other blocks go to the deallocating thread's cache. An arena that has been
+// released lives until its last block is deallocated.
+void handler_arena_thread_test()
+{
+  handler_arena* arena = handler_arena::create(4);
+  thread_info_base owner;
+  owner.set_arena(arena);
+
+  std::vector<void*> blocks;
+  for (int i = 0; i < 6; ++i)
+    blocks.push_back(thread_info_base::allocate(&owner, 32));
+  // Once the arena's blocks of the size are used up, memory comes from the
+  // heap.
+  ASIO_CHECK(arena->bytes_allocated() == 4 * 64);
+  arena->release();
+
+  thread_info_base other;
+  asio::detail::thread t(bindns::bind(
+        deallocate_blocks, &other, &blocks, 32));
+  t.join();
+
+  // Only the blocks from the heap are cached, and the arena has been
+  // destroyed along with its last block.
+  ASIO_CHECK(other.cached_bytes() == 2 * 64);
+
+  std::vector<void*> heap_blocks;
+  heap_blocks.push_back(thread_info_base::allocate(&other, 32));
+  deallocate_blocks(&owner, &heap_blocks, 32);
+  ASIO_CHECK(owner.cached_bytes() == 64);
+  owner.set_arena(0);
+}
+
+void churn(handler_arena* arena, int seed)
+{
+  thread_info_base info;
+  info.set_arena(arena);
+  for (int i = 0; i < 10000; ++i)
+  {
+    std::size_t size = 1 + (i * 37 + seed * 101) % 1500;
+    void* p = thread_info_base::allocate(&info, size);
+    thread_info_base::deallocate(&info, p, size);
+  }
+  info.set_arena(0);
+}
+
+// Threads allocating blocks of every size from one arena leave no memory
+// allocated.
+void handler_arena_concurrency_test()
+{
+  handler_arena* arena = handler_arena::create(2);
+  std::vector<asio::detail::thread*> threads;
+  for (int i = 0; i < 4; ++i)
+    threads.push_back(new asio::detail::thread(
+          bindns::bind(churn, arena, i)));
+  for (std::size_t i = 0; i < threads.size(); ++i)
+  {
+    threads[i]->join();
+    delete threads[i];
+  }
+  ASIO_CHECK(arena->bytes_allocated() == 0);
+  ASIO_CHECK(arena->peak_bytes_allocated() > 0);
+  arena->release();
+}
+
+void post_chain(asio::io_context* ioc, int remaining)
+{
+  if (remaining > 0)
+    asio::post(*ioc, bindns::bind(post_chain, ioc, remaining - 1));
+}
+
+// An io_context with an arena allocates its handlers from it.
+void handler_arena_io_context_test()
+{
+  asio::io_context_options options;
+  options.handler_arena_blocks(16);
+  asio::io_context ioc(options);
+
+  asio::post(ioc, bindns::bind(post_chain, &ioc, 100));
+  ioc.run();
+  ASIO_CHECK(ioc.arena_bytes_allocated() == 0);
+  ASIO_CHECK(ioc.arena_peak_bytes_allocated() > 0);
+
+  asio::io_context plain;
+  asio::post(plain, bindns::bind(post_chain, &plain, 10));
+  plain.run();
+  ASIO_CHECK(plain.arena_peak_bytes_allocated() == 0);
+}
+
+ASIO_TEST_SUITE
+(
+  "handler_arena",
+  ASIO_TEST_CASE(handler_arena_allocate_test)
+  ASIO_TEST_CASE(handler_arena_thread_test)
+  ASIO_TEST_CASE(handler_arena_concurrency_test)
+  ASIO_TEST_CASE(handler_arena_io_context_test)
+)
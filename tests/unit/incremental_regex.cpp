@@ -0,0 +1,179 @@
+//
+// incremental_regex.cpp
+// ~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2020 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Disable autolinking for unit tests.
+#if !defined(BOOST_ALL_NO_LIB)
+#define BOOST_ALL_NO_LIB 1
+#endif // !defined(BOOST_ALL_NO_LIB)
+
+// Test that header file is self-contained.
+#include "asio/incremental_regex.hpp"
+
+#include "unit_test.hpp"
+
+#if defined(ASIO_HAS_BOOST_REGEX)
+
+#include <string>
+#include "asio/buffers_iterator.hpp"
+#include "asio/io_context.hpp"
+#include "asio/local/connect_pair.hpp"
+#include "asio/local/stream_protocol.hpp"
+#include "asio/read_until.hpp"
+#include "asio/write.hpp"
+
+#if defined(ASIO_HAS_BOOST_BIND)
+# include <boost/bind/bind.hpp>
+#else // defined(ASIO_HAS_BOOST_BIND)
+# include <functional>
+#endif // defined(ASIO_HAS_BOOST_BIND)
+
+#if defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = boost;
+#else // defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = std;
+#endif
+
+using asio::incremental_regex;
+
+typedef std::pair<std::size_t, bool> search_result;
+
+search_result search(const incremental_regex& expr, const std::string& data)
+{
+  typedef asio::buffers_iterator<asio::const_buffer> iterator;
+  asio::const_buffer b = asio::buffer(data);
+  iterator begin = iterator::begin(b);
+  std::pair<iterator, bool> r = expr(begin, iterator::end(b));
+  return search_result(static_cast<std::size_t>(r.first - begin), r.second);
+}
+
+// A partial match resumes from its start, or from the lookback before the
+// end of the data, whichever is later.
+void incremental_regex_lookback_test()
+{
+  const boost::regex re("a*b");
+  const std::string partial = "xxaaaaaaaa";
+
+  incremental_regex unlimited(re);
+  ASIO_CHECK(search(unlimited, partial) == search_result(2, false));
+  ASIO_CHECK(search(incremental_regex(re, 8), partial)
+      == search_result(2, false));
+  ASIO_CHECK(search(incremental_regex(re, 100), partial)
+      == search_result(2, false));
+  ASIO_CHECK(search(incremental_regex(re, 3), partial)
+      == search_result(7, false));
+  ASIO_CHECK(search(incremental_regex(re, 0), partial)
+      == search_result(10, false));
+
+  // The lookback does not affect full matches, or data with no partial
+  // match.
+  ASIO_CHECK(search(incremental_regex(re, 0), "xxaab")
+      == search_result(5, true));
+  ASIO_CHECK(search(incremental_regex(re, 0), "xxx")
+      == search_result(3, false));
+  ASIO_CHECK(search(incremental_regex(re, 0), "")
+      == search_result(0, false));
+
+  // A match that must begin before the resume position is not found from
+  // there.
+  incremental_regex tag(boost::regex("<[^>]*>"), 2);
+  ASIO_CHECK(search(tag, "<aaaa") == search_result(3, false));
+  ASIO_CHECK(search(tag, "aa>") == search_result(3, false));
+}
+
+// Copies share the count of bytes searched.
+void incremental_regex_bytes_scanned_test()
+{
+  incremental_regex expr(boost::regex("\r\n"), 1);
+  ASIO_CHECK(expr.bytes_scanned() == 0);
+  ASIO_CHECK(expr.lookback() == 1);
+
+  incremental_regex copy(expr);
+  search(expr, "abc");
+  search(copy, "de\r\n");
+  ASIO_CHECK(expr.bytes_scanned() == 7);
+  ASIO_CHECK(copy.bytes_scanned() == 7);
+
+  incremental_regex other(expr.expression());
+  ASIO_CHECK(other.bytes_scanned() == 0);
+}
+
+void handle_read(const asio::error_code& ec, std::size_t bytes,
+    asio::error_code* out_ec, std::size_t* out_bytes)
+{
+  *out_ec = ec;
+  *out_bytes = bytes;
+}
+
+#if defined(ASIO_HAS_LOCAL_SOCKETS)
+
+// Read a long partial match that arrives in small pieces, and return the
+// number of bytes searched.
+asio::uint64_t read_in_pieces(const incremental_regex& expr,
+    const std::string& record, std::size_t piece)
+{
+  asio::io_context ioc;
+  asio::local::stream_protocol::socket s1(ioc), s2(ioc);
+  asio::local::connect_pair(s1, s2);
+
+  std::string data;
+  asio::error_code ec;
+  std::size_t bytes = 0;
+  asio::async_read_until(s2, asio::dynamic_buffer(data), expr,
+      bindns::bind(handle_read, bindns::placeholders::_1,
+        bindns::placeholders::_2, &ec, &bytes));
+  for (std::size_t i = 0; i < record.size(); i += piece)
+  {
+    asio::write(s1, asio::buffer(record.data() + i,
+          (std::min)(piece, record.size() - i)));
+    ioc.restart();
+    ioc.poll();
+  }
+  ioc.restart();
+  ioc.run();
+
+  ASIO_CHECK(!ec);
+  ASIO_CHECK(bytes == record.size());
+  ASIO_CHECK(data == record);
+  return expr.bytes_scanned();
+}
+
+#endif // defined(ASIO_HAS_LOCAL_SOCKETS)
+
+// With a small lookback, the bytes searched grow linearly with the length of
+// a partial match, rather than with its square, and the result is the same.
+void incremental_regex_read_until_test()
+{
+#if defined(ASIO_HAS_LOCAL_SOCKETS)
+  const std::string record = std::string(2000, 'a') + "b";
+  const boost::regex re("a*b");
+
+  asio::uint64_t bounded =
+    read_in_pieces(incremental_regex(re, 1), record, 10);
+  ASIO_CHECK(bounded <= 2 * record.size());
+
+  asio::uint64_t unbounded =
+    read_in_pieces(incremental_regex(re), record, 10);
+  ASIO_CHECK(unbounded > 20 * record.size());
+#endif // defined(ASIO_HAS_LOCAL_SOCKETS)
+}
+
+#endif // defined(ASIO_HAS_BOOST_REGEX)
+
+ASIO_TEST_SUITE
+(
+  "incremental_regex",
+#if defined(ASIO_HAS_BOOST_REGEX)
+  ASIO_TEST_CASE(incremental_regex_lookback_test)
+  ASIO_TEST_CASE(incremental_regex_bytes_scanned_test)
+  ASIO_TEST_CASE(incremental_regex_read_until_test)
+#else // defined(ASIO_HAS_BOOST_REGEX)
+  ASIO_TEST_CASE(null_test)
+#endif // defined(ASIO_HAS_BOOST_REGEX)
+)
@@ -0,0 +1,492 @@
+//
+// io_context.cpp
+// ~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2020 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Disable autolinking for unit tests.
+#if !defined(BOOST_ALL_NO_LIB)
+#define BOOST_ALL_NO_LIB 1
+#endif // !defined(BOOST_ALL_NO_LIB)
+
+// Test that header file is self-contained.
+#include "asio/io_context.hpp"
+
+#include <set>
+#include <vector>
+#include "asio/detail/mutex.hpp"
+#include "asio/detail/reactor.hpp"
+#include "asio/detail/thread.hpp"
+#include "asio/local/connect_pair.hpp"
+#include "asio/ip/tcp.hpp"
+#include "asio/local/stream_protocol.hpp"
+#include "asio/post.hpp"
+#include "asio/steady_timer.hpp"
+#include "asio/write.hpp"
+#include "unit_test.hpp"
+
+#if defined(ASIO_HAS_BOOST_BIND)
+# include <boost/bind/bind.hpp>
+#else // defined(ASIO_HAS_BOOST_BIND)
+# include <functional>
+#endif // defined(ASIO_HAS_BOOST_BIND)
+
+#if defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = boost;
+#else // defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = std;
+#endif
+
+using namespace asio;
+
+// Records which threads ran a handler.
+struct thread_record
+{
+  asio::detail::mutex mutex_;
+  std::set<asio::detail::thread_info_base*> threads_;
+  int count_;
+};
+
+void record_thread(thread_record* r)
+{
+  // Give idle threads time to steal the rest of the batch.
+  for (volatile int i = 0; i < 20000; i = i + 1)
+  {
+  }
+
+  asio::detail::mutex::scoped_lock lock(r->mutex_);
+  r->threads_.insert(
+      asio::detail::thread_context::thread_call_stack::top());
+  ++r->count_;
+}
+
+void post_batch(io_context* ioc, thread_record* r, int n)
+{
+  for (int i = 0; i < n; ++i)
+    asio::post(*ioc, bindns::bind(record_thread, r));
+}
+
+void run_context(io_context* ioc)
+{
+  ioc->run();
+}
+
+void post_chain(io_context* ioc, int* count, int remaining)
+{
+  ++*count;
+  if (remaining > 0)
+    asio::post(*ioc, bindns::bind(post_chain, ioc, count, remaining - 1));
+}
+
+void stop_context(io_context* ioc, int* count)
+{
+  ++*count;
+  ioc->stop();
+}
+
+void increment(int* count)
+{
+  ++*count;
+}
+
+// Handlers posted from within a handler go to the posting thread's queue, and
+// idle threads steal them, so every handler runs and more than one thread
+// shares the work.
+void io_context_work_stealing_test()
+{
+  io_context ioc(ASIO_CONCURRENCY_HINT_WORK_STEALING);
+  thread_record record;
+  record.count_ = 0;
+
+  const int batch = 2000;
+  asio::post(ioc, bindns::bind(post_batch, &ioc, &record, batch));
+
+  std::vector<asio::detail::thread*> threads;
+  for (int i = 0; i < 4; ++i)
+    threads.push_back(new asio::detail::thread(
+          bindns::bind(run_context, &ioc)));
+  for (std::size_t i = 0; i < threads.size(); ++i)
+  {
+    threads[i]->join();
+    delete threads[i];
+  }
+
+  ASIO_CHECK(record.count_ == batch);
+  ASIO_CHECK(record.threads_.size() > 1);
+}
+
+// A long chain of handlers, each posted by its predecessor, runs to
+// completion when a single thread runs the io_context.
+void io_context_work_stealing_chain_test()
+{
+  io_context ioc(ASIO_CONCURRENCY_HINT_WORK_STEALING);
+  int count = 0;
+
+  asio::post(ioc, bindns::bind(post_chain, &ioc, &count, 9999));
+  std::size_t n = ioc.run();
+
+  ASIO_CHECK(count == 10000);
+  ASIO_CHECK(n == 10000);
+  ASIO_CHECK(ioc.stopped());
+}
+
+// Handlers left in a thread's local queue when the io_context is stopped are
+// not lost, and run when the io_context is restarted.
+void io_context_work_stealing_stop_test()
+{
+  io_context ioc(ASIO_CONCURRENCY_HINT_WORK_STEALING);
+  int count = 0;
+
+  asio::post(ioc, bindns::bind(stop_context, &ioc, &count));
+  for (int i = 0; i < 10; ++i)
+    asio::post(ioc, bindns::bind(increment, &count));
+
+  ioc.run_one();
+  ASIO_CHECK(count == 1);
+  ASIO_CHECK(ioc.stopped());
+
+  ioc.restart();
+  ioc.run();
+  ASIO_CHECK(count == 11);
+
+  // poll() uses the shared queue.
+  for (int i = 0; i < 5; ++i)
+    asio::post(ioc, bindns::bind(increment, &count));
+  ioc.restart();
+  ASIO_CHECK(ioc.poll() == 5);
+  ASIO_CHECK(count == 16);
+}
+
+#if defined(ASIO_HAS_LOCAL_SOCKETS)
+
+void handle_read(const asio::error_code& ec, std::size_t, int* count)
+{
+  if (!ec)
+    ++*count;
+}
+
+// Start a one-byte read on each of n socket pairs and make them all readable,
+// so that the next reactor wait returns n events if its batch allows.
+void run_ready_reads(io_context& ioc, std::size_t n)
+{
+  typedef asio::local::stream_protocol::socket socket_type;
+  std::vector<socket_type*> sockets;
+  char buf[64];
+  int count = 0;
+
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    socket_type* a = new socket_type(ioc);
+    socket_type* b = new socket_type(ioc);
+    asio::local::connect_pair(*a, *b);
+    sockets.push_back(a);
+    sockets.push_back(b);
+    a->async_read_some(asio::buffer(buf, 1),
+        bindns::bind(handle_read, bindns::placeholders::_1,
+          bindns::placeholders::_2, &count));
+  }
+
+  for (std::size_t i = 0; i < n; ++i)
+    asio::write(*sockets[i * 2 + 1], asio::buffer("x", 1));
+
+  ioc.restart();
+  ioc.run();
+  ASIO_CHECK(count == static_cast<int>(n));
+
+  for (std::size_t i = 0; i < sockets.size(); ++i)
+    delete sockets[i];
+}
+
+#endif // defined(ASIO_HAS_LOCAL_SOCKETS)
+
+// The reactor's batch size and the number of events returned by each wait may
+// be read through the io_context.
+void io_context_reactor_batch_test()
+{
+#if defined(ASIO_HAS_EPOLL) && !defined(ASIO_HAS_IO_URING) \
+  && defined(ASIO_HAS_LOCAL_SOCKETS)
+  {
+    io_context ioc(io_context_options().reactor_batch_size(4));
+
+    // The reactor is not created until it is needed.
+    ASIO_CHECK(ioc.reactor_event_count() == 0);
+    ASIO_CHECK(ioc.reactor_batch_size() == 0);
+
+    run_ready_reads(ioc, 20);
+    ASIO_CHECK(ioc.reactor_batch_size() == 4);
+    ASIO_CHECK(ioc.reactor_event_count() <= 4);
+  }
+
+  {
+    io_context ioc(io_context_options()
+        .reactor_batch_size(4)
+        .max_reactor_batch_size(64)
+        .adaptive_reactor_batch(true));
+
+    // Each wait that fills the batch doubles it.
+    run_ready_reads(ioc, 40);
+    ASIO_CHECK(ioc.reactor_batch_size() > 4);
+    ASIO_CHECK(ioc.reactor_batch_size() <= 64);
+
+    // Each wait that returns less than a quarter of the batch halves it.
+    for (int i = 0; i < 10; ++i)
+      run_ready_reads(ioc, 1);
+    ASIO_CHECK(ioc.reactor_batch_size() == 4);
+    ASIO_CHECK(ioc.reactor_event_count() <= 1);
+  }
+#endif // defined(ASIO_HAS_EPOLL) && !defined(ASIO_HAS_IO_URING)
+       //   && defined(ASIO_HAS_LOCAL_SOCKETS)
+}
+
+void read_busy_poll_stats(io_context* ioc,
+    asio::detail::atomic_count* done, uint64_t* total)
+{
+  while (*done == 0)
+  {
+    *total = ioc->busy_poll_spin_usec() + ioc->busy_poll_block_usec();
+  }
+}
+
+void set_flag(bool* flag)
+{
+  *flag = true;
+}
+
+// Threads that busy poll before blocking report the time spent in each state
+// through the io_context, which may be read while the io_context runs.
+void io_context_busy_poll_test()
+{
+  {
+    io_context ioc;
+    asio::steady_timer timer(ioc, asio::chrono::milliseconds(10));
+    bool fired = false;
+    timer.async_wait(bindns::bind(set_flag, &fired));
+    ioc.run();
+    ASIO_CHECK(fired);
+    ASIO_CHECK(ioc.busy_poll_spin_usec() == 0);
+    ASIO_CHECK(ioc.busy_poll_block_usec() == 0);
+  }
+
+#if defined(ASIO_HAS_STD_CHRONO)
+  {
+    io_context ioc(io_context_options().busy_poll_usec(2000));
+    asio::detail::atomic_count done(0);
+    uint64_t observed = 0;
+    asio::detail::thread reader(
+        bindns::bind(read_busy_poll_stats, &ioc, &done, &observed));
+
+    // The timer expires long after polling has given up, so the thread polls
+    // for about 2ms and then blocks.
+    asio::steady_timer timer(ioc, asio::chrono::milliseconds(50));
+    bool fired = false;
+    timer.async_wait(bindns::bind(set_flag, &fired));
+    ioc.run();
+
+    ++done;
+    reader.join();
+
+    ASIO_CHECK(fired);
+    ASIO_CHECK(ioc.busy_poll_spin_usec() >= 1000);
+    ASIO_CHECK(ioc.busy_poll_block_usec() > 0);
+    ASIO_CHECK(observed <= ioc.busy_poll_spin_usec()
+        + ioc.busy_poll_block_usec());
+  }
+#endif // defined(ASIO_HAS_STD_CHRONO)
+}
+
+void record_sequence(std::vector<int>* seen, int value)
+{
+  seen->push_back(value);
+}
+
+void post_sequence(io_context* ioc, std::vector<int>* seen, int n)
+{
+  for (int i = 0; i < n; ++i)
+    asio::post(*ioc, bindns::bind(record_sequence, seen, i));
+}
+
+// Handlers posted concurrently from threads outside the io_context are all
+// run, and those from each thread run in the order in which they were posted.
+void io_context_foreign_post_test()
+{
+  io_context ioc;
+  const int producers = 4;
+  const int per_producer = 10000;
+  std::vector<int> seen[producers];
+
+  asio::detail::thread* runner;
+  {
+    asio::executor_work_guard<io_context::executor_type>
+      work(ioc.get_executor());
+    runner = new asio::detail::thread(bindns::bind(run_context, &ioc));
+
+    std::vector<asio::detail::thread*> threads;
+    for (int i = 0; i < producers; ++i)
+      threads.push_back(new asio::detail::thread(
+            bindns::bind(post_sequence, &ioc, &seen[i], per_producer)));
+    for (std::size_t i = 0; i < threads.size(); ++i)
+    {
+      threads[i]->join();
+      delete threads[i];
+    }
+  }
+  runner->join();
+  delete runner;
+
+  for (int i = 0; i < producers; ++i)
+  {
+    ASIO_CHECK(static_cast<int>(seen[i].size()) == per_producer);
+    bool in_order = true;
+    for (std::size_t j = 0; j < seen[i].size(); ++j)
+      if (seen[i][j] != static_cast<int>(j))
+        in_order = false;
+    ASIO_CHECK(in_order);
+  }
+}
+
+// Give the reactor task a chance to run.
+void poll_task(io_context& ioc)
+{
+  asio::executor_work_guard<io_context::executor_type>
+    work(ioc.get_executor());
+  ioc.restart();
+  ioc.poll();
+}
+
+// Open and close a number of sockets.
+void open_and_close(io_context& ioc, std::size_t n)
+{
+  std::vector<asio::ip::tcp::socket*> sockets;
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    sockets.push_back(new asio::ip::tcp::socket(ioc));
+    sockets.back()->open(asio::ip::tcp::v4());
+  }
+  for (std::size_t i = 0; i < sockets.size(); ++i)
+    delete sockets[i];
+}
+
+// Closed sockets leave their reactor state objects free for reuse. A trim
+// destroys them once a thread has run the io_context. With the default
+// options, sockets closed before the first trim are not removed from the
+// reactor, and their objects are kept.
+void io_context_trim_test()
+{
+#if defined(ASIO_HAS_EPOLL) && !defined(ASIO_HAS_IO_URING)
+  const std::size_t n = 100;
+
+  for (int bounded = 0; bounded < 2; ++bounded)
+  {
+    io_context_options options;
+    if (bounded)
+      options.max_free_descriptor_states(n / 2);
+    io_context ioc(options);
+
+    open_and_close(ioc, n);
+    asio::detail::reactor& reactor = use_service<asio::detail::reactor>(ioc);
+    ASIO_CHECK(reactor.free_descriptor_states() == n);
+
+    // Objects beyond the bound are destroyed when the task next runs.
+    poll_task(ioc);
+    ASIO_CHECK(reactor.free_descriptor_states() == (bounded ? n / 2 : n));
+
+    ioc.trim();
+    poll_task(ioc);
+    ASIO_CHECK(reactor.free_descriptor_states() == (bounded ? 0 : n));
+
+    // Sockets closed after a trim has been requested are removed from the
+    // reactor, so their objects may be destroyed.
+    open_and_close(ioc, n);
+    ioc.trim();
+    poll_task(ioc);
+    ASIO_CHECK(reactor.free_descriptor_states() == 0);
+
+    // The memory may still be reused afterwards.
+    asio::ip::tcp::socket socket(ioc);
+    socket.open(asio::ip::tcp::v4());
+    socket.close();
+    ASIO_CHECK(reactor.free_descriptor_states() == 1);
+  }
+#endif // defined(ASIO_HAS_EPOLL) && !defined(ASIO_HAS_IO_URING)
+}
+
+struct timer_record
+{
+  asio::steady_timer::time_point expiry;
+  asio::steady_timer::time_point completed;
+  asio::error_code ec;
+};
+
+void handle_timer(const asio::error_code& ec, timer_record* r)
+{
+  r->completed = asio::steady_timer::clock_type::now();
+  r->ec = ec;
+}
+
+// With a timer slack, timers that expire within the slack of the earliest one
+// are completed by the same wakeup. No timer completes early, and a timer that
+// has already expired does not wait for the slack.
+void io_context_timer_slack_test()
+{
+#if defined(ASIO_HAS_CHRONO)
+  io_context_options options;
+  options.timer_slack_usec(50000);
+  io_context ioc(options);
+
+  const int n = 10;
+  std::vector<asio::steady_timer*> timers;
+  std::vector<timer_record> records(n);
+  for (int i = 0; i < n; ++i)
+  {
+    timers.push_back(new asio::steady_timer(ioc,
+          asio::chrono::milliseconds(1 + i)));
+    records[i].expiry = timers.back()->expiry();
+    timers.back()->async_wait(bindns::bind(handle_timer,
+          bindns::placeholders::_1, &records[i]));
+  }
+
+  ioc.run();
+
+  bool early = false;
+  for (int i = 0; i < n; ++i)
+  {
+    ASIO_CHECK(!records[i].ec);
+    if (records[i].completed < records[i].expiry)
+      early = true;
+    delete timers[i];
+  }
+  ASIO_CHECK(!early);
+#if defined(ASIO_HAS_EPOLL) && !defined(ASIO_HAS_IO_URING)
+  // The first timer waited for the last one to expire.
+  ASIO_CHECK(records[0].completed >= records[n - 1].expiry);
+#endif // defined(ASIO_HAS_EPOLL) && !defined(ASIO_HAS_IO_URING)
+
+  asio::steady_timer::time_point start
+    = asio::steady_timer::clock_type::now();
+  asio::steady_timer past(ioc, start - asio::chrono::seconds(1));
+  timer_record past_record;
+  past.async_wait(bindns::bind(handle_timer,
+        bindns::placeholders::_1, &past_record));
+  ioc.restart();
+  ioc.run();
+  ASIO_CHECK(!past_record.ec);
+  ASIO_CHECK(past_record.completed - start < asio::chrono::milliseconds(40));
+#endif // defined(ASIO_HAS_CHRONO)
+}
+
+ASIO_TEST_SUITE
+(
+  "io_context",
+  ASIO_TEST_CASE(io_context_work_stealing_test)
+  ASIO_TEST_CASE(io_context_work_stealing_chain_test)
+  ASIO_TEST_CASE(io_context_work_stealing_stop_test)
+  ASIO_TEST_CASE(io_context_reactor_batch_test)
+  ASIO_TEST_CASE(io_context_busy_poll_test)
+  ASIO_TEST_CASE(io_context_foreign_post_test)
+  ASIO_TEST_CASE(io_context_trim_test)
+  ASIO_TEST_CASE(io_context_timer_slack_test)
+)
@@ -0,0 +1,157 @@
+//
+// io_context_pool.cpp
+// ~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2020 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Disable autolinking for unit tests.
+#if !defined(BOOST_ALL_NO_LIB)
+#define BOOST_ALL_NO_LIB 1
+#endif // !defined(BOOST_ALL_NO_LIB)
+
+// Test that header file is self-contained.
+#include "asio/io_context_pool.hpp"
+
+#include <vector>
+#include "asio/detail/atomic_count.hpp"
+#include "asio/ip/tcp.hpp"
+#include "asio/post.hpp"
+#include "asio/steady_timer.hpp"
+#include "unit_test.hpp"
+
+#if defined(ASIO_HAS_BOOST_BIND)
+# include <boost/bind/bind.hpp>
+#else // defined(ASIO_HAS_BOOST_BIND)
+# include <functional>
+#endif // defined(ASIO_HAS_BOOST_BIND)
+
+#if defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = boost;
+#else // defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = std;
+#endif
+
+using namespace asio;
+
+void increment(asio::detail::atomic_count* count)
+{
+  ++(*count);
+}
+
+// Each io_context is chosen in turn, and handlers given to any of them are run
+// by the pool's threads.
+void io_context_pool_round_robin_test()
+{
+  io_context_pool pool(3);
+  ASIO_CHECK(pool.size() == 3);
+
+  io_context* first = &pool.get_io_context();
+  io_context* second = &pool.get_io_context();
+  io_context* third = &pool.get_io_context();
+  ASIO_CHECK(first != second);
+  ASIO_CHECK(second != third);
+  ASIO_CHECK(first != third);
+  ASIO_CHECK(&pool.get_io_context() == first);
+
+  asio::detail::atomic_count count(0);
+  for (int i = 0; i < 300; ++i)
+    asio::post(pool.get_io_context(), bindns::bind(increment, &count));
+
+  pool.join();
+  ASIO_CHECK(count == 300);
+}
+
+// An io_context that has outstanding work is not chosen while another has
+// none.
+void io_context_pool_least_loaded_test()
+{
+  io_context_pool pool(2);
+
+  asio::detail::atomic_count count(0);
+  asio::steady_timer timer(pool.get_io_context(0), asio::chrono::hours(1));
+  timer.async_wait(bindns::bind(increment, &count));
+
+  bool busy_chosen = false;
+  for (int i = 0; i < 10; ++i)
+    if (&pool.get_io_context(io_context_pool::least_loaded)
+        == &pool.get_io_context(0))
+      busy_chosen = true;
+  ASIO_CHECK(!busy_chosen);
+
+  pool.stop();
+  pool.join();
+}
+
+void handle_accept(const asio::error_code& ec,
+    asio::detail::atomic_count* accepted)
+{
+  if (!ec)
+    ++(*accepted);
+}
+
+// All of the acceptors share one port, and between them accept every
+// connection made to it.
+void io_context_pool_reuseport_test()
+{
+#if defined(ASIO_OS_DEF_SO_REUSEPORT) && defined(ASIO_HAS_MOVE)
+  io_context_pool pool(4);
+
+  asio::error_code ec;
+  std::vector<ip::tcp::acceptor> acceptors = pool.make_reuseport_acceptors(
+      ip::tcp::endpoint(ip::address_v4::loopback(), 0),
+      socket_base::max_listen_connections, ec);
+  ASIO_CHECK(!ec);
+  ASIO_CHECK(acceptors.size() == 4);
+
+  const int connections = 64;
+  asio::detail::atomic_count accepted(0);
+  std::vector<ip::tcp::socket*> peers;
+  for (std::size_t i = 0; i < acceptors.size(); ++i)
+  {
+    ASIO_CHECK(acceptors[i].local_endpoint()
+        == acceptors[0].local_endpoint());
+    for (int j = 0; j < connections; ++j)
+    {
+      peers.push_back(new ip::tcp::socket(pool.get_io_context(i)));
+      acceptors[i].async_accept(*peers.back(),
+          bindns::bind(handle_accept, bindns::placeholders::_1, &accepted));
+    }
+  }
+
+  io_context client_context;
+  std::vector<ip::tcp::socket*> clients;
+  for (int i = 0; i < connections; ++i)
+  {
+    clients.push_back(new ip::tcp::socket(client_context));
+    clients.back()->connect(acceptors[0].local_endpoint());
+  }
+
+  for (int i = 0; i < 1000 && accepted < connections; ++i)
+  {
+    asio::steady_timer t(client_context, asio::chrono::milliseconds(1));
+    t.wait();
+  }
+  ASIO_CHECK(accepted == connections);
+
+  for (std::size_t i = 0; i < acceptors.size(); ++i)
+    acceptors[i].close();
+  pool.join();
+
+  for (std::size_t i = 0; i < clients.size(); ++i)
+    delete clients[i];
+  for (std::size_t i = 0; i < peers.size(); ++i)
+    delete peers[i];
+#endif // defined(ASIO_OS_DEF_SO_REUSEPORT) && defined(ASIO_HAS_MOVE)
+}
+
+ASIO_TEST_SUITE
+(
+  "io_context_pool",
+  ASIO_TEST_CASE(io_context_pool_round_robin_test)
+  ASIO_TEST_CASE(io_context_pool_least_loaded_test)
+  ASIO_TEST_CASE(io_context_pool_reuseport_test)
+)
@@ -0,0 +1,172 @@
+//
+// io_uring_reactor.cpp
+// ~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2020 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Disable autolinking for unit tests.
+#if !defined(BOOST_ALL_NO_LIB)
+#define BOOST_ALL_NO_LIB 1
+#endif // !defined(BOOST_ALL_NO_LIB)
+
+#include "asio/io_context.hpp"
+#include "asio/ip/tcp.hpp"
+#include "asio/read.hpp"
+#include "asio/steady_timer.hpp"
+#include "asio/write.hpp"
+#include "unit_test.hpp"
+
+#if defined(ASIO_HAS_IO_URING)
+
+#include <vector>
+
+namespace io_uring_reactor_test {
+
+void handle_io(const asio::error_code& ec, std::size_t n,
+    asio::error_code* out_ec, std::size_t* out_n)
+{
+  *out_ec = ec;
+  *out_n = n;
+}
+
+void handle_wait(const asio::error_code& ec, std::vector<int>* order, int id)
+{
+  if (!ec)
+    order->push_back(id);
+}
+
+void socket_round_trip_test()
+{
+  asio::io_context ioc;
+  asio::ip::tcp::acceptor acceptor(ioc,
+      asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), 0));
+  asio::ip::tcp::socket client(ioc);
+  asio::ip::tcp::socket server(ioc);
+
+  asio::error_code accept_ec = asio::error::would_block;
+  acceptor.async_accept(server,
+      [&](const asio::error_code& ec) { accept_ec = ec; });
+  client.connect(acceptor.local_endpoint());
+  ioc.run();
+  ASIO_CHECK(!accept_ec);
+
+  const char data[] = "0123456789abcdef";
+  char buf[sizeof(data)] = "";
+  asio::error_code read_ec = asio::error::would_block;
+  std::size_t read_n = 0;
+  asio::async_read(server, asio::buffer(buf),
+      [&](const asio::error_code& ec, std::size_t n)
+      {
+        handle_io(ec, n, &read_ec, &read_n);
+      });
+  asio::write(client, asio::buffer(data));
+
+  ioc.restart();
+  ioc.run();
+  ASIO_CHECK(!read_ec);
+  ASIO_CHECK(read_n == sizeof(data));
+  ASIO_CHECK(std::string(buf) == data);
+}
+
+void timer_order_test()
+{
+  asio::io_context ioc;
+  std::vector<int> order;
+
+  asio::steady_timer t3(ioc, asio::chrono::milliseconds(30));
+  asio::steady_timer t1(ioc, asio::chrono::milliseconds(10));
+  asio::steady_timer t2(ioc, asio::chrono::milliseconds(20));
+  asio::steady_timer cancelled(ioc, asio::chrono::milliseconds(15));
+
+  t3.async_wait([&](const asio::error_code& ec)
+      { handle_wait(ec, &order, 3); });
+  t1.async_wait([&](const asio::error_code& ec)
+      { handle_wait(ec, &order, 1); });
+  t2.async_wait([&](const asio::error_code& ec)
+      { handle_wait(ec, &order, 2); });
+  cancelled.async_wait([&](const asio::error_code& ec)
+      { handle_wait(ec, &order, 4); });
+  cancelled.cancel();
+
+  ioc.run();
+
+  ASIO_CHECK(order.size() == 3);
+  ASIO_CHECK(order.size() > 0 && order[0] == 1);
+  ASIO_CHECK(order.size() > 1 && order[1] == 2);
+  ASIO_CHECK(order.size() > 2 && order[2] == 3);
+}
+
+// Each bounded wait ends early because a receive completes first. The timeout
+// submitted for the previous wait must be removed, rather than left to expire
+// later, and an idle bounded wait must still last for its full duration.
+void bounded_wait_test()
+{
+  asio::io_context ioc;
+  asio::ip::tcp::acceptor acceptor(ioc,
+      asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), 0));
+  asio::ip::tcp::socket client(ioc);
+  asio::ip::tcp::socket server(ioc);
+  client.connect(acceptor.local_endpoint());
+  acceptor.accept(server);
+
+  const int iterations = 1000;
+  int completed = 0;
+  for (int i = 0; i < iterations; ++i)
+  {
+    char c = 0;
+    asio::error_code ec = asio::error::would_block;
+    std::size_t n = 0;
+    asio::async_read(server, asio::buffer(&c, 1),
+        [&](const asio::error_code& e, std::size_t m)
+        {
+          handle_io(e, m, &ec, &n);
+        });
+    asio::write(client, asio::buffer("x", 1));
+
+    ioc.restart();
+    while (ec == asio::error::would_block)
+      if (ioc.run_one_for(asio::chrono::seconds(5)) == 0)
+        break;
+    if (!ec && n == 1 && c == 'x')
+      ++completed;
+  }
+  ASIO_CHECK(completed == iterations);
+
+  ioc.restart();
+  asio::chrono::steady_clock::time_point start
+    = asio::chrono::steady_clock::now();
+  std::size_t handlers = 0;
+  {
+    asio::executor_work_guard<asio::io_context::executor_type>
+      work(ioc.get_executor());
+    handlers = ioc.run_for(asio::chrono::milliseconds(100));
+  }
+  asio::chrono::steady_clock::duration elapsed
+    = asio::chrono::steady_clock::now() - start;
+  ASIO_CHECK(handlers == 0);
+  ASIO_CHECK(elapsed >= asio::chrono::milliseconds(100));
+}
+
+} // namespace io_uring_reactor_test
+
+ASIO_TEST_SUITE
+(
+  "io_uring_reactor",
+  ASIO_TEST_CASE(io_uring_reactor_test::socket_round_trip_test)
+  ASIO_TEST_CASE(io_uring_reactor_test::timer_order_test)
+  ASIO_TEST_CASE(io_uring_reactor_test::bounded_wait_test)
+)
+
+#else // defined(ASIO_HAS_IO_URING)
+
+ASIO_TEST_SUITE
+(
+  "io_uring_reactor",
+  ASIO_TEST_CASE(null_test)
+)
+
+#endif // defined(ASIO_HAS_IO_URING)
@@ -0,0 +1,192 @@
+//
+// read_until.cpp
+// ~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2020 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Disable autolinking for unit tests.
+#if !defined(BOOST_ALL_NO_LIB)
+#define BOOST_ALL_NO_LIB 1
+#endif // !defined(BOOST_ALL_NO_LIB)
+
+// Test that header file is self-contained.
+#include "asio/read_until.hpp"
+
+#include <string>
+#include <vector>
+#include "asio/io_context.hpp"
+#include "asio/local/connect_pair.hpp"
+#include "asio/local/stream_protocol.hpp"
+#include "asio/write.hpp"
+#include "unit_test.hpp"
+
+#if defined(ASIO_HAS_BOOST_BIND)
+# include <boost/bind/bind.hpp>
+#else // defined(ASIO_HAS_BOOST_BIND)
+# include <functional>
+#endif // defined(ASIO_HAS_BOOST_BIND)
+
+#if defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = boost;
+#else // defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = std;
+#endif
+
+typedef std::vector<asio::const_buffer> buffer_vector;
+typedef std::pair<std::size_t, bool> search_result;
+
+// Split a string into buffers at the given lengths. The last buffer holds
+// whatever remains.
+buffer_vector split(const std::string& s, const std::size_t* lengths,
+    std::size_t count)
+{
+  buffer_vector v;
+  std::size_t offset = 0;
+  for (std::size_t i = 0; i < count && offset < s.size(); ++i)
+  {
+    std::size_t n = (std::min)(lengths[i], s.size() - offset);
+    v.push_back(asio::buffer(s.data() + offset, n));
+    offset += n;
+  }
+  v.push_back(asio::buffer(s.data() + offset, s.size() - offset));
+  return v;
+}
+
+search_result find(const buffer_vector& v, std::size_t position, char delim)
+{
+  return asio::detail::find_delimiter(v, position, delim);
+}
+
+search_result search(const buffer_vector& v,
+    std::size_t position, const std::string& delim)
+{
+  return asio::detail::partial_search(
+      v, position, delim.data(), delim.size());
+}
+
+// A character is found in any buffer at or after the position, and empty
+// buffers are skipped.
+void find_delimiter_test()
+{
+  const std::string s = "ab\ncd\nef";
+  const std::size_t lengths[] = { 2, 0, 1, 3 };
+  buffer_vector v = split(s, lengths, 4);
+
+  ASIO_CHECK(find(v, 0, '\n') == search_result(2, true));
+  ASIO_CHECK(find(v, 2, '\n') == search_result(2, true));
+  ASIO_CHECK(find(v, 3, '\n') == search_result(5, true));
+  ASIO_CHECK(find(v, 6, '\n') == search_result(8, false));
+  ASIO_CHECK(find(v, 8, '\n') == search_result(8, false));
+  ASIO_CHECK(find(v, 0, 'x') == search_result(8, false));
+  ASIO_CHECK(find(v, 0, 'a') == search_result(0, true));
+  ASIO_CHECK(find(v, 0, 'f') == search_result(7, true));
+
+  ASIO_CHECK(find(buffer_vector(), 0, '\n') == search_result(0, false));
+}
+
+// A string may match across several buffers. A string cut off by the end of
+// the data is reported as a partial match, and candidates that fail part way
+// through do not hide a later match.
+void partial_search_test()
+{
+  const std::string s = "xx\r\r\nyy\r";
+  const std::size_t lengths[] = { 3, 1, 1 };
+  buffer_vector v = split(s, lengths, 3);
+
+  ASIO_CHECK(search(v, 0, "\r\n") == search_result(3, true));
+  ASIO_CHECK(search(v, 4, "\r\n") == search_result(7, false));
+  ASIO_CHECK(search(v, 0, "\r\ny") == search_result(3, true));
+  ASIO_CHECK(search(v, 0, "\r\nyy\r\n") == search_result(3, false));
+  ASIO_CHECK(search(v, 0, "zz") == search_result(8, false));
+  ASIO_CHECK(search(v, 0, "xx\r\r\nyy\r") == search_result(0, true));
+
+  const std::string t = "abcabcabd";
+  const std::size_t one[] = { 1, 1, 1, 1, 1, 1, 1, 1 };
+  buffer_vector w = split(t, one, 8);
+  ASIO_CHECK(search(w, 0, "abcabd") == search_result(3, true));
+  ASIO_CHECK(search(w, 4, "abcabd") == search_result(9, false));
+  ASIO_CHECK(search(w, 0, "abd") == search_result(6, true));
+}
+
+// An empty string matches at the position, but only once there is data to
+// search there.
+void empty_delimiter_test()
+{
+  const std::string s = "abc";
+  const std::size_t lengths[] = { 1 };
+  buffer_vector v = split(s, lengths, 1);
+
+  ASIO_CHECK(search(v, 0, "") == search_result(0, true));
+  ASIO_CHECK(search(v, 2, "") == search_result(2, true));
+  ASIO_CHECK(search(v, 3, "") == search_result(3, false));
+  ASIO_CHECK(search(buffer_vector(), 0, "") == search_result(0, false));
+
+#if defined(ASIO_HAS_LOCAL_SOCKETS)
+  asio::io_context ioc;
+  asio::local::stream_protocol::socket s1(ioc), s2(ioc);
+  asio::local::connect_pair(s1, s2);
+  asio::write(s1, asio::buffer(s));
+
+  std::string data;
+  std::size_t n = asio::read_until(s2, asio::dynamic_buffer(data), "");
+  ASIO_CHECK(n == 0);
+  ASIO_CHECK(data == s);
+#endif // defined(ASIO_HAS_LOCAL_SOCKETS)
+}
+
+void handle_read(const asio::error_code& ec, std::size_t bytes,
+    asio::error_code* out_ec, std::size_t* out_bytes)
+{
+  *out_ec = ec;
+  *out_bytes = bytes;
+}
+
+// A delimiter that arrives in two reads is found, and a line that is
+// already in the buffer is returned without reading.
+void read_until_test()
+{
+#if defined(ASIO_HAS_LOCAL_SOCKETS)
+  asio::io_context ioc;
+  asio::local::stream_protocol::socket s1(ioc), s2(ioc);
+  asio::local::connect_pair(s1, s2);
+
+  std::string data;
+  asio::error_code ec;
+  std::size_t bytes = 0;
+  asio::async_read_until(s2, asio::dynamic_buffer(data), "\r\n",
+      bindns::bind(handle_read, bindns::placeholders::_1,
+        bindns::placeholders::_2, &ec, &bytes));
+  asio::write(s1, asio::buffer("hello\r", 6));
+  ioc.poll();
+  ASIO_CHECK(bytes == 0);
+  ASIO_CHECK(data.compare(0, 6, "hello\r") == 0);
+
+  asio::write(s1, asio::buffer("\nworld\nx\r\n", 10));
+  ioc.restart();
+  ioc.run();
+  ASIO_CHECK(!ec);
+  ASIO_CHECK(bytes == 7);
+  data.erase(0, bytes);
+
+  std::size_t n = asio::read_until(s2, asio::dynamic_buffer(data), '\n');
+  ASIO_CHECK(n == 6);
+  ASIO_CHECK(data.substr(0, n) == "world\n");
+  data.erase(0, n);
+  n = asio::read_until(s2, asio::dynamic_buffer(data), "\r\n");
+  ASIO_CHECK(n == 3);
+  ASIO_CHECK(data == "x\r\n");
+#endif // defined(ASIO_HAS_LOCAL_SOCKETS)
+}
+
+ASIO_TEST_SUITE
+(
+  "read_until",
+  ASIO_TEST_CASE(find_delimiter_test)
+  ASIO_TEST_CASE(partial_search_test)
+  ASIO_TEST_CASE(empty_delimiter_test)
+  ASIO_TEST_CASE(read_until_test)
+)
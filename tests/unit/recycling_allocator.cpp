@@ -0,0 +1,222 @@
+//
+// recycling_allocator.cpp
+// ~~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2020 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Disable autolinking for unit tests.
+#if !defined(BOOST_ALL_NO_LIB)
+#define BOOST_ALL_NO_LIB 1
+#endif // !defined(BOOST_ALL_NO_LIB)
+
+// Test that header file is self-contained.
+#include "asio/recycling_allocator.hpp"
+
+#include <memory>
+#include <vector>
+#include "asio/bind_allocator.hpp"
+#include "asio/io_context.hpp"
+#include "asio/post.hpp"
+#include "unit_test.hpp"
+
+#if defined(ASIO_HAS_BOOST_BIND)
+# include <boost/bind/bind.hpp>
+#else // defined(ASIO_HAS_BOOST_BIND)
+# include <functional>
+#endif // defined(ASIO_HAS_BOOST_BIND)
+
+#if defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = boost;
+#else // defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = std;
+#endif
+
+using asio::recycling_allocator;
+
+// A thread that is not running an io_context has no cache, and its memory
+// comes from the heap.
+void recycling_allocator_no_thread_test()
+{
+  ASIO_CHECK(recycling_allocator<void>::max_cached_blocks() == 0);
+  recycling_allocator<void>::max_cached_blocks(2);
+  ASIO_CHECK(recycling_allocator<void>::max_cached_blocks() == 0);
+
+  recycling_allocator<int> a;
+  int* p = a.allocate(10);
+  p[9] = 1;
+  a.deallocate(p, 10);
+  ASIO_CHECK(recycling_allocator<void>::cached_bytes() == 0);
+  recycling_allocator<void>::trim();
+
+  ASIO_CHECK(a == recycling_allocator<int>(recycling_allocator<char>()));
+  ASIO_CHECK(!(a != recycling_allocator<int>()));
+}
+
+struct cache_results
+{
+  std::size_t default_limit;
+  std::size_t cached_after_free;
+  bool reused;
+  std::size_t cached_after_limit;
+  std::size_t cached_after_trim;
+  std::size_t limit_after_trim;
+  std::size_t cached_when_disabled;
+};
+
+void use_cache(cache_results* r)
+{
+  recycling_allocator<char> a;
+  recycling_allocator<void>::trim();
+  r->default_limit = recycling_allocator<void>::max_cached_blocks();
+
+  char* blocks[3];
+  for (int i = 0; i < 3; ++i)
+    blocks[i] = a.allocate(100);
+  for (int i = 0; i < 3; ++i)
+    a.deallocate(blocks[i], 100);
+  r->cached_after_free = recycling_allocator<void>::cached_bytes();
+
+  char* p = a.allocate(100);
+  r->reused = (p == blocks[2]);
+  a.deallocate(p, 100);
+
+  recycling_allocator<void>::max_cached_blocks(1);
+  r->cached_after_limit = recycling_allocator<void>::cached_bytes();
+
+  recycling_allocator<void>::trim();
+  r->cached_after_trim = recycling_allocator<void>::cached_bytes();
+  r->limit_after_trim = recycling_allocator<void>::max_cached_blocks();
+
+  recycling_allocator<void>::max_cached_blocks(0);
+  p = a.allocate(100);
+  a.deallocate(p, 100);
+  r->cached_when_disabled = recycling_allocator<void>::cached_bytes();
+}
+
+// A thread running an io_context reuses freed blocks, up to the limit on the
+// number retained.
+void recycling_allocator_cache_test()
+{
+  asio::io_context ioc;
+  cache_results r = cache_results();
+  asio::post(ioc, bindns::bind(use_cache, &r));
+  ioc.run();
+
+  ASIO_CHECK(r.default_limit == 4);
+  ASIO_CHECK(r.cached_after_free == 3 * 128);
+  ASIO_CHECK(r.reused);
+  ASIO_CHECK(r.cached_after_limit == 128);
+  ASIO_CHECK(r.cached_after_trim == 0);
+  ASIO_CHECK(r.limit_after_trim == 1);
+  ASIO_CHECK(r.cached_when_disabled == 0);
+}
+
+void fill_vector(std::size_t* size)
+{
+#if defined(ASIO_HAS_CXX11_ALLOCATORS)
+  std::vector<int, recycling_allocator<int> > v;
+  for (int i = 0; i < 1000; ++i)
+    v.push_back(i);
+  *size = v.size();
+#else // defined(ASIO_HAS_CXX11_ALLOCATORS)
+  *size = 1000;
+#endif // defined(ASIO_HAS_CXX11_ALLOCATORS)
+}
+
+// Standard containers may use the allocator, including for allocations too
+// large to be cached.
+void recycling_allocator_container_test()
+{
+  asio::io_context ioc;
+  std::size_t size = 0;
+  asio::post(ioc, bindns::bind(fill_vector, &size));
+  ioc.run();
+  ASIO_CHECK(size == 1000);
+}
+
+template <typename T>
+class counting_allocator
+{
+public:
+  typedef T value_type;
+
+  template <typename U>
+  struct rebind
+  {
+    typedef counting_allocator<U> other;
+  };
+
+  explicit counting_allocator(int* count)
+    : count_(count)
+  {
+  }
+
+  template <typename U>
+  counting_allocator(const counting_allocator<U>& other)
+    : count_(other.count_)
+  {
+  }
+
+  T* allocate(std::size_t n)
+  {
+    ++(*count_);
+    return std::allocator<T>().allocate(n);
+  }
+
+  void deallocate(T* p, std::size_t n)
+  {
+    std::allocator<T>().deallocate(p, n);
+  }
+
+  bool operator==(const counting_allocator& other) const
+  {
+    return count_ == other.count_;
+  }
+
+  bool operator!=(const counting_allocator& other) const
+  {
+    return count_ != other.count_;
+  }
+
+  int* count_;
+};
+
+void increment(int* count)
+{
+  ++(*count);
+}
+
+// A function posted with a bound allocator has its storage allocated by it.
+void recycling_allocator_bind_test()
+{
+  asio::io_context ioc;
+  int allocations = 0;
+  int calls = 0;
+
+  asio::post(ioc, asio::bind_allocator(
+        counting_allocator<int>(&allocations),
+        bindns::bind(increment, &calls)));
+  asio::post(ioc, asio::bind_allocator(
+        recycling_allocator<void>(),
+        bindns::bind(increment, &calls)));
+  ioc.run();
+
+  ASIO_CHECK(calls == 2);
+  ASIO_CHECK(allocations > 0);
+  ASIO_CHECK(asio::get_associated_allocator(asio::bind_allocator(
+          counting_allocator<int>(&allocations),
+          bindns::bind(increment, &calls))).count_ == &allocations);
+}
+
+ASIO_TEST_SUITE
+(
+  "recycling_allocator",
+  ASIO_TEST_CASE(recycling_allocator_no_thread_test)
+  ASIO_TEST_CASE(recycling_allocator_cache_test)
+  ASIO_TEST_CASE(recycling_allocator_container_test)
+  ASIO_TEST_CASE(recycling_allocator_bind_test)
+)
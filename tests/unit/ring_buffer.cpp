@@ -0,0 +1,324 @@
+//
+// ring_buffer.cpp
+// ~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2020 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Disable autolinking for unit tests.
+#if !defined(BOOST_ALL_NO_LIB)
+#define BOOST_ALL_NO_LIB 1
+#endif // !defined(BOOST_ALL_NO_LIB)
+
+// Test that header file is self-contained.
+#include "asio/ring_buffer.hpp"
+
+#include "unit_test.hpp"
+
+#if defined(ASIO_HAS_RING_BUFFER)
+
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include "asio/io_context.hpp"
+#include "asio/local/connect_pair.hpp"
+#include "asio/local/stream_protocol.hpp"
+#include "asio/read.hpp"
+#include "asio/read_until.hpp"
+#include "asio/write.hpp"
+
+#if defined(ASIO_HAS_BOOST_BIND)
+# include <boost/bind/bind.hpp>
+#else // defined(ASIO_HAS_BOOST_BIND)
+# include <functional>
+#endif // defined(ASIO_HAS_BOOST_BIND)
+
+#if defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = boost;
+#else // defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = std;
+#endif
+
+using asio::ring_buffer;
+
+std::size_t page_size()
+{
+  return static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+}
+
+// Append a string to the readable bytes.
+void append(ring_buffer& ring, const std::string& s)
+{
+  asio::mutable_buffer b = ring.prepare(s.size());
+  std::memcpy(b.data(), s.data(), s.size());
+  ring.commit(s.size());
+}
+
+std::string contents(const ring_buffer& ring)
+{
+  return std::string(static_cast<const char*>(ring.data().data()),
+      ring.data().size());
+}
+
+std::string pattern(std::size_t n, std::size_t seed)
+{
+  std::string s(n, '\0');
+  for (std::size_t i = 0; i < n; ++i)
+    s[i] = static_cast<char>('a' + (i + seed) % 26);
+  return s;
+}
+
+// The capacity is a whole number of pages, and the buffer starts empty.
+void ring_buffer_construct_test()
+{
+  ring_buffer a(0);
+  ASIO_CHECK(a.capacity() == page_size());
+  ASIO_CHECK(a.size() == 0);
+  ASIO_CHECK(a.data().size() == 0);
+
+  ring_buffer b(page_size() + 1);
+  ASIO_CHECK(b.capacity() == 2 * page_size());
+
+  b.reserve(page_size());
+  ASIO_CHECK(b.capacity() == 2 * page_size());
+}
+
+// Readable and writable regions that cross the end of the memory are still
+// contiguous, and are seen through both mappings.
+void ring_buffer_wraparound_test()
+{
+  const std::size_t capacity = page_size();
+  ring_buffer ring(capacity);
+  std::string expected;
+
+  // Each round leaves the head further round the ring, so that the regions
+  // start at many different offsets and often cross the end of the memory.
+  for (std::size_t round = 0; round < 200; ++round)
+  {
+    std::size_t n = (round * 977) % (capacity - expected.size() + 1);
+    std::string s = pattern(n, round);
+    append(ring, s);
+    expected += s;
+    ASIO_CHECK(ring.capacity() == capacity);
+    ASIO_CHECK(contents(ring) == expected);
+
+    std::size_t c = (round * 389) % (expected.size() + 1);
+    ring.consume(c);
+    expected.erase(0, c);
+    ASIO_CHECK(contents(ring) == expected);
+  }
+
+  // Fill the ring completely from an offset part way round. The last byte is
+  // then in the second mapping, and is the same memory as the byte before the
+  // first.
+  ring.consume(ring.size());
+  append(ring, pattern(capacity / 2 + 3, 0));
+  ring.consume(capacity / 2);
+  asio::mutable_buffer space = ring.prepare(capacity - 3);
+  ASIO_CHECK(space.size() == capacity - 3);
+  ASIO_CHECK(ring.capacity() == capacity);
+  std::memset(space.data(), 'z', space.size());
+  ring.commit(space.size());
+  ASIO_CHECK(ring.size() == capacity);
+  unsigned char* first = static_cast<unsigned char*>(ring.data().data());
+  ASIO_CHECK(first[capacity - 1] == 'z');
+  first[capacity - 1] = 'y';
+  ASIO_CHECK(first[-1] == 'y');
+}
+
+// Remapping to a larger capacity keeps the readable bytes, including those
+// that crossed the end of the old memory.
+void ring_buffer_reserve_test()
+{
+  const std::size_t capacity = page_size();
+  ring_buffer ring(capacity);
+
+  append(ring, pattern(capacity - 100, 0));
+  ring.consume(capacity - 200);
+  std::string expected = pattern(capacity - 100, 0).substr(capacity - 200);
+  std::string tail = pattern(500, 7);
+  append(ring, tail);
+  expected += tail;
+  ASIO_CHECK(ring.capacity() == capacity);
+  ASIO_CHECK(contents(ring) == expected);
+
+  ring.reserve(3 * capacity);
+  ASIO_CHECK(ring.capacity() == 3 * capacity);
+  ASIO_CHECK(contents(ring) == expected);
+
+  // Preparing more than the free space grows the memory as needed.
+  std::string more = pattern(5 * capacity, 3);
+  append(ring, more);
+  expected += more;
+  ASIO_CHECK(ring.capacity() >= expected.size());
+  ASIO_CHECK(contents(ring) == expected);
+}
+
+// Committing, consuming and shrinking are clamped to the available bytes, and
+// a failed prepare leaves the readable bytes unchanged.
+void ring_buffer_clamp_test()
+{
+  ring_buffer ring(100);
+  append(ring, "abcdef");
+  ring.consume(2);
+
+  asio::mutable_buffer b = ring.prepare(3);
+  std::memcpy(b.data(), "ghi", 3);
+  ring.commit(10);
+  ASIO_CHECK(contents(ring) == "cdefghi");
+  ring.commit(5);
+  ASIO_CHECK(ring.size() == 7);
+
+  ring.grow(2);
+  ASIO_CHECK(ring.size() == 9);
+  ring.shrink(4);
+  ASIO_CHECK(contents(ring) == "cdefg");
+
+  ring.consume(100);
+  ASIO_CHECK(ring.size() == 0);
+  append(ring, "x");
+  ring.shrink(100);
+  ASIO_CHECK(ring.size() == 0);
+
+  append(ring, "yz");
+
+  bool thrown = false;
+  try
+  {
+    ring.prepare((std::numeric_limits<std::size_t>::max)());
+  }
+  catch (std::length_error&)
+  {
+    thrown = true;
+  }
+  ASIO_CHECK(thrown);
+  ASIO_CHECK(contents(ring) == "yz");
+}
+
+// The dynamic buffer enforces its maximum size, and gives access to the
+// underlying memory by position.
+void dynamic_ring_buffer_test()
+{
+  ring_buffer ring(100);
+  asio::dynamic_ring_buffer db = asio::dynamic_buffer(ring, 10);
+  ASIO_CHECK(db.max_size() == 10);
+  ASIO_CHECK(db.size() == 0);
+  ASIO_CHECK(db.capacity() == 10);
+
+  db.grow(4);
+  std::memcpy(db.data(0, 4).data(), "abcd", 4);
+  ASIO_CHECK(db.size() == 4);
+  ASIO_CHECK(std::memcmp(db.data(1, 2).data(), "bc", 2) == 0);
+
+  asio::dynamic_ring_buffer copy(db);
+  copy.shrink(1);
+  ASIO_CHECK(db.size() == 3);
+
+#if !defined(ASIO_NO_DYNAMIC_BUFFER_V1)
+  asio::mutable_buffer b = db.prepare(2);
+  std::memcpy(b.data(), "ef", 2);
+  db.commit(2);
+  ASIO_CHECK(db.data().size() == 5);
+  ASIO_CHECK(std::memcmp(db.data().data(), "abcef", 5) == 0);
+#else // !defined(ASIO_NO_DYNAMIC_BUFFER_V1)
+  db.grow(2);
+#endif // !defined(ASIO_NO_DYNAMIC_BUFFER_V1)
+
+  bool thrown = false;
+  try
+  {
+    db.grow(6);
+  }
+  catch (std::length_error&)
+  {
+    thrown = true;
+  }
+  ASIO_CHECK(thrown);
+  ASIO_CHECK(db.size() == 5);
+
+  db.consume(2);
+  ASIO_CHECK(db.size() == 3);
+  db.grow(7);
+  ASIO_CHECK(db.size() == 10);
+}
+
+void handle_io(const asio::error_code& ec,
+    std::size_t bytes, asio::error_code* out_ec, std::size_t* out_bytes)
+{
+  *out_ec = ec;
+  *out_bytes = bytes;
+}
+
+// The dynamic buffer may be used with the composed read and write
+// operations, with lines that wrap around the ring.
+void dynamic_ring_buffer_io_test()
+{
+#if defined(ASIO_HAS_LOCAL_SOCKETS)
+  asio::io_context ioc;
+  asio::local::stream_protocol::socket s1(ioc), s2(ioc);
+  asio::local::connect_pair(s1, s2);
+
+  ring_buffer ring(page_size());
+  std::string line = pattern(1000, 0) + "\n";
+  for (int i = 0; i < 10; ++i)
+  {
+    asio::write(s1, asio::buffer(line));
+    std::size_t n = asio::read_until(s2, asio::dynamic_buffer(ring), '\n');
+    ASIO_CHECK(n == line.size());
+    ASIO_CHECK(contents(ring).substr(0, n) == line);
+    ring.consume(n);
+  }
+  ASIO_CHECK(ring.capacity() == page_size());
+
+  std::string payload = pattern(3 * page_size() + 5, 1);
+  asio::error_code read_ec, write_ec;
+  std::size_t read_bytes = 0, write_bytes = 0;
+  asio::async_write(s1, asio::buffer(payload),
+      bindns::bind(handle_io, bindns::placeholders::_1,
+        bindns::placeholders::_2, &write_ec, &write_bytes));
+  asio::async_read(s2, asio::dynamic_buffer(ring),
+      asio::transfer_exactly(payload.size()),
+      bindns::bind(handle_io, bindns::placeholders::_1,
+        bindns::placeholders::_2, &read_ec, &read_bytes));
+  ioc.run();
+  ASIO_CHECK(!read_ec && read_bytes == payload.size());
+  ASIO_CHECK(contents(ring) == payload);
+
+  // Write the data back out directly from the ring.
+  asio::ring_buffer echo(page_size());
+  asio::async_write(s2, asio::dynamic_buffer(ring),
+      bindns::bind(handle_io, bindns::placeholders::_1,
+        bindns::placeholders::_2, &write_ec, &write_bytes));
+  asio::async_read(s1, asio::dynamic_buffer(echo),
+      asio::transfer_exactly(payload.size()),
+      bindns::bind(handle_io, bindns::placeholders::_1,
+        bindns::placeholders::_2, &read_ec, &read_bytes));
+  ioc.restart();
+  ioc.run();
+  ASIO_CHECK(!write_ec && write_bytes == payload.size());
+  ASIO_CHECK(ring.size() == 0);
+  ASIO_CHECK(contents(echo) == payload);
+#endif // defined(ASIO_HAS_LOCAL_SOCKETS)
+}
+
+#endif // defined(ASIO_HAS_RING_BUFFER)
+
+ASIO_TEST_SUITE
+(
+  "ring_buffer",
+#if defined(ASIO_HAS_RING_BUFFER)
+  ASIO_TEST_CASE(ring_buffer_construct_test)
+  ASIO_TEST_CASE(ring_buffer_wraparound_test)
+  ASIO_TEST_CASE(ring_buffer_reserve_test)
+  ASIO_TEST_CASE(ring_buffer_clamp_test)
+  ASIO_TEST_CASE(dynamic_ring_buffer_test)
+  ASIO_TEST_CASE(dynamic_ring_buffer_io_test)
+#else // defined(ASIO_HAS_RING_BUFFER)
+  ASIO_TEST_CASE(null_test)
+#endif // defined(ASIO_HAS_RING_BUFFER)
+)
@@ -0,0 +1,369 @@
+//
+// segmented_buffer.cpp
+// ~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2020 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Disable autolinking for unit tests.
+#if !defined(BOOST_ALL_NO_LIB)
+#define BOOST_ALL_NO_LIB 1
+#endif // !defined(BOOST_ALL_NO_LIB)
+
+// Test that header file is self-contained.
+#include "asio/segmented_buffer.hpp"
+
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "asio/io_context.hpp"
+#include "asio/local/connect_pair.hpp"
+#include "asio/local/stream_protocol.hpp"
+#include "asio/post.hpp"
+#include "asio/read.hpp"
+#include "asio/read_until.hpp"
+#include "asio/write.hpp"
+#include "unit_test.hpp"
+
+#if defined(ASIO_HAS_BOOST_BIND)
+# include <boost/bind/bind.hpp>
+#else // defined(ASIO_HAS_BOOST_BIND)
+# include <functional>
+#endif // defined(ASIO_HAS_BOOST_BIND)
+
+#if defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = boost;
+#else // defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = std;
+#endif
+
+using asio::segmented_buffer;
+
+// Append a string to the readable bytes.
+void append(segmented_buffer& buf, const std::string& s)
+{
+  asio::buffer_copy(buf.prepare(s.size()), asio::buffer(s));
+  buf.commit(s.size());
+}
+
+template <typename Buffers>
+std::string to_string(const Buffers& buffers)
+{
+  std::string s(asio::buffer_size(buffers), '\0');
+  if (!s.empty())
+    asio::buffer_copy(asio::buffer(&s[0], s.size()), buffers);
+  return s;
+}
+
+// Get the sizes of the buffers in a sequence.
+template <typename Buffers>
+std::vector<std::size_t> sizes(const Buffers& buffers)
+{
+  std::vector<std::size_t> v;
+  for (typename Buffers::const_iterator i = buffers.begin();
+      i != buffers.end(); ++i)
+    v.push_back(asio::const_buffer(*i).size());
+  return v;
+}
+
+std::vector<std::size_t> make_sizes(std::size_t a,
+    std::size_t b = 0, std::size_t c = 0)
+{
+  std::vector<std::size_t> v;
+  v.push_back(a);
+  if (b) v.push_back(b);
+  if (c) v.push_back(c);
+  return v;
+}
+
+// The readable bytes and prepared space are split at block boundaries, and
+// the sequences may be walked in either direction.
+void segmented_buffer_sequence_test()
+{
+  segmented_buffer buf(8);
+  ASIO_CHECK(buf.block_size() == 8);
+  ASIO_CHECK(buf.size() == 0);
+  ASIO_CHECK(buf.capacity() == 0);
+  ASIO_CHECK(buf.data().begin() == buf.data().end());
+
+  append(buf, "0123456789abcdefghij");
+  ASIO_CHECK(buf.size() == 20);
+  ASIO_CHECK(buf.capacity() == 24);
+  ASIO_CHECK(sizes(buf.data()) == make_sizes(8, 8, 4));
+  ASIO_CHECK(to_string(buf.data()) == "0123456789abcdefghij");
+
+  buf.consume(3);
+  ASIO_CHECK(sizes(buf.data()) == make_sizes(5, 8, 4));
+  ASIO_CHECK(to_string(buf.data()) == "3456789abcdefghij");
+
+  segmented_buffer::const_buffers_type cb = buf.data();
+  segmented_buffer::const_buffers_type::const_iterator i = cb.end();
+  ASIO_CHECK(asio::const_buffer(*--i).size() == 4);
+  ASIO_CHECK(asio::const_buffer(*i--).size() == 4);
+  ASIO_CHECK(asio::const_buffer(*i).size() == 8);
+  ASIO_CHECK(asio::const_buffer(*--i).size() == 5);
+  ASIO_CHECK(i == cb.begin());
+  ASIO_CHECK(std::distance(cb.begin(), cb.end()) == 3);
+
+  // Parts of the readable bytes are clamped to those available.
+  ASIO_CHECK(to_string(buf.data(4, 6)) == "789abc");
+  ASIO_CHECK(sizes(buf.data(4, 6)) == make_sizes(1, 5));
+  ASIO_CHECK(to_string(buf.data(15, 100)) == "ij");
+  ASIO_CHECK(asio::buffer_size(buf.data(100, 1)) == 0);
+
+  // The prepared space follows the readable bytes, in the partly used last
+  // block and then new ones.
+  ASIO_CHECK(sizes(buf.prepare(13)) == make_sizes(4, 8, 1));
+  ASIO_CHECK(buf.capacity() == 37);
+  ASIO_CHECK(asio::buffer_size(buf.prepare(0)) == 0);
+}
+
+// Consuming releases every block that holds no readable bytes, without
+// moving the bytes that remain.
+void segmented_buffer_consume_test()
+{
+  segmented_buffer buf(8);
+  append(buf, "0123456789abcdefghij");
+  const void* last = (*--buf.data().end()).data();
+
+  buf.consume(10);
+  ASIO_CHECK(buf.capacity() == 14);
+  ASIO_CHECK(to_string(buf.data()) == "abcdefghij");
+  ASIO_CHECK((*--buf.data().end()).data() == last);
+
+  buf.consume(6);
+  ASIO_CHECK(buf.capacity() == 8);
+  ASIO_CHECK(to_string(buf.data()) == "ghij");
+
+  // Emptying the buffer keeps the last block, which is then used from its
+  // start.
+  buf.consume(100);
+  ASIO_CHECK(buf.size() == 0);
+  ASIO_CHECK(buf.capacity() == 8);
+  append(buf, "01234567");
+  ASIO_CHECK(sizes(buf.data()) == make_sizes(8));
+
+  buf.consume(8);
+  ASIO_CHECK(buf.capacity() == 0);
+}
+
+// Commits, shrinks and consumes are clamped, and unused blocks may be
+// released.
+void segmented_buffer_resize_test()
+{
+  segmented_buffer buf(8);
+  append(buf, "abc");
+
+  asio::buffer_copy(buf.prepare(4), asio::buffer("defg", 4));
+  buf.commit(100);
+  ASIO_CHECK(to_string(buf.data()) == "abcdefg");
+  buf.commit(5);
+  ASIO_CHECK(buf.size() == 7);
+
+  buf.grow(10);
+  ASIO_CHECK(buf.size() == 17);
+  ASIO_CHECK(buf.capacity() == 24);
+  buf.shrink(12);
+  ASIO_CHECK(to_string(buf.data()) == "abcde");
+
+  buf.prepare(30);
+  ASIO_CHECK(buf.capacity() == 40);
+  buf.shrink_to_fit();
+  ASIO_CHECK(buf.capacity() == 8);
+  ASIO_CHECK(to_string(buf.data()) == "abcde");
+
+  buf.shrink(100);
+  ASIO_CHECK(buf.size() == 0);
+  buf.shrink_to_fit();
+  ASIO_CHECK(buf.capacity() == 0);
+
+  append(buf, "xy");
+  bool thrown = false;
+  try
+  {
+    buf.prepare((std::numeric_limits<std::size_t>::max)());
+  }
+  catch (std::length_error&)
+  {
+    thrown = true;
+  }
+  ASIO_CHECK(thrown);
+  ASIO_CHECK(to_string(buf.data()) == "xy");
+}
+
+void cycle_blocks(std::size_t* cached)
+{
+  asio::recycling_allocator<void>::trim();
+  {
+    segmented_buffer buf(100);
+    append(buf, std::string(250, 'x'));
+    buf.consume(200);
+    cached[0] = asio::recycling_allocator<void>::cached_bytes();
+  }
+  cached[1] = asio::recycling_allocator<void>::cached_bytes();
+}
+
+// Blocks released by a thread running an io_context are kept for reuse.
+void segmented_buffer_recycling_test()
+{
+  asio::io_context ioc;
+  std::size_t cached[2] = { 0, 0 };
+  asio::post(ioc, bindns::bind(cycle_blocks, cached));
+  ioc.run();
+  ASIO_CHECK(cached[0] > 0);
+  ASIO_CHECK(cached[1] > cached[0]);
+}
+
+void cycle_default_block(std::size_t* cached)
+{
+  asio::recycling_allocator<void>::trim();
+  {
+    segmented_buffer buf;
+    append(buf, std::string(segmented_buffer::default_block_size, 'x'));
+    ASIO_CHECK(sizes(buf.data()).size() == 1);
+  }
+  *cached = asio::recycling_allocator<void>::cached_bytes();
+}
+
+// A block of the default size, with its tag, fills a 4096-byte cache block
+// rather than spilling into the next size.
+void segmented_buffer_default_block_test()
+{
+  asio::io_context ioc;
+  std::size_t cached = 0;
+  asio::post(ioc, bindns::bind(cycle_default_block, &cached));
+  ioc.run();
+  ASIO_CHECK(cached == 4096);
+}
+
+// The dynamic buffer enforces its maximum size.
+void dynamic_segmented_buffer_test()
+{
+  segmented_buffer buf(4);
+  asio::dynamic_segmented_buffer db = asio::dynamic_buffer(buf, 10);
+  ASIO_CHECK(db.max_size() == 10);
+  ASIO_CHECK(db.capacity() == 0);
+
+  db.grow(6);
+  asio::buffer_copy(db.data(0, 6), asio::buffer("abcdef", 6));
+  ASIO_CHECK(db.size() == 6);
+  ASIO_CHECK(db.capacity() == 8);
+  ASIO_CHECK(to_string(db.data(2, 3)) == "cde");
+
+  asio::dynamic_segmented_buffer copy(db);
+  copy.shrink(1);
+  ASIO_CHECK(db.size() == 5);
+
+#if !defined(ASIO_NO_DYNAMIC_BUFFER_V1)
+  asio::buffer_copy(db.prepare(3), asio::buffer("ghi", 3));
+  db.commit(3);
+  ASIO_CHECK(to_string(db.data()) == "abcdeghi");
+#else // !defined(ASIO_NO_DYNAMIC_BUFFER_V1)
+  db.grow(3);
+#endif // !defined(ASIO_NO_DYNAMIC_BUFFER_V1)
+
+  bool thrown = false;
+  try
+  {
+    db.grow(3);
+  }
+  catch (std::length_error&)
+  {
+    thrown = true;
+  }
+  ASIO_CHECK(thrown);
+  ASIO_CHECK(db.size() == 8);
+
+  db.consume(5);
+  ASIO_CHECK(db.size() == 3);
+  ASIO_CHECK(buf.capacity() == 3);
+}
+
+void handle_io(const asio::error_code& ec,
+    std::size_t bytes, asio::error_code* out_ec, std::size_t* out_bytes)
+{
+  *out_ec = ec;
+  *out_bytes = bytes;
+}
+
+// The dynamic buffer may be used with the composed read and write
+// operations, including with delimiters split across blocks.
+void dynamic_segmented_buffer_io_test()
+{
+#if defined(ASIO_HAS_LOCAL_SOCKETS)
+  asio::io_context ioc;
+  asio::local::stream_protocol::socket s1(ioc), s2(ioc);
+  asio::local::connect_pair(s1, s2);
+
+  segmented_buffer buf(16);
+  std::string message = "0123456789abc\r\n0123456789abcdefghijklmn\r\n";
+  asio::write(s1, asio::buffer(message));
+
+  asio::error_code ec;
+  std::size_t n = 0;
+  asio::async_read_until(s2, asio::dynamic_buffer(buf), "\r\n",
+      bindns::bind(handle_io, bindns::placeholders::_1,
+        bindns::placeholders::_2, &ec, &n));
+  ioc.run();
+  ASIO_CHECK(!ec);
+  ASIO_CHECK(n == 15);
+  buf.consume(n);
+
+  // The second delimiter starts at the end of a block.
+  n = asio::read_until(s2, asio::dynamic_buffer(buf), "\r\n");
+  ASIO_CHECK(n == 26);
+  ASIO_CHECK(to_string(buf.data(0, n)) == message.substr(15));
+  buf.consume(n);
+  ASIO_CHECK(buf.size() == 0);
+
+  std::string payload(100000, '\0');
+  for (std::size_t i = 0; i < payload.size(); ++i)
+    payload[i] = static_cast<char>(i * 7);
+
+  asio::error_code write_ec;
+  std::size_t written = 0;
+  asio::async_write(s1, asio::buffer(payload),
+      bindns::bind(handle_io, bindns::placeholders::_1,
+        bindns::placeholders::_2, &write_ec, &written));
+  asio::async_read(s2, asio::dynamic_buffer(buf),
+      asio::transfer_exactly(payload.size()),
+      bindns::bind(handle_io, bindns::placeholders::_1,
+        bindns::placeholders::_2, &ec, &n));
+  ioc.restart();
+  ioc.run();
+  ASIO_CHECK(!ec && n == payload.size());
+  ASIO_CHECK(to_string(buf.data()) == payload);
+
+  // Write the data back out directly from the blocks.
+  segmented_buffer echo(1000);
+  asio::async_write(s2, asio::dynamic_buffer(buf),
+      bindns::bind(handle_io, bindns::placeholders::_1,
+        bindns::placeholders::_2, &write_ec, &written));
+  asio::async_read(s1, asio::dynamic_buffer(echo),
+      asio::transfer_exactly(payload.size()),
+      bindns::bind(handle_io, bindns::placeholders::_1,
+        bindns::placeholders::_2, &ec, &n));
+  ioc.restart();
+  ioc.run();
+  ASIO_CHECK(!write_ec && written == payload.size());
+  ASIO_CHECK(buf.size() == 0);
+  ASIO_CHECK(to_string(echo.data()) == payload);
+#endif // defined(ASIO_HAS_LOCAL_SOCKETS)
+}
+
+ASIO_TEST_SUITE
+(
+  "segmented_buffer",
+  ASIO_TEST_CASE(segmented_buffer_sequence_test)
+  ASIO_TEST_CASE(segmented_buffer_consume_test)
+  ASIO_TEST_CASE(segmented_buffer_resize_test)
+  ASIO_TEST_CASE(segmented_buffer_recycling_test)
+  ASIO_TEST_CASE(segmented_buffer_default_block_test)
+  ASIO_TEST_CASE(dynamic_segmented_buffer_test)
+  ASIO_TEST_CASE(dynamic_segmented_buffer_io_test)
+)
@@ -0,0 +1,331 @@
+//
+// strand.cpp
+// ~~~~~~~~~~
+//
+// Copyright (c) 2003-2020 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Disable autolinking for unit tests.
+#if !defined(BOOST_ALL_NO_LIB)
+#define BOOST_ALL_NO_LIB 1
+#endif // !defined(BOOST_ALL_NO_LIB)
+
+// Test that header file is self-contained.
+#include "asio/strand.hpp"
+
+#include <vector>
+#include "asio/detail/atomic_count.hpp"
+#include "asio/detail/thread.hpp"
+#include "asio/dispatch.hpp"
+#include "asio/executor_work_guard.hpp"
+#include "asio/io_context.hpp"
+#include "asio/post.hpp"
+#include "unit_test.hpp"
+
+#if defined(ASIO_HAS_BOOST_BIND)
+# include <boost/bind/bind.hpp>
+#else // defined(ASIO_HAS_BOOST_BIND)
+# include <functional>
+#endif // defined(ASIO_HAS_BOOST_BIND)
+
+#if defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = boost;
+#else // defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = std;
+#endif
+
+using namespace asio;
+
+typedef strand<io_context::executor_type> io_strand;
+
+// The handlers run on a strand, as seen from within it. Only the strand's own
+// handlers modify the record, so it needs no other synchronisation.
+struct strand_record
+{
+  strand_record()
+    : in_strand(0),
+      overlapped(false),
+      outside(false)
+  {
+  }
+
+  asio::detail::atomic_count in_strand;
+  bool overlapped;
+  bool outside;
+  std::vector<std::vector<int> > seen;
+};
+
+void record_handler(io_strand* s, strand_record* r, int producer, int value)
+{
+  if (++r->in_strand != 1)
+    r->overlapped = true;
+  if (!s->running_in_this_thread())
+    r->outside = true;
+  r->seen[producer].push_back(value);
+  --r->in_strand;
+}
+
+void post_to_strand(io_strand* s, strand_record* r, int producer, int n)
+{
+  for (int i = 0; i < n; ++i)
+    asio::post(*s, bindns::bind(record_handler, s, r, producer, i));
+}
+
+void run_context(io_context* ioc)
+{
+  ioc->run();
+}
+
+// Handlers posted to one strand from several threads, while several threads
+// run the io_context, never run concurrently, and those from each thread run
+// in the order they were posted.
+void strand_cross_thread_post_test()
+{
+  io_context ioc;
+  io_strand s = asio::make_strand(ioc);
+  strand_record r;
+  const int producers = 4;
+  const int per_producer = 10000;
+  r.seen.resize(producers);
+
+  asio::executor_work_guard<io_context::executor_type> work(
+      ioc.get_executor());
+  std::vector<asio::detail::thread*> runners;
+  for (int i = 0; i < 4; ++i)
+    runners.push_back(new asio::detail::thread(
+          bindns::bind(run_context, &ioc)));
+
+  std::vector<asio::detail::thread*> posters;
+  for (int i = 0; i < producers; ++i)
+    posters.push_back(new asio::detail::thread(
+          bindns::bind(post_to_strand, &s, &r, i, per_producer)));
+  for (std::size_t i = 0; i < posters.size(); ++i)
+  {
+    posters[i]->join();
+    delete posters[i];
+  }
+
+  work.reset();
+  for (std::size_t i = 0; i < runners.size(); ++i)
+  {
+    runners[i]->join();
+    delete runners[i];
+  }
+
+  ASIO_CHECK(!r.overlapped);
+  ASIO_CHECK(!r.outside);
+  for (int i = 0; i < producers; ++i)
+  {
+    ASIO_CHECK(static_cast<int>(r.seen[i].size()) == per_producer);
+    bool in_order = true;
+    for (std::size_t j = 0; j < r.seen[i].size(); ++j)
+      if (r.seen[i][j] != static_cast<int>(j))
+        in_order = false;
+    ASIO_CHECK(in_order);
+  }
+}
+
+void post_chain(io_strand* s, asio::detail::atomic_count* count, int remaining)
+{
+  ++(*count);
+  if (remaining > 0)
+    asio::post(*s, bindns::bind(post_chain, s, count, remaining - 1));
+}
+
+// Many strands sharing the io_context's threads each run all of their
+// handlers.
+void strand_many_strands_test()
+{
+  io_context ioc;
+  const int strands = 1000;
+  const int chain = 20;
+  std::vector<io_strand> all;
+  all.reserve(strands);
+  asio::detail::atomic_count count(0);
+  for (int i = 0; i < strands; ++i)
+  {
+    all.push_back(asio::make_strand(ioc));
+    asio::post(all.back(), bindns::bind(post_chain, &all.back(), &count,
+          chain - 1));
+  }
+
+  std::vector<asio::detail::thread*> runners;
+  for (int i = 0; i < 4; ++i)
+    runners.push_back(new asio::detail::thread(
+          bindns::bind(run_context, &ioc)));
+  for (std::size_t i = 0; i < runners.size(); ++i)
+  {
+    runners[i]->join();
+    delete runners[i];
+  }
+
+  ASIO_CHECK(count == strands * chain);
+}
+
+void record_order(int* order, int* next)
+{
+  *order = (*next)++;
+}
+
+void run_nested(io_strand* s, int* inner, int* after, int* next)
+{
+  asio::dispatch(*s, bindns::bind(record_order, inner, next));
+  record_order(after, next);
+}
+
+struct counted
+{
+  explicit counted(asio::detail::atomic_count* live)
+    : live_(live)
+  {
+    ++(*live_);
+  }
+
+  counted(const counted& other)
+    : live_(other.live_)
+  {
+    ++(*live_);
+  }
+
+  ~counted()
+  {
+    --(*live_);
+  }
+
+  void operator()()
+  {
+  }
+
+  asio::detail::atomic_count* live_;
+};
+
+// Dispatching from within the strand runs the function at once, and handlers
+// still waiting when the io_context is destroyed are destroyed without being
+// run.
+void strand_dispatch_and_shutdown_test()
+{
+  {
+    io_context ioc;
+    io_strand s = asio::make_strand(ioc);
+    int inner = -1, after = -1, next = 0;
+    asio::post(s, bindns::bind(run_nested, &s, &inner, &after, &next));
+    ioc.run();
+    ASIO_CHECK(inner == 0);
+    ASIO_CHECK(after == 1);
+  }
+
+  asio::detail::atomic_count live(0);
+  {
+    io_context ioc;
+    io_strand s = asio::make_strand(ioc);
+    for (int i = 0; i < 100; ++i)
+      asio::post(s, counted(&live));
+    ASIO_CHECK(live == 100);
+  }
+  ASIO_CHECK(live == 0);
+}
+
+void noop()
+{
+}
+
+void spin_for(long usec)
+{
+#if defined(ASIO_HAS_CHRONO)
+  asio::chrono::steady_clock::time_point end
+    = asio::chrono::steady_clock::now() + asio::chrono::microseconds(usec);
+  while (asio::chrono::steady_clock::now() < end)
+  {
+  }
+#else // defined(ASIO_HAS_CHRONO)
+  (void)usec;
+#endif // defined(ASIO_HAS_CHRONO)
+}
+
+// A strand stops after its limit of handlers, or of time, and reschedules
+// itself to run the rest, counting each turn and preemption.
+void strand_limits_test()
+{
+  io_context ioc;
+  io_strand s = asio::make_strand(ioc);
+  ASIO_CHECK(s.max_handlers_per_turn() == 0);
+  ASIO_CHECK(s.max_usec_per_turn() == 0);
+  ASIO_CHECK(s.turns() == 0);
+
+  // The first handler is scheduled on its own, and the other nine wait for
+  // the next turn.
+  s.max_handlers_per_turn(2);
+  ASIO_CHECK(s.max_handlers_per_turn() == 2);
+  for (int i = 0; i < 10; ++i)
+    asio::post(s, noop);
+  ioc.run();
+  ASIO_CHECK(s.turns() == 6);
+  ASIO_CHECK(s.preemptions() == 4);
+  ASIO_CHECK(s.max_queue_depth() == 9);
+  ASIO_CHECK(s.run_time_usec() == 0);
+
+#if defined(ASIO_HAS_STD_CHRONO)
+  io_strand t = asio::make_strand(ioc);
+  t.max_usec_per_turn(1000);
+  ASIO_CHECK(t.max_usec_per_turn() == 1000);
+  for (int i = 0; i < 10; ++i)
+    asio::post(t, bindns::bind(spin_for, 400));
+  ioc.restart();
+  ioc.run();
+  ASIO_CHECK(t.preemptions() > 0);
+  ASIO_CHECK(t.turns() == t.preemptions() + 2);
+  ASIO_CHECK(t.run_time_usec() >= 10 * 400);
+#endif // defined(ASIO_HAS_STD_CHRONO)
+}
+
+void adjust_limits(io_strand* s, asio::detail::atomic_count* done)
+{
+  std::size_t n = 0;
+  while (*done == 0)
+  {
+    s->max_handlers_per_turn(++n % 4);
+    n += s->turns() + s->preemptions() + s->max_queue_depth();
+  }
+}
+
+// The limits may be changed, and the statistics read, by other threads while
+// the strand runs.
+void strand_limits_cross_thread_test()
+{
+  io_context ioc;
+  io_strand s = asio::make_strand(ioc);
+  asio::detail::atomic_count count(0);
+  asio::detail::atomic_count done(0);
+
+  asio::detail::thread adjuster(bindns::bind(adjust_limits, &s, &done));
+  for (int i = 0; i < 100; ++i)
+    asio::post(s, bindns::bind(post_chain, &s, &count, 99));
+
+  std::vector<asio::detail::thread*> runners;
+  for (int i = 0; i < 4; ++i)
+    runners.push_back(new asio::detail::thread(
+          bindns::bind(run_context, &ioc)));
+  for (std::size_t i = 0; i < runners.size(); ++i)
+  {
+    runners[i]->join();
+    delete runners[i];
+  }
+
+  ++done;
+  adjuster.join();
+  ASIO_CHECK(count == 100 * 100);
+  ASIO_CHECK(s.turns() > 0);
+}
+
+ASIO_TEST_SUITE
+(
+  "strand",
+  ASIO_TEST_CASE(strand_cross_thread_post_test)
+  ASIO_TEST_CASE(strand_many_strands_test)
+  ASIO_TEST_CASE(strand_dispatch_and_shutdown_test)
+  ASIO_TEST_CASE(strand_limits_test)
+  ASIO_TEST_CASE(strand_limits_cross_thread_test)
+)
@@ -0,0 +1,182 @@
+//
+// thread_affinity.cpp
+// ~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2020 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Disable autolinking for unit tests.
+#if !defined(BOOST_ALL_NO_LIB)
+#define BOOST_ALL_NO_LIB 1
+#endif // !defined(BOOST_ALL_NO_LIB)
+
+// Test that header file is self-contained.
+#include "asio/thread_affinity.hpp"
+
+#include "asio/post.hpp"
+#include "asio/thread.hpp"
+#include "asio/thread_pool.hpp"
+#include "unit_test.hpp"
+
+#if defined(__linux__)
+# include <pthread.h>
+# include <sched.h>
+#endif // defined(__linux__)
+
+#if defined(ASIO_HAS_BOOST_BIND)
+# include <boost/bind/bind.hpp>
+#else // defined(ASIO_HAS_BOOST_BIND)
+# include <functional>
+#endif // defined(ASIO_HAS_BOOST_BIND)
+
+#if defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = boost;
+#else // defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = std;
+#endif
+
+using namespace asio;
+
+#if defined(__linux__) && defined(CPU_SET)
+
+// Get the CPUs on which the calling thread may run.
+thread_affinity current_affinity()
+{
+  thread_affinity affinity;
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  if (::pthread_getaffinity_np(::pthread_self(),
+        sizeof(cpu_set), &cpu_set) == 0)
+  {
+    for (std::size_t cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+      if (CPU_ISSET(cpu, &cpu_set))
+        affinity.add_cpu(cpu);
+  }
+  return affinity;
+}
+
+void record_affinity(thread_affinity* result)
+{
+  *result = current_affinity();
+}
+
+#endif // defined(__linux__) && defined(CPU_SET)
+
+// The set is kept in ascending order without duplicates.
+void thread_affinity_set_test()
+{
+  thread_affinity affinity;
+  ASIO_CHECK(affinity.empty());
+  ASIO_CHECK(affinity.size() == 0);
+  ASIO_CHECK(affinity.numa_node() == -1);
+  ASIO_CHECK(!affinity.distribute());
+
+  affinity.add_cpu(3).add_cpu(1).add_cpu(2).add_cpu(1);
+  ASIO_CHECK(!affinity.empty());
+  ASIO_CHECK(affinity.size() == 3);
+  ASIO_CHECK(affinity.cpu(0) == 1);
+  ASIO_CHECK(affinity.cpu(1) == 2);
+  ASIO_CHECK(affinity.cpu(2) == 3);
+  ASIO_CHECK(affinity.contains(2));
+  ASIO_CHECK(!affinity.contains(0));
+
+  affinity.distribute(true);
+  ASIO_CHECK(affinity.distribute());
+
+  // Binding to an empty set has no effect.
+  asio::error_code ec;
+  thread_affinity().apply(0, ec);
+  ASIO_CHECK(!ec);
+}
+
+// A thread is bound to all of the CPUs in the set, or to a single one when
+// the set distributes threads.
+void thread_affinity_apply_test()
+{
+#if defined(__linux__) && defined(CPU_SET)
+  thread_affinity original = current_affinity();
+  ASIO_CHECK(!original.empty());
+  if (original.empty())
+    return;
+
+  std::size_t last = original.cpu(original.size() - 1);
+
+  {
+    thread_affinity single;
+    single.add_cpu(last);
+    thread_affinity result;
+    asio::thread t(bindns::bind(record_affinity, &result), single);
+    t.join();
+    ASIO_CHECK(result.size() == 1);
+    ASIO_CHECK(result.contains(last));
+  }
+
+  {
+    // Each thread is bound to the CPU at its index, wrapping around.
+    thread_affinity distributed = original;
+    distributed.distribute(true);
+    thread_affinity result;
+    std::size_t index = original.size() + 1;
+    asio::thread t(bindns::bind(record_affinity, &result),
+        distributed, index);
+    t.join();
+    ASIO_CHECK(result.size() == 1);
+    ASIO_CHECK(result.contains(original.cpu(index % original.size())));
+  }
+
+  {
+    // Threads in a pool are bound before they run any handlers.
+    thread_affinity single;
+    single.add_cpu(last);
+    thread_pool pool(2, single);
+    thread_affinity result;
+    asio::post(pool, bindns::bind(record_affinity, &result));
+    pool.join();
+    ASIO_CHECK(result.size() == 1);
+    ASIO_CHECK(result.contains(last));
+  }
+
+  {
+    // A CPU that cannot exist is rejected.
+    thread_affinity invalid;
+    invalid.add_cpu(CPU_SETSIZE);
+    asio::error_code ec;
+    invalid.apply(0, ec);
+    ASIO_CHECK(ec == asio::error::invalid_argument);
+    ASIO_CHECK(current_affinity().size() == original.size());
+  }
+#endif // defined(__linux__) && defined(CPU_SET)
+}
+
+// A NUMA node's CPUs are read from the operating system, and a node that does
+// not exist is an error.
+void thread_affinity_numa_test()
+{
+#if defined(__linux__)
+  asio::error_code ec;
+  thread_affinity node = thread_affinity::numa_node(0, ec);
+  if (!ec)
+  {
+    ASIO_CHECK(!node.empty());
+    ASIO_CHECK(node.numa_node() == 0);
+  }
+
+  thread_affinity::numa_node(-1, ec);
+  ASIO_CHECK(ec == asio::error::invalid_argument);
+
+  thread_affinity missing = thread_affinity::numa_node(1 << 20, ec);
+  ASIO_CHECK(ec == asio::error::invalid_argument);
+  ASIO_CHECK(missing.empty());
+#endif // defined(__linux__)
+}
+
+ASIO_TEST_SUITE
+(
+  "thread_affinity",
+  ASIO_TEST_CASE(thread_affinity_set_test)
+  ASIO_TEST_CASE(thread_affinity_apply_test)
+  ASIO_TEST_CASE(thread_affinity_numa_test)
+)
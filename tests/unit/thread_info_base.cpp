@@ -0,0 +1,122 @@
+//
+// thread_info_base.cpp
+// ~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2020 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Disable autolinking for unit tests.
+#if !defined(BOOST_ALL_NO_LIB)
+#define BOOST_ALL_NO_LIB 1
+#endif // !defined(BOOST_ALL_NO_LIB)
+
+#include "asio/detail/thread_info_base.hpp"
+
+#include "unit_test.hpp"
+
+using asio::detail::thread_info_base;
+
+// Several blocks of each size are kept, and a freed block is reused by the
+// next allocation of the same size class.
+void thread_info_base_size_class_test()
+{
+  thread_info_base info;
+  ASIO_CHECK(info.max_cached_blocks() == 4);
+  ASIO_CHECK(info.cached_bytes() == 0);
+
+  void* blocks[5];
+  for (int i = 0; i < 5; ++i)
+    blocks[i] = thread_info_base::allocate(&info, 40);
+  ASIO_CHECK(info.cache_hits() == 0);
+  ASIO_CHECK(info.cache_misses() == 5);
+
+  // Only four of the five blocks are kept.
+  for (int i = 0; i < 5; ++i)
+    thread_info_base::deallocate(&info, blocks[i], 40);
+  ASIO_CHECK(info.cached_bytes() == 4 * 64);
+
+  // Blocks are reused most recently freed first, for any size in the class.
+  void* p = thread_info_base::allocate(&info, 50);
+  ASIO_CHECK(p == blocks[3]);
+  ASIO_CHECK(info.cache_hits() == 1);
+  thread_info_base::deallocate(&info, p, 50);
+
+  // A different size class does not use those blocks.
+  void* q = thread_info_base::allocate(&info, 100);
+  ASIO_CHECK(info.cache_misses() == 6);
+  thread_info_base::deallocate(&info, q, 100);
+  ASIO_CHECK(info.cached_bytes() == 4 * 64 + 128);
+
+  // A block also holds a tag byte after the requested size, so an allocation
+  // of a whole block's size uses the next size class.
+  void* r = thread_info_base::allocate(&info, 64);
+  ASIO_CHECK(r == q);
+  thread_info_base::deallocate(&info, r, 64);
+}
+
+// Blocks are shared between purposes, and allocations that are too large, or
+// that are made without a thread, are not cached.
+void thread_info_base_purpose_test()
+{
+  thread_info_base info;
+
+  void* p = thread_info_base::allocate(
+      thread_info_base::executor_function_tag(), &info, 200);
+  thread_info_base::deallocate(
+      thread_info_base::executor_function_tag(), &info, p, 200);
+
+  void* q = thread_info_base::allocate(
+      thread_info_base::awaitable_frame_tag(), &info, 250);
+  ASIO_CHECK(q == p);
+  ASIO_CHECK(info.cache_hits() == 1);
+  thread_info_base::deallocate(
+      thread_info_base::awaitable_frame_tag(), &info, q, 250);
+
+  void* large = thread_info_base::allocate(&info, 100000);
+  thread_info_base::deallocate(&info, large, 100000);
+  ASIO_CHECK(info.cached_bytes() == 256);
+
+  void* orphan = thread_info_base::allocate(0, 64);
+  thread_info_base::deallocate(0, orphan, 64);
+  ASIO_CHECK(info.cached_bytes() == 256);
+}
+
+// Lowering the limit, or trimming, releases the cached blocks in excess.
+void thread_info_base_trim_test()
+{
+  thread_info_base info;
+
+  void* blocks[8];
+  for (int i = 0; i < 4; ++i)
+  {
+    blocks[i] = thread_info_base::allocate(&info, 60);
+    blocks[i + 4] = thread_info_base::allocate(&info, 1000);
+  }
+  for (int i = 0; i < 8; ++i)
+    thread_info_base::deallocate(&info, blocks[i], i < 4 ? 60 : 1000);
+  ASIO_CHECK(info.cached_bytes() == 4 * 64 + 4 * 1024);
+
+  info.max_cached_blocks(2);
+  ASIO_CHECK(info.max_cached_blocks() == 2);
+  ASIO_CHECK(info.cached_bytes() == 2 * 64 + 2 * 1024);
+
+  info.trim(0);
+  ASIO_CHECK(info.cached_bytes() == 0);
+
+  // With no blocks cached, freed memory is released at once.
+  info.max_cached_blocks(0);
+  void* p = thread_info_base::allocate(&info, 60);
+  thread_info_base::deallocate(&info, p, 60);
+  ASIO_CHECK(info.cached_bytes() == 0);
+}
+
+ASIO_TEST_SUITE
+(
+  "thread_info_base",
+  ASIO_TEST_CASE(thread_info_base_size_class_test)
+  ASIO_TEST_CASE(thread_info_base_purpose_test)
+  ASIO_TEST_CASE(thread_info_base_trim_test)
+)
@@ -0,0 +1,199 @@
+//
+// timer_wheel_traits.cpp
+// ~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2020 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Disable autolinking for unit tests.
+#if !defined(BOOST_ALL_NO_LIB)
+#define BOOST_ALL_NO_LIB 1
+#endif // !defined(BOOST_ALL_NO_LIB)
+
+// Test that header file is self-contained.
+#include "asio/timer_wheel_traits.hpp"
+
+#include <cstdlib>
+#include <vector>
+#include "asio/basic_waitable_timer.hpp"
+#include "asio/io_context.hpp"
+#include "unit_test.hpp"
+
+#if defined(ASIO_HAS_BOOST_BIND)
+# include <boost/bind/bind.hpp>
+#else // defined(ASIO_HAS_BOOST_BIND)
+# include <functional>
+#endif // defined(ASIO_HAS_BOOST_BIND)
+
+#if defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = boost;
+#else // defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = std;
+#endif
+
+#if defined(ASIO_HAS_CHRONO)
+
+typedef asio::chrono::steady_clock clock_type;
+
+// A tick of 100us, so that every level of the wheel below the third is used
+// by waits of less than half a second.
+typedef asio::basic_waitable_timer<clock_type,
+    asio::timer_wheel_wait_traits<clock_type, 100> > wheel_timer;
+
+struct wait_result
+{
+  clock_type::time_point expiry;
+  clock_type::time_point completed;
+  asio::error_code ec;
+  bool called;
+};
+
+void handle_wait(const asio::error_code& ec, wait_result* result)
+{
+  result->completed = clock_type::now();
+  result->ec = ec;
+  result->called = true;
+}
+
+// Waits spread over several levels of the wheel complete successfully, and
+// never before their expiry times.
+void timer_wheel_expiry_test()
+{
+  asio::io_context ioc;
+  const std::size_t n = 2000;
+  std::vector<wheel_timer*> timers;
+  std::vector<wait_result> results(n);
+
+  std::srand(1);
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    // Mostly short waits, with some reaching into the higher levels.
+    long usec = (i % 10 == 0) ? std::rand() % 400000 : std::rand() % 20000;
+    timers.push_back(new wheel_timer(ioc,
+          asio::chrono::microseconds(usec)));
+    results[i].expiry = timers.back()->expiry();
+    results[i].called = false;
+    timers.back()->async_wait(bindns::bind(handle_wait,
+          bindns::placeholders::_1, &results[i]));
+  }
+
+  ioc.run();
+
+  std::size_t called = 0, succeeded = 0, early = 0;
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    called += results[i].called ? 1 : 0;
+    succeeded += results[i].ec ? 0 : 1;
+    early += results[i].completed < results[i].expiry ? 1 : 0;
+    delete timers[i];
+  }
+  ASIO_CHECK(called == n);
+  ASIO_CHECK(succeeded == n);
+  ASIO_CHECK(early == 0);
+}
+
+// Cancelled waits complete with operation_aborted, while the remaining waits
+// in the same slots still expire.
+void timer_wheel_cancel_test()
+{
+  asio::io_context ioc;
+  const std::size_t n = 1000;
+  std::vector<wheel_timer*> timers;
+  std::vector<wait_result> results(n);
+
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    timers.push_back(new wheel_timer(ioc,
+          asio::chrono::milliseconds(5 + i % 20)));
+    results[i].called = false;
+    timers.back()->async_wait(bindns::bind(handle_wait,
+          bindns::placeholders::_1, &results[i]));
+  }
+
+  for (std::size_t i = 0; i < n; i += 2)
+    ASIO_CHECK(timers[i]->cancel() == 1);
+
+  ioc.run();
+
+  std::size_t aborted = 0, succeeded = 0;
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    ASIO_CHECK(results[i].called);
+    if (i % 2 == 0)
+      aborted += results[i].ec == asio::error::operation_aborted ? 1 : 0;
+    else
+      succeeded += results[i].ec ? 0 : 1;
+    delete timers[i];
+  }
+  ASIO_CHECK(aborted == n / 2);
+  ASIO_CHECK(succeeded == n / 2);
+}
+
+// Moving a wait's expiry, a wait beyond the span of the wheel, and a wait that
+// has already expired.
+void timer_wheel_reschedule_test()
+{
+  asio::io_context ioc;
+
+  // A wait far beyond the span of every level is held until cancelled.
+  wheel_timer distant(ioc, asio::chrono::hours(24 * 365));
+  wait_result distant_result = wait_result();
+  distant.async_wait(bindns::bind(handle_wait,
+        bindns::placeholders::_1, &distant_result));
+
+  // Bringing a wait forward cancels the original and starts it in a lower
+  // level.
+  wheel_timer moved(ioc, asio::chrono::seconds(30));
+  wait_result first = wait_result();
+  moved.async_wait(bindns::bind(handle_wait,
+        bindns::placeholders::_1, &first));
+  ASIO_CHECK(moved.expires_after(asio::chrono::milliseconds(10)) == 1);
+  wait_result second = wait_result();
+  second.expiry = moved.expiry();
+  moved.async_wait(bindns::bind(handle_wait,
+        bindns::placeholders::_1, &second));
+
+  // A wait that has already expired completes at once.
+  wheel_timer past(ioc, clock_type::now() - asio::chrono::seconds(1));
+  wait_result past_result = wait_result();
+  past.async_wait(bindns::bind(handle_wait,
+        bindns::placeholders::_1, &past_result));
+
+  ioc.run_for(asio::chrono::milliseconds(100));
+
+  ASIO_CHECK(first.called);
+  ASIO_CHECK(first.ec == asio::error::operation_aborted);
+  ASIO_CHECK(second.called);
+  ASIO_CHECK(!second.ec);
+  ASIO_CHECK(second.completed >= second.expiry);
+  ASIO_CHECK(past_result.called);
+  ASIO_CHECK(!past_result.ec);
+  ASIO_CHECK(!distant_result.called);
+
+  ASIO_CHECK(distant.cancel() == 1);
+  ioc.restart();
+  ioc.run();
+  ASIO_CHECK(distant_result.called);
+  ASIO_CHECK(distant_result.ec == asio::error::operation_aborted);
+}
+
+ASIO_TEST_SUITE
+(
+  "timer_wheel_traits",
+  ASIO_TEST_CASE(timer_wheel_expiry_test)
+  ASIO_TEST_CASE(timer_wheel_cancel_test)
+  ASIO_TEST_CASE(timer_wheel_reschedule_test)
+)
+
+#else // defined(ASIO_HAS_CHRONO)
+
+ASIO_TEST_SUITE
+(
+  "timer_wheel_traits",
+  ASIO_TEST_CASE(null_test)
+)
+
+#endif // defined(ASIO_HAS_CHRONO)
@@ -0,0 +1,291 @@
+//
+// transfer.cpp
+// ~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2020 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Disable autolinking for unit tests.
+#if !defined(BOOST_ALL_NO_LIB)
+#define BOOST_ALL_NO_LIB 1
+#endif // !defined(BOOST_ALL_NO_LIB)
+
+// Test that header file is self-contained.
+#include "asio/transfer.hpp"
+
+#include "unit_test.hpp"
+
+#if defined(ASIO_HAS_SPLICE)
+
+#include <cstdlib>
+#include <limits>
+#include <vector>
+#include <unistd.h>
+#include "asio/io_context.hpp"
+#include "asio/local/connect_pair.hpp"
+#include "asio/local/stream_protocol.hpp"
+#include "asio/posix/stream_descriptor.hpp"
+#include "asio/read.hpp"
+#include "asio/write.hpp"
+
+#if defined(ASIO_HAS_BOOST_BIND)
+# include <boost/bind/bind.hpp>
+#else // defined(ASIO_HAS_BOOST_BIND)
+# include <functional>
+#endif // defined(ASIO_HAS_BOOST_BIND)
+
+#if defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = boost;
+#else // defined(ASIO_HAS_BOOST_BIND)
+namespace bindns = std;
+#endif
+
+using namespace asio;
+
+typedef local::stream_protocol::socket socket_type;
+
+struct transfer_result
+{
+  asio::error_code ec;
+  std::size_t bytes;
+  bool called;
+};
+
+void handle_transfer(const asio::error_code& ec,
+    std::size_t bytes, transfer_result* r)
+{
+  r->ec = ec;
+  r->bytes = bytes;
+  r->called = true;
+}
+
+std::vector<char> make_data(std::size_t size)
+{
+  std::vector<char> data(size);
+  for (std::size_t i = 0; i < size; ++i)
+    data[i] = static_cast<char>(i * 13 + i / 509);
+  return data;
+}
+
+// Data moves from one socket to another intact, in more pieces than fit in
+// the pipe at once, while the ends are written and read concurrently.
+void transfer_socket_test()
+{
+  io_context ioc;
+  socket_type in_writer(ioc), in_reader(ioc);
+  socket_type out_writer(ioc), out_reader(ioc);
+  local::connect_pair(in_writer, in_reader);
+  local::connect_pair(out_writer, out_reader);
+
+  const std::size_t size = 1 << 20;
+  std::vector<char> data = make_data(size);
+  std::vector<char> received(size);
+
+  transfer_result w = transfer_result(), t = transfer_result();
+  transfer_result r = transfer_result();
+  async_write(in_writer, asio::buffer(data),
+      bindns::bind(handle_transfer, bindns::placeholders::_1,
+        bindns::placeholders::_2, &w));
+  async_transfer(in_reader, out_writer, size,
+      bindns::bind(handle_transfer, bindns::placeholders::_1,
+        bindns::placeholders::_2, &t));
+  async_read(out_reader, asio::buffer(received),
+      bindns::bind(handle_transfer, bindns::placeholders::_1,
+        bindns::placeholders::_2, &r));
+  ioc.run();
+
+  ASIO_CHECK(w.called && !w.ec);
+  ASIO_CHECK(t.called);
+  ASIO_CHECK(!t.ec);
+  ASIO_CHECK(t.bytes == size);
+  ASIO_CHECK(r.called && !r.ec);
+  ASIO_CHECK(received == data);
+}
+
+// A source that ends before the requested size is reached completes with
+// eof, unless the transfer was asked to run until the end. A transfer of
+// nothing completes at once.
+void transfer_eof_test()
+{
+  io_context ioc;
+  const std::size_t size = 100000;
+  std::vector<char> data = make_data(size);
+
+  for (int until_end = 0; until_end < 2; ++until_end)
+  {
+    socket_type in_writer(ioc), in_reader(ioc);
+    socket_type out_writer(ioc), out_reader(ioc);
+    local::connect_pair(in_writer, in_reader);
+    local::connect_pair(out_writer, out_reader);
+
+    std::vector<char> received(size);
+    transfer_result w = transfer_result(), t = transfer_result();
+    transfer_result r = transfer_result();
+    async_write(in_writer, asio::buffer(data),
+        bindns::bind(handle_transfer, bindns::placeholders::_1,
+          bindns::placeholders::_2, &w));
+    async_transfer(in_reader, out_writer, until_end
+          ? (std::numeric_limits<std::size_t>::max)() : size * 2,
+        bindns::bind(handle_transfer, bindns::placeholders::_1,
+          bindns::placeholders::_2, &t));
+    async_read(out_reader, asio::buffer(received),
+        bindns::bind(handle_transfer, bindns::placeholders::_1,
+          bindns::placeholders::_2, &r));
+
+    ioc.restart();
+    while (!w.called)
+      ioc.run_one();
+    in_writer.close();
+    ioc.restart();
+    ioc.run();
+
+    ASIO_CHECK(t.called);
+    if (until_end)
+      ASIO_CHECK(!t.ec);
+    else
+      ASIO_CHECK(t.ec == asio::error::eof);
+    ASIO_CHECK(t.bytes == size);
+    ASIO_CHECK(r.called && !r.ec);
+    ASIO_CHECK(received == data);
+  }
+
+  socket_type a(ioc), b(ioc);
+  local::connect_pair(a, b);
+  transfer_result t = transfer_result();
+  async_transfer(a, b, 0, bindns::bind(handle_transfer,
+        bindns::placeholders::_1, bindns::placeholders::_2, &t));
+  ASIO_CHECK(!t.called);
+  ioc.restart();
+  ioc.run();
+  ASIO_CHECK(t.called);
+  ASIO_CHECK(!t.ec);
+  ASIO_CHECK(t.bytes == 0);
+}
+
+// A transfer waiting on a source with no data is cancelled with it.
+void transfer_cancel_test()
+{
+  io_context ioc;
+  socket_type in_writer(ioc), in_reader(ioc);
+  socket_type out_writer(ioc), out_reader(ioc);
+  local::connect_pair(in_writer, in_reader);
+  local::connect_pair(out_writer, out_reader);
+
+  transfer_result t = transfer_result();
+  async_transfer(in_reader, out_writer, 1000,
+      bindns::bind(handle_transfer, bindns::placeholders::_1,
+        bindns::placeholders::_2, &t));
+  ioc.poll();
+  ASIO_CHECK(!t.called);
+
+  in_reader.cancel();
+  ioc.restart();
+  ioc.run();
+  ASIO_CHECK(t.called);
+  ASIO_CHECK(t.ec == asio::error::operation_aborted);
+  ASIO_CHECK(t.bytes == 0);
+}
+
+// A pipe, wrapped in a stream descriptor, may be the source of a transfer.
+void transfer_descriptor_test()
+{
+  io_context ioc;
+  int fds[2];
+  ASIO_CHECK(::pipe(fds) == 0);
+  posix::stream_descriptor pipe_reader(ioc, fds[0]);
+  posix::stream_descriptor pipe_writer(ioc, fds[1]);
+  socket_type out_writer(ioc), out_reader(ioc);
+  local::connect_pair(out_writer, out_reader);
+
+  const std::size_t size = 300000;
+  std::vector<char> data = make_data(size);
+  std::vector<char> received(size);
+
+  transfer_result w = transfer_result(), t = transfer_result();
+  transfer_result r = transfer_result();
+  async_write(pipe_writer, asio::buffer(data),
+      bindns::bind(handle_transfer, bindns::placeholders::_1,
+        bindns::placeholders::_2, &w));
+  async_transfer(pipe_reader, out_writer, size,
+      bindns::bind(handle_transfer, bindns::placeholders::_1,
+        bindns::placeholders::_2, &t));
+  async_read(out_reader, asio::buffer(received),
+      bindns::bind(handle_transfer, bindns::placeholders::_1,
+        bindns::placeholders::_2, &r));
+  ioc.run();
+
+  ASIO_CHECK(w.called && !w.ec);
+  ASIO_CHECK(t.called && !t.ec);
+  ASIO_CHECK(t.bytes == size);
+  ASIO_CHECK(received == data);
+}
+
+// Part of a file is sent from an offset, leaving the descriptor's file
+// offset unchanged, and a range past the end of the file ends with eof.
+void transfer_file_test()
+{
+  char name[] = "/tmp/asio_transfer_XXXXXX";
+  int fd = ::mkstemp(name);
+  ASIO_CHECK(fd >= 0);
+  if (fd < 0)
+    return;
+  ::unlink(name);
+
+  const std::size_t size = 200000;
+  std::vector<char> data = make_data(size);
+  ASIO_CHECK(::write(fd, &data[0], size) == static_cast<ssize_t>(size));
+  ::lseek(fd, 10, SEEK_SET);
+
+  io_context ioc;
+  socket_type out_writer(ioc), out_reader(ioc);
+  local::connect_pair(out_writer, out_reader);
+
+  const std::size_t offset = 1234;
+  std::vector<char> received(size - offset);
+  transfer_result t = transfer_result(), r = transfer_result();
+  async_transfer_file(fd, offset, size - offset, out_writer,
+      bindns::bind(handle_transfer, bindns::placeholders::_1,
+        bindns::placeholders::_2, &t));
+  async_read(out_reader, asio::buffer(received),
+      bindns::bind(handle_transfer, bindns::placeholders::_1,
+        bindns::placeholders::_2, &r));
+  ioc.run();
+
+  ASIO_CHECK(t.called && !t.ec);
+  ASIO_CHECK(t.bytes == size - offset);
+  ASIO_CHECK(r.called && !r.ec);
+  ASIO_CHECK(std::vector<char>(data.begin() + offset, data.end())
+      == received);
+  ASIO_CHECK(::lseek(fd, 0, SEEK_CUR) == 10);
+
+  t = transfer_result();
+  async_transfer_file(fd, size - 10, 100, out_writer,
+      bindns::bind(handle_transfer, bindns::placeholders::_1,
+        bindns::placeholders::_2, &t));
+  ioc.restart();
+  ioc.run();
+  ASIO_CHECK(t.called);
+  ASIO_CHECK(t.ec == asio::error::eof);
+  ASIO_CHECK(t.bytes == 10);
+
+  ::close(fd);
+}
+
+#endif // defined(ASIO_HAS_SPLICE)
+
+ASIO_TEST_SUITE
+(
+  "transfer",
+#if defined(ASIO_HAS_SPLICE)
+  ASIO_TEST_CASE(transfer_socket_test)
+  ASIO_TEST_CASE(transfer_eof_test)
+  ASIO_TEST_CASE(transfer_cancel_test)
+  ASIO_TEST_CASE(transfer_descriptor_test)
+  ASIO_TEST_CASE(transfer_file_test)
+#else // defined(ASIO_HAS_SPLICE)
+  ASIO_TEST_CASE(null_test)
+#endif // defined(ASIO_HAS_SPLICE)
+)
@@ -16,8 +16,11 @@
 #endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
 
 #include "detail/config.hpp"
+#include <cstddef>
+#include "detail/affinity_thread_function.hpp"
 #include "detail/noncopyable.hpp"
 #include "detail/thread.hpp"
+#include "thread_affinity.hpp"
 
 #include "detail/push_options.hpp"
 
@@ -63,6 +66,30 @@ public:
   {
   }
 
+  /// Start a new thread that is bound to the specified CPUs and executes the
+  /// supplied function.
+  /**
+   * This constructor creates a new thread that binds itself to the CPUs in the
+   * given affinity, and then executes the given function or function object.
+   *
+   * @param f The function or function object to be run in the thread. The
+   * function signature must be: @code void f(); @endcode
+   *
+   * @param affinity The CPUs to which the thread is bound. If the thread cannot
+   * be bound, it runs the function anyway.
+   *
+   * @param thread_index The position of the thread among the threads that
+   * share the affinity. Used to select a CPU when the affinity distributes
+   * threads.
+   */
+  template <typename Function>
+  thread(Function f, const thread_affinity& affinity,
+      std::size_t thread_index = 0)
+    : impl_(detail::affinity_thread_function<Function>(
+          f, affinity, thread_index))
+  {
+  }
+
   /// Destructor.
   ~thread()
   {
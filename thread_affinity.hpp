@@ -0,0 +1,171 @@
+//
+// thread_affinity.hpp
+// ~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2020 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_THREAD_AFFINITY_HPP
+#define ASIO_THREAD_AFFINITY_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "detail/config.hpp"
+#include <cstddef>
+#include <vector>
+#include "error_code.hpp"
+
+#include "detail/push_options.hpp"
+
+namespace asio {
+
+/// Describes the CPUs on which threads are permitted to run.
+/**
+ * A thread_affinity object holds a set of CPUs, numbered from zero as they
+ * are by the operating system. It may be passed to thread_pool,
+ * io_context_pool or thread, each of which binds the threads that it starts
+ * to the CPUs in the set before the thread runs any other code.
+ *
+ * A default-constructed thread_affinity holds no CPUs, and threads started
+ * with it are left to run wherever the operating system schedules them.
+ *
+ * @par Distributing threads between CPUs
+ *
+ * By default every thread may run on any of the CPUs in the set. When
+ * distribution is enabled, each thread is instead bound to a single CPU: the
+ * first thread started to the first CPU in the set, the second thread to the
+ * second CPU, and so on, wrapping around when the CPUs are exhausted.
+ *
+ * @par NUMA nodes
+ *
+ * An affinity obtained from numa_node() holds the CPUs of that node. On Linux,
+ * a thread bound to it also asks the kernel to prefer that node's memory for
+ * its own allocations. Since each thread caches and reuses the memory used for
+ * its handlers, that memory then stays local to the node.
+ *
+ * @par Example
+ * Run a thread pool on NUMA node 1, with one thread bound to each of the
+ * node's CPUs:
+ * @code asio::thread_affinity affinity = asio::thread_affinity::numa_node(1);
+ * asio::thread_pool pool(affinity.size(), affinity.distribute(true)); @endcode
+ */
+class thread_affinity
+{
+public:
+  /// Construct an affinity that holds no CPUs.
+  thread_affinity()
+    : numa_node_(-1),
+      distribute_(false)
+  {
+  }
+
+  /// Obtain an affinity that holds the CPUs of the specified NUMA node.
+  /**
+   * @throws asio::system_error Thrown on failure, including on platforms
+   * where the topology of NUMA nodes is not available.
+   */
+  ASIO_DECL static thread_affinity numa_node(int node);
+
+  /// Obtain an affinity that holds the CPUs of the specified NUMA node.
+  /**
+   * @param node The number of the NUMA node.
+   *
+   * @param ec Set to indicate what error occurred, if any. Set to
+   * asio::error::operation_not_supported on platforms where the topology
+   * of NUMA nodes is not available.
+   */
+  ASIO_DECL static thread_affinity numa_node(int node, asio::error_code& ec);
+
+  /// Add a CPU to the set.
+  ASIO_DECL thread_affinity& add_cpu(std::size_t cpu);
+
+  /// Determine whether the set contains a CPU.
+  ASIO_DECL bool contains(std::size_t cpu) const;
+
+  /// Determine whether the set is empty.
+  bool empty() const
+  {
+    return cpus_.empty();
+  }
+
+  /// Get the number of CPUs in the set.
+  std::size_t size() const
+  {
+    return cpus_.size();
+  }
+
+  /// Get the CPU at the specified position in the set, in ascending order.
+  std::size_t cpu(std::size_t index) const
+  {
+    return cpus_[index];
+  }
+
+  /// Get the NUMA node from which the affinity was obtained, or -1 if none.
+  int numa_node() const
+  {
+    return numa_node_;
+  }
+
+  /// Get whether each thread is bound to a single CPU of the set.
+  bool distribute() const
+  {
+    return distribute_;
+  }
+
+  /// Set whether each thread is bound to a single CPU of the set.
+  thread_affinity& distribute(bool enabled)
+  {
+    distribute_ = enabled;
+    return *this;
+  }
+
+  /// Bind the calling thread.
+  /**
+   * @param thread_index The position of the calling thread among the threads
+   * that share this affinity. Used to select a CPU when distribution is
+   * enabled.
+   *
+   * @throws asio::system_error Thrown on failure.
+   */
+  ASIO_DECL void apply(std::size_t thread_index) const;
+
+  /// Bind the calling thread.
+  /**
+   * Has no effect if the set is empty.
+   *
+   * @param thread_index The position of the calling thread among the threads
+   * that share this affinity. Used to select a CPU when distribution is
+   * enabled.
+   *
+   * @param ec Set to indicate what error occurred, if any. Set to
+   * asio::error::operation_not_supported on platforms where threads cannot
+   * be bound to CPUs.
+   */
+  ASIO_DECL ASIO_SYNC_OP_VOID apply(std::size_t thread_index,
+      asio::error_code& ec) const;
+
+private:
+  // The CPUs in the set, in ascending order.
+  std::vector<std::size_t> cpus_;
+
+  // The NUMA node from which the set was obtained, or -1.
+  int numa_node_;
+
+  // Whether each thread is bound to a single CPU.
+  bool distribute_;
+};
+
+} // namespace asio
+
+#include "detail/pop_options.hpp"
+
+#if defined(ASIO_HEADER_ONLY)
+#include "impl/thread_affinity.ipp"
+#endif // defined(ASIO_HEADER_ONLY)
+
+#endif // ASIO_THREAD_AFFINITY_HPP
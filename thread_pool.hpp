@@ -19,6 +19,7 @@
 #include "detail/scheduler.hpp"
 #include "detail/thread_group.hpp"
 #include "execution_context.hpp"
+#include "thread_affinity.hpp"
 
 #include "detail/push_options.hpp"
 
@@ -71,6 +72,11 @@ public:
   /// Constructs a pool with a specified number of threads.
   ASIO_DECL thread_pool(std::size_t num_threads);
 
+  /// Constructs a pool with a specified number of threads, each of which is
+  /// bound to the specified CPUs.
+  ASIO_DECL thread_pool(std::size_t num_threads,
+      const thread_affinity& affinity);
+
   /// Destructor.
   /**
    * Automatically stops and joins the pool, if not explicitly done beforehand.
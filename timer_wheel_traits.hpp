@@ -0,0 +1,99 @@
+//
+// timer_wheel_traits.hpp
+// ~~~~~~~~~~~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2020 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_TIMER_WHEEL_TRAITS_HPP
+#define ASIO_TIMER_WHEEL_TRAITS_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "detail/config.hpp"
+#include "wait_traits.hpp"
+
+#if defined(ASIO_HAS_BOOST_DATE_TIME)
+# include "time_traits.hpp"
+#endif // defined(ASIO_HAS_BOOST_DATE_TIME)
+
+#include "detail/push_options.hpp"
+
+namespace asio {
+
+/// Wait traits that select a timing wheel for the basic_waitable_timer class
+/// template.
+/**
+ * By default, the pending waits of all timers that share a clock and wait
+ * traits are kept in order of expiry, so that starting or cancelling a wait
+ * takes time proportional to the logarithm of the number of pending waits.
+ * When a timer uses these wait traits, its waits are instead kept in a timing
+ * wheel, where both operations take constant time. This suits programs that
+ * start and cancel many more waits than are allowed to expire, such as those
+ * with an inactivity timeout per connection.
+ *
+ * The wheel measures time in ticks. A wait's expiry time is rounded up to the
+ * next tick, so a wait may complete up to one tick later than it would
+ * otherwise, but never earlier.
+ *
+ * @tparam Clock The clock type.
+ *
+ * @tparam TickMicroseconds The length of a tick, in microseconds.
+ *
+ * @tparam WaitTraits The wait traits that supply all other behaviour.
+ *
+ * @par Example
+ * A timer whose waits complete within ten milliseconds of their expiry:
+ * @code typedef asio::basic_waitable_timer<
+ *     std::chrono::steady_clock,
+ *     asio::timer_wheel_wait_traits<std::chrono::steady_clock, 10000> >
+ *   timeout_timer; @endcode
+ */
+template <typename Clock, long TickMicroseconds = 1000,
+    typename WaitTraits = asio::wait_traits<Clock> >
+struct timer_wheel_wait_traits
+  : WaitTraits
+{
+  /// The length of a tick, in microseconds.
+  static const long tick_microseconds = TickMicroseconds;
+};
+
+#if defined(ASIO_HAS_BOOST_DATE_TIME) \
+  || defined(GENERATING_DOCUMENTATION)
+
+/// Time traits that select a timing wheel for the basic_deadline_timer class
+/// template.
+/**
+ * These time traits behave as @c TimeTraits, except that the timer's pending
+ * waits are kept in a timing wheel. See timer_wheel_wait_traits for details.
+ *
+ * @tparam Time The time type.
+ *
+ * @tparam TickMicroseconds The length of a tick, in microseconds.
+ *
+ * @tparam TimeTraits The time traits that supply all other behaviour.
+ */
+template <typename Time, long TickMicroseconds = 1000,
+    typename TimeTraits = asio::time_traits<Time> >
+struct timer_wheel_time_traits
+  : TimeTraits
+{
+  /// The length of a tick, in microseconds.
+  static const long tick_microseconds = TickMicroseconds;
+};
+
+#endif // defined(ASIO_HAS_BOOST_DATE_TIME)
+       //   || defined(GENERATING_DOCUMENTATION)
+
+} // namespace asio
+
+#include "detail/pop_options.hpp"
+
+#include "detail/timer_queue_wheel.hpp"
+
+#endif // ASIO_TIMER_WHEEL_TRAITS_HPP
@@ -0,0 +1,189 @@
+//
+// transfer.hpp
+// ~~~~~~~~~~~~
+//
+// Copyright (c) 2003-2020 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef ASIO_TRANSFER_HPP
+#define ASIO_TRANSFER_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "detail/config.hpp"
+
+#if defined(ASIO_HAS_SPLICE) \
+  || defined(GENERATING_DOCUMENTATION)
+
+#include <cstddef>
+#include "async_result.hpp"
+#include "error.hpp"
+#include "detail/cstdint.hpp"
+
+#include "detail/push_options.hpp"
+
+namespace asio {
+
+/**
+ * @defgroup async_transfer asio::async_transfer
+ *
+ * @brief The @c async_transfer function is a composed asynchronous operation
+ * that moves data from one stream to another without copying it through a
+ * user-space buffer.
+ */
+/*@{*/
+
+/// Start an asynchronous operation to move a certain amount of data from one
+/// stream to another.
+/**
+ * This function is used to asynchronously move a certain number of bytes of
+ * data from a source stream to a destination stream. The data passes through
+ * a kernel pipe using @c splice(), and is never copied into user space. The
+ * function call always returns immediately. The asynchronous operation will
+ * continue until one of the following conditions is true:
+ *
+ * @li The requested number of bytes has been written to the destination.
+ *
+ * @li An error occurred. An error code of asio::error::eof indicates
+ * that the source reached the end of its data first.
+ *
+ * This operation is implemented in terms of zero or more calls to each
+ * stream's async_wait function, and is known as a <em>composed operation</em>.
+ * The program must ensure that the source performs no other read operations,
+ * and that the destination performs no other write operations, until this
+ * operation completes. The native handles of both streams are put into
+ * non-blocking mode.
+ *
+ * @param source The stream from which the data is to be read. The type must
+ * provide @c native_handle(), @c native_non_blocking() and @c async_wait(),
+ * such as basic_stream_socket or posix::basic_stream_descriptor.
+ *
+ * @param destination The stream to which the data is to be written. The type
+ * must meet the same requirements as the source.
+ *
+ * @param size The number of bytes to move. To move data until the source
+ * reaches the end of its data, pass the largest value of @c std::size_t. The
+ * operation then completes without error when the end is reached.
+ *
+ * @param handler The handler to be called when the transfer operation
+ * completes. Copies will be made of the handler as required. The function
+ * signature of the handler must be:
+ * @code void handler(
+ *   const asio::error_code& error, // Result of operation.
+ *
+ *   std::size_t bytes_transferred           // Number of bytes written to the
+ *                                           // destination. If an error
+ *                                           // occurred, this will be the
+ *                                           // number of bytes successfully
+ *                                           // transferred prior to the error.
+ * ); @endcode
+ * Regardless of whether the asynchronous operation completes immediately or
+ * not, the handler will not be invoked from within this function. On
+ * immediate completion, invocation of the handler will be performed in a
+ * manner equivalent to using asio::post().
+ *
+ * @note If the operation fails or is cancelled, data that has been read from
+ * the source but not yet written to the destination is discarded.
+ *
+ * @par Example
+ * Proxy the rest of a connection to another connection:
+ * @code asio::async_transfer(client, upstream,
+ *     (std::numeric_limits<std::size_t>::max)(), handler); @endcode
+ */
+template <typename AsyncReadStream, typename AsyncWriteStream,
+    ASIO_COMPLETION_TOKEN_FOR(void (asio::error_code,
+      std::size_t)) TransferHandler
+        ASIO_DEFAULT_COMPLETION_TOKEN_TYPE(
+          typename AsyncWriteStream::executor_type)>
+ASIO_INITFN_AUTO_RESULT_TYPE(TransferHandler,
+    void (asio::error_code, std::size_t))
+async_transfer(AsyncReadStream& source, AsyncWriteStream& destination,
+    std::size_t size,
+    ASIO_MOVE_ARG(TransferHandler) handler
+      ASIO_DEFAULT_COMPLETION_TOKEN(
+        typename AsyncWriteStream::executor_type));
+
+/// Start an asynchronous operation to send part of a file to a stream.
+/**
+ * This function is used to asynchronously send a certain number of bytes of
+ * data from a file to a stream, using @c sendfile(). The data is never copied
+ * into user space. The function call always returns immediately. The
+ * asynchronous operation will continue until one of the following conditions
+ * is true:
+ *
+ * @li The requested number of bytes has been written to the destination.
+ *
+ * @li An error occurred. An error code of asio::error::eof indicates
+ * that the end of the file was reached first.
+ *
+ * This operation is implemented in terms of zero or more calls to the
+ * destination's async_wait function, and is known as a <em>composed
+ * operation</em>. The program must ensure that the destination performs no
+ * other write operations until this operation completes. The destination's
+ * native handle is put into non-blocking mode.
+ *
+ * @param file A descriptor for a file that supports @c mmap(), such as a
+ * regular file. Ownership of the descriptor is retained by the caller, which
+ * must guarantee that it remains open until the handler is called. The
+ * descriptor's file offset is not changed.
+ *
+ * @param offset The offset in the file at which to start reading.
+ *
+ * @param size The number of bytes to send.
+ *
+ * @param destination The stream to which the data is to be written. The type
+ * must provide @c native_handle(), @c native_non_blocking() and
+ * @c async_wait(), such as basic_stream_socket or
+ * posix::basic_stream_descriptor.
+ *
+ * @param handler The handler to be called when the transfer operation
+ * completes. Copies will be made of the handler as required. The function
+ * signature of the handler must be:
+ * @code void handler(
+ *   const asio::error_code& error, // Result of operation.
+ *
+ *   std::size_t bytes_transferred           // Number of bytes written to the
+ *                                           // destination. If an error
+ *                                           // occurred, this will be the
+ *                                           // number of bytes successfully
+ *                                           // transferred prior to the error.
+ * ); @endcode
+ * Regardless of whether the asynchronous operation completes immediately or
+ * not, the handler will not be invoked from within this function. On
+ * immediate completion, invocation of the handler will be performed in a
+ * manner equivalent to using asio::post().
+ *
+ * @par Example
+ * @code asio::async_transfer_file(fd, 0, file_size, socket, handler);
+ * @endcode
+ */
+template <typename AsyncWriteStream,
+    ASIO_COMPLETION_TOKEN_FOR(void (asio::error_code,
+      std::size_t)) TransferHandler
+        ASIO_DEFAULT_COMPLETION_TOKEN_TYPE(
+          typename AsyncWriteStream::executor_type)>
+ASIO_INITFN_AUTO_RESULT_TYPE(TransferHandler,
+    void (asio::error_code, std::size_t))
+async_transfer_file(int file, uint64_t offset, std::size_t size,
+    AsyncWriteStream& destination,
+    ASIO_MOVE_ARG(TransferHandler) handler
+      ASIO_DEFAULT_COMPLETION_TOKEN(
+        typename AsyncWriteStream::executor_type));
+
+/*@}*/
+
+} // namespace asio
+
+#include "detail/pop_options.hpp"
+
+#include "impl/transfer.hpp"
+
+#endif // defined(ASIO_HAS_SPLICE)
+       //   || defined(GENERATING_DOCUMENTATION)
+
+#endif // ASIO_TRANSFER_HPP